@@ -21,11 +21,13 @@
 
 #include <QWidget>
 #include <QHBoxLayout>
+#include <QMessageBox>
 #include <QVBoxLayout>
 #include <QPushButton>
 #include <QScrollArea>
 #include <QSpacerItem>
 #include "config.h"
+#include "database/BtSqlQuery.h"
 
 AboutDialog::AboutDialog(QWidget * parent) :
    QDialog(parent),
@@ -220,13 +222,29 @@ void AboutDialog::doLayout()  {
       QHBoxLayout* horizontalLayout = new QHBoxLayout;
          QSpacerItem* horizontalSpacer = new QSpacerItem(40, 20, QSizePolicy::Expanding, QSizePolicy::Minimum);
          horizontalLayout->addItem(horizontalSpacer);
+         pushButton_dbStatistics = new QPushButton(this);
+         horizontalLayout->addWidget(pushButton_dbStatistics);
       verticalLayout->addWidget(scrollArea);
       verticalLayout->addLayout(horizontalLayout);
+   connect(pushButton_dbStatistics, &QAbstractButton::clicked, this, &AboutDialog::showDbStatistics);
    this->retranslateUi();
    return;
 }
 
+void AboutDialog::showDbStatistics() {
+   QMessageBox statisticsBox{this};
+   statisticsBox.setWindowTitle(tr("Database statistics"));
+   statisticsBox.setText(
+      tr("Timings for each kind of database query run since Brewtarget started, slowest overall first.  (These are "
+         "also written to the log file on exit.)")
+   );
+   statisticsBox.setDetailedText(BtSqlQuery::statisticsReport());
+   statisticsBox.exec();
+   return;
+}
+
 void AboutDialog::retranslateUi() {
    setWindowTitle(tr("About Brewtarget"));
+   pushButton_dbStatistics->setText(tr("Database statistics"));
    return;
 }
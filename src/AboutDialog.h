@@ -23,6 +23,7 @@
 #include <QDialog>
 #include <QEvent>
 #include <QLabel>
+#include <QPushButton>
 
 /*!
  * \class AboutDialog
@@ -41,10 +42,13 @@ public:
    //! \name Public UI Variables
    //! @{
    QLabel* label;
+   QPushButton* pushButton_dbStatistics;
    //! @}
 
 private:
    void doLayout();
+   //! \brief Show how long each kind of DB query has taken since the program started
+   void showDbStatistics();
    void retranslateUi();
 };
 
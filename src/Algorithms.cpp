@@ -107,76 +107,79 @@ namespace {
    };
 
    /**
-    * \brief Extension of std::lower_bound to find an interpolated conversion in a sorted range
+    * \brief Convert between two columns of \c Measurement::sucroseConversions, by finding the rows either side of the
+    *        value we're converting from and doing a linear interpolation between them.  (If there is an exact match,
+    *        we just return that.)
     *
-    * \param first As \c std::lower_bound, first \c T in the sorted range
-    * \param last  Different from \c std::lower_bound, last \c T in the sorted range
-    * \param value As \c std::lower_bound, a \c T struct containing the value to convert
-    * \param getFrom Lambda to extract the "from" value from a struct of the type \c T
-    * \param getTo Lambda to extract the "to" value from a struct of the type \c T
+    *        We used to find the rows with std::lower_bound, which is an O(log N) binary search.  Using the index for
+    *        the column (see \c Measurement::SucroseConversionIndex) makes this constant time, whilst giving exactly the
+    *        same results.
+    *
+    * \param value    The value to convert
+    * \param index    Index for the column we're converting from
+    * \param toColumn The column we're converting to
     * \param whatFrom Description for logging of what we're converting from
-    * \param whatTo   Description for logging of what we're converting from
+    * \param whatTo   Description for logging of what we're converting to
     */
-   template<class ForwardIt, class T, class GetFrom, class GetTo>
-   double interpolatedConversion(ForwardIt first,
-                                    ForwardIt last,
-                                    T const & value,
-                                    GetFrom getFrom,
-                                    GetTo getTo,
-                                    char const * const whatFrom,
-                                    char const * const whatTo) {
-      auto const firstLarger = std::lower_bound(
-         first,
-         last + 1,
-         value,
-         [& getFrom, & getTo](T const & lhs, T const & rhs) {return getFrom(lhs) < getFrom(rhs);}
-      );
-
-      if (firstLarger == last + 1) {
-         // We're off the end of the array
+   double interpolatedConversion(double const value,
+                                 Measurement::SucroseConversionIndex const & index,
+                                 double Measurement::SucroseConversion::* toColumn,
+                                 char const * const whatFrom,
+                                 char const * const whatTo) {
+      auto const & rows = Measurement::sucroseConversions;
+      auto const fromColumn = index.column;
+      std::size_t const lastRow = Measurement::sucroseConversions_size - 1;
+
+      if (value > rows[lastRow].*fromColumn) {
          qWarning() <<
-            Q_FUNC_INFO << whatFrom << getFrom(value) << "too large to convert to " << whatTo <<
-            " so using max value of" << getTo(*last);
-         return getTo(*last);
+            Q_FUNC_INFO << whatFrom << value << "too large to convert to " << whatTo << " so using max value of" <<
+            rows[lastRow].*toColumn;
+         return rows[lastRow].*toColumn;
       }
 
-      // The lower bound is the first element that does not satisfy "element < value" (where value is what we're searching
-      // for.
-      Q_ASSERT(getFrom(*firstLarger) >= getFrom(value));
+      if (value < rows[0].*fromColumn) {
+         qWarning() <<
+            Q_FUNC_INFO << whatFrom << value << "too small to convert to " << whatTo << " so using min value of" <<
+            rows[0].*toColumn;
+         return rows[0].*toColumn;
+      }
 
-      // If we found an exact match, then return that
-      if (getFrom(*firstLarger) == getFrom(value)) {
-         return getTo(*firstLarger);
+      // Having done the checks above, we know the bucket number can't be negative.  (It could be one too big because of
+      // rounding if value is the last row's value.)
+      std::size_t const bucket = std::min(static_cast<std::size_t>((value - index.lowest) / index.bucketWidth),
+                                          index.numBuckets - 1);
+
+      //
+      // Find the first row that is not less than value (ie what std::lower_bound would give us).  Per the comment in
+      // SucroseConversion.h, we are already at most a couple of rows away.  (We step backwards as well as forwards in
+      // case rounding put us in the wrong bucket.)
+      //
+      std::size_t firstLarger = index.startRows[bucket];
+      while (firstLarger > 0 && rows[firstLarger - 1].*fromColumn >= value) {
+         --firstLarger;
+      }
+      while (rows[firstLarger].*fromColumn < value) {
+         ++firstLarger;
       }
 
-      if (firstLarger == first) {
-         qWarning() <<
-            Q_FUNC_INFO << whatFrom << getFrom(value) << "too small to convert to " << whatTo <<
-            " so using min value of" << getTo(*first);
-         return getTo(*first);
+      // If we found an exact match, then return that
+      if (rows[firstLarger].*fromColumn == value) {
+         return rows[firstLarger].*toColumn;
       }
 
-      // Since firstLarger is the first element not to satisfy element < value, its predecessor must, by definition,
-      // satisfy this
-      auto const lastSmaller = firstLarger - 1;
-      Q_ASSERT(getFrom(*lastSmaller) < getFrom(value));
+      // Since value is not less than the first row, and doesn't match it exactly, firstLarger can't be the first row
+      Q_ASSERT(firstLarger > 0);
+      std::size_t const lastSmaller = firstLarger - 1;
 
       // Now we just do a linear interpolation
-      // positionInRange will be between 0 and 1 and tells us, in relative terms, where the supplied SG is in relation to
-      // lastSmaller and firstLarger.  Eg 0.5 would mean it was exactly half-way between the two.
-      Q_ASSERT(getFrom(*lastSmaller) < getFrom(*firstLarger));
-
+      // positionInRange will be between 0 and 1 and tells us, in relative terms, where the supplied value is in relation
+      // to lastSmaller and firstLarger.  Eg 0.5 would mean it was exactly half-way between the two.
       double const positionInRange =
-         (getFrom(value) - getFrom(*lastSmaller)) / (getFrom(*firstLarger) - getFrom(*lastSmaller));
-      qDebug() <<
-         Q_FUNC_INFO << "Supplied value" << getFrom(value) << whatFrom << " lies" << (100 * positionInRange) << "% "
-         "between" << getFrom(*lastSmaller) << whatFrom << "(=" << getTo(*lastSmaller) << whatTo << ") and" <<
-         getFrom(*firstLarger) << whatFrom << "(=" << getTo(*firstLarger) << whatTo << ")";
-
+         (value - rows[lastSmaller].*fromColumn) / (rows[firstLarger].*fromColumn - rows[lastSmaller].*fromColumn);
       Q_ASSERT(positionInRange >= 0.0);
       Q_ASSERT(positionInRange <= 1.0);
 
-      return positionInRange * (getTo(*firstLarger) - getTo(*lastSmaller)) + getTo(*lastSmaller);
+      return positionInRange * (rows[firstLarger].*toColumn - rows[lastSmaller].*toColumn) + rows[lastSmaller].*toColumn;
    }
 
 }
@@ -344,23 +347,11 @@ double Algorithms::SgAt20CToBrix(double sg) {
    //
 
 
-   //
-   // The zeros in searchingFor are dummy values.  We need the struct for std::lower_bound below
-   //
-   // The advantage of using std::lower_bound over std::find_if is that, provided you give it random-access iterators,
-   // the former does O(log N) binary search rather than O(N) linear search.
-   //
-   Measurement::SucroseConversion const searchingFor{0, 0, sg};
-   return interpolatedConversion(
-      &Measurement::sucroseConversions[0],
-      &Measurement::sucroseConversions[Measurement::sucroseConversions_size - 1],
-      searchingFor,
-      [](Measurement::SucroseConversion const & value) {return value.apparentSgAt2020C; },
-      [](Measurement::SucroseConversion const & value) {return value.degreesBrix; },
-      "Specific gravity",
-      "Brix"
-   );
-
+   return interpolatedConversion(sg,
+                                 Measurement::sucroseConversionsBySg,
+                                 &Measurement::SucroseConversion::degreesBrix,
+                                 "Specific gravity",
+                                 "Brix");
 }
 
 double Algorithms::BrixToSgAt20C(double brix) {
@@ -395,19 +386,55 @@ double Algorithms::BrixToSgAt20C(double brix) {
    //
    // However, instead, we use the same approach as in SgAt20CToBrix of interpolating the USDA observed data.
    //
-   Measurement::SucroseConversion const searchingFor{0, brix, 0};
-
-   return interpolatedConversion(
-      &Measurement::sucroseConversions[0],
-      &Measurement::sucroseConversions[Measurement::sucroseConversions_size - 1],
-      searchingFor,
-      [](Measurement::SucroseConversion const & value) {return value.degreesBrix; },
-      [](Measurement::SucroseConversion const & value) {return value.apparentSgAt2020C; },
-      "Brix",
-      "Specific gravity"
-   );
+   return interpolatedConversion(brix,
+                                 Measurement::sucroseConversionsByBrix,
+                                 &Measurement::SucroseConversion::apparentSgAt2020C,
+                                 "Brix",
+                                 "Specific gravity");
+}
 
+double Algorithms::RefractiveIndexAt20CToBrix(double refractiveIndex) {
+   return interpolatedConversion(refractiveIndex,
+                                 Measurement::sucroseConversionsByRefractiveIndex,
+                                 &Measurement::SucroseConversion::degreesBrix,
+                                 "Refractive index",
+                                 "Brix");
+}
 
+double Algorithms::BrixToRefractiveIndexAt20C(double brix) {
+   return interpolatedConversion(brix,
+                                 Measurement::sucroseConversionsByBrix,
+                                 &Measurement::SucroseConversion::refractiveIndexAt20C,
+                                 "Brix",
+                                 "Refractive index");
+}
+
+void Algorithms::SgAt20CToBrix(std::size_t count, double const * sgs, double * brix) {
+   for (std::size_t ii = 0; ii < count; ++ii) {
+      brix[ii] = Algorithms::SgAt20CToBrix(sgs[ii]);
+   }
+   return;
+}
+
+void Algorithms::BrixToSgAt20C(std::size_t count, double const * brix, double * sgs) {
+   for (std::size_t ii = 0; ii < count; ++ii) {
+      sgs[ii] = Algorithms::BrixToSgAt20C(brix[ii]);
+   }
+   return;
+}
+
+void Algorithms::RefractiveIndexAt20CToBrix(std::size_t count, double const * refractiveIndexes, double * brix) {
+   for (std::size_t ii = 0; ii < count; ++ii) {
+      brix[ii] = Algorithms::RefractiveIndexAt20CToBrix(refractiveIndexes[ii]);
+   }
+   return;
+}
+
+void Algorithms::BrixToRefractiveIndexAt20C(std::size_t count, double const * brix, double * refractiveIndexes) {
+   for (std::size_t ii = 0; ii < count; ++ii) {
+      refractiveIndexes[ii] = Algorithms::BrixToRefractiveIndexAt20C(brix[ii]);
+   }
+   return;
 }
 
 double Algorithms::getPlato(double sugar_kg, double wort_l) {
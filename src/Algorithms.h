@@ -24,6 +24,7 @@
 #pragma once
 
 #include <cmath>
+#include <cstddef> // For std::size_t
 #include <limits> // For std::numeric_limits
 #include <string.h>
 #include <vector>
@@ -120,6 +121,21 @@ namespace Algorithms {
    //! \brief Convert Brix to Specific Gravity (measured at 20°C)
    double BrixToSgAt20C(double brix);
 
+   //! \brief Convert refractive index (measured at 20°C) to Brix, using the USDA sucrose conversion table
+   double RefractiveIndexAt20CToBrix(double refractiveIndex);
+
+   //! \brief Convert Brix to refractive index (measured at 20°C), using the USDA sucrose conversion table
+   double BrixToRefractiveIndexAt20C(double brix);
+
+   /**
+    * \brief Batch versions of the above four conversions, for converting a whole series of readings (eg from a
+    *        refractometer) in one go.  Input and output arrays must each have \c count elements.
+    */
+   void SgAt20CToBrix(std::size_t count, double const * sgs, double * brix);
+   void BrixToSgAt20C(std::size_t count, double const * brix, double * sgs);
+   void RefractiveIndexAt20CToBrix(std::size_t count, double const * refractiveIndexes, double * brix);
+   void BrixToRefractiveIndexAt20C(std::size_t count, double const * brix, double * refractiveIndexes);
+
    //! \returns water density in kg/L at temperature \b celsius
    double getWaterDensity_kgL( double celsius );
    //! \returns additive correction to the 15C hydrometer reading if read at \b celsius
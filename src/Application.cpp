@@ -46,6 +46,7 @@
 #include "BtSplashScreen.h"
 #include "config.h"
 #include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
 #include "Localization.h"
 #include "MainWindow.h"
 #include "measurement/ColorMethods.h"
@@ -448,7 +449,13 @@ bool Application::initialize() {
    // Check if the database was successfully loaded before
    // loading the main window.
    qDebug() << Q_FUNC_INFO << "Loading Database...";
-   return Database::instance().loadSuccessful();
+   if (!Database::instance().loadSuccessful()) {
+      return false;
+   }
+
+   // Read everything in from the DB now (in parallel) rather than each object store loading itself on first use
+   LoadAllObjectStores(Database::instance());
+   return true;
 }
 
 void Application::cleanup() {
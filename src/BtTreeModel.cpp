@@ -93,9 +93,11 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case RECIPEMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::RECIPE);
          connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectInserted, this, &BtTreeModel::elementAddedRecipe);
+         connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Recipe>);
          connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedRecipe);
          // Brewnotes need love too!
          connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectInserted, this, &BtTreeModel::elementAddedBrewNote);
+         connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<BrewNote>);
          connect(&ObjectStoreTyped<BrewNote>::getInstance(), &ObjectStoreTyped<BrewNote>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedBrewNote);
          // And some versioning stuff, because why not?
          connect(&ObjectStoreTyped<Recipe>::getInstance(), &ObjectStoreTyped<Recipe>::signalPropertyChanged, this, &BtTreeModel::recipePropertyChanged);
@@ -106,6 +108,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case EQUIPMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::EQUIPMENT);
          connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectInserted, this, &BtTreeModel::elementAddedEquipment);
+         connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Equipment>);
          connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedEquipment);
          this->itemType = BtTreeItem::Type::EQUIPMENT;
          _mimeType = "application/x-brewtarget-recipe";
@@ -114,6 +117,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case FERMENTMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::FERMENTABLE);
          connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectInserted, this, &BtTreeModel::elementAddedFermentable);
+         connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Fermentable>);
          connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedFermentable);
          this->itemType = BtTreeItem::Type::FERMENTABLE;
          _mimeType = "application/x-brewtarget-ingredient";
@@ -122,6 +126,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case HOPMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::HOP);
          connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectInserted, this, &BtTreeModel::elementAddedHop);
+         connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Hop>);
          connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedHop);
          this->itemType = BtTreeItem::Type::HOP;
          _mimeType = "application/x-brewtarget-ingredient";
@@ -130,6 +135,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case MISCMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::MISC);
          connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectInserted, this, &BtTreeModel::elementAddedMisc);
+         connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Misc>);
          connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedMisc);
          this->itemType = BtTreeItem::Type::MISC;
          _mimeType = "application/x-brewtarget-ingredient";
@@ -138,6 +144,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case STYLEMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::STYLE);
          connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectInserted, this, &BtTreeModel::elementAddedStyle);
+         connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Style>);
          connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedStyle);
          this->itemType = BtTreeItem::Type::STYLE;
          _mimeType = "application/x-brewtarget-recipe";
@@ -146,6 +153,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case YEASTMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::YEAST);
          connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectInserted, this, &BtTreeModel::elementAddedYeast);
+         connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Yeast>);
          connect(&ObjectStoreTyped<Yeast>::getInstance(), &ObjectStoreTyped<Yeast>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedYeast);
          this->itemType = BtTreeItem::Type::YEAST;
          _mimeType = "application/x-brewtarget-ingredient";
@@ -154,6 +162,7 @@ BtTreeModel::BtTreeModel(BtTreeView * parent, TypeMasks type) :
       case WATERMASK:
          rootItem->insertChildren(items, 1, BtTreeItem::Type::WATER);
          connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectInserted, this, &BtTreeModel::elementAddedWater);
+         connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectsInserted, this, &BtTreeModel::elementsAdded<Water>);
          connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectDeleted,  this, &BtTreeModel::elementRemovedWater);
          this->itemType = BtTreeItem::Type::WATER;
          _mimeType = "application/x-brewtarget-ingredient";
@@ -1272,6 +1281,16 @@ void BtTreeModel::elementAddedWater(int victimId) {
    this->elementAdded(qobject_cast<NamedEntity *>(ObjectStoreWrapper::getByIdRaw<Water      >(victimId)));
 }
 
+template<class NE>
+void BtTreeModel::elementsAdded(QVector<int> const & victimIds) {
+   QList<NamedEntity *> victims;
+   for (int victimId : victimIds) {
+      victims.append(qobject_cast<NamedEntity *>(ObjectStoreWrapper::getByIdRaw<NE>(victimId)));
+   }
+   this->elementsAdded(victims);
+   return;
+}
+
 // I guess this isn't too bad. Better than this same function copied 7 times
 void BtTreeModel::elementAdded(NamedEntity * victim) {
 
@@ -1317,6 +1336,67 @@ void BtTreeModel::elementAdded(NamedEntity * victim) {
    return;
 }
 
+void BtTreeModel::elementsAdded(QList<NamedEntity *> const & victims) {
+   //
+   // BrewNotes go under their Recipes, which is fiddly to batch up, so we add them one at a time.  But, when a Recipe is
+   // added, its BrewNotes are added along with it, so we need to skip any BrewNote that's already there.  (It's also
+   // possible that the BrewNote's Recipe isn't in the tree yet, in which case the BrewNote will be added along with the
+   // Recipe later.)  Everything else can be added to the top level in one go.
+   //
+   QList<NamedEntity *> topLevelVictims;
+   for (NamedEntity * victim : victims) {
+      if (!victim || !victim->display()) {
+         continue;
+      }
+      if (qobject_cast<BrewNote *>(victim)) {
+         if (!this->findElement(victim).isValid()) {
+            this->elementAdded(victim);
+         }
+         continue;
+      }
+      topLevelVictims.append(victim);
+   }
+
+   if (topLevelVictims.isEmpty()) {
+      return;
+   }
+
+   QModelIndex pIdx = createIndex(0, 0, rootItem->child(0));
+   BtTreeItem * pItem = item(pIdx);
+   int const breadth = rowCount(pIdx);
+   qDebug() << Q_FUNC_INFO << "Adding" << topLevelVictims.size() << "item(s) after existing" << breadth;
+
+   beginInsertRows(pIdx, breadth, breadth + topLevelVictims.size() - 1);
+   bool const success = pItem->insertChildren(breadth, topLevelVictims.size(), pItem->type());
+   if (success) {
+      for (int ii = 0; ii < topLevelVictims.size(); ++ii) {
+         pItem->child(breadth + ii)->setData(this->itemType, topLevelVictims.at(ii));
+      }
+   }
+   endInsertRows();
+
+   if (!success) {
+      return;
+   }
+
+   for (NamedEntity * victim : topLevelVictims) {
+      // Same special processing as in elementAdded() for brewnotes on a recipe import
+      Recipe * recipe = qobject_cast<Recipe *>(victim);
+      if (recipe) {
+         QList<BrewNote *> notes = recipe->brewNotes();
+         if (notes.size()) {
+            QModelIndex rIdx = findElement(recipe);
+            int row = 0;
+            for (BrewNote * note : notes) {
+               insertRow(row++, rIdx, note, BtTreeItem::Type::BREWNOTE);
+            }
+         }
+      }
+      observeElement(victim);
+   }
+   return;
+}
+
 void BtTreeModel::elementRemovedRecipe([[maybe_unused]] int victimId, std::shared_ptr<QObject> victim) {
    this->elementRemoved(qobject_cast<NamedEntity *>(victim.get()));
 }
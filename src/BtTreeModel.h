@@ -31,6 +31,7 @@
 #include <QObject>
 #include <QSqlRelationalTableModel>
 #include <QVariant>
+#include <QVector>
 
 #include "BtTreeItem.h"
 
@@ -231,6 +232,11 @@ private:
    //! \brief add and remove an element from the, respectively. All of the
    //slots actually call these two methods
    void elementAdded(NamedEntity * victim);
+
+   //! \brief Batched equivalents of the elementAddedXxx() slots and elementAdded(), for when lots of things are
+   //         imported at once -- see \c ObjectStore::signalObjectsInserted
+   template<class NE> void elementsAdded(QVector<int> const & victimIds);
+   void elementsAdded(QList<NamedEntity *> const & victims);
    void elementRemoved(NamedEntity * victim);
 
    //! \brief connects the changedName() signal and changedFolder() signals to
@@ -672,7 +672,7 @@ int BtTreeView::verifyDelete(int confirmDelete, QString tag, QString name) {
 // I should maybe shove this further down the stack. But I prefer to keep the
 // confirmation windows at least this high -- models shouldn't be interacting
 // with users.
-void BtTreeView::deleteSelected(QModelIndexList selected) {
+QModelIndexList BtTreeView::confirmDeletion(QModelIndexList selected) {
    //.:TODO:. Pull out some of the common code from this and copySelected()
 
    QModelIndexList translated;
@@ -683,7 +683,7 @@ void BtTreeView::deleteSelected(QModelIndexList selected) {
    for (QModelIndex at : selected) {
       // If somebody said cancel, bug out
       if (confirmDelete == QMessageBox::Cancel) {
-         return;
+         return QModelIndexList{};
       }
 
       // First, we should translate from proxy to model, because I need this index a lot.
@@ -744,8 +744,16 @@ void BtTreeView::deleteSelected(QModelIndexList selected) {
       }
    }
 
-   // If we get here, call the model to delete the victims
-   this->m_model->deleteSelected(translated);
+   // The last prompt might have been the one where they said cancel
+   if (confirmDelete == QMessageBox::Cancel) {
+      return QModelIndexList{};
+   }
+   return translated;
+}
+
+void BtTreeView::deleteConfirmed(QModelIndexList confirmed) {
+   // Call the model to delete the victims
+   this->m_model->deleteSelected(confirmed);
 
    // NB: In the case of deleting a Recipe, MainWindow::deleteSelected() has the logic that then chooses a new Recipe to
    // show in the main edit pane.
@@ -125,7 +125,16 @@ public:
    //! \brief gets the current filter
    BtTreeFilterProxyModel * filter() const;
 
-   void deleteSelected(QModelIndexList selected);
+   /**
+    * \brief Ask the user to confirm the deletion of each of the selected items.  This is separate from
+    *        \c deleteConfirmed() so that the caller can wait for the user before starting any DB transaction for the
+    *        deletions.
+    *
+    * \return The items the user confirmed, ready to pass to \c deleteConfirmed().  Empty if the user cancelled.
+    */
+   QModelIndexList confirmDeletion(QModelIndexList selected);
+   //! \brief Delete the items returned by \c confirmDeletion()
+   void deleteConfirmed(QModelIndexList confirmed);
    void copySelected(QModelIndexList selected);
    // Friend classes. For the most part, the children don't do much beyond
    // contructors and context menus. So far :/
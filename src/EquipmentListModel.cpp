@@ -31,6 +31,8 @@
 EquipmentListModel::EquipmentListModel(QWidget* parent) :
    QAbstractListModel(parent), recipe(0) {
    connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectInserted, this, &EquipmentListModel::addEquipment);
+   connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectsInserted, this,
+           [this](QVector<int> const & equipmentIds) { for (int id : equipmentIds) { this->addEquipment(id); } return; });
    connect(&ObjectStoreTyped<Equipment>::getInstance(), &ObjectStoreTyped<Equipment>::signalObjectDeleted,  this, &EquipmentListModel::removeEquipment);
    this->repopulateList();
    return;
@@ -75,6 +75,7 @@
 #include "ConverterTool.h"
 #include "database/Database.h"
 #include "database/ObjectStoreWrapper.h"
+#include "database/SqliteBackup.h"
 #include "EquipmentEditor.h"
 #include "EquipmentListModel.h"
 #include "FermentableDialog.h"
@@ -1048,7 +1049,22 @@ void MainWindow::deleteSelected() {
 
    QModelIndex start = active->selectionModel()->selectedRows().first();
    qDebug() << Q_FUNC_INFO << "Delete starting from row" << start.row();
-   active->deleteSelected(active->selectionModel()->selectedRows());
+
+   // Get the user's go-ahead before we start the transaction, so we don't hold it open while they think about it
+   QModelIndexList const confirmed = active->confirmDeletion(active->selectionModel()->selectedRows());
+   if (confirmed.isEmpty()) {
+      return;
+   }
+   {
+      // Deleting several items (or a Recipe and everything in it) should be all or nothing
+      ObjectStoreTransaction objectStoreTransaction;
+      active->deleteConfirmed(confirmed);
+      if (!objectStoreTransaction.commit()) {
+         QMessageBox::warning(this,
+                              tr("Delete failed"),
+                              tr("Unable to delete the selected item(s) from the database.  Nothing has been deleted."));
+      }
+   }
 
    //
    // Now that we deleted the selected recipe, we don't want it to appear in the main window any more, so let's select
@@ -2576,13 +2592,37 @@ void MainWindow::backup() {
    qDebug() << QString("Database backup filename \"%1\"").arg(backupFileName);
 
    // If the filename returned from the dialog is empty, it means the user clicked cancel, so we should stop trying to do the backup
-   if (!backupFileName.isEmpty())
-   {
-      bool success = Database::instance().backupToFile(backupFileName);
+   if (backupFileName.isEmpty()) {
+      return;
+   }
 
-      if( ! success )
-         QMessageBox::warning( this, tr("Oops!"), tr("Could not copy the files for some reason."));
+   //
+   // Where possible, we copy the DB in the background, so the user can carry on working while it happens.  Otherwise
+   // we have to do it here and now.
+   //
+   SqliteBackup * backup = Database::instance().startBackupToFile(backupFileName, this);
+   if (!backup) {
+      if (!Database::instance().backupToFile(backupFileName)) {
+         QMessageBox::warning(this, tr("Oops!"), tr("Could not copy the files for some reason."));
+      }
+      return;
    }
+
+   this->updateStatus(tr("Backing up database to %1...").arg(backupFileName));
+   connect(backup, &QThread::finished, this, [this, backup]() {
+      if (backup->succeeded()) {
+         this->updateStatus(
+            tr("Database backed up to %1 (%2 KiB in %3 ms)").arg(
+               backup->destinationFileName()
+            ).arg(backup->bytesCopied() / 1024).arg(backup->elapsed_ms())
+         );
+      } else {
+         QMessageBox::warning(this, tr("Oops!"), tr("Could not copy the files for some reason."));
+      }
+      backup->deleteLater();
+      return;
+   });
+   return;
 }
 
 void MainWindow::restoreFromBackup()
@@ -2809,9 +2849,16 @@ void MainWindow::copyRecipe() {
       return;
    }
 
+   // Copying a Recipe means inserting copies of all its ingredients etc, which we want to happen all or nothing
+   ObjectStoreTransaction objectStoreTransaction;
    auto newRec = std::make_shared<Recipe>(*this->recipeObs); // Create a deep copy
    newRec->setName(name);
    ObjectStoreTyped<Recipe>::getInstance().insert(newRec);
+   if (!objectStoreTransaction.commit()) {
+      QMessageBox::warning(this,
+                           tr("Copy failed"),
+                           tr("Unable to store the copy of the recipe in the database."));
+   }
    return;
 }
 
@@ -31,6 +31,8 @@ MashComboBox::MashComboBox(QWidget * parent) :
    this->setCurrentIndex(-1);
 
    connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectInserted, this, &MashComboBox::addMash);
+   connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectsInserted, this,
+           [this](QVector<int> const & mashIds) { for (int id : mashIds) { this->addMash(id); } return; });
    connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectDeleted,  this, &MashComboBox::removeMash);
    this->repopulateList();
    return;
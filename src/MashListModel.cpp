@@ -32,6 +32,8 @@ MashListModel::MashListModel(QWidget* parent) :
    QAbstractListModel(parent),
    recipe(0) {
    connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectInserted, this, &MashListModel::addMash);
+   connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectsInserted, this,
+           [this](QVector<int> const & mashIds) { for (int id : mashIds) { this->addMash(id); } return; });
    connect(&ObjectStoreTyped<Mash>::getInstance(), &ObjectStoreTyped<Mash>::signalObjectDeleted,  this, &MashListModel::removeMash);
    this->repopulateList();
    return;
@@ -30,6 +30,7 @@
 #include <QIcon>
 #include <QMap>
 #include <QMessageBox>
+#include <QProgressDialog>
 #include <QSizePolicy>
 #include <QString>
 #include <QVector>
@@ -984,12 +985,32 @@ bool OptionDialog::transferDatabase() {
       QString theQuestion =
          tr("Would you like Brewtarget to transfer your data to the new database? NOTE: If you've already loaded the data, say No");
       if (QMessageBox::Yes == QMessageBox::question(this, tr("Transfer database"), theQuestion)) {
-         Database::instance().convertDatabase(this->pimpl->input_pgHostname.text(),
-                                              this->pimpl->input_pgDbName.text(),
-                                              this->pimpl->input_pgUsername.text(),
-                                              this->pimpl->input_pgPassword.text(),
-                                              this->pimpl->input_pgPortNum.text().toInt(),
-                                              static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()));
+         //
+         // Copying a big DB can take a while, so show the user that something is happening.  There's no cancel button,
+         // as stopping part way through would leave the new DB with tables but no data.
+         //
+         QProgressDialog progressDialog{tr("Transferring data..."), QString{}, 0, 0, this};
+         progressDialog.setWindowTitle(tr("Transfer database"));
+         progressDialog.setWindowModality(Qt::WindowModal);
+         progressDialog.setMinimumDuration(0);
+         progressDialog.show();
+         Database::instance().convertDatabase(
+            this->pimpl->input_pgHostname.text(),
+            this->pimpl->input_pgDbName.text(),
+            this->pimpl->input_pgUsername.text(),
+            this->pimpl->input_pgPassword.text(),
+            this->pimpl->input_pgPortNum.text().toInt(),
+            static_cast<Database::DbType>(this->comboBox_engine->currentData().toInt()),
+            [&progressDialog](QString const & tableName, int objectsCopied, int objectsTotal) {
+               progressDialog.setMaximum(objectsTotal);
+               progressDialog.setLabelText(
+                  tr("Transferring %1: %2 of %3 records").arg(tableName).arg(objectsCopied).arg(objectsTotal)
+               );
+               // Because the dialog is modal, setValue() also processes events, so the dialog gets repainted
+               progressDialog.setValue(objectsCopied);
+               return;
+            }
+         );
       }
       // Database engine stuff
       int engine = comboBox_engine->currentData().toInt();
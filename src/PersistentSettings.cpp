@@ -43,6 +43,7 @@
 #include <QStandardPaths>
 
 #include "config.h"
+#include "Localization.h"
 
 //
 // Anonymous namespace for constants, global variables and functions used only in this file
@@ -220,7 +221,9 @@ void PersistentSettings::insert(QString const & key,
    Q_ASSERT(initialised);
    // QSettings is a bit inconsistent here in using setValue() when QMap, QHash etc use insert() for the equivalent
    // functionality
-   qSettings->setValue(generateFqKey(key, section, extension), value);
+   QString const fqKey{generateFqKey(key, section, extension)};
+   qSettings->setValue(fqKey, value);
+   emit PersistentSettings::changeNotifier().settingChanged(fqKey);
    return;
 }
 
@@ -281,6 +284,7 @@ void PersistentSettings::remove(QString const & key,
    if (PersistentSettings::contains(fqKey)) {
       qSettings->remove(fqKey);
    }
+   emit PersistentSettings::changeNotifier().settingChanged(fqKey);
    return;
 }
 
@@ -301,3 +305,35 @@ void PersistentSettings::remove(BtStringConst const & constKey,
    PersistentSettings::remove(constKey, section, extension);
    return;
 }
+
+PersistentSettings::ChangeNotifier & PersistentSettings::changeNotifier() {
+   static PersistentSettings::ChangeNotifier notifier;
+   return notifier;
+}
+
+PersistentSettings::CalcSettings PersistentSettings::readCalcSettings() {
+   Q_ASSERT(initialised);
+   // Values are stored as strings in the config file, so we use Localization::toDouble() to read them back in the same
+   // way we always have
+   PersistentSettings::CalcSettings calcSettings{
+      Localization::toDouble(
+         PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
+         Q_FUNC_INFO
+      ),
+      Localization::toDouble(
+         PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
+         Q_FUNC_INFO
+      )
+   };
+   qDebug() <<
+      Q_FUNC_INFO << "First wort hop adjustment:" << calcSettings.firstWortHopAdjustment <<
+      ", mash hop adjustment:" << calcSettings.mashHopAdjustment;
+   return calcSettings;
+}
+
+bool PersistentSettings::affectsCalcSettings(QString const & fullyQualifiedKey) {
+   // Per the QSettings docs, removing an empty key removes everything, which includes our settings
+   return fullyQualifiedKey.isEmpty() ||
+          fullyQualifiedKey == *PersistentSettings::Names::firstWortHopAdjustment ||
+          fullyQualifiedKey == *PersistentSettings::Names::mashHopAdjustment;
+}
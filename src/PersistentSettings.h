@@ -33,6 +33,7 @@
 #pragma once
 
 #include <QDir>
+#include <QObject>
 #include <QString>
 #include <QVariant>
 
@@ -43,6 +44,7 @@
 //===== (Note that we only need to add here names that have no section or are used in multiple places in the code) =====
 //===== (Note too that property names are often used as setting names and, in such cases, are not redefined here) ======
 #define AddSettingName(name) namespace PersistentSettings::Names { BtStringConst const name{#name}; }
+AddSettingName(cache_size)                       // sqlite section
 AddSettingName(check_version)
 AddSettingName(color_formula)
 AddSettingName(config_version)
@@ -64,19 +66,25 @@ AddSettingName(firstWortHopAdjustment)
 AddSettingName(forcedLocale)
 AddSettingName(frequency)                        // backups section
 AddSettingName(geometry)
+AddSettingName(journal_mode)                     // sqlite section
 AddSettingName(ibu_formula)
 AddSettingName(language)
 AddSettingName(last_db_merge_req)
+AddSettingName(locking_mode)                     // sqlite section
 AddSettingName(LogDirectory)
 AddSettingName(LoggingLevel)
 AddSettingName(mashHopAdjustment)
 AddSettingName(mashStepTableWidget_headerState)  // MainWindow section
 AddSettingName(maximum)                          // backups section
+AddSettingName(mmap_size)                        // sqlite section
 AddSettingName(productionDate)
 AddSettingName(recipeKey)
 AddSettingName(showsnapshots)
+AddSettingName(slowQueryThreshold_ms)
 AddSettingName(splitter_horizontal_State)        // MainWindow section
 AddSettingName(splitter_vertical_State)          // MainWindow section
+AddSettingName(synchronous)                      // sqlite section
+AddSettingName(temp_store)                       // sqlite section
 AddSettingName(treeView_equip_headerState)       // MainWindow section
 AddSettingName(treeView_ferm_headerState)        // MainWindow section
 AddSettingName(treeView_hops_headerState)        // MainWindow section
@@ -90,6 +98,7 @@ AddSettingName(unitSystem_diastaticPower)
 AddSettingName(unitSystem_temperature)
 AddSettingName(unitSystem_volume)
 AddSettingName(unitSystem_weight)
+AddSettingName(useObjectStoreSnapshot)
 AddSettingName(UserDataDirectory)
 AddSettingName(versioning)
 AddSettingName(windowState)
@@ -112,6 +121,7 @@ AddSettingSection(page_postferment)
 AddSettingSection(page_preboil)
 AddSettingSection(pitchRateCalc)
 AddSettingSection(saltTable)
+AddSettingSection(sqlite)
 AddSettingSection(tab_recipe)
 AddSettingSection(yeastTable)
 AddSettingSection(yeastTableModel)
@@ -218,5 +228,49 @@ namespace PersistentSettings {
    void remove(BtStringConst const & constName, QString const section = QString(),  Extension extension = PersistentSettings::Extension::NONE);
    void remove(BtStringConst const & constName, BtStringConst const & constSection, Extension extension = PersistentSettings::Extension::NONE);
 
+   /**
+    * \brief Emits a signal whenever a setting is changed through \c insert() or \c remove(), so that anything holding
+    *        its own copy of a setting (eg see \c Recipe) knows when to refresh it.
+    *
+    *        The signal is emitted on the thread that changed the setting.
+    */
+   class ChangeNotifier : public QObject {
+      Q_OBJECT
+   signals:
+      /**
+       * \param fullyQualifiedKey The key (including any section and extension) of the setting that was changed
+       */
+      void settingChanged(QString const & fullyQualifiedKey);
+   };
+
+   /**
+    * \brief The one and only \c ChangeNotifier
+    */
+   ChangeNotifier & changeNotifier();
+
+   /**
+    * \brief The settings that are read in calculation hot paths (eg for every hop, every time we recalculate a
+    *        Recipe's IBUs).  \c Recipe keeps a copy of these, refreshed via \c changeNotifier(), so that those paths
+    *        don't have to go through \c QSettings, key generation and string-to-number conversion each time.
+    *
+    *        (The IBU and color formulas are not here because they are already held in memory, by \c IbuMethods and
+    *        \c ColorMethods respectively.)
+    */
+   struct CalcSettings {
+      double firstWortHopAdjustment;
+      double mashHopAdjustment;
+   };
+
+   /**
+    * \brief Read the current \c CalcSettings
+    */
+   CalcSettings readCalcSettings();
+
+   /**
+    * \brief Whether a change to the setting with the supplied fully-qualified key (as passed to
+    *        \c ChangeNotifier::settingChanged) might change \c CalcSettings
+    */
+   bool affectsCalcSettings(QString const & fullyQualifiedKey);
+
 }
 #endif
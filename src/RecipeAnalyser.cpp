@@ -0,0 +1,325 @@
+/*
+ * RecipeAnalyser.cpp is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecipeAnalyser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <limits>
+#include <tuple>
+#include <utility>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QSqlDatabase>
+#include <QSqlError>
+#include <QThreadPool>
+
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/ObjectStoreWrapper.h"
+#include "model/Recipe.h"
+
+namespace {
+   //
+   // Stored OG/FG are only compared to the calculated ones to within this tolerance, so that we don't flag up
+   // differences that are just rounding.  (Half a gravity point is well below anything a brewer could measure.)
+   //
+   double constexpr ogFgTolerance = 0.0005;
+
+   //
+   // Each worker takes this many recipes at a time.  Calculating one recipe is quick, so doing them one per runnable
+   // would mean most of the time went on thread pool overhead.  OTOH we want enough chunks that the threads stay busy
+   // even if some recipes are a lot bigger than others.
+   //
+   int constexpr recipesPerChunk = 32;
+
+   RecipeAnalyser::RecipeStats statsFor(RecipeAnalyser::RecipeSnapshot const & snapshot) {
+      RecipeCalculator::Results const results = RecipeCalculator::calculate(snapshot.inputs);
+      return RecipeAnalyser::RecipeStats{snapshot.key,
+                                         snapshot.name,
+                                         results.og,
+                                         results.fg,
+                                         results.ABV_pct,
+                                         results.IBU,
+                                         results.color_srm,
+                                         results.calories,
+                                         snapshot.storedOg,
+                                         snapshot.storedFg};
+   }
+
+   QString csvField(QString const & value) {
+      QString escaped{value};
+      escaped.replace("\"", "\"\"");
+      return QString{"\"%1\""}.arg(escaped);
+   }
+
+   QString csvField(double const value, int const decimals) {
+      return QString::number(value, 'f', decimals);
+   }
+
+   class CsvFileSink : public RecipeAnalyser::Sink {
+   public:
+      CsvFileSink(QString const & fileName) : file{fileName} {
+         return;
+      }
+
+      virtual bool begin() override {
+         if (!this->file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << Q_FUNC_INFO << "Unable to open" << this->file.fileName() << ":" << this->file.errorString();
+            return false;
+         }
+         return this->writeLine({"key", "name", "og", "fg", "abv_pct", "ibu", "color_srm", "calories_12oz",
+                                 "stored_og", "stored_fg", "stored_og_fg_disagree"});
+      }
+
+      virtual bool write(RecipeAnalyser::RecipeStats const & stats) override {
+         return this->writeLine({QString::number(stats.key),
+                                 csvField(stats.name),
+                                 csvField(stats.og,           4),
+                                 csvField(stats.fg,           4),
+                                 csvField(stats.ABV_pct,      2),
+                                 csvField(stats.IBU,          1),
+                                 csvField(stats.color_srm,    1),
+                                 csvField(stats.calories12oz, 0),
+                                 csvField(stats.storedOg,     4),
+                                 csvField(stats.storedFg,     4),
+                                 stats.storedOgFgDisagree() ? "1" : "0"});
+      }
+
+      virtual bool end() override {
+         this->file.close();
+         return this->file.error() == QFileDevice::NoError;
+      }
+
+   private:
+      QFile file;
+
+      bool writeLine(QStringList const & fields) {
+         return this->file.write((fields.join(',') + '\n').toUtf8()) >= 0;
+      }
+   };
+
+   /**
+    * \brief Writes a JSON array of objects, one per recipe.  We write each object as we get it (rather than building
+    *        up one big QJsonArray) so that we never need to hold all the results in memory.
+    */
+   class JsonFileSink : public RecipeAnalyser::Sink {
+   public:
+      JsonFileSink(QString const & fileName) : file{fileName}, numWritten{0} {
+         return;
+      }
+
+      virtual bool begin() override {
+         if (!this->file.open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text)) {
+            qCritical() << Q_FUNC_INFO << "Unable to open" << this->file.fileName() << ":" << this->file.errorString();
+            return false;
+         }
+         return this->file.write("[\n") >= 0;
+      }
+
+      virtual bool write(RecipeAnalyser::RecipeStats const & stats) override {
+         QJsonObject const object{
+            {"key",                   stats.key                 },
+            {"name",                  stats.name                },
+            {"og",                    stats.og                  },
+            {"fg",                    stats.fg                  },
+            {"abv_pct",               stats.ABV_pct             },
+            {"ibu",                   stats.IBU                 },
+            {"color_srm",             stats.color_srm           },
+            {"calories_12oz",         stats.calories12oz        },
+            {"stored_og",             stats.storedOg            },
+            {"stored_fg",             stats.storedFg            },
+            {"stored_og_fg_disagree", stats.storedOgFgDisagree()}
+         };
+         QByteArray line{this->numWritten == 0 ? "   " : ",\n   "};
+         line += QJsonDocument{object}.toJson(QJsonDocument::Compact);
+         ++this->numWritten;
+         return this->file.write(line) >= 0;
+      }
+
+      virtual bool end() override {
+         this->file.write("\n]\n");
+         this->file.close();
+         return this->file.error() == QFileDevice::NoError;
+      }
+
+   private:
+      QFile file;
+      int numWritten;
+   };
+
+   /**
+    * \brief State shared between all the workers of one call to \c RecipeAnalyser::analyse()
+    */
+   struct SharedState {
+      SharedState(RecipeAnalyser::Sink & sink) : sink{sink}, sinkMutex{}, sinkFailed{false}, numDisagreeing{0} {
+         return;
+      }
+
+      RecipeAnalyser::Sink & sink;
+      QMutex sinkMutex;
+      std::atomic<bool> sinkFailed;
+      std::atomic<int> numDisagreeing;
+   };
+
+   class AnalyserWorker : public QRunnable {
+   public:
+      AnalyserWorker(QVector<RecipeAnalyser::RecipeSnapshot> const & snapshots,
+                     int const begin,
+                     int const end,
+                     SharedState & sharedState) : snapshots{snapshots},
+                                                  begin{begin},
+                                                  end{end},
+                                                  sharedState{sharedState} {
+         return;
+      }
+
+      void run() override {
+         for (int ii = this->begin; ii < this->end && !this->sharedState.sinkFailed.load(); ++ii) {
+            RecipeAnalyser::RecipeStats const stats = statsFor(this->snapshots.at(ii));
+            if (stats.storedOgFgDisagree()) {
+               ++this->sharedState.numDisagreeing;
+            }
+            QMutexLocker locker{&this->sharedState.sinkMutex};
+            if (!this->sharedState.sink.write(stats)) {
+               this->sharedState.sinkFailed.store(true);
+            }
+         }
+         return;
+      }
+
+   private:
+      QVector<RecipeAnalyser::RecipeSnapshot> const & snapshots;
+      int const begin;
+      int const end;
+      SharedState & sharedState;
+   };
+}
+
+bool RecipeAnalyser::RecipeStats::storedOgFgDisagree() const {
+   return std::abs(this->og - this->storedOg) > ogFgTolerance || std::abs(this->fg - this->storedFg) > ogFgTolerance;
+}
+
+RecipeAnalyser::Sink::~Sink() = default;
+
+std::unique_ptr<RecipeAnalyser::Sink> RecipeAnalyser::makeFileSink(QString const & fileName) {
+   if (fileName.endsWith(".json", Qt::CaseInsensitive)) {
+      return std::make_unique<JsonFileSink>(fileName);
+   }
+   return std::make_unique<CsvFileSink>(fileName);
+}
+
+QVector<RecipeAnalyser::RecipeSnapshot> RecipeAnalyser::snapshotAllRecipes() {
+   //
+   // By the time we get here, the in-memory OG/FG of each Recipe has already been overwritten, either from its stored
+   // calculation results or by the recalculation at start-up, so we have to go to the DB for the values that were
+   // actually stored.  We flush first (see ObjectStore::flush()) so that any edits made in this session are included.
+   //
+   if (!FlushAllObjectStores()) {
+      qWarning() << Q_FUNC_INFO << "Error flushing object stores; stored OG/FG may be out of date";
+   }
+   QHash<int, std::pair<double, double>> storedOgFgById;
+   QSqlDatabase connection = Database::instance().sqlDatabase();
+   BtSqlQuery sqlQuery{connection};
+   if (sqlQuery.exec("SELECT id, og, fg FROM recipe;")) {
+      while (sqlQuery.next()) {
+         storedOgFgById.insert(sqlQuery.value(0).toInt(),
+                               std::make_pair(sqlQuery.value(1).toDouble(), sqlQuery.value(2).toDouble()));
+      }
+   } else {
+      qCritical() << Q_FUNC_INFO << "Error reading stored OG/FG:" << sqlQuery.lastError().text();
+   }
+
+   QList<Recipe *> const recipes = ObjectStoreWrapper::getAllRaw<Recipe>();
+   QVector<RecipeSnapshot> snapshots;
+   snapshots.reserve(recipes.size());
+   for (Recipe * recipe : recipes) {
+      if (recipe->deleted()) {
+         continue;
+      }
+      // If, for whatever reason, we couldn't read the stored values, they are NaN, which never compares as
+      // disagreeing with the calculated ones (see RecipeStats::storedOgFgDisagree()), so we don't flag up every recipe
+      double storedOg = std::numeric_limits<double>::quiet_NaN();
+      double storedFg = std::numeric_limits<double>::quiet_NaN();
+      if (storedOgFgById.contains(recipe->key())) {
+         std::tie(storedOg, storedFg) = storedOgFgById.value(recipe->key());
+      }
+      snapshots.append(RecipeSnapshot{recipe->key(), recipe->name(), storedOg, storedFg, recipe->calculatorInputs()});
+   }
+   return snapshots;
+}
+
+int RecipeAnalyser::analyse(QVector<RecipeSnapshot> const & snapshots, Sink & sink, int const maxThreads) {
+   if (!sink.begin()) {
+      return -1;
+   }
+
+   SharedState sharedState{sink};
+
+   //
+   // As in LoadAllObjectStores(), we use our own pool rather than the global one so that waitForDone() only waits for
+   // our work.
+   //
+   QThreadPool threadPool;
+   threadPool.setMaxThreadCount(std::max(maxThreads, 1));
+   for (int begin = 0; begin < snapshots.size(); begin += recipesPerChunk) {
+      int const end = std::min(begin + recipesPerChunk, snapshots.size());
+      // Thread pool takes ownership of the runnable (because autoDelete() defaults to true)
+      threadPool.start(new AnalyserWorker(snapshots, begin, end, sharedState));
+   }
+   threadPool.waitForDone();
+
+   if (!sink.end() || sharedState.sinkFailed.load()) {
+      qCritical() << Q_FUNC_INFO << "Error writing results";
+      return -1;
+   }
+   return sharedState.numDisagreeing.load();
+}
+
+bool RecipeAnalyser::analyseAll(QString const & fileName) {
+   QElapsedTimer timer;
+   timer.start();
+
+   QVector<RecipeSnapshot> const snapshots = snapshotAllRecipes();
+   qint64 const snapshotElapsed_ms = timer.elapsed();
+
+   std::unique_ptr<Sink> sink = makeFileSink(fileName);
+   int const numDisagreeing = analyse(snapshots, *sink);
+   if (numDisagreeing < 0) {
+      return false;
+   }
+
+   qInfo() <<
+      Q_FUNC_INFO << "Analysed" << snapshots.size() << "recipes in" << timer.elapsed() << "ms (of which" <<
+      snapshotElapsed_ms << "ms taking snapshots).  Results written to" << fileName;
+   if (numDisagreeing > 0) {
+      qWarning() <<
+         Q_FUNC_INFO << numDisagreeing << "recipe(s) have stored OG/FG that disagree with the calculated values";
+   }
+   return true;
+}
@@ -0,0 +1,127 @@
+/*
+ * RecipeAnalyser.h is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RECIPEANALYSER_H
+#define RECIPEANALYSER_H
+#pragma once
+
+#include <memory>
+
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include "RecipeCalculator.h"
+
+/*!
+ * \namespace RecipeAnalyser
+ *
+ * \brief Batch calculation of the stats (OG, FG, ABV, IBU, colour, calories) of every recipe in the library, eg for
+ *        reports, or to find recipes whose stored OG/FG no longer agree with a fresh calculation.
+ *
+ *        This is done in two stages:
+ *           - On the main thread, \c snapshotAllRecipes() copies out everything the calculations need from each
+ *             \c Recipe (and its ingredients, equipment, etc) into plain values.  This is the only part that touches
+ *             the object stores or the DB.
+ *           - \c analyse() then runs \c RecipeCalculator::calculate() on the snapshots on a pool of worker threads,
+ *             passing each result to a \c Sink as soon as it is ready.  Results therefore arrive in whatever order
+ *             the workers finish, not necessarily the order of the snapshots.
+ *
+ *        \c analyseAll() does both, writing the results to a CSV or JSON file, and is what's behind the
+ *        \c --analyse-all command line option.
+ */
+namespace RecipeAnalyser {
+
+   /**
+    * \brief Everything needed to analyse one recipe.  NB: \c storedOg and \c storedFg are the values in the DB (ie
+    *        what was persisted the last time the recipe was saved), not the in-memory ones, which, by the time we take
+    *        the snapshot, have already been replaced by calculated values.  They are NaN if they could not be read.
+    */
+   struct RecipeSnapshot {
+      int     key;
+      QString name;
+      double  storedOg;
+      double  storedFg;
+      RecipeCalculator::Inputs inputs;
+   };
+
+   struct RecipeStats {
+      int     key;
+      QString name;
+      double  og;
+      double  fg;
+      double  ABV_pct;
+      double  IBU;
+      double  color_srm;
+      double  calories12oz;
+      double  storedOg;
+      double  storedFg;
+
+      /**
+       * \brief Whether the OG or FG stored in the DB for this recipe differs (by more than rounding error) from the
+       *        calculated one.  Always \c false if the stored values could not be read.
+       */
+      bool storedOgFgDisagree() const;
+   };
+
+   /**
+    * \brief Somewhere to send results.  Calls to \c write() are serialised by \c analyse(), so implementations do not
+    *        need to be thread-safe, but they will be made from worker threads.
+    */
+   class Sink {
+   public:
+      virtual ~Sink();
+      virtual bool begin() = 0;
+      virtual bool write(RecipeStats const & stats) = 0;
+      virtual bool end() = 0;
+   };
+
+   /**
+    * \brief Make a sink that writes to the given file, as JSON if its name ends in ".json", or as CSV otherwise
+    */
+   std::unique_ptr<Sink> makeFileSink(QString const & fileName);
+
+   /**
+    * \brief Take snapshots of all (non-deleted) recipes.  Must be called on the main thread, with the object stores
+    *        loaded.  Flushes any pending writes to the DB before reading the stored OG/FG from it.
+    */
+   QVector<RecipeSnapshot> snapshotAllRecipes();
+
+   /**
+    * \brief Calculate stats for the given snapshots, in parallel, and send them to \c sink
+    *
+    * \param snapshots
+    * \param sink
+    * \param maxThreads  How many worker threads to use
+    *
+    * \return Number of recipes whose stored OG/FG disagree with the calculated ones, or -1 if there was an error
+    *         writing to the sink
+    */
+   int analyse(QVector<RecipeSnapshot> const & snapshots,
+               Sink & sink,
+               int const maxThreads = QThread::idealThreadCount());
+
+   /**
+    * \brief Snapshot and analyse all recipes, writing the results to \c fileName (see \c makeFileSink())
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool analyseAll(QString const & fileName);
+}
+
+#endif
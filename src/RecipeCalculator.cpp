@@ -0,0 +1,570 @@
+/*
+ * RecipeCalculator.cpp is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "RecipeCalculator.h"
+
+#include <QByteArray>
+#include <QCryptographicHash>
+#include <QDebug>
+#include <QDataStream>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonParseError>
+#include <QJsonValue>
+
+#include "Algorithms.h"
+#include "PhysicalConstants.h"
+
+namespace {
+   //
+   // This goes into every fingerprint, so that results stored by an older version of the code are not reused once the
+   // calculations have changed.  Bump it whenever a change here (or in IbuMethods, ColorMethods, etc) would give
+   // different results for the same inputs.
+   //
+   quint32 const calculationsVersion = 1;
+
+   //
+   // The fields of Results that get stored by toJson() (other than the per-hop IBUs, which are an array, and
+   // SRMColor, which is quicker to recalculate than to store).
+   //
+   struct StoredField {
+      char const * name;
+      double RecipeCalculator::Results::* member;
+   };
+   StoredField const storedFields[] {
+      {"grainsInMash_kg",       &RecipeCalculator::Results::grainsInMash_kg      },
+      {"grains_kg",             &RecipeCalculator::Results::grains_kg            },
+      {"wortFromMash_l",        &RecipeCalculator::Results::wortFromMash_l       },
+      {"boilVolume_l",          &RecipeCalculator::Results::boilVolume_l         },
+      {"postBoilVolume_l",      &RecipeCalculator::Results::postBoilVolume_l     },
+      {"finalVolume_l",         &RecipeCalculator::Results::finalVolume_l        },
+      {"finalVolumeNoLosses_l", &RecipeCalculator::Results::finalVolumeNoLosses_l},
+      {"color_srm",             &RecipeCalculator::Results::color_srm            },
+      {"og",                    &RecipeCalculator::Results::og                   },
+      {"fg",                    &RecipeCalculator::Results::fg                   },
+      {"og_fermentable",        &RecipeCalculator::Results::og_fermentable       },
+      {"fg_fermentable",        &RecipeCalculator::Results::fg_fermentable       },
+      {"ABV_pct",               &RecipeCalculator::Results::ABV_pct              },
+      {"boilGrav",              &RecipeCalculator::Results::boilGrav             },
+      {"IBU",                   &RecipeCalculator::Results::IBU                  },
+      {"calories",              &RecipeCalculator::Results::calories             }
+   };
+}
+
+double RecipeCalculator::FermentableInput::equivSucrose_kg() const {
+   double ret = this->amount_kg * this->yield_pct * (1.0 - this->moisture_pct / 100.0) / 100.0;
+
+   // If this is a steeped grain...
+   if (this->type == Fermentable::Type::Grain && !this->isMashed) {
+      return 0.60 * ret; // Reduce the yield by 60%.
+   }
+   return ret;
+}
+
+bool RecipeCalculator::FermentableInput::isSugar() const {
+   return this->type == Fermentable::Type::Sugar;
+}
+
+bool RecipeCalculator::FermentableInput::isExtract() const {
+   return this->type == Fermentable::Type::Extract || this->type == Fermentable::Type::Dry_Extract;
+}
+
+double RecipeCalculator::EquipmentInput::wortEndOfBoil_l(double kettleWort_l) const {
+   return kettleWort_l - (this->boilTime_min / 60.0) * this->evapRate_lHr;
+}
+
+RecipeCalculator::Sugars RecipeCalculator::totalSugars(Inputs const & inputs) {
+   Sugars sugars;
+   for (auto const & ferm : inputs.fermentables) {
+      double const equivSucrose_kg = ferm.equivSucrose_kg();
+      // If we have some sort of non-grain, we have to ignore efficiency.
+      if (ferm.isSugar() || ferm.isExtract()) {
+         sugars.sugar_kg_ignoreEfficiency += equivSucrose_kg;
+
+         if (ferm.addAfterBoil) {
+            sugars.lateAddition_kg_ignoreEff += equivSucrose_kg;
+         }
+
+         if (!ferm.isFermentableSugar) {
+            sugars.nonFermentableSugars_kg += equivSucrose_kg;
+         }
+      } else {
+         sugars.sugar_kg += equivSucrose_kg;
+
+         if (ferm.addAfterBoil) {
+            sugars.lateAddition_kg += equivSucrose_kg;
+         }
+      }
+   }
+   return sugars;
+}
+
+namespace {
+   /**
+    * \brief How long a hop counts as being boiled for, for the purposes of IBU calculation
+    */
+   double ibuMinutes(RecipeCalculator::Inputs const & inputs, RecipeCalculator::HopInput const & hop) {
+      if (hop.use == Hop::Use::Boil) {
+         return hop.time_min;
+      }
+      // First wort and mash hops are in for the whole boil.  Assume 60 min boil until further notice.
+      return inputs.equipment ? static_cast<int>(inputs.equipment->boilTime_min) : 60;
+   }
+
+   /**
+    * \brief What to multiply the IBU formula's result by for a given hop, to allow for how and in what form it's
+    *        used.  A hop that does not contribute any bitterness (eg dry hops) gets 0.
+    */
+   double ibuMultiplier(RecipeCalculator::Inputs const & inputs, RecipeCalculator::HopInput const & hop) {
+      // NOTE: we used to carefully calculate the average boil gravity and use it in the
+      // IBU calculations. However, due to John Palmer
+      // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
+      // it seems more appropriate to just use the OG directly, since it is the total
+      // amount of break material that truly affects the IBUs.
+
+      double useFactor = 0.0;
+      if (hop.use == Hop::Use::Boil) {
+         useFactor = 1.0;
+      } else if (hop.use == Hop::Use::First_Wort) {
+         useFactor = inputs.settings.firstWortHopAdjustment;
+      } else if (hop.use == Hop::Use::Mash && inputs.settings.mashHopAdjustment > 0.0) {
+         useFactor = inputs.settings.mashHopAdjustment;
+      }
+
+      // Assume 100% utilization until further notice
+      double hopUtilization = inputs.equipment ? inputs.equipment->hopUtilization_pct / 100.0 : 1.0;
+
+      // Adjust for hop form. Tinseth's table was created from whole cone data,
+      // and it seems other formulae are optimized that way as well. So, the
+      // utilization is considered unadjusted for whole cones, and adjusted
+      // up for plugs and pellets.
+      //
+      // - http://www.realbeer.com/hops/FAQ.html
+      // - https://groups.google.com/forum/#!topic"brewtarget.h"lp/mv2qvWBC4sU
+      switch (hop.form) {
+         case Hop::Form::Plug:
+            hopUtilization *= 1.02;
+            break;
+         case Hop::Form::Pellet:
+            hopUtilization *= 1.10;
+            break;
+         default:
+            break;
+      }
+
+      return useFactor * hopUtilization;
+   }
+}
+
+double RecipeCalculator::ibuFromHop(Inputs const & inputs,
+                                    HopInput const & hop,
+                                    double const og,
+                                    double const finalVolumeNoLosses_l) {
+   double const multiplier = ibuMultiplier(inputs, hop);
+   if (multiplier == 0.0) {
+      return 0.0;
+   }
+   return multiplier * IbuMethods::getIbus(inputs.settings.ibuFormula,
+                                           hop.alpha_pct / 100.0,
+                                           hop.amount_kg * 1000.0,
+                                           finalVolumeNoLosses_l,
+                                           og,
+                                           ibuMinutes(inputs, hop));
+}
+
+void RecipeCalculator::calcGrainsInMash(Inputs const & inputs, Results & results) {
+   double ret = 0.0;
+   for (auto const & ferm : inputs.fermentables) {
+      if (ferm.type == Fermentable::Type::Grain && ferm.isMashed) {
+         ret += ferm.amount_kg;
+      }
+   }
+   results.grainsInMash_kg = ret;
+   return;
+}
+
+void RecipeCalculator::calcGrains(Inputs const & inputs, Results & results) {
+   double ret = 0.0;
+   for (auto const & ferm : inputs.fermentables) {
+      ret += ferm.amount_kg;
+   }
+   results.grains_kg = ret;
+   return;
+}
+
+void RecipeCalculator::calcVolumeEstimates(Inputs const & inputs, Results & results) {
+   // wortFromMash_l ==========================
+   double wortFromMash_l = 0.0;
+   if (inputs.totalMashWater_l) {
+      double const absorption_lKg =
+         inputs.equipment ? inputs.equipment->grainAbsorption_LKg : PhysicalConstants::grainAbsorption_Lkg;
+      wortFromMash_l = *inputs.totalMashWater_l - absorption_lKg * results.grainsInMash_kg;
+   }
+
+   // boilVolume_l ==============================
+   double boilVolume_l = wortFromMash_l;
+   if (inputs.equipment) {
+      boilVolume_l += inputs.equipment->topUpKettle_l - inputs.equipment->lauterDeadspace_l;
+   }
+
+   // Need to account for extract/sugar volume also.
+   for (auto const & ferm : inputs.fermentables) {
+      if (ferm.type == Fermentable::Type::Extract) {
+         boilVolume_l += ferm.amount_kg / PhysicalConstants::liquidExtractDensity_kgL;
+      } else if (ferm.type == Fermentable::Type::Sugar) {
+         boilVolume_l += ferm.amount_kg / PhysicalConstants::sucroseDensity_kgL;
+      } else if (ferm.type == Fermentable::Type::Dry_Extract) {
+         boilVolume_l += ferm.amount_kg / PhysicalConstants::dryExtractDensity_kgL;
+      }
+   }
+
+   if (boilVolume_l <= 0.0) {
+      boilVolume_l = inputs.boilSize_l;   // Give up.
+   }
+
+   // finalVolume_l ==============================
+
+   // NOTE: the following figure is not based on the other volume estimates
+   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
+   // (It's the batch size without losses.)
+   results.finalVolumeNoLosses_l = inputs.batchSize_l;
+   if (inputs.equipment) {
+      results.finalVolumeNoLosses_l += inputs.equipment->trubChillerLoss_l;
+      results.finalVolume_l = inputs.equipment->wortEndOfBoil_l(boilVolume_l) +
+                              inputs.equipment->topUpWater_l - inputs.equipment->trubChillerLoss_l;
+   } else {
+      results.finalVolume_l = boilVolume_l - 4.0; // This is just shooting in the dark. Can't do much without an equipment.
+   }
+
+   // postBoilVolume_l ===========================
+   if (inputs.equipment) {
+      results.postBoilVolume_l = inputs.equipment->wortEndOfBoil_l(boilVolume_l);
+   } else {
+      results.postBoilVolume_l = inputs.batchSize_l; // Give up.
+   }
+
+   results.wortFromMash_l = wortFromMash_l;
+   results.boilVolume_l   = boilVolume_l;
+   return;
+}
+
+void RecipeCalculator::calcColor(Inputs const & inputs, Results & results) {
+   double mcu = 0.0;
+   for (auto const & ferm : inputs.fermentables) {
+      // Conversion factor for lb/gal to kg/l = 8.34538.
+      mcu += ferm.color_srm * 8.34538 * ferm.amount_kg / results.finalVolumeNoLosses_l;
+   }
+   results.color_srm = ColorMethods::mcuToSrm(inputs.settings.colorFormula, mcu);
+   return;
+}
+
+void RecipeCalculator::calcSRMColor([[maybe_unused]] Inputs const & inputs, Results & results) {
+   results.SRMColor = Algorithms::srmToColor(results.color_srm);
+   return;
+}
+
+void RecipeCalculator::calcOgFg(Inputs const & inputs, Results & results) {
+   // Find out how much sugar we have.
+   Sugars const sugars = totalSugars(inputs);
+   double sugar_kg                  = sugars.sugar_kg;
+   double sugar_kg_ignoreEfficiency = sugars.sugar_kg_ignoreEfficiency;
+   double nonFermentableSugars_kg   = sugars.nonFermentableSugars_kg;
+
+   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
+   if (inputs.equipment) {
+      double const kettleWort_l =
+         (results.wortFromMash_l - inputs.equipment->lauterDeadspace_l) + inputs.equipment->topUpKettle_l;
+      double const postBoilWort_l = inputs.equipment->wortEndOfBoil_l(kettleWort_l);
+      double ratio = (postBoilWort_l - inputs.equipment->trubChillerLoss_l) / postBoilWort_l;
+      if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
+         ratio = 1.0;
+      } else if (ratio < 0.0) {
+         ratio = 0.0;
+      } else if (Algorithms::isNan(ratio)) {
+         ratio = 1.0;
+      }
+      // Ignore this again since it should be included in efficiency.
+      //sugar_kg *= ratio;
+      sugar_kg_ignoreEfficiency *= ratio;
+      if (nonFermentableSugars_kg != 0.0) {
+         nonFermentableSugars_kg *= ratio;
+      }
+   }
+
+   // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
+   sugar_kg = sugar_kg * inputs.efficiency_pct / 100.0 + sugar_kg_ignoreEfficiency;
+   double plato = Algorithms::getPlato(sugar_kg, results.finalVolumeNoLosses_l);
+
+   double const og = Algorithms::PlatoToSG_20C20C(plato);    // og from all sugars
+   double pnts = (og - 1) * 1000.0; // points from all sugars
+   double nonFermPnts = 0.0;
+   if (nonFermentableSugars_kg != 0.0) {
+      double const ferm_kg = sugar_kg - nonFermentableSugars_kg;  // Mass of only fermentable sugars
+      plato = Algorithms::getPlato(ferm_kg, results.finalVolumeNoLosses_l);   // Plato from fermentable sugars
+      results.og_fermentable = Algorithms::PlatoToSG_20C20C(plato);    // og from only fermentable sugars
+      plato = Algorithms::getPlato(nonFermentableSugars_kg, results.finalVolumeNoLosses_l);   // Plato from non-fermentable sugars
+      nonFermPnts = ((Algorithms::PlatoToSG_20C20C(plato)) - 1) * 1000.0; // og points from non-fermentable sugars
+   } else {
+      results.og_fermentable = og;
+   }
+
+   // Calculate FG from the yeast with the greatest attenuation.
+   double attenuation_pct = 0.0;
+   for (double const yeastAttenuation_pct : inputs.yeastAttenuations_pct) {
+      if (yeastAttenuation_pct > attenuation_pct) {
+         attenuation_pct = yeastAttenuation_pct;
+      }
+   }
+   // This means we have yeast, but they neglected to provide attenuation percentages.
+   if (!inputs.yeastAttenuations_pct.empty() && attenuation_pct <= 0.0)  {
+      attenuation_pct = 75.0; // 75% is an average attenuation.
+   }
+
+   double fg;
+   if (nonFermentableSugars_kg != 0.0) {
+      double const fermPnts = (pnts - nonFermPnts) * (1.0 - attenuation_pct / 100.0); // fg points from fermentable sugars
+      pnts = fermPnts + nonFermPnts;  // FG points from both fermentable and non-fermentable sugars
+      fg = 1 + pnts / 1000.0; // new FG value
+      results.fg_fermentable = 1 + fermPnts / 1000.0; // FG from fermentables only
+   } else {
+      pnts *= (1.0 - attenuation_pct / 100.0);
+      fg = 1 + pnts / 1000.0;
+      results.fg_fermentable = fg;
+   }
+
+   results.og = og;
+   results.fg = fg;
+   return;
+}
+
+void RecipeCalculator::calcABV([[maybe_unused]] Inputs const & inputs, Results & results) {
+   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
+   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
+   results.ABV_pct = (76.08 * (results.og_fermentable - results.fg_fermentable) / (1.775 - results.og_fermentable)) *
+                     (results.fg_fermentable / 0.794);
+   return;
+}
+
+void RecipeCalculator::calcBoilGrav(Inputs const & inputs, Results & results) {
+   Sugars const sugars = totalSugars(inputs);
+
+   // Since the efficiency refers to how much sugar we get into the fermenter,
+   // we need to adjust for that here.
+   double const sugar_kg = inputs.efficiency_pct / 100.0 * (sugars.sugar_kg - sugars.lateAddition_kg) +
+                           sugars.sugar_kg_ignoreEfficiency - sugars.lateAddition_kg_ignoreEff;
+
+   results.boilGrav = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(sugar_kg, inputs.boilSize_l));
+   return;
+}
+
+void RecipeCalculator::calcIBU(Inputs const & inputs, Results & results) {
+   double ibus = 0.0;
+
+   //
+   // Bitterness due to hops...
+   //
+   // We gather up the hops that contribute bitterness into arrays so that IbuMethods can do them all in one go (see
+   // comment in IbuMethods::getIbus()).  Hops that don't contribute are left out, rather than multiplying by zero, so
+   // they can't end up as NaN if the volume is zero.
+   //
+   std::size_t const numHops = inputs.hops.size();
+   std::vector<std::size_t> hopIndexes;
+   std::vector<double> multipliers, AAratings, grams, minutes;
+   hopIndexes.reserve(numHops);
+   multipliers.reserve(numHops);
+   AAratings.reserve(numHops);
+   grams.reserve(numHops);
+   minutes.reserve(numHops);
+   for (std::size_t ii = 0; ii < numHops; ++ii) {
+      HopInput const & hop = inputs.hops[ii];
+      double const multiplier = ibuMultiplier(inputs, hop);
+      if (multiplier != 0.0) {
+         hopIndexes.push_back(ii);
+         multipliers.push_back(multiplier);
+         AAratings.push_back(hop.alpha_pct / 100.0);
+         grams.push_back(hop.amount_kg * 1000.0);
+         minutes.push_back(ibuMinutes(inputs, hop));
+      }
+   }
+
+   std::vector<double> hopIbus(hopIndexes.size());
+   IbuMethods::getIbus(inputs.settings.ibuFormula,
+                       hopIndexes.size(),
+                       AAratings.data(),
+                       grams.data(),
+                       minutes.data(),
+                       results.finalVolumeNoLosses_l,
+                       results.og,
+                       hopIbus.data());
+
+   results.ibus.assign(numHops, 0.0);
+   for (std::size_t jj = 0; jj < hopIndexes.size(); ++jj) {
+      double const ibusFromThisHop = multipliers[jj] * hopIbus[jj];
+      results.ibus[hopIndexes[jj]] = ibusFromThisHop;
+      ibus += ibusFromThisHop;
+   }
+
+   // Bitterness due to hopped extracts...
+   for (auto const & ferm : inputs.fermentables) {
+      // Conversion factor for lb/gal to kg/l = 8.34538.
+      ibus += ferm.ibuGalPerLb * (ferm.amount_kg / inputs.batchSize_l) / 8.34538;
+   }
+
+   results.IBU = ibus;
+   return;
+}
+
+// the formula in here are taken from http://hbd.org/ensmingr/
+void RecipeCalculator::calcCalories([[maybe_unused]] Inputs const & inputs, Results & results) {
+   double const oog = results.og;
+   double const ffg = results.fg;
+
+   // Need to translate OG and FG into plato
+   double const startPlato  = -463.37 + (668.72 * oog) - (205.35 * oog * oog);
+   double const finishPlato = -463.37 + (668.72 * ffg) - (205.35 * ffg * ffg);
+
+   // RE (real extract)
+   double const RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
+
+   // Alcohol by weight?
+   double const abw = (startPlato - RE) / (2.0665 - (0.010665 * startPlato));
+
+   // The final results of this formular are calories per 100 ml.
+   // The 3.55 puts it in terms of 12 oz. I really should have stored it
+   // without that adjust.
+   double calories = ((6.9 * abw) + 4.0 * (RE - 0.1)) * ffg * 3.55;
+
+   //! If there are no fermentables in the recipe, if there is no mash, etc.,
+   //  then the calories/12 oz ends up negative. Since negative doesn't make
+   //  sense, set it to 0
+   if (calories < 0) {
+      calories = 0;
+   }
+
+   results.calories = calories;
+   return;
+}
+
+RecipeCalculator::Results RecipeCalculator::calculate(Inputs const & inputs) {
+   Results results;
+   calcGrainsInMash   (inputs, results);
+   calcGrains         (inputs, results);
+   calcVolumeEstimates(inputs, results);
+   calcColor          (inputs, results);
+   calcSRMColor       (inputs, results);
+   calcOgFg           (inputs, results);
+   calcABV            (inputs, results);
+   calcBoilGrav       (inputs, results);
+   calcIBU            (inputs, results);
+   calcCalories       (inputs, results);
+   return results;
+}
+
+QString RecipeCalculator::fingerprint(Inputs const & inputs) {
+   QByteArray data;
+   {
+      QDataStream stream{&data, QIODevice::WriteOnly};
+      // Fix the stream format so that the same inputs always give the same fingerprint, whichever Qt we're running on
+      stream.setVersion(QDataStream::Qt_5_9);
+      stream << calculationsVersion << inputs.batchSize_l << inputs.boilSize_l << inputs.efficiency_pct;
+
+      stream << static_cast<quint32>(inputs.fermentables.size());
+      for (auto const & ferm : inputs.fermentables) {
+         stream <<
+            static_cast<qint32>(ferm.type) << ferm.isMashed << ferm.addAfterBoil << ferm.isFermentableSugar <<
+            ferm.amount_kg << ferm.yield_pct << ferm.moisture_pct << ferm.color_srm << ferm.ibuGalPerLb;
+      }
+
+      stream << static_cast<quint32>(inputs.hops.size());
+      for (auto const & hop : inputs.hops) {
+         stream <<
+            hop.alpha_pct << hop.amount_kg << hop.time_min << static_cast<qint32>(hop.use) <<
+            static_cast<qint32>(hop.form);
+      }
+
+      stream << static_cast<quint32>(inputs.yeastAttenuations_pct.size());
+      for (auto const attenuation_pct : inputs.yeastAttenuations_pct) {
+         stream << attenuation_pct;
+      }
+
+      stream << inputs.equipment.has_value();
+      if (inputs.equipment) {
+         stream <<
+            inputs.equipment->grainAbsorption_LKg << inputs.equipment->lauterDeadspace_l <<
+            inputs.equipment->topUpKettle_l << inputs.equipment->topUpWater_l << inputs.equipment->trubChillerLoss_l <<
+            inputs.equipment->boilTime_min << inputs.equipment->evapRate_lHr << inputs.equipment->hopUtilization_pct;
+      }
+
+      stream << inputs.totalMashWater_l.has_value();
+      if (inputs.totalMashWater_l) {
+         stream << *inputs.totalMashWater_l;
+      }
+
+      stream <<
+         static_cast<qint32>(inputs.settings.ibuFormula) << static_cast<qint32>(inputs.settings.colorFormula) <<
+         inputs.settings.firstWortHopAdjustment << inputs.settings.mashHopAdjustment;
+   }
+   return QString::fromLatin1(QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex());
+}
+
+QString RecipeCalculator::toJson(Results const & results) {
+   QJsonObject object;
+   for (auto const & field : storedFields) {
+      object.insert(field.name, results.*field.member);
+   }
+   QJsonArray ibus;
+   for (auto const hopIbus : results.ibus) {
+      ibus.append(hopIbus);
+   }
+   object.insert("ibus", ibus);
+   return QString::fromUtf8(QJsonDocument{object}.toJson(QJsonDocument::Compact));
+}
+
+bool RecipeCalculator::fromJson(QString const & json, Inputs const & inputs, Results & results) {
+   QJsonParseError jsonParseError{};
+   QJsonDocument const document = QJsonDocument::fromJson(json.toUtf8(), &jsonParseError);
+   if (jsonParseError.error != QJsonParseError::NoError || !document.isObject()) {
+      qWarning() << Q_FUNC_INFO << "Unable to parse stored results:" << jsonParseError.errorString();
+      return false;
+   }
+
+   QJsonObject const object = document.object();
+   for (auto const & field : storedFields) {
+      QJsonValue const value = object.value(field.name);
+      if (!value.isDouble()) {
+         qWarning() << Q_FUNC_INFO << "Stored results missing" << field.name;
+         return false;
+      }
+      results.*field.member = value.toDouble();
+   }
+
+   QJsonArray const ibus = object.value("ibus").toArray();
+   if (static_cast<std::size_t>(ibus.size()) != inputs.hops.size()) {
+      qWarning() << Q_FUNC_INFO << "Stored results have" << ibus.size() << "per-hop IBUs, expected" << inputs.hops.size();
+      return false;
+   }
+   results.ibus.clear();
+   results.ibus.reserve(inputs.hops.size());
+   for (auto const hopIbus : ibus) {
+      results.ibus.push_back(hopIbus.toDouble());
+   }
+
+   calcSRMColor(inputs, results);
+   return true;
+}
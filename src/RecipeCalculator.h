@@ -0,0 +1,224 @@
+/*
+ * RecipeCalculator.h is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef RECIPECALCULATOR_H
+#define RECIPECALCULATOR_H
+#pragma once
+
+#include <optional>
+#include <vector>
+
+#include <QColor>
+#include <QString>
+
+#include "measurement/ColorMethods.h"
+#include "measurement/IbuMethods.h"
+#include "model/Fermentable.h" // For Fermentable::Type
+#include "model/Hop.h"         // For Hop::Use and Hop::Form
+
+/*!
+ * \namespace RecipeCalculator
+ *
+ * \brief The maths behind a Recipe's calculated values (OG, FG, ABV, IBU, colour, volumes, calories).
+ *
+ *        Everything here works on plain value types: the caller gathers up a snapshot of the recipe, its ingredients,
+ *        its equipment and the relevant settings into an \c Inputs struct, and gets back a \c Results struct.  There
+ *        is no access to the object stores, persistent settings or any global state, and no Qt signals, so these
+ *        functions are re-entrant and can be called from any thread (eg for batch calculations over many recipes,
+ *        "what if" tools, or benchmarks).  \c Recipe is a thin adapter that builds the \c Inputs from its contained
+ *        objects and stores (and announces) the \c Results.
+ *
+ *        The calculation is split into the same steps as the nodes of \c Recipe::CalcNode.  Each \c calc* function
+ *        reads \c Inputs plus the fields of \c Results set by the steps it depends on, and sets its own fields of
+ *        \c Results.  \c calculate() runs them all in order.
+ */
+namespace RecipeCalculator {
+
+   struct FermentableInput {
+      Fermentable::Type type;
+      bool   isMashed;
+      bool   addAfterBoil;
+      //! \brief See \c Recipe::isFermentableSugar()
+      bool   isFermentableSugar;
+      double amount_kg;
+      double yield_pct;
+      double moisture_pct;
+      double color_srm;
+      double ibuGalPerLb;
+
+      //! \brief Same as \c Fermentable::equivSucrose_kg()
+      double equivSucrose_kg() const;
+      //! \brief Same as \c Fermentable::isSugar() and \c Fermentable::isExtract() respectively
+      bool isSugar() const;
+      bool isExtract() const;
+
+      bool operator==(FermentableInput const & other) const = default;
+   };
+
+   struct HopInput {
+      double    alpha_pct;
+      double    amount_kg;
+      double    time_min;
+      Hop::Use  use;
+      Hop::Form form;
+
+      bool operator==(HopInput const & other) const = default;
+   };
+
+   struct EquipmentInput {
+      double grainAbsorption_LKg;
+      double lauterDeadspace_l;
+      double topUpKettle_l;
+      double topUpWater_l;
+      double trubChillerLoss_l;
+      double boilTime_min;
+      double evapRate_lHr;
+      double hopUtilization_pct;
+
+      //! \brief Same as \c Equipment::wortEndOfBoil_l()
+      double wortEndOfBoil_l(double kettleWort_l) const;
+
+      bool operator==(EquipmentInput const & other) const = default;
+   };
+
+   /**
+    * \brief The user settings that affect the calculations.  (See \c IbuMethods::ibuFormula,
+    *        \c ColorMethods::colorFormula and \c PersistentSettings::CalcSettings.)
+    */
+   struct Settings {
+      IbuMethods::IbuType     ibuFormula;
+      ColorMethods::ColorType colorFormula;
+      double                  firstWortHopAdjustment;
+      double                  mashHopAdjustment;
+
+      bool operator==(Settings const & other) const = default;
+   };
+
+   struct Inputs {
+      double batchSize_l;
+      double boilSize_l;
+      double efficiency_pct;
+      std::vector<FermentableInput> fermentables;
+      std::vector<HopInput>         hops;
+      std::vector<double>           yeastAttenuations_pct;
+      //! \brief Not set if the recipe has no equipment
+      std::optional<EquipmentInput> equipment;
+      //! \brief Total water added in the mash (see \c Mash::totalMashWater_l()), or not set if the recipe has no mash
+      std::optional<double>         totalMashWater_l;
+      Settings                      settings;
+
+      //! \brief Much cheaper than comparing \c fingerprint()s, when we have both sets of inputs to hand
+      bool operator==(Inputs const & other) const = default;
+   };
+
+   /**
+    * \brief Masses of sugar in the fermentables.  (These were previously returned in a \c QHash by
+    *        \c Recipe::calcTotalPoints(), which still exists for the benefit of \c BrewNote.)
+    */
+   struct Sugars {
+      //! \brief Mass of sugar that \b is affected by mash efficiency
+      double sugar_kg                  = 0.0;
+      //! \brief Mass of sugar that is not fermentable (also counted in \c sugar_kg_ignoreEfficiency)
+      double nonFermentableSugars_kg   = 0.0;
+      //! \brief Mass of sugar that is \b not affected by mash efficiency
+      double sugar_kg_ignoreEfficiency = 0.0;
+      double lateAddition_kg           = 0.0;
+      double lateAddition_kg_ignoreEff = 0.0;
+   };
+
+   struct Results {
+      double grainsInMash_kg       = 0.0;
+      double grains_kg             = 0.0;
+      double wortFromMash_l        = 0.0;
+      double boilVolume_l          = 0.0;
+      double postBoilVolume_l      = 0.0;
+      double finalVolume_l         = 0.0;
+      //! \brief Final volume before any losses out of the kettle, used in calculations for sg/ibu/etc.
+      double finalVolumeNoLosses_l = 0.0;
+      double color_srm             = 0.0;
+      QColor SRMColor              = QColor{};
+      double og                    = 1.0;
+      double fg                    = 1.0;
+      double og_fermentable        = 0.0;
+      double fg_fermentable        = 0.0;
+      double ABV_pct               = 0.0;
+      double boilGrav              = 0.0;
+      double IBU                   = 0.0;
+      //! \brief IBUs from each hop, in the same order as \c Inputs::hops
+      std::vector<double> ibus;
+      double calories              = 0.0;
+
+      bool operator==(Results const & other) const = default;
+   };
+
+   Sugars totalSugars(Inputs const & inputs);
+
+   /**
+    * \brief Get the IBUs from a given hop, given the OG and final volume (see \c calcOgFg() and
+    *        \c calcVolumeEstimates()).
+    */
+   double ibuFromHop(Inputs const & inputs, HopInput const & hop, double const og, double const finalVolumeNoLosses_l);
+
+   //! \brief Sets \c grainsInMash_kg.  Depends on: --.
+   void calcGrainsInMash(Inputs const & inputs, Results & results);
+   //! \brief Sets \c grains_kg.  Depends on: --.
+   void calcGrains(Inputs const & inputs, Results & results);
+   //! \brief Sets all the volumes.  Depends on: \c grainsInMash_kg.
+   void calcVolumeEstimates(Inputs const & inputs, Results & results);
+   //! \brief Sets \c color_srm.  Depends on: \c finalVolumeNoLosses_l.
+   void calcColor(Inputs const & inputs, Results & results);
+   //! \brief Sets \c SRMColor.  Depends on: \c color_srm.
+   void calcSRMColor(Inputs const & inputs, Results & results);
+   //! \brief Sets \c og, \c fg, \c og_fermentable, \c fg_fermentable.  Depends on: \c wortFromMash_l,
+   //!        \c finalVolumeNoLosses_l.
+   void calcOgFg(Inputs const & inputs, Results & results);
+   //! \brief Sets \c ABV_pct.  Depends on: \c og_fermentable, \c fg_fermentable.
+   void calcABV(Inputs const & inputs, Results & results);
+   //! \brief Sets \c boilGrav.  Depends on: --.
+   void calcBoilGrav(Inputs const & inputs, Results & results);
+   //! \brief Sets \c IBU and \c ibus.  Depends on: \c og, \c finalVolumeNoLosses_l.
+   void calcIBU(Inputs const & inputs, Results & results);
+   //! \brief Sets \c calories.  Depends on: \c og, \c fg.
+   void calcCalories(Inputs const & inputs, Results & results);
+
+   /**
+    * \brief Do all of the above, in dependency order
+    */
+   Results calculate(Inputs const & inputs);
+
+   /**
+    * \brief A hash of everything in \c inputs (and of the version of the calculations themselves).  If this is the
+    *        same as when a set of \c Results was calculated then those results are still valid.
+    */
+   QString fingerprint(Inputs const & inputs);
+
+   /**
+    * \brief Serialise \c results (eg for storing in the DB along with the \c fingerprint() of the inputs)
+    */
+   QString toJson(Results const & results);
+
+   /**
+    * \brief Restore \c results from the output of \c toJson().  The caller must already have checked that the
+    *        \c fingerprint() of \c inputs matches the one the results were stored with.
+    *
+    * \return \c true if succeeded, \c false if \c json is not valid (in which case \c results should be recalculated)
+    */
+   bool fromJson(QString const & json, Inputs const & inputs, Results & results);
+}
+
+#endif
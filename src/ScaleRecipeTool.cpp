@@ -23,6 +23,7 @@
 #include <QButtonGroup>
 
 #include "EquipmentListModel.h"
+#include "database/ObjectStoreTyped.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
@@ -65,6 +66,9 @@ void ScaleRecipeTool::scale(Equipment* equip, double newEff) {
       return;
    }
 
+   // Every amount in the Recipe is about to change, so we want all the DB updates to happen together
+   ObjectStoreTransaction objectStoreTransaction;
+
    // Calculate volume ratio
    double currentBatchSize_l = recObs->batchSize_l();
    double newBatchSize_l = equip->batchSize_l();
@@ -74,43 +78,54 @@ void ScaleRecipeTool::scale(Equipment* equip, double newEff) {
    double oldEfficiency = recObs->efficiency_pct();
    double effRatio = oldEfficiency / newEff;
 
-   this->recObs->setEquipment(equip);
-   this->recObs->setBatchSize_l(newBatchSize_l);
-   this->recObs->setBoilSize_l(equip->boilSize_l());
-   this->recObs->setEfficiency_pct(newEff);
-   this->recObs->setBoilTime_min(equip->boilTime_min());
-
-   for (auto ferm : this->recObs->fermentables()) {
-      if (!ferm->isSugar() && !ferm->isExtract()) {
-         ferm->setAmount_kg(ferm->amount_kg() * effRatio * volRatio);
-      } else {
-         ferm->setAmount_kg(ferm->amount_kg() * volRatio);
+   {
+      // Nearly everything the Recipe's calculated values depend on is about to change, so we only want to recalculate
+      // them once, when we're done (and before we commit, so that the new OG, FG etc are part of the transaction).
+      Recipe::RecalcBatch recalcBatch{*this->recObs};
+
+      this->recObs->setEquipment(equip);
+      this->recObs->setBatchSize_l(newBatchSize_l);
+      this->recObs->setBoilSize_l(equip->boilSize_l());
+      this->recObs->setEfficiency_pct(newEff);
+      this->recObs->setBoilTime_min(equip->boilTime_min());
+
+      for (auto ferm : this->recObs->fermentables()) {
+         if (!ferm->isSugar() && !ferm->isExtract()) {
+            ferm->setAmount_kg(ferm->amount_kg() * effRatio * volRatio);
+         } else {
+            ferm->setAmount_kg(ferm->amount_kg() * volRatio);
+         }
       }
-   }
 
-   for (auto hop : this->recObs->hops()) {
-      hop->setAmount_kg(hop->amount_kg() * volRatio);
-   }
+      for (auto hop : this->recObs->hops()) {
+         hop->setAmount_kg(hop->amount_kg() * volRatio);
+      }
 
-   for (auto misc : this->recObs->miscs()) {
-      misc->setAmount( misc->amount() * volRatio);
-   }
+      for (auto misc : this->recObs->miscs()) {
+         misc->setAmount( misc->amount() * volRatio);
+      }
 
-   for (auto water : this->recObs->waters()) {
-      water->setAmount(water->amount() * volRatio);
-   }
+      for (auto water : this->recObs->waters()) {
+         water->setAmount(water->amount() * volRatio);
+      }
 
-   Mash* mash = this->recObs->mash();
-   if (mash) {
-      for (auto step : mash->mashSteps()) {
-         // Reset all these to zero so that the user
-         // will know to re-run the mash wizard.
-         step->setDecoctionAmount_l(0);
-         step->setInfuseAmount_l(0);
+      Mash* mash = this->recObs->mash();
+      if (mash) {
+         for (auto step : mash->mashSteps()) {
+            // Reset all these to zero so that the user
+            // will know to re-run the mash wizard.
+            step->setDecoctionAmount_l(0);
+            step->setInfuseAmount_l(0);
+         }
       }
+
+      // I don't think I should scale the yeasts.
    }
 
-   // I don't think I should scale the yeasts.
+   if (!objectStoreTransaction.commit()) {
+      QMessageBox::warning(this, tr("Recipe Not Scaled"), tr("Unable to store the scaled recipe in the database."));
+      return;
+   }
 
    // Let the user know what happened.
    QMessageBox::information(this, tr("Recipe Scaled"),
@@ -31,6 +31,8 @@ StyleListModel::StyleListModel(QWidget* parent) :
    QAbstractListModel(parent),
    recipe(0) {
    connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectInserted, this, &StyleListModel::addStyle);
+   connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectsInserted, this,
+           [this](QVector<int> const & styleIds) { for (int id : styleIds) { this->addStyle(id); } return; });
    connect(&ObjectStoreTyped<Style>::getInstance(), &ObjectStoreTyped<Style>::signalObjectDeleted,  this, &StyleListModel::removeStyle);
    repopulateList();
    return;
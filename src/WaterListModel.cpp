@@ -30,6 +30,8 @@ WaterListModel::WaterListModel(QWidget* parent) :
    QAbstractListModel(parent),
    m_recipe(nullptr) {
    connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectInserted, this, &WaterListModel::addWater);
+   connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectsInserted, this,
+           [this](QVector<int> const & waterIds) { for (int id : waterIds) { this->addWater(id); } return; });
    connect(&ObjectStoreTyped<Water>::getInstance(), &ObjectStoreTyped<Water>::signalObjectDeleted,  this, &WaterListModel::removeWater);
    repopulateList();
    return;
@@ -1,6 +1,6 @@
 /*
  * database/BtSqlQuery.cpp is part of Brewtarget, and is copyright the following
- * authors 2021:
+ * authors 2021-2023:
  *   • Matt Young <mfsy@yahoo.com>
  *
  * Brewtarget is free software: you can redistribute it and/or modify
@@ -18,10 +18,130 @@
  */
 #include "database/BtSqlQuery.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <stdexcept>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRegularExpression>
 #include <QSqlError>
+#include <QTextStream>
+#include <QVector>
+
+namespace {
+   //
+   // Rather than keep every timing, we keep a histogram with four buckets for each power of two of nanoseconds.  This
+   // uses a fixed (small) amount of memory per statement shape and is still good enough to give percentiles to within
+   // about 20%.
+   //
+   int const subBucketsPerPowerOfTwo = 4;
+   int const numLatencyBuckets = 64 * subBucketsPerPowerOfTwo;
+
+   int latencyBucket(quint64 const nanoseconds) {
+      if (nanoseconds < subBucketsPerPowerOfTwo) {
+         return static_cast<int>(nanoseconds);
+      }
+      int mostSignificantBit = 0;
+      while ((nanoseconds >> (mostSignificantBit + 1)) != 0) {
+         ++mostSignificantBit;
+      }
+      // The two bits after the most significant one tell us which quarter of the power of two we're in
+      int const subBucket = static_cast<int>((nanoseconds >> (mostSignificantBit - 2)) & 0x3);
+      return mostSignificantBit * subBucketsPerPowerOfTwo + subBucket;
+   }
+
+   /**
+    * \brief Largest number of nanoseconds that goes in the given bucket (ie the inverse of \c latencyBucket())
+    */
+   quint64 latencyBucketUpperBound_ns(int const bucket) {
+      if (bucket < subBucketsPerPowerOfTwo) {
+         return static_cast<quint64>(bucket);
+      }
+      int const mostSignificantBit = bucket / subBucketsPerPowerOfTwo;
+      quint64 const subBucket = static_cast<quint64>(bucket % subBucketsPerPowerOfTwo);
+      return ((subBucketsPerPowerOfTwo + subBucket + 1) << (mostSignificantBit - 2)) - 1;
+   }
+
+   struct StatementStats {
+      quint64 prepareCount = 0;
+      quint64 prepareTotal_ns = 0;
+      quint64 execCount = 0;
+      quint64 execTotal_ns = 0;
+      quint64 execMax_ns = 0;
+      qint64 rowsAffected = 0;
+      std::array<quint64, numLatencyBuckets> latencyHistogram{};
+
+      /**
+       * \brief Approximate latency below which the given fraction of executions fall
+       */
+      quint64 percentile_ns(double const fraction) const {
+         quint64 const target = static_cast<quint64>(fraction * static_cast<double>(this->execCount));
+         quint64 soFar = 0;
+         for (int bucket = 0; bucket < numLatencyBuckets; ++bucket) {
+            soFar += this->latencyHistogram[bucket];
+            if (soFar > target) {
+               return std::min(latencyBucketUpperBound_ns(bucket), this->execMax_ns);
+            }
+         }
+         return this->execMax_ns;
+      }
+   };
+
+   // Queries are run on both the GUI thread and the DB writer thread, so access to the stats needs to be serialised
+   QMutex statsMutex;
+   QHash<QString, StatementStats> statsByStatementShape;
+
+   // Zero or less means don't log slow queries
+   std::atomic<qint64> slowQueryThreshold_ns{0};
+
+   /**
+    * \brief Turn SQL into its "shape" by replacing literal strings and numbers with \c ? and normalising whitespace,
+    *        so that, eg, "SELECT * FROM hop WHERE id = 12" and "SELECT * FROM hop WHERE id = 13" are counted together.
+    */
+   QString statementShape(QString const & sql) {
+      // QRegularExpression is reentrant but not thread-safe, hence one per thread
+      thread_local QRegularExpression const literals{"'(?:[^']|'')*'|\\b\\d+(?:\\.\\d+)?\\b"};
+      QString shape = sql.simplified();
+      shape.replace(literals, "?");
+      return shape;
+   }
+
+   void recordPrepare(QString const & shape, quint64 const elapsed_ns) {
+      QMutexLocker locker(&statsMutex);
+      StatementStats & stats = statsByStatementShape[shape];
+      ++stats.prepareCount;
+      stats.prepareTotal_ns += elapsed_ns;
+      return;
+   }
+
+   void recordExec(QString const & shape, quint64 const elapsed_ns, int const rowsAffected) {
+      {
+         QMutexLocker locker(&statsMutex);
+         StatementStats & stats = statsByStatementShape[shape];
+         ++stats.execCount;
+         stats.execTotal_ns += elapsed_ns;
+         stats.execMax_ns = std::max(stats.execMax_ns, elapsed_ns);
+         if (rowsAffected > 0) {
+            stats.rowsAffected += rowsAffected;
+         }
+         ++stats.latencyHistogram[latencyBucket(elapsed_ns)];
+      }
+
+      qint64 const threshold_ns = slowQueryThreshold_ns.load();
+      if (threshold_ns > 0 && elapsed_ns >= static_cast<quint64>(threshold_ns)) {
+         qWarning() <<
+            Q_FUNC_INFO << "Slow query (" << (elapsed_ns / 1000000) << "ms, " << rowsAffected << "rows affected):" <<
+            shape;
+      }
+      return;
+   }
+}
 
 bool BtSqlQuery::prepare(const QString & query) {
    //
@@ -29,6 +149,7 @@ bool BtSqlQuery::prepare(const QString & query) {
    // get an error.
    //
    this->bt_query = query;
+   this->bt_statementShape = statementShape(query);
    this->bt_boundValues = false;
 
    // Since we didn't actually call QSqlQuery::prepare() (yet), there's no possibility of an error to return
@@ -40,7 +161,11 @@ void BtSqlQuery::reallyPrepare() {
    // already, call QSqlQuery::prepare()
    if (!this->bt_boundValues) {
       this->bt_boundValues = true;
-      if (!this->QSqlQuery::prepare(this->bt_query)) {
+      QElapsedTimer timer;
+      timer.start();
+      bool const succeeded = this->QSqlQuery::prepare(this->bt_query);
+      recordPrepare(this->bt_statementShape, static_cast<quint64>(timer.nsecsElapsed()));
+      if (!succeeded) {
          qCritical() << Q_FUNC_INFO << "Call to QSqlQuery::prepare() failed: " << this->lastError().text();
          throw std::runtime_error(this->lastError().text().toStdString());
       }
@@ -66,11 +191,18 @@ void BtSqlQuery::bindValue(int pos, const QVariant &val, QSql::ParamType paramTy
    return;
 }
 
-/**
-   * \brief As \c QSqlQuery::exec() except that if no values were bound to the query, we pass the SQL from \c prepare()
-   *        as a parameter
-   */
+bool BtSqlQuery::exec(QString const & query) {
+   QElapsedTimer timer;
+   timer.start();
+   bool const result = this->QSqlQuery::exec(query);
+   qint64 const elapsed_ns = timer.nsecsElapsed();
+   recordExec(statementShape(query), static_cast<quint64>(elapsed_ns), this->isSelect() ? 0 : this->numRowsAffected());
+   return result;
+}
+
 bool BtSqlQuery::exec() {
+   QElapsedTimer timer;
+   timer.start();
    bool result;
    if (this->bt_boundValues) {
       result = this->QSqlQuery::exec();
@@ -79,9 +211,65 @@ bool BtSqlQuery::exec() {
       // pass it to QSqlQuery for execution
       result = this->QSqlQuery::exec(this->bt_query);
    }
+   qint64 const elapsed_ns = timer.nsecsElapsed();
+   recordExec(this->bt_statementShape,
+              static_cast<quint64>(elapsed_ns),
+              this->isSelect() ? 0 : this->numRowsAffected());
 
    // If someone wants to reuse the object, eg to insert multiple rows with the same query, it's already in the correct
    // state (whether or not there were bound variables, so we're done here.
 
    return result;
 }
+
+void BtSqlQuery::setSlowQueryThreshold_ms(int const threshold_ms) {
+   qInfo() << Q_FUNC_INFO << "Logging queries that take" << threshold_ms << "ms or more";
+   slowQueryThreshold_ns.store(static_cast<qint64>(threshold_ms) * 1000000);
+   return;
+}
+
+QString BtSqlQuery::statisticsReport() {
+   QVector<QPair<QString, StatementStats> > allStats;
+   {
+      QMutexLocker locker(&statsMutex);
+      allStats.reserve(statsByStatementShape.size());
+      for (auto ii = statsByStatementShape.cbegin(); ii != statsByStatementShape.cend(); ++ii) {
+         allStats.append(qMakePair(ii.key(), ii.value()));
+      }
+   }
+
+   // Statements where we spent the most time overall are the ones most worth looking at, so put them first
+   std::sort(
+      allStats.begin(),
+      allStats.end(),
+      [](QPair<QString, StatementStats> const & lhs, QPair<QString, StatementStats> const & rhs) {
+         return lhs.second.execTotal_ns + lhs.second.prepareTotal_ns >
+                rhs.second.execTotal_ns + rhs.second.prepareTotal_ns;
+      }
+   );
+
+   QString report;
+   QTextStream stream{&report};
+   stream << "Count\tTotal ms\tMean us\tp50 us\tp99 us\tMax us\tRows\tPrepares\tPrepare ms\tStatement\n";
+   for (auto const & shapeAndStats : allStats) {
+      StatementStats const & stats = shapeAndStats.second;
+      stream <<
+         stats.execCount << "\t" <<
+         (stats.execTotal_ns / 1000000) << "\t" <<
+         (stats.execCount > 0 ? stats.execTotal_ns / stats.execCount / 1000 : 0) << "\t" <<
+         (stats.percentile_ns(0.50) / 1000) << "\t" <<
+         (stats.percentile_ns(0.99) / 1000) << "\t" <<
+         (stats.execMax_ns / 1000) << "\t" <<
+         stats.rowsAffected << "\t" <<
+         stats.prepareCount << "\t" <<
+         (stats.prepareTotal_ns / 1000000) << "\t" <<
+         shapeAndStats.first << "\n";
+   }
+   stream.flush();
+   return report;
+}
+
+void BtSqlQuery::logStatistics() {
+   qInfo().noquote() << Q_FUNC_INFO << "DB query statistics:\n" << BtSqlQuery::statisticsReport();
+   return;
+}
@@ -50,6 +50,10 @@
  *        Note that a syntax error in a prepared statement will not get reported until the first call to \c bindValue()
  *        (and will be reported via logging + run-time exception rather than return value), but otherwise behaviour
  *        should be similar to the way you would want \c QSqlQuery to work.
+ *
+ *        We also time every prepare and execution, and keep statistics for each "shape" of SQL statement (ie the SQL
+ *        with any literal values replaced by \c ?, so that, eg, all the queries that differ only by ID are counted
+ *        together).  See \c statisticsReport().  Executions that take longer than the slow query threshold are logged.
  */
 class BtSqlQuery : public QSqlQuery {
 public:
@@ -66,8 +70,10 @@ public:
    void bindValue(const QString &placeholder, const QVariant &val, QSql::ParamType paramType = QSql::In);
    void bindValue(int pos, const QVariant &val, QSql::ParamType paramType = QSql::In);
 
-   // Allow access to the version of QSqlQuery::exec() that we don't override
-   using QSqlQuery::exec;
+   /**
+    * \brief As \c QSqlQuery::exec(const QString &) except that we record how long it took
+    */
+   bool exec(QString const & query);
 
    /**
     * \brief As \c QSqlQuery::exec() except that if no values were bound to the query, we pass the SQL from \c prepare()
@@ -75,9 +81,29 @@ public:
     */
    bool exec();
 
+   /**
+    * \brief Set how long a statement has to take to execute before we log it as slow.  Zero or less means don't log
+    *        any statements as slow.  Normally called once at start-up, from \c Database::load(), with the value from
+    *        \c PersistentSettings.
+    */
+   static void setSlowQueryThreshold_ms(int const threshold_ms);
+
+   /**
+    * \brief Human-readable table (plain text, one line per statement shape, slowest total time first) of the
+    *        statistics we have gathered since the program started: number of executions, total/mean/p50/p99/max
+    *        latency, rows affected, and number of prepares.  Percentiles are approximate (to within about 20%).
+    */
+   static QString statisticsReport();
+
+   /**
+    * \brief Write \c statisticsReport() to the log.  Called when the DB is closed.
+    */
+   static void logStatistics();
+
 private:
    // We need to be careful about names to avoid clashes with anything in the base class
    QString bt_query;
+   QString bt_statementShape;
    bool bt_boundValues = false;
 
    void reallyPrepare();
@@ -42,6 +42,7 @@
 #include <iostream> // For writing to std::cerr in destructor
 #include <mutex>    // For std::once_flag etc
 
+#include <QDataStream>
 #include <QDateTime>
 #include <QDebug>
 #include <QFile>
@@ -62,6 +63,9 @@
 #include "config.h"
 #include "database/BtSqlQuery.h"
 #include "database/DatabaseSchemaHelper.h"
+#include "database/DbWriter.h"
+#include "database/ObjectStoreTyped.h"
+#include "database/SqliteBackup.h"
 #include "PersistentSettings.h"
 #include "utils/BtStringConst.h"
 #include "utils/EnumStringMapping.h"
@@ -259,6 +263,11 @@ public:
          QFile newdb(QString("%1.new").arg(this->dbFileName));
          if (newdb.exists()) {
             this->dbFile.remove();
+            // Any write-ahead log left over from the old DB must not be applied to the restored one.  Conversely, if
+            // the backup came with its own write-ahead log (see restoreFromFile()) then it belongs with the new file.
+            QFile::remove(QString("%1-wal").arg(this->dbFileName));
+            QFile::remove(QString("%1-shm").arg(this->dbFileName));
+            QFile::rename(QString("%1.new-wal").arg(this->dbFileName), QString("%1-wal").arg(this->dbFileName));
             newdb.copy(this->dbFileName);
             QFile::setPermissions(this->dbFileName, QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
             newdb.remove();
@@ -283,6 +292,7 @@ public:
       // It's a coding error if we didn't already establish that SQLite is the type of DB we're talking to, so assert
       // that and then call the generic code to get a connection
       Q_ASSERT(this->dbType == Database::DbType::SQLITE);
+      this->readSqlitePerformanceProfile();
       QSqlDatabase connection = database.sqlDatabase();
 
       this->dbConName = connection.connectionName();
@@ -302,32 +312,179 @@ public:
       QVariant fieldValue = sqlQuery.value("version");
       qInfo() << Q_FUNC_INFO << "SQLite version" << fieldValue;
 
-      // NOTE: synchronous=off reduces query time by an order of magnitude!
+      // NB: Connection-level settings (synchronous, foreign_keys, journal_mode etc) are applied in
+      //     applySqlitePerformanceProfile(), which Database::sqlDatabase() calls for every connection it opens.
+
+      // older sqlite databases may not have a settings table. I think I will
+      // just check to see if anything is in there.
+      this->createFromScratch = connection.tables().size() == 0;
+
+      return true;
+   }
+
+   /**
+    * \brief Read the SQLite performance profile from the sqlite section of PersistentSettings (writing the defaults
+    *        there the first time round so it's easy to find and tweak).
+    *
+    *        The defaults are WAL journalling with synchronous=NORMAL, which is durable against application crashes
+    *        and makes each of the many small transactions we do (see \c DbTransaction) a single append to the log
+    *        rather than a rewrite of the rollback journal.  Because WAL allows readers to run alongside the writer,
+    *        the default locking mode is NORMAL rather than the EXCLUSIVE we used with the rollback journal.
+    *
+    *        We read the settings once here, on the main thread, rather than each time a connection is opened, as
+    *        connections can also be opened on worker threads.
+    */
+   void readSqlitePerformanceProfile() {
+      this->sqliteLockingMode = sqlitePragmaSetting(PersistentSettings::Names::locking_mode,
+                                                    "NORMAL",
+                                                    {"NORMAL", "EXCLUSIVE"});
+      this->sqliteJournalMode = sqlitePragmaSetting(PersistentSettings::Names::journal_mode,
+                                                    "WAL",
+                                                    {"DELETE", "TRUNCATE", "PERSIST", "MEMORY", "WAL", "OFF"});
+      this->sqliteSynchronous = sqlitePragmaSetting(PersistentSettings::Names::synchronous,
+                                                    "NORMAL",
+                                                    {"OFF", "NORMAL", "FULL", "EXTRA"});
+      this->sqliteTempStore   = sqlitePragmaSetting(PersistentSettings::Names::temp_store,
+                                                    "MEMORY",
+                                                    {"DEFAULT", "FILE", "MEMORY"});
+      // Default to mapping up to 256 MiB of the DB file, which in practice means all of it
+      this->sqliteMmapSize    = sqlitePragmaSetting(PersistentSettings::Names::mmap_size, 256 * 1024 * 1024);
+      // Per the SQLite docs, a negative cache size is in KiB rather than pages, so the default is 64 MiB
+      this->sqliteCacheSize   = sqlitePragmaSetting(PersistentSettings::Names::cache_size, -64 * 1024);
+      qInfo() <<
+         Q_FUNC_INFO << "SQLite profile: locking_mode =" << this->sqliteLockingMode << ", journal_mode =" <<
+         this->sqliteJournalMode << ", synchronous =" << this->sqliteSynchronous << ", temp_store =" <<
+         this->sqliteTempStore << ", mmap_size =" << this->sqliteMmapSize << ", cache_size =" << this->sqliteCacheSize;
+      return;
+   }
+
+   /**
+    * \brief Apply the SQLite performance profile to a newly-opened connection.
+    *
+    *        With the exception of journal_mode, which SQLite records in the DB file itself, these are all
+    *        per-connection settings, so they have to be applied to every connection we open, including the ones on
+    *        worker threads, rather than just once in loadSQLite().
+    *
+    * \return \c false if we could not enable foreign keys (which we regard as fatal), \c true otherwise.  Failure to
+    *         apply any of the performance settings is logged but otherwise ignored, as the DB still works correctly
+    *         without them.
+    */
+   bool applySqlitePerformanceProfile(QSqlDatabase & connection) const {
       BtSqlQuery pragma(connection);
-      if ( ! pragma.exec( "PRAGMA synchronous = off" ) ) {
-         qCritical() << Q_FUNC_INFO << "Could not disable synchronous writes: " << pragma.lastError().text();
-         return false;
-      }
-      if ( ! pragma.exec( "PRAGMA foreign_keys = on")) {
+      if (!pragma.exec("PRAGMA foreign_keys = on")) {
          qCritical() << Q_FUNC_INFO << "Could not enable foreign keys: " << pragma.lastError().text();
          return false;
       }
-      if ( ! pragma.exec( "PRAGMA locking_mode = EXCLUSIVE")) {
-         qCritical() << Q_FUNC_INFO << "Could not enable exclusive locks: " << pragma.lastError().text();
-         return false;
+
+      // Locking mode needs to be set before journal mode, as it determines whether WAL uses shared memory
+      if (!pragma.exec(QString("PRAGMA locking_mode = %1").arg(this->sqliteLockingMode))) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set locking mode" << this->sqliteLockingMode << ": " <<
+            pragma.lastError().text();
       }
-      if ( ! pragma.exec("PRAGMA temp_store = MEMORY") ) {
-         qCritical() << Q_FUNC_INFO << "Could not enable temporary memory: " << pragma.lastError().text();
-         return false;
+
+      // Setting journal_mode returns the mode actually in effect, which is not necessarily the one we asked for (eg
+      // WAL is not available for in-memory DBs)
+      if (!pragma.exec(QString("PRAGMA journal_mode = %1").arg(this->sqliteJournalMode)) || !pragma.next()) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set journal mode" << this->sqliteJournalMode << ": " <<
+            pragma.lastError().text();
+      } else {
+         qDebug() <<
+            Q_FUNC_INFO << "Connection" << connection.connectionName() << "journal mode" << pragma.value(0).toString();
       }
 
-      // older sqlite databases may not have a settings table. I think I will
-      // just check to see if anything is in there.
-      this->createFromScratch = connection.tables().size() == 0;
+      if (!pragma.exec(QString("PRAGMA synchronous = %1").arg(this->sqliteSynchronous))) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set synchronous" << this->sqliteSynchronous << ": " << pragma.lastError().text();
+      }
+      if (!pragma.exec(QString("PRAGMA temp_store = %1").arg(this->sqliteTempStore))) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set temp store" << this->sqliteTempStore << ": " << pragma.lastError().text();
+      }
+      if (!pragma.exec(QString("PRAGMA mmap_size = %1").arg(this->sqliteMmapSize))) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set mmap size" << this->sqliteMmapSize << ": " << pragma.lastError().text();
+      }
+      if (!pragma.exec(QString("PRAGMA cache_size = %1").arg(this->sqliteCacheSize))) {
+         qWarning() <<
+            Q_FUNC_INFO << "Could not set cache size" << this->sqliteCacheSize << ": " << pragma.lastError().text();
+      }
 
       return true;
    }
 
+   /**
+    * \brief Read one of the string-valued settings of the SQLite performance profile, falling back to
+    *        \c defaultValue (with a warning) if what's stored is not one of \c allowedValues.  (Besides catching
+    *        typos, this stops anything odd from being spliced into the PRAGMA statement.)
+    */
+   static QString sqlitePragmaSetting(BtStringConst const & name,
+                                      QString const & defaultValue,
+                                      QStringList const & allowedValues) {
+      if (!PersistentSettings::contains(name, PersistentSettings::Sections::sqlite)) {
+         PersistentSettings::insert(name, defaultValue, PersistentSettings::Sections::sqlite);
+         return defaultValue;
+      }
+      QString const value =
+         PersistentSettings::value(name, defaultValue, PersistentSettings::Sections::sqlite).toString().toUpper();
+      if (!allowedValues.contains(value)) {
+         qWarning() <<
+            Q_FUNC_INFO << "Ignoring invalid value" << value << "for SQLite setting" << name << "- using" <<
+            defaultValue;
+         return defaultValue;
+      }
+      return value;
+   }
+
+   /**
+    * \brief Read one of the numeric settings of the SQLite performance profile
+    */
+   static qint64 sqlitePragmaSetting(BtStringConst const & name, qint64 const defaultValue) {
+      if (!PersistentSettings::contains(name, PersistentSettings::Sections::sqlite)) {
+         PersistentSettings::insert(name, defaultValue, PersistentSettings::Sections::sqlite);
+         return defaultValue;
+      }
+      bool ok = false;
+      qint64 const value =
+         PersistentSettings::value(name, defaultValue, PersistentSettings::Sections::sqlite).toLongLong(&ok);
+      if (!ok) {
+         qWarning() <<
+            Q_FUNC_INFO << "Ignoring invalid value for SQLite setting" << name << "- using" << defaultValue;
+         return defaultValue;
+      }
+      return value;
+   }
+
+   /**
+    * \brief In WAL mode, recently committed changes can be in the -wal file rather than the main DB file.  Before we
+    *        copy the main DB file anywhere, we therefore need to copy everything from the log back into it.  (We use
+    *        TRUNCATE mode so the log is also emptied, which avoids it growing without bound over a long session.)
+    *
+    *        This is a no-op if we're not using SQLite or we don't (any longer) have a connection open on this thread.
+    *        In the latter case, SQLite will have checkpointed the log when the last connection was closed.
+    */
+   void checkpointWriteAheadLog() const {
+      if (this->dbType != Database::DbType::SQLITE || !QSqlDatabase::contains(this->dbConName)) {
+         return;
+      }
+      QSqlDatabase connection = QSqlDatabase::database(this->dbConName, false);
+      if (!connection.isOpen()) {
+         return;
+      }
+      BtSqlQuery sqlQuery(connection);
+      if (!sqlQuery.exec("PRAGMA wal_checkpoint(TRUNCATE)")) {
+         qWarning() << Q_FUNC_INFO << "Could not checkpoint write-ahead log: " << sqlQuery.lastError().text();
+         return;
+      }
+      // The first column of the result is 1 if the checkpoint could not complete because something else had the DB
+      // locked.  (In other journal modes, the PRAGMA is harmless and this will be 0.)
+      if (sqlQuery.next() && sqlQuery.value(0).toInt() != 0) {
+         qWarning() << Q_FUNC_INFO << "Write-ahead log checkpoint did not complete as DB is busy";
+      }
+      return;
+   }
+
    bool loadPgSQL(Database & database) {
 
       this->dbHostname = PersistentSettings::value(PersistentSettings::Names::dbHostname).toString();
@@ -414,6 +571,18 @@ public:
       return doUpdate;
    }
 
+   /**
+    * \brief Whether we can copy the DB with \c SqliteBackup, which needs its own connection to the DB file.  This is
+    *        not possible if we're using SQLite in exclusive locking mode and our own connection is still open, or if
+    *        the Qt SQLite driver doesn't use the same SQLite library as we do (see \c SqliteBackup).
+    */
+   bool canBackupOnline() const {
+      if (this->dbType != Database::DbType::SQLITE || !SqliteBackup::driverUsesLinkedSqlite()) {
+         return false;
+      }
+      return this->sqliteLockingMode != "EXCLUSIVE" || !QSqlDatabase::contains(this->dbConName);
+   }
+
    void automaticBackup(Database & database) {
       int count = PersistentSettings::value(PersistentSettings::Names::count, 0, PersistentSettings::Sections::backups).toInt() + 1;
       int frequency = PersistentSettings::value(PersistentSettings::Names::frequency, 4, PersistentSettings::Sections::backups).toInt();
@@ -441,7 +610,9 @@ public:
       QStringList fileNames = listOfFiles.split(",", Qt::SkipEmptyParts);
 #endif
 
-      QString halfName = QString("%1.%2").arg("databaseBackup").arg(QDate::currentDate().toString("yyyyMMdd"));
+      // Including the time means we keep more than one backup per day if Brewtarget is run several times that day
+      QString halfName =
+         QString("%1.%2").arg("databaseBackup").arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
       QString newName = halfName;
       // Unique filenames are a pain in the ass. In the case you open Brewtarget
       // twice in a day, this loop makes sure we don't over write (or delete) the
@@ -513,12 +684,22 @@ public:
 
    bool userDatabaseDidNotExist;
 
+   // Does the DB writes for the object stores -- see DbWriter
+   std::unique_ptr<DbWriter> writer;
+
 
    // These are for SQLite databases
    QFile dbFile;
    QString dbFileName;
    QFile dataDbFile;
    QString dataDbFileName;
+   // SQLite performance profile -- see readSqlitePerformanceProfile()
+   QString sqliteLockingMode = "NORMAL";
+   QString sqliteJournalMode = "WAL";
+   QString sqliteSynchronous = "NORMAL";
+   QString sqliteTempStore   = "MEMORY";
+   qint64  sqliteMmapSize    = 0;
+   qint64  sqliteCacheSize   = -2000;
 
    // And these are for Postgres databases
    QString dbHostname;
@@ -531,6 +712,7 @@ public:
 
 
 Database::Database(Database::DbType dbType) : pimpl{std::make_unique<impl>(dbType)} {
+   this->pimpl->writer = std::make_unique<DbWriter>(*this);
    return;
 }
 
@@ -615,7 +797,8 @@ QSqlDatabase Database::sqlDatabase() const {
       }
       qCritical() << Q_FUNC_INFO << errorMessage;
 
-      if (Application::isInteractive()) {
+      // We can only show a message box from the GUI thread -- eg not from the DB writer thread
+      if (Application::isInteractive() && QThread::currentThread() == QCoreApplication::instance()->thread()) {
          QMessageBox::critical(nullptr,
                                QObject::tr("Database Failure"),
                                errorMessage);
@@ -625,9 +808,68 @@ QSqlDatabase Database::sqlDatabase() const {
       throw errorMessage;
    }
 
+   if (this->pimpl->dbType == Database::DbType::SQLITE && !this->pimpl->applySqlitePerformanceProfile(connection)) {
+      QString errorMessage{
+         QObject::tr("Could not configure SQLite DB file %1.\n%2")
+      };
+      errorMessage = errorMessage.arg(this->pimpl->dbFileName).arg(connection.lastError().text());
+      qCritical() << Q_FUNC_INFO << errorMessage;
+      throw errorMessage;
+   }
+
    return connection;
 }
 
+void Database::closeConnectionForThisThread() {
+   QString const connectionName = dbConnectionNamesForThisThread.value(this->pimpl->dbType);
+   if (!QSqlDatabase::contains(connectionName)) {
+      return;
+   }
+   qDebug() << Q_FUNC_INFO << "Closing connection" << connectionName;
+
+   // Any statements we prepared on this connection have to go before the connection does
+   ClearAllObjectStoreStatementCaches(connectionName);
+   {
+      // Per the comment on sqlDatabase() in the header, the QSqlDatabase object has to be gone before removeDatabase()
+      QSqlDatabase connection = QSqlDatabase::database(connectionName, false);
+      connection.close();
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+   return;
+}
+
+DbWriter & Database::writer() const {
+   return *this->pimpl->writer;
+}
+
+QString Database::snapshotFileName() const {
+   if (this->pimpl->dbType != Database::DbType::SQLITE ||
+       !PersistentSettings::value(PersistentSettings::Names::useObjectStoreSnapshot, true).toBool()) {
+      return QString{};
+   }
+   return QString{"%1.snapshot"}.arg(this->pimpl->dbFileName);
+}
+
+QByteArray Database::fileStamp() const {
+   QByteArray stamp;
+   QDataStream stampStream{&stamp, QIODevice::WriteOnly};
+   QFileInfo const dbFileInfo{this->pimpl->dbFileName};
+   stampStream << this->pimpl->dbFileName << dbFileInfo.size() << dbFileInfo.lastModified().toMSecsSinceEpoch();
+
+   //
+   // In WAL mode, the write-ahead log is checkpointed into the DB file and deleted when the last connection closes
+   // (which is when we write the snapshot), but it is created again, empty, as soon as the next connection is opened
+   // (which is before we read the snapshot).  An empty log is therefore the same as no log.  A non-empty one means
+   // there are writes that haven't made it to the DB file (eg because we crashed, or because something has been
+   // written since the DB was opened), so it has to be part of the stamp.
+   //
+   QFileInfo const walFileInfo{QString{"%1-wal"}.arg(this->pimpl->dbFileName)};
+   if (walFileInfo.exists() && walFileInfo.size() > 0) {
+      stampStream << walFileInfo.filePath() << walFileInfo.size() << walFileInfo.lastModified().toMSecsSinceEpoch();
+   }
+   return stamp;
+}
+
 bool Database::load() {
    this->pimpl->createFromScratch = false;
    this->pimpl->schemaUpdated = false;
@@ -637,6 +879,18 @@ bool Database::load() {
    // diagnostic to help resolve that.
    qInfo() << Q_FUNC_INFO << "Known DB drivers: " << QSqlDatabase::drivers();
 
+   //
+   // Queries get run on the DB writer thread as well as this one, so we read the slow query threshold here, once,
+   // rather than have BtSqlQuery look in PersistentSettings.  We write the default back so that users can find the
+   // setting if they want to change it.
+   //
+   if (!PersistentSettings::contains(PersistentSettings::Names::slowQueryThreshold_ms)) {
+      PersistentSettings::insert(PersistentSettings::Names::slowQueryThreshold_ms, 100);
+   }
+   BtSqlQuery::setSlowQueryThreshold_ms(
+      PersistentSettings::value(PersistentSettings::Names::slowQueryThreshold_ms, 100).toInt()
+   );
+
    bool dbIsOpen;
    if (this->dbType() == Database::DbType::PGSQL ) {
       dbIsOpen = this->pimpl->loadPgSQL(*this);
@@ -677,6 +931,18 @@ bool Database::load() {
    }
 
    this->pimpl->loadWasSuccessful = true;
+
+   //
+   // From now on, object store writes can happen on their own thread.  The exception is if we're using SQLite in
+   // exclusive locking mode, as then the main thread's connection holds onto the lock and no other connection would be
+   // able to write.
+   //
+   if (this->pimpl->dbType == Database::DbType::SQLITE && this->pimpl->sqliteLockingMode == "EXCLUSIVE") {
+      qInfo() << Q_FUNC_INFO << "Not using DB writer thread as SQLite is in exclusive locking mode";
+   } else {
+      this->pimpl->writer->start();
+   }
+
    return this->pimpl->loadWasSuccessful;
 }
 
@@ -776,6 +1042,18 @@ void Database::unload() {
       return;
    }
 
+   //
+   // Write out anything the object stores have queued up.  This needs to happen before we take the mutex below, as
+   // writing to the DB means getting a connection, which also takes the mutex.
+   //
+   bool const flushedObjectStores = FlushAllObjectStores();
+
+   // Now there's nothing left for the writer thread to do, we can stop it, which also closes its connection
+   this->pimpl->writer->stop();
+
+   // All the queries we're going to run have been run, so this is a good point to log how long they took
+   BtSqlQuery::logStatistics();
+
    // This RAII wrapper does all the hard work on mutex.lock() and mutex.unlock() in an exception-safe way
    QMutexLocker locker(&this->pimpl->mutex);
 
@@ -787,6 +1065,8 @@ void Database::unload() {
    for (QString conName : allConnectionNames) {
       if (0 == conName.indexOf(ourConnectionPrefix)) {
          qDebug() << Q_FUNC_INFO << "Closing connection " << conName;
+         // Any statements the object stores have prepared on this connection need to be gone before we remove it
+         ClearAllObjectStoreStatementCaches(conName);
          {
             //
             // Extra braces here are to ensure that this QSqlDatabase object is out of scope before the call to
@@ -809,6 +1089,16 @@ void Database::unload() {
 
    if (this->pimpl->loadWasSuccessful && this->dbType() == Database::DbType::SQLITE ) {
       this->pimpl->dbFile.close();
+
+      //
+      // Now that nothing else will be written to the DB file, we can take a snapshot of the object stores for next
+      // time.  We only do this for the database the object stores were loaded from (ie not, say, the target of a
+      // conversion to a different DB type) and only if everything in memory made it to the DB.
+      //
+      if (this->pimpl->dbType == currentDbType && flushedObjectStores) {
+         WriteObjectStoreSnapshot(*this);
+      }
+
       this->pimpl->automaticBackup(*this);
    }
 
@@ -867,17 +1157,43 @@ char const * Database::getDefaultBackupFileName() {
 }
 
 bool Database::backupToFile(QString newDbFileName) {
-   // Remove the files if they already exist so that
-   // the copy() operation will succeed.
-   QFile::remove(newDbFileName);
+   // Make sure the backup includes any changes that are still queued up in the object stores
+   FlushAllObjectStores();
+
+   bool success;
+   if (this->pimpl->canBackupOnline()) {
+      // The backup API gives us a consistent copy even if something writes to the DB while we're copying it
+      SqliteBackup backup{this->pimpl->dbFile.fileName(), newDbFileName};
+      success = backup.backupNow();
+   } else {
+      // Make sure none of the changes are sitting in the write-ahead log rather than the DB file itself
+      this->pimpl->checkpointWriteAheadLog();
+
+      // Remove the files if they already exist so that
+      // the copy() operation will succeed.
+      QFile::remove(newDbFileName);
 
-   bool success = this->pimpl->dbFile.copy(newDbFileName);
+      success = this->pimpl->dbFile.copy(newDbFileName);
+   }
 
    qDebug() << QString("Database backup to \"%1\" %2").arg(newDbFileName, success ? "succeeded" : "failed");
 
    return success;
 }
 
+SqliteBackup * Database::startBackupToFile(QString const & newDbFileName, QObject * parent) {
+   if (!this->pimpl->canBackupOnline()) {
+      return nullptr;
+   }
+
+   // As in backupToFile(), we want the backup to include anything still queued up in the object stores
+   FlushAllObjectStores();
+
+   auto backup = new SqliteBackup{this->pimpl->dbFile.fileName(), newDbFileName, 256, parent};
+   backup->start();
+   return backup;
+}
+
 bool Database::backupToDir(QString dir, QString filename) {
    QString prefix = dir + "/";
    QString newDbFileName = prefix + getDefaultBackupFileName();
@@ -896,7 +1212,19 @@ bool Database::restoreFromFile(QString newDbFileStr) {
       return false;
    }
 
-   bool success = newDbFile.copy(QString("%1.new").arg(this->pimpl->dbFile.fileName()));
+   QString const stagedDbFileName = QString("%1.new").arg(this->pimpl->dbFile.fileName());
+   QFile::remove(stagedDbFileName);
+   bool success = newDbFile.copy(stagedDbFileName);
+
+   // If the file we're restoring from was itself in WAL mode and not cleanly closed, its latest changes will be in
+   // the accompanying -wal file, so that needs to come too.  (It gets moved into place, along with the DB file, in
+   // loadSQLite() next time we start up.)
+   QString const stagedWalFileName = QString("%1-wal").arg(stagedDbFileName);
+   QFile::remove(stagedWalFileName);
+   QFile newDbWalFile(QString("%1-wal").arg(newDbFileStr));
+   if (success && newDbWalFile.exists()) {
+      success = newDbWalFile.copy(stagedWalFileName);
+   }
    QFile::setPermissions( newDbFile.fileName(), QFile::ReadOwner | QFile::WriteOwner | QFile::ReadGroup );
 
    return success;
@@ -960,7 +1288,8 @@ bool Database::verifyDbConnection(Database::DbType testDb,
 
 void Database::convertDatabase(QString const& Hostname, QString const& DbName,
                                QString const& Username, QString const& Password,
-                               int Portnum, Database::DbType newType) {
+                               int Portnum, Database::DbType newType,
+                               Database::CopyProgress const & progress) {
    QSqlDatabase connectionNew;
 
    try {
@@ -985,7 +1314,7 @@ void Database::convertDatabase(QString const& Hostname, QString const& DbName,
       // Don't get newDatabase via Database::instance() as we don't want to use the connection details from
       // PersistentSettings (or to attempt to read data from newDatabase)
       Database newDatabase{newType};
-      DatabaseSchemaHelper::copyToNewDatabase(newDatabase, connectionNew);
+      DatabaseSchemaHelper::copyToNewDatabase(newDatabase, connectionNew, progress);
    }
    catch (QString e) {
       qCritical() << QString("%1 %2").arg(Q_FUNC_INFO).arg(e);
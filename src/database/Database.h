@@ -32,6 +32,7 @@
 #define DATABASE_H
 #pragma once
 
+#include <functional>
 #include <memory> // For PImpl
 
 #include <QCoreApplication>
@@ -40,6 +41,9 @@
 #include <QString>
 
 class BtStringConst;
+class DbWriter;
+class QObject;
+class SqliteBackup;
 
 /*!
  * \class Database
@@ -62,6 +66,12 @@ public:
       ALLDB      // Keep this one the last one, or bad things will happen
    };
 
+   /**
+    * \brief Called periodically by \c convertDatabase() with the table currently being copied and the number of
+    *        objects copied so far and in total (across all tables), eg to update a progress dialog
+    */
+   using CopyProgress = std::function<void(QString const & tableName, int objectsCopied, int objectsTotal)>;
+
    /*!
     * \brief This should be the ONLY way you get an instance.
     *
@@ -103,9 +113,37 @@ public:
     */
    QSqlDatabase sqlDatabase() const;
 
+   /**
+    * \brief Close and remove this thread's connection to the database, if it has one.  Should be called by worker
+    *        threads (eg in a thread pool) that have used \c sqlDatabase() before they finish their work.  Caller must
+    *        ensure they are no longer holding any \c QSqlDatabase or \c QSqlQuery objects for the connection.
+    */
+   void closeConnectionForThisThread();
+
+   /**
+    * \brief The thread on which object stores do their DB writes -- see \c DbWriter.  This is started at the end of a
+    *        successful \c load() and stopped by \c unload().
+    */
+   DbWriter & writer() const;
+
    //! \brief Should be called when we are about to close down.
    void unload();
 
+   /**
+    * \brief Name of the file, next to the database file, in which we keep a snapshot of all the object stores for
+    *        quicker start-up (see \c WriteObjectStoreSnapshot()).  Returns an empty string if we are not using a
+    *        snapshot for this database, eg because it is PostgreSQL or the user has turned snapshots off.
+    */
+   QString snapshotFileName() const;
+
+   /**
+    * \brief Returns something that changes whenever the database file is written to (currently the size and
+    *        modification time of the file and, if it is not empty, of the SQLite write-ahead log).  This is how we tell
+    *        whether a snapshot is still valid, so it needs to give the same answer with the DB closed (when the
+    *        snapshot is written) as with it freshly opened (when the snapshot is read).
+    */
+   QByteArray fileStamp() const;
+
    //! \brief Create a blank database in the given file
    bool createBlank(QString const& filename);
 
@@ -123,6 +161,16 @@ public:
    //! backs up database to chosen file
    bool backupToFile(QString newDbFileName);
 
+   /**
+    * \brief Start backing up the database to the chosen file on a background thread (see \c SqliteBackup), so that
+    *        the caller does not have to wait.  Caller owns the returned object (or can give it a parent) and can
+    *        connect to its \c QThread::finished signal to find out how it went.
+    *
+    * \return \c nullptr if the DB cannot be backed up in the background (eg because it's not SQLite or it's in
+    *         exclusive locking mode), in which case the caller should use \c backupToFile() instead.
+    */
+   SqliteBackup * startBackupToFile(QString const & newDbFileName, QObject * parent = nullptr);
+
    //! backs up database to 'dir' in chosen directory
    bool backupToDir(QString dir, QString filename="");
 
@@ -142,7 +190,8 @@ public:
    //   needs opens and then calls the appropriate workhorse to get it done.
    void convertDatabase(QString const& Hostname, QString const& DbName,
                         QString const& Username, QString const& Password,
-                        int Portnum, Database::DbType newType);
+                        int Portnum, Database::DbType newType,
+                        Database::CopyProgress const & progress = nullptr);
 
    /*!
     * \brief If we are supporting multiple databases, we need some way to
@@ -26,6 +26,7 @@
 
 #include <QDebug>
 #include <QMessageBox>
+#include <QPair>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
@@ -43,7 +44,7 @@
 #include "model/Water.h"
 #include "xml/BeerXml.h"
 
-int const DatabaseSchemaHelper::dbVersion = 10;
+int const DatabaseSchemaHelper::dbVersion = 12;
 
 namespace {
    char const * const FOLDER_FOR_SUPPLIED_RECIPES = "brewtarget";
@@ -530,6 +531,75 @@ namespace {
       return executeSqlQueries(q, migrationQueries);
    }
 
+   //
+   // Add an index on every foreign key column.  Without these, eg, deleting the rows for one Recipe from a junction table
+   // means scanning the whole table.  New databases get the same indexes (with the same names) from
+   // ObjectStore::addTableConstraints().
+   //
+   bool migrate_to_11([[maybe_unused]] Database & db, BtSqlQuery q) {
+      QVector<QPair<char const *, char const *> > const foreignKeyColumns{
+         {"brewnote",              "recipe_id"     },
+         {"equipment_children",    "child_id"      },
+         {"equipment_children",    "parent_id"     },
+         {"fermentable",           "inventory_id"  },
+         {"fermentable_children",  "child_id"      },
+         {"fermentable_children",  "parent_id"     },
+         {"fermentable_in_recipe", "recipe_id"     },
+         {"fermentable_in_recipe", "fermentable_id"},
+         {"hop",                   "inventory_id"  },
+         {"hop_children",          "child_id"      },
+         {"hop_children",          "parent_id"     },
+         {"hop_in_recipe",         "recipe_id"     },
+         {"hop_in_recipe",         "hop_id"        },
+         {"instruction_in_recipe", "recipe_id"     },
+         {"instruction_in_recipe", "instruction_id"},
+         {"mashstep",              "mash_id"       },
+         {"misc",                  "inventory_id"  },
+         {"misc_children",         "child_id"      },
+         {"misc_children",         "parent_id"     },
+         {"misc_in_recipe",        "recipe_id"     },
+         {"misc_in_recipe",        "misc_id"       },
+         {"recipe",                "equipment_id"  },
+         {"recipe",                "mash_id"       },
+         {"recipe",                "style_id"      },
+         {"recipe",                "ancestor_id"   },
+         {"salt_in_recipe",        "recipe_id"     },
+         {"salt_in_recipe",        "salt_id"       },
+         {"style_children",        "child_id"      },
+         {"style_children",        "parent_id"     },
+         {"water_children",        "child_id"      },
+         {"water_children",        "parent_id"     },
+         {"water_in_recipe",       "recipe_id"     },
+         {"water_in_recipe",       "water_id"      },
+         {"yeast",                 "inventory_id"  },
+         {"yeast_children",        "child_id"      },
+         {"yeast_children",        "parent_id"     },
+         {"yeast_in_recipe",       "recipe_id"     },
+         {"yeast_in_recipe",       "yeast_id"      }
+      };
+      QVector<QueryAndParameters> migrationQueries;
+      for (auto const & foreignKeyColumn : foreignKeyColumns) {
+         migrationQueries.append(
+            {QString("CREATE INDEX IF NOT EXISTS idx_%1_%2 ON %1 (%2)").arg(foreignKeyColumn.first,
+                                                                            foreignKeyColumn.second)}
+         );
+      }
+      return executeSqlQueries(q, migrationQueries);
+   }
+
+   //
+   // Store a copy of each Recipe's calculated values, along with a fingerprint of the inputs they were calculated from,
+   // so that we don't have to recalculate every Recipe at start-up.  Existing Recipes start off with nothing stored, so
+   // they'll get recalculated (and their results stored) the first time round.
+   //
+   bool migrate_to_12(Database & db, BtSqlQuery q) {
+      QVector<QueryAndParameters> const migrationQueries{
+         {QString("ALTER TABLE recipe ADD COLUMN calc_fingerprint %1").arg(db.getDbNativeTypeName<QString>())},
+         {QString("ALTER TABLE recipe ADD COLUMN calc_results     %1").arg(db.getDbNativeTypeName<QString>())}
+      };
+      return executeSqlQueries(q, migrationQueries);
+   }
+
    /*!
     * \brief Migrate from version \c oldVersion to \c oldVersion+1
     */
@@ -567,6 +637,12 @@ namespace {
          case 9:
             ret &= migrate_to_10(database, sqlQuery);
             break;
+         case 10:
+            ret &= migrate_to_11(database, sqlQuery);
+            break;
+         case 11:
+            ret &= migrate_to_12(database, sqlQuery);
+            break;
          default:
             qCritical() << QString("Unknown version %1").arg(oldVersion);
             return false;
@@ -707,7 +783,9 @@ int DatabaseSchemaHelper::currentVersion(QSqlDatabase db) {
    return -1;
 }
 
-bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabase & connectionNew) {
+bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase,
+                                             QSqlDatabase & connectionNew,
+                                             Database::CopyProgress const & progress) {
 
    // this is to prevent us from over-writing or doing heavens knows what to an existing db
    if (connectionNew.tables().contains(QLatin1String("settings"))) {
@@ -722,7 +800,7 @@ bool DatabaseSchemaHelper::copyToNewDatabase(Database & newDatabase, QSqlDatabas
       return false;
    }
 
-   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew)) {
+   if (!WriteAllObjectStoresToNewDb(newDatabase, connectionNew, progress)) {
       qCritical() << Q_FUNC_INFO << "Error writing data to new DB";
       return false;
    }
@@ -19,52 +19,167 @@
 #include "database/DbTransaction.h"
 
 #include <QDebug>
+#include <QHash>
 #include <QSqlError>
 
+#include "database/BtSqlQuery.h"
 #include "database/Database.h"
 
+namespace {
+   //
+   // How many DbTransaction objects are currently open on each connection.  Connections are per-thread (see
+   // Database::sqlDatabase()) so this can be too, which saves us from needing a mutex.
+   //
+   thread_local QHash<QString, int> openTransactionsByConnection;
+
+   /**
+    * \brief Run one of the savepoint statements, which are the same on SQLite and PostgreSQL
+    */
+   bool execSavepointStatement(QSqlDatabase & connection, QString const & sql) {
+      BtSqlQuery sqlQuery{connection};
+      bool const succeeded = sqlQuery.exec(sql);
+      qDebug() << Q_FUNC_INFO << sql << (succeeded ? "succeeded" : "failed");
+      if (!succeeded) {
+         qCritical() << Q_FUNC_INFO << "Error executing" << sql << ":" << sqlQuery.lastError().text();
+      }
+      return succeeded;
+   }
+}
 
 DbTransaction::DbTransaction(Database & database, QSqlDatabase & connection, DbTransaction::SpecialBehaviours specialBehaviours) :
    database{database},
    connection{connection},
-   committed{false},
-   specialBehaviours{specialBehaviours} {
-   // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have to
-   // be careful about the order in which we do things.
-   if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
-      this->database.setForeignKeysEnabled(false, connection);
+   beginSucceeded{false},
+   finished{false},
+   specialBehaviours{specialBehaviours},
+   savepointName{} {
+   int const alreadyOpen = openTransactionsByConnection.value(this->connection.connectionName(), 0);
+   if (alreadyOpen > 0) {
+      //
+      // There's already a transaction open on this connection, so we use a savepoint inside it.  The name only needs to
+      // be unique among the savepoints currently open on the connection, so the nesting depth does nicely.
+      //
+      this->savepointName = QString("bt_savepoint_%1").arg(alreadyOpen);
+      if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
+         // Foreign keys can only be turned off outside a transaction, so there's nothing we can do here
+         qWarning() <<
+            Q_FUNC_INFO << "Unable to disable foreign keys inside transaction already open on" <<
+            this->connection.connectionName();
+      }
+      this->beginSucceeded = execSavepointStatement(this->connection,
+                                                    QString("SAVEPOINT %1").arg(this->savepointName));
+   } else {
+      // Note that, on SQLite at least, turning foreign keys on and off has to happen outside a transaction, so we have
+      // to be careful about the order in which we do things.
+      if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
+         this->database.setForeignKeysEnabled(false, connection);
+      }
+
+      this->beginSucceeded = this->connection.transaction();
+      qDebug() <<
+         Q_FUNC_INFO << "Database transaction begin: " << (this->beginSucceeded ? "succeeded" : "failed");
+      if (!this->beginSucceeded) {
+         qCritical() << Q_FUNC_INFO << "Unable to start database transaction:" << connection.lastError().text();
+      }
    }
 
-   bool succeeded = this->connection.transaction();
-   qDebug() << Q_FUNC_INFO << "Database transaction begin: " << (succeeded ? "succeeded" : "failed");
-   if (!succeeded) {
-      qCritical() << Q_FUNC_INFO << "Unable to start database transaction:" << connection.lastError().text();
+   //
+   // We only count ourselves as open if the DB agrees.  Otherwise the next DbTransaction on this connection would try
+   // to create a savepoint in a transaction that doesn't exist (or use the wrong savepoint name).
+   //
+   if (this->beginSucceeded) {
+      ++openTransactionsByConnection[this->connection.connectionName()];
    }
    return;
 }
 
 DbTransaction::~DbTransaction() {
    qDebug() << Q_FUNC_INFO;
-   if (!committed) {
-      bool succeeded = this->connection.rollback();
-      qDebug() << Q_FUNC_INFO << "Database transaction rollback: " << (succeeded ? "succeeded" : "failed");
-      if (!succeeded) {
-         qCritical() << Q_FUNC_INFO << "Unable to rollback database transaction:" << connection.lastError().text();
-      }
+   if (!this->finished) {
+      this->rollBack();
    }
 
-   // See comment above about why we need to do this _after_ the transaction has finished
-   if (this->specialBehaviours & DISABLE_FOREIGN_KEYS) {
+   // See comment in constructor about why we need to do this _after_ the transaction has finished
+   if (this->savepointName.isEmpty() && (this->specialBehaviours & DISABLE_FOREIGN_KEYS)) {
       this->database.setForeignKeysEnabled(true, connection);
    }
    return;
 }
 
 bool DbTransaction::commit() {
-   this->committed = connection.commit();
-   qDebug() << Q_FUNC_INFO << "Database transaction commit: " << (this->committed ? "succeeded" : "failed");
-   if (!this->committed) {
-      qCritical() << Q_FUNC_INFO << "Unable to commit database transaction:" << connection.lastError().text();
+   if (this->finished) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Transaction already finished";
+      Q_ASSERT(false);
+      return false;
+   }
+   if (!this->beginSucceeded) {
+      // Error was logged in the constructor.  There's nothing to commit, but nothing to roll back either.
+      this->finished = true;
+      return false;
    }
-   return this->committed;
+
+   bool committed = false;
+   if (!this->savepointName.isEmpty()) {
+      // Releasing a savepoint merges its changes into the enclosing transaction, which will do the real commit
+      committed = execSavepointStatement(this->connection, QString("RELEASE SAVEPOINT %1").arg(this->savepointName));
+   } else {
+      committed = connection.commit();
+      qDebug() << Q_FUNC_INFO << "Database transaction commit: " << (committed ? "succeeded" : "failed");
+      if (!committed) {
+         qCritical() << Q_FUNC_INFO << "Unable to commit database transaction:" << connection.lastError().text();
+      }
+   }
+
+   // If the commit failed, we are still open, and the destructor (or the caller) will roll back
+   if (committed) {
+      this->finished = true;
+      this->noLongerOpen();
+   }
+   return committed;
+}
+
+bool DbTransaction::rollBack() {
+   if (this->finished) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Transaction already finished";
+      Q_ASSERT(false);
+      return false;
+   }
+   this->finished = true;
+   if (!this->beginSucceeded) {
+      // Error was logged in the constructor.  Nothing to roll back.
+      return false;
+   }
+
+   bool succeeded = false;
+   if (!this->savepointName.isEmpty()) {
+      //
+      // Rolling back to a savepoint undoes everything since it was created, but leaves the savepoint itself open, so
+      // we also need to release it.  This leaves the enclosing transaction as it was before we started.
+      //
+      succeeded =
+         execSavepointStatement(this->connection, QString("ROLLBACK TO SAVEPOINT %1").arg(this->savepointName)) &&
+         execSavepointStatement(this->connection, QString("RELEASE SAVEPOINT %1").arg(this->savepointName));
+   } else {
+      succeeded = this->connection.rollback();
+      qDebug() << Q_FUNC_INFO << "Database transaction rollback: " << (succeeded ? "succeeded" : "failed");
+      if (!succeeded) {
+         qCritical() << Q_FUNC_INFO << "Unable to rollback database transaction:" << connection.lastError().text();
+      }
+   }
+   this->noLongerOpen();
+   return succeeded;
+}
+
+bool DbTransaction::begun() const {
+   return this->beginSucceeded;
+}
+
+void DbTransaction::noLongerOpen() {
+   QString const connectionName = this->connection.connectionName();
+   if (--openTransactionsByConnection[connectionName] <= 0) {
+      openTransactionsByConnection.remove(connectionName);
+   }
+   return;
 }
@@ -21,11 +21,19 @@
 #pragma once
 
 #include <QSqlDatabase>
+#include <QString>
 
 class Database;
 
 /**
  * \brief RAII wrapper for transaction(), commit(), rollback() member functions of QSqlDatabase
+ *
+ *        \c DbTransaction objects can be nested.  If one is created while another is already open on the same
+ *        connection (eg because an object is being inserted during a \c BulkImportSession) then, rather than starting a
+ *        new transaction, it creates a savepoint in the enclosing one.  Committing the inner \c DbTransaction releases
+ *        the savepoint, and rolling it back undoes only the inner changes.  Either way, nothing is written to disk
+ *        until the outermost \c DbTransaction is committed.  Nested \c DbTransaction objects must be destroyed in the
+ *        reverse order to that in which they were created (which RAII will normally take care of).
  */
 class DbTransaction {
 public:
@@ -46,18 +54,43 @@ public:
    ~DbTransaction();
 
    /**
-    * \brief Commits the transaction started in the constructor
+    * \brief Commits the transaction started in the constructor (or, if nested, releases the savepoint so that the
+    *        changes become part of the enclosing transaction)
     *
     * \returns \c true if the commit succeeded, \c false otherwise
     */
    bool commit();
 
+   /**
+    * \brief Roll back the transaction started in the constructor (or, if nested, everything since the savepoint was
+    *        created) now, rather than waiting for the destructor to do it
+    *
+    * \returns \c true if the rollback succeeded, \c false otherwise
+    */
+   bool rollBack();
+
+   /**
+    * \brief Whether the transaction (or savepoint) was successfully started in the constructor.  If not, \c commit()
+    *        will fail, and there is nothing to roll back.
+    */
+   bool begun() const;
+
 private:
    Database & database;
    // This is intended to be a short-lived object, so it's OK to store a reference to a QSqlDatabase object
    QSqlDatabase & connection;
-   bool committed;
+   bool beginSucceeded;
+   // Set once we have either committed or rolled back, so the destructor knows there's nothing left to do
+   bool finished;
    int specialBehaviours;
+   // If there was already a transaction open on the connection when we were constructed, the name of the savepoint we
+   // created inside it, otherwise empty
+   QString savepointName;
+
+   /**
+    * \brief Once we've committed or rolled back, we no longer count towards the transactions open on the connection
+    */
+   void noLongerOpen();
 
    // RAII class shouldn't be getting copied or moved
    DbTransaction(DbTransaction const &) = delete;
@@ -0,0 +1,248 @@
+/*
+ * database/DbWriter.cpp is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/DbWriter.h"
+
+#include <atomic>
+#include <exception>
+
+#include <QDebug>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QQueue>
+#include <QThread>
+#include <QWaitCondition>
+
+#include "database/Database.h"
+
+namespace {
+   /**
+    * \brief An operation waiting to be run, plus the promise through which we tell the submitter how it went
+    */
+   struct QueuedOperation {
+      QString description;
+      DbWriter::Operation operation;
+      std::shared_ptr<std::promise<bool> > promise;
+   };
+}
+
+// This private implementation class holds all private non-virtual members of DbWriter
+class DbWriter::impl {
+public:
+
+   /**
+    * \brief We only need to override \c QThread::run(), and can't use \c QThread::create() as it needs Qt 5.10
+    */
+   class WriterThread : public QThread {
+   public:
+      WriterThread(DbWriter::impl & writer) : writer{writer} {
+         return;
+      }
+      virtual ~WriterThread() = default;
+   protected:
+      virtual void run() override {
+         this->writer.runQueue();
+         return;
+      }
+   private:
+      DbWriter::impl & writer;
+   };
+
+   impl(Database & database) : database{database},
+                               thread{*this},
+                               mutex{},
+                               workAvailable{},
+                               becameIdle{},
+                               queue{},
+                               running{false},
+                               stopRequested{false},
+                               busy{false},
+                               failedSinceLastWait{false},
+                               numFailures{0} {
+      return;
+   }
+
+   ~impl() = default;
+
+   /**
+    * \brief Run one operation with this thread's DB connection, and tell the submitter how it went
+    */
+   bool execute(QueuedOperation const & queuedOperation) {
+      bool succeeded = false;
+      try {
+         QSqlDatabase connection = this->database.sqlDatabase();
+         succeeded = queuedOperation.operation(connection);
+      } catch (QString const & errorMessage) {
+         // Database::sqlDatabase() will already have logged the details
+         qCritical() << Q_FUNC_INFO << "Unable to get DB connection:" << errorMessage;
+      } catch (std::exception const & exception) {
+         //
+         // Eg BtSqlQuery throws std::runtime_error if it can't prepare a statement.  Nothing above us on the writer
+         // thread can catch this, so, if we didn't, it would terminate the program (and anyone waiting for this
+         // operation's result would wait forever).
+         //
+         qCritical() << Q_FUNC_INFO << "Exception running" << queuedOperation.description << ":" << exception.what();
+         succeeded = false;
+      } catch (...) {
+         qCritical() << Q_FUNC_INFO << "Unknown exception running" << queuedOperation.description;
+         succeeded = false;
+      }
+      if (!succeeded) {
+         qCritical() << Q_FUNC_INFO << "DB write failed:" << queuedOperation.description;
+         ++this->numFailures;
+      }
+      queuedOperation.promise->set_value(succeeded);
+      return succeeded;
+   }
+
+   /**
+    * \brief Main loop of the writer thread: run operations in the order they were queued until asked to stop and
+    *        there is nothing left to do
+    */
+   void runQueue() {
+      qDebug() << Q_FUNC_INFO << "DB writer thread starting";
+      while (true) {
+         QueuedOperation queuedOperation;
+         {
+            QMutexLocker locker(&this->mutex);
+            while (this->queue.isEmpty() && !this->stopRequested) {
+               this->workAvailable.wait(&this->mutex);
+            }
+            if (this->queue.isEmpty()) {
+               // Once we've said we're no longer running, submitters will run their own operations
+               this->running = false;
+               this->becameIdle.wakeAll();
+               break;
+            }
+            queuedOperation = this->queue.dequeue();
+            this->busy = true;
+         }
+
+         bool const succeeded = this->execute(queuedOperation);
+
+         QMutexLocker locker(&this->mutex);
+         this->busy = false;
+         if (!succeeded) {
+            this->failedSinceLastWait = true;
+         }
+         if (this->queue.isEmpty()) {
+            this->becameIdle.wakeAll();
+         }
+      }
+
+      // Per the comments in Database.h, the connection has to be closed by the thread that opened it
+      this->database.closeConnectionForThisThread();
+      qDebug() << Q_FUNC_INFO << "DB writer thread finished";
+      return;
+   }
+
+   Database & database;
+   WriterThread thread;
+   QMutex mutex;
+   QWaitCondition workAvailable;
+   QWaitCondition becameIdle;
+   QQueue<QueuedOperation> queue;
+   bool running;
+   bool stopRequested;
+   // True while an operation that has been taken off the queue is being run
+   bool busy;
+   bool failedSinceLastWait;
+   // Only changed by whichever thread is running operations, but can be read from any thread
+   std::atomic<unsigned int> numFailures;
+};
+
+DbWriter::DbWriter(Database & database) : pimpl{std::make_unique<impl>(database)} {
+   return;
+}
+
+DbWriter::~DbWriter() {
+   // Normally Database::unload() will have stopped us already, but we don't want to leave a thread running on a
+   // destroyed object if not
+   this->stop();
+   return;
+}
+
+void DbWriter::start() {
+   QMutexLocker locker(&this->pimpl->mutex);
+   if (this->pimpl->running) {
+      return;
+   }
+   qInfo() << Q_FUNC_INFO << "Starting DB writer thread";
+   this->pimpl->running = true;
+   this->pimpl->stopRequested = false;
+   this->pimpl->thread.start();
+   return;
+}
+
+void DbWriter::stop() {
+   {
+      QMutexLocker locker(&this->pimpl->mutex);
+      if (!this->pimpl->running) {
+         return;
+      }
+      this->pimpl->stopRequested = true;
+      this->pimpl->workAvailable.wakeAll();
+   }
+   this->pimpl->thread.wait();
+   qInfo() << Q_FUNC_INFO << "Stopped DB writer thread";
+   return;
+}
+
+bool DbWriter::isRunning() const {
+   QMutexLocker locker(&this->pimpl->mutex);
+   return this->pimpl->running;
+}
+
+std::future<bool> DbWriter::enqueue(QString const & description, DbWriter::Operation operation) {
+   QueuedOperation queuedOperation{description, operation, std::make_shared<std::promise<bool> >()};
+   std::future<bool> future = queuedOperation.promise->get_future();
+
+   QMutexLocker locker(&this->pimpl->mutex);
+   if (!this->pimpl->running) {
+      // No writer thread, so just do the work here
+      locker.unlock();
+      bool const succeeded = this->pimpl->execute(queuedOperation);
+      if (!succeeded) {
+         locker.relock();
+         this->pimpl->failedSinceLastWait = true;
+      }
+      return future;
+   }
+
+   qDebug() << Q_FUNC_INFO << "Queueing" << description << "behind" << this->pimpl->queue.size() << "other(s)";
+   this->pimpl->queue.enqueue(queuedOperation);
+   this->pimpl->workAvailable.wakeOne();
+   return future;
+}
+
+bool DbWriter::waitForIdle() {
+   QMutexLocker locker(&this->pimpl->mutex);
+   // If we're called from an operation on the writer thread, waiting would be waiting for ourselves
+   if (QThread::currentThread() != &this->pimpl->thread) {
+      while (this->pimpl->running && (this->pimpl->busy || !this->pimpl->queue.isEmpty())) {
+         this->pimpl->becameIdle.wait(&this->pimpl->mutex);
+      }
+   }
+   bool const succeeded = !this->pimpl->failedSinceLastWait;
+   this->pimpl->failedSinceLastWait = false;
+   return succeeded;
+}
+
+unsigned int DbWriter::numFailures() const {
+   return this->pimpl->numFailures.load();
+}
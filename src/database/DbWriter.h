@@ -0,0 +1,149 @@
+/*
+ * database/DbWriter.h is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_DBWRITER_H
+#define DATABASE_DBWRITER_H
+#pragma once
+
+#include <functional>
+#include <future>
+#include <memory> // For PImpl
+#include <optional>
+
+#include <QSqlDatabase>
+#include <QString>
+
+class Database;
+
+/**
+ * \class DbWriter
+ *
+ * \brief Runs DB write operations, in the order they were submitted, on a dedicated thread with its own DB connection
+ *        (see \c Database::sqlDatabase() for how connections are per-thread).  This means the GUI thread does not
+ *        have to wait for the disk (or a PostgreSQL server round-trip) every time an object is changed.
+ *
+ *        There is one \c DbWriter per \c Database.  Operations are submitted by \c ObjectStore, and must not touch
+ *        the objects being written, as these belong to (and can be changed at any time by) the submitting thread.
+ *        Instead, the submitter takes a copy of everything the operation will need, and the operation just binds
+ *        those values and runs its queries.  Each operation is responsible for its own \c DbTransaction.
+ *
+ *        Until \c start() is called (or after \c stop()), operations are run synchronously on the submitting thread,
+ *        using that thread's DB connection.  We also don't start the thread at all if the DB is configured in a way
+ *        that would not let a second connection write (eg SQLite exclusive locking mode).
+ *
+ *        Errors are logged by the operations themselves (as they always were), and additionally reported through
+ *        the futures returned when operations are submitted and through \c waitForIdle().
+ */
+class DbWriter {
+public:
+   /**
+    * \brief An operation is run with the writer thread's DB connection and returns \c true if it succeeded
+    */
+   using Operation = std::function<bool(QSqlDatabase &)>;
+
+   DbWriter(Database & database);
+   ~DbWriter();
+
+   /**
+    * \brief Start the writer thread.  Does nothing if it is already running.
+    */
+   void start();
+
+   /**
+    * \brief Run any outstanding operations, then stop the writer thread (closing its DB connection).  Subsequent
+    *        operations are run synchronously on the submitting thread.
+    */
+   void stop();
+
+   /**
+    * \brief Whether operations are currently being run on the writer thread
+    */
+   bool isRunning() const;
+
+   /**
+    * \brief Add an operation to the back of the queue
+    *
+    * \param description  Used for logging, eg if the operation fails
+    * \param operation
+    *
+    * \return Future that becomes ready, with the operation's result, once the operation has run.  Callers that don't
+    *         need to wait for the result are free to discard this.
+    */
+   std::future<bool> enqueue(QString const & description, Operation operation);
+
+   /**
+    * \brief Add an operation that produces a value (eg the primary key generated for a new row) to the back of the
+    *        queue.  The operation returns \c std::nullopt if it failed.
+    */
+   template<typename T>
+   std::future<std::optional<T> > enqueueForResult(QString const & description,
+                                                   std::function<std::optional<T>(QSqlDatabase &)> operation) {
+      //
+      // If the operation never gets run (eg because the writer could not get a DB connection) then the result is
+      // std::nullopt, which we ensure by setting it, if need be, when the last copy of the operation goes away.
+      //
+      struct ResultHolder {
+         std::promise<std::optional<T> > promise;
+         bool resultSet = false;
+         ~ResultHolder() {
+            if (!this->resultSet) {
+               this->promise.set_value(std::nullopt);
+            }
+         }
+      };
+      auto resultHolder = std::make_shared<ResultHolder>();
+      auto future = resultHolder->promise.get_future();
+      this->enqueue(
+         description,
+         [resultHolder, operation](QSqlDatabase & connection) {
+            std::optional<T> result = operation(connection);
+            bool const succeeded = result.has_value();
+            resultHolder->promise.set_value(std::move(result));
+            resultHolder->resultSet = true;
+            return succeeded;
+         }
+      );
+      return future;
+   }
+
+   /**
+    * \brief Block until every operation submitted so far has been run
+    *
+    * \return \c false if any operation failed since the last call to this function, \c true otherwise
+    */
+   bool waitForIdle();
+
+   /**
+    * \brief Total number of operations that have failed since the writer was created.  Unlike \c waitForIdle(), this
+    *        does not reset, so a caller can note the value before some operations and compare it afterwards.  (Mostly
+    *        useful from inside an operation, as then all earlier operations are known to have run.)
+    */
+   unsigned int numFailures() const;
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   DbWriter(DbWriter const &) = delete;
+   DbWriter & operator=(DbWriter const &) = delete;
+   DbWriter(DbWriter &&) = delete;
+   DbWriter & operator=(DbWriter &&) = delete;
+};
+
+#endif
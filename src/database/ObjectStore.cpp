@@ -18,21 +18,35 @@
  */
 #include "database/ObjectStore.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cstring>
+#include <functional>
+#include <future>
+#include <memory>
+#include <optional>
 #include <tuple>
 
 #include <QDebug>
 #include <QHash>
 #include <QMap>
+#include <QCoreApplication>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QSet>
 #include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlField>
 #include <QSqlRecord>
+#include <QThread>
+#include <QTimer>
 #include <QVector>
 
 #include "database/BtSqlQuery.h"
 #include "database/Database.h"
 #include "database/DbTransaction.h"
+#include "database/DbWriter.h"
 #include "Logging.h"
 #include "model/NamedParameterBundle.h"
 #include "utils/OptionalHelpers.h"
@@ -201,6 +215,38 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Add an index on each foreign key column of a table.  Neither SQLite nor PostgreSQL does this automatically,
+    *        and, without them, looking up rows by foreign key (eg deleting all the rows for a given Recipe from a
+    *        junction table) means scanning the whole table.
+    *
+    *        The index names are the same as those used for existing databases in DatabaseSchemaHelper (see
+    *        migrate_to_11()), and we use "IF NOT EXISTS" so it is harmless to call this on a table that already has
+    *        the indexes.
+    *
+    * \return true if succeeded, false otherwise
+    */
+   bool addForeignKeyIndexesToTable(QSqlDatabase & connection, ObjectStore::TableDefinition const & tableDefinition) {
+      BtSqlQuery sqlQuery{connection};
+      for (auto const & fieldDefn: tableDefinition.tableFields) {
+         if (fieldDefn.foreignKeyTo != nullptr) {
+            QString const queryString = QString(
+               "CREATE INDEX IF NOT EXISTS idx_%1_%2 ON %1 (%2);"
+            ).arg(*tableDefinition.tableName, *fieldDefn.columnName);
+            qDebug().noquote() << Q_FUNC_INFO << "Indexes: " << queryString;
+
+            sqlQuery.prepare(queryString);
+            if (!sqlQuery.exec()) {
+               qCritical() <<
+                  Q_FUNC_INFO << "Error executing database query " << queryString << ": " <<
+                  sqlQuery.lastError().text();
+               return false;
+            }
+         }
+      }
+      return true;
+   }
+
    /**
     * \brief Return a string containing all the bound values on a query.   This is quite a useful thing to have logged
     *        when you get an error!
@@ -220,6 +266,166 @@ namespace {
       return result;
    }
 
+   /**
+    * \brief If this many property updates are queued for an object store, we write them straight away rather than
+    *        waiting for the event loop to be idle.  This stops the queue growing without limit if something is making
+    *        lots of changes without returning to the event loop.
+    */
+   int constexpr maxQueuedPropertyUpdates = 1000;
+
+   /**
+    * \brief A future that is already ready with the supplied value, for when there turns out to be nothing to wait for
+    */
+   std::future<bool> readyFuture(bool const value) {
+      std::promise<bool> promise;
+      promise.set_value(value);
+      return promise.get_future();
+   }
+
+   //
+   // Limits on the number of bind values in a single SQL statement.  For SQLite, it's SQLITE_MAX_VARIABLE_NUMBER, which
+   // defaults to 999 prior to version 3.32.0 (and 32766 thereafter).  For PostgreSQL, it's 65535 (because the count is
+   // sent as a 16-bit integer in the wire protocol).
+   //
+   int constexpr maxBindValuesSQLite     = 999;
+   int constexpr maxBindValuesPostgreSQL = 65535;
+
+   //
+   // Maximum number of rows we'll insert into a junction table with a single multi-row INSERT statement -- see
+   // insertJunctionTableRows().  There's not much to be gained by going much beyond a few hundred.  Can be changed via
+   // ObjectStore::setMaxRowsPerJunctionInsert().
+   //
+   std::atomic<int> maxRowsPerJunctionInsert{256};
+
+   //
+   // Maximum number of objects we'll write to a primary table with a single multi-row INSERT statement when copying
+   // everything to a new DB -- see ObjectStore::impl::execBulkInsertWithPrimaryKey().  In practice, the limit on bind
+   // values usually kicks in first for SQLite, as primary tables have lots of columns.
+   //
+   int constexpr maxRowsPerBulkInsert = 256;
+
+   //
+   // When copying everything to a new DB, this is how many objects we capture and write at a time.  (Capturing them
+   // all at once would mean holding a second copy of the whole DB in memory.)
+   //
+   int constexpr objectsPerBulkWriteChunk = 1024;
+
+   /**
+    * \brief The different SQL statements we run often enough to be worth caching.  See \c StatementCache.
+    */
+   enum class StatementKind {
+      Insert,
+      InsertWithPrimaryKey,
+      Update,
+      UpdateProperty,
+      HardDelete,
+      BulkInsertWithPrimaryKey,
+      JunctionInsert,
+      JunctionDelete,
+      JunctionDeleteRow,
+      JunctionUpdateOrder
+   };
+
+   /**
+    * \brief A SQL statement that we have prepared once and can bind and execute many times
+    */
+   struct CachedStatement {
+      QString const queryString;
+      BtSqlQuery sqlQuery;
+      CachedStatement(QString const & queryString, QSqlDatabase & connection) :
+         queryString{queryString},
+         sqlQuery{connection} {
+         // NB: BtSqlQuery::prepare() defers the call to QSqlQuery::prepare() until the first value is bound, after
+         //     which the query stays prepared for all subsequent binds and executions.
+         this->sqlQuery.prepare(queryString);
+         return;
+      }
+   };
+
+   /**
+    * \brief Cache of prepared statements for one \c ObjectStore (and thus one primary table plus its junction tables).
+    *
+    *        Most of the SQL we run is the same text every time for a given table (and, in the case of updating a single
+    *        property, a given column), so it's wasteful to rebuild the query string and have the DB re-parse it on
+    *        every edit the user makes.  Instead, we build and prepare each statement the first time it is needed and
+    *        keep it for subsequent calls.
+    *
+    *        Because a prepared statement belongs to a particular DB connection (and, per the comments in
+    *        \c Database::sqlDatabase(), each thread has its own connection), the cache key includes the connection
+    *        name.  All cached statements for a connection must be released (via \c clear()) before that connection is
+    *        removed from Qt's list of connections.
+    */
+   class StatementCache {
+   public:
+      StatementCache() : mutex{}, statements{}, hits{0}, misses{0} {
+         return;
+      }
+
+      /**
+       * \brief Get the cached statement for the supplied connection, kind and name, creating it if necessary
+       *
+       * \param connection
+       * \param kind
+       * \param name  Name of the property or junction table the statement relates to (plus, if needed, anything else
+       *              that distinguishes it from other statements of the same kind), or empty if the statement is for
+       *              the primary table as a whole
+       * \param makeQueryString  Called only on a cache miss, to construct the SQL for the statement
+       */
+      std::shared_ptr<CachedStatement> get(QSqlDatabase & connection,
+                                           StatementKind const kind,
+                                           QString const & name,
+                                           std::function<QString()> const & makeQueryString) {
+         Key const key{connection.connectionName(), kind, name};
+         QMutexLocker locker(&this->mutex);
+         auto match = this->statements.find(key);
+         if (match != this->statements.end()) {
+            ++this->hits;
+            return match.value();
+         }
+         ++this->misses;
+         auto newStatement = std::make_shared<CachedStatement>(makeQueryString(), connection);
+         this->statements.insert(key, newStatement);
+         return newStatement;
+      }
+
+      /**
+       * \brief Convenience version of \c get for when the name is a property or table name
+       */
+      std::shared_ptr<CachedStatement> get(QSqlDatabase & connection,
+                                           StatementKind const kind,
+                                           BtStringConst const & name,
+                                           std::function<QString()> const & makeQueryString) {
+         return this->get(connection, kind, name.isNull() ? QString{} : QString{*name}, makeQueryString);
+      }
+
+      /**
+       * \brief Release all cached statements for the supplied connection
+       */
+      void clear(QString const & connectionName) {
+         QMutexLocker locker(&this->mutex);
+         for (auto ii = this->statements.begin(); ii != this->statements.end(); ) {
+            if (std::get<0>(ii.key()) == connectionName) {
+               ii = this->statements.erase(ii);
+            } else {
+               ++ii;
+            }
+         }
+         return;
+      }
+
+      ObjectStore::StatementCacheStats stats() const {
+         QMutexLocker locker(&this->mutex);
+         return ObjectStore::StatementCacheStats{this->hits, this->misses, this->statements.size()};
+      }
+
+   private:
+      using Key = std::tuple<QString, StatementKind, QString>;
+      mutable QMutex mutex;
+      QMap<Key, std::shared_ptr<CachedStatement> > statements;
+      unsigned int hits;
+      unsigned int misses;
+   };
+
    /**
     * \brief Given a string value pulled out of the DB for an enum, look up and return its internal numerical enum
     *        equivalent.  Caller's responsibility to handle null values etc before deciding whether to call this
@@ -260,85 +466,22 @@ namespace {
    }
 
    /**
-    * \brief Insert data from an object property to a junction table
+    * \brief Read the list of "other" IDs that an object property stored in a junction table currently holds
     *
     * \param junctionTable
     * \param object
-    * \param primaryKey  Note that this must be supplied separately as, for a new object, we may not (yet) have set its
-    *                    primary key (ie we cannot just read primary key from object)
-    * \param connection
+    * \param primaryKey  Only used for logging
+    * \param propertyValues  Set to the IDs held by the property.  Empty if the property is a single ID that is
+    *                        "unset" (ie not a valid primary key).
     *
     * \return \c true if succeeded, \c false otherwise
     */
-   bool insertIntoJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
-                                          QObject const & object,
-                                          QVariant const & primaryKey,
-                                          QSqlDatabase & connection) {
-      qDebug() <<
-         Q_FUNC_INFO << "Writing" << object.metaObject()->className() << "property" <<
-         GetJunctionTableDefinitionPropertyName(junctionTable) << " into junction table " <<
-         junctionTable.tableName;
-
-      //
-      // It's a coding error if the caller has supplied us anything other than an int inside the primaryKey QVariant.
-      //
-      // Here and elsewhere, although we could just do a Q_ASSERT, we prefer (a) some extra diagnostics on debug builds
-      // and (b) to bail out immediately of the DB transaction on non-debug builds.
-      //
-      if (QVariant::Type::Int != primaryKey.type()) {
-         qCritical() << Q_FUNC_INFO << "Unexpected contents of primaryKey QVariant: " << primaryKey.typeName();
-         Q_ASSERT(false); // Stop here on debug builds
-         return false;    // Continue but bail out of the current DB transaction on other builds
-      }
-
-      //
-      // Construct the query
-      //
-      // We may be inserting more than one row.  In theory we COULD combine all the rows into a single insert statement
-      // using either BtSqlQuery::execBatch() or directly constructing one of the common (but technically non-standard)
-      // syntaxes, eg the following works on a lot of databases (including PostgreSQL and newer versions of SQLite) for
-      // up to 1000 rows):
-      //    INSERT INTO table (columnA, columnB, ..., columnN)
-      //         VALUES       (r1_valA, r1_valB, ..., r1_valN),
-      //                      (r2_valA, r2_valB, ..., r2_valN),
-      //                      ...,
-      //                      (rm_valA, rm_valB, ..., rm_valN);
-      // However, we DON"T do this.  The variable binding is more complicated/error-prone than when just doing
-      // individual inserts.  (Even with BtSqlQuery::execBatch(), we'd have to loop to construct the lists of bind
-      // parameters.)  And there's likely no noticeable performance benefit given that we're typically inserting only
-      // a handful of rows at a time (eg all the Hops in a Recipe).
-      //
-      // So instead, we just do individual inserts.  Note that orderByColumn column is only used if specified, and
-      // that, if it is, we assume it's an integer type and that we create the values ourselves.
-      //
-      QString queryString{"INSERT INTO "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream << junctionTable.tableName << " (" <<
-         GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
-         GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      }
-      QString const thisPrimaryKeyBindName  = QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
-      QString const otherPrimaryKeyBindName = QString{":"} + *GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
-      QString const orderByBindName         = QString{":"} + *GetJunctionTableDefinitionOrderByColumn(junctionTable);
-      queryStringAsStream << ") VALUES (" << thisPrimaryKeyBindName << ", " << otherPrimaryKeyBindName;
-      if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-         queryStringAsStream << ", " << orderByBindName;
-      }
-      queryStringAsStream << ");";
-      qDebug() << Q_FUNC_INFO << "Using query string" << queryString;
+   bool readJunctionTableProperty(ObjectStore::JunctionTableDefinition const & junctionTable,
+                                  QObject const & object,
+                                  QVariant const & primaryKey,
+                                  QVector<int> & propertyValues) {
+      propertyValues.clear();
 
-      //
-      // Note that, when we are using bind values, we do NOT want to call the
-      // BtSqlQuery::BtSqlQuery(const QString &, QSqlDatabase db) version of the BtSqlQuery constructor because that
-      // would result in the supplied query being executed immediately (ie before we've had a chance to bind
-      // parameters).
-      //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
-
-      // Get the list of data to bind to it
       QVariant propertyValuesWrapper = object.property(*GetJunctionTableDefinitionPropertyName(junctionTable));
       if (!propertyValuesWrapper.isValid()) {
          // It's a programming error if we couldn't read a property value
@@ -350,7 +493,6 @@ namespace {
       }
 
       // We now need to extract the property values from their QVariant wrapper
-      QVector<int> propertyValues;
       if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
          // If it's single entry only, just turn it into a one-item list so that the remaining processing is the same
          bool succeeded = false;
@@ -391,44 +533,178 @@ namespace {
          propertyValues = propertyValuesWrapper.value< QVector<int> >();
       }
 
-      // Now loop through and bind/run the insert query once for each item in the list
-      int itemNumber = 1;
       qDebug() <<
          Q_FUNC_INFO << propertyValues.size() << "value(s) (in" << propertyValuesWrapper.typeName() <<
          ") for property" << GetJunctionTableDefinitionPropertyName(junctionTable) << "of" <<
          object.metaObject()->className() << "#" << primaryKey.toInt();
-      for (int curValue : propertyValues) {
-         sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
-         sqlQuery.bindValue(otherPrimaryKeyBindName, curValue);
-         if (!GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull()) {
-            sqlQuery.bindValue(orderByBindName, itemNumber);
+      return true;
+   }
+
+   /**
+    * \brief Get the statement for inserting \c numRows rows at once into a junction table
+    *
+    *        The SQL will be of the form:
+    *
+    *           INSERT INTO tablename (thisColumn, otherColumn, orderColumn)
+    *           VALUES (?, ?, ?), (?, ?, ?), ..., (?, ?, ?);
+    *
+    *        (where orderColumn is omitted if the junction table doesn't have one).  Multi-row VALUES is supported by
+    *        both PostgreSQL and SQLite (since 3.7.11).  We use positional bind values as they are simpler to generate
+    *        for many rows, and avoid a name lookup per bind.
+    */
+   std::shared_ptr<CachedStatement> getJunctionInsertStatement(StatementCache & statementCache,
+                                                               ObjectStore::JunctionTableDefinition const & junctionTable,
+                                                               int const numRows,
+                                                               QSqlDatabase & connection) {
+      return statementCache.get(
+         connection,
+         StatementKind::JunctionInsert,
+         QString{"%1/%2"}.arg(*junctionTable.tableName).arg(numRows),
+         [&]() {
+            bool const hasOrderColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+            QString queryString{"INSERT INTO "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << junctionTable.tableName << " (" <<
+               GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << ", " <<
+               GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+            if (hasOrderColumn) {
+               queryStringAsStream << ", " << GetJunctionTableDefinitionOrderByColumn(junctionTable);
+            }
+            queryStringAsStream << ") VALUES ";
+            for (int ii = 0; ii < numRows; ++ii) {
+               queryStringAsStream << (ii == 0 ? "" : ", ") << (hasOrderColumn ? "(?, ?, ?)" : "(?, ?)");
+            }
+            queryStringAsStream << ";";
+            return queryString;
+         }
+      );
+   }
+
+   /**
+    * \brief Work out the largest power of two rows we can insert with one statement, given the number of columns per
+    *        row, the DB's limit on the number of bind values in one statement, and our own limit \c maxRows.
+    */
+   int rowsPerMultiRowInsert(QSqlDatabase const & connection, int const numColumns, int const maxRows) {
+      int const maxBindValues =
+         connection.driverName() == "QPSQL" ? maxBindValuesPostgreSQL : maxBindValuesSQLite;
+      int const limit = std::max(1, std::min(maxRows, maxBindValues / numColumns));
+      int rowsPerStatement = 1;
+      while (rowsPerStatement * 2 <= limit) {
+         rowsPerStatement *= 2;
+      }
+      return rowsPerStatement;
+   }
+
+   /**
+    * \brief One row to insert into a junction table
+    */
+   struct JunctionTableRow {
+      // Primary key of the object whose property we are writing
+      int thisId;
+      // The "other" ID
+      int otherId;
+      // Value for the order column, which is ignored if the junction table doesn't have one
+      int itemNumber;
+   };
+
+   /**
+    * \brief Insert rows, for one or more objects, into a junction table
+    *
+    *        Rather than run one INSERT per row, we insert up to \c maxRowsPerJunctionInsert rows per statement.  (This
+    *        makes a big difference when, eg, importing or copying large numbers of recipes.)  To keep the number of
+    *        distinct statements we prepare (and cache) small, each statement inserts a power-of-two number of rows, so
+    *        eg 13 rows would be written with statements for 8, 4 and 1 rows.
+    *
+    * \param statementCache
+    * \param junctionTable
+    * \param rows
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool insertJunctionTableRows(StatementCache & statementCache,
+                                ObjectStore::JunctionTableDefinition const & junctionTable,
+                                QVector<JunctionTableRow> const & rows,
+                                QSqlDatabase & connection) {
+      if (rows.isEmpty()) {
+         return true;
+      }
+
+      //
+      // Work out how many rows we can insert per statement without exceeding the DB's limit on the number of bind
+      // values in one statement.  Note that orderByColumn column is only used if specified, and that, if it is, we
+      // assume it's an integer type and that we create the values ourselves.
+      //
+      bool const hasOrderColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+      int const numColumns = hasOrderColumn ? 3 : 2;
+      int rowsPerStatement = rowsPerMultiRowInsert(connection, numColumns, maxRowsPerJunctionInsert.load());
+
+      qDebug() <<
+         Q_FUNC_INFO << "Inserting" << rows.size() << "row(s) into" << junctionTable.tableName << "with up to" <<
+         rowsPerStatement << "row(s) per statement";
+
+      for (int rowsDone = 0; rowsDone < rows.size(); ) {
+         while (rowsPerStatement > rows.size() - rowsDone) {
+            rowsPerStatement /= 2;
+         }
+
+         auto cachedStatement = getJunctionInsertStatement(statementCache, junctionTable, rowsPerStatement, connection);
+         QString const & queryString = cachedStatement->queryString;
+         BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
+
+         int bindPosition = 0;
+         for (int ii = rowsDone; ii < rowsDone + rowsPerStatement; ++ii) {
+            sqlQuery.bindValue(bindPosition++, rows.at(ii).thisId);
+            sqlQuery.bindValue(bindPosition++, rows.at(ii).otherId);
+            if (hasOrderColumn) {
+               sqlQuery.bindValue(bindPosition++, rows.at(ii).itemNumber);
+            }
          }
-         qDebug() <<
-            Q_FUNC_INFO <<
-            GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " #" << primaryKey.toInt() << ":" <<
-            GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) << "N°" << itemNumber << " is #" << curValue;
 
          if (!sqlQuery.exec()) {
             qCritical() <<
                Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
             return false;
          }
-         ++itemNumber;
+         rowsDone += rowsPerStatement;
       }
 
       return true;
    }
 
+   /**
+    * \brief Turn a list of "other" IDs into the rows to insert for them, numbering from 1, and append them to \c rows
+    */
+   void numberJunctionTableRows(int const primaryKey,
+                                QVector<int> const & propertyValues,
+                                QVector<JunctionTableRow> & rows) {
+      rows.reserve(rows.size() + propertyValues.size());
+      int itemNumber = 1;
+      for (int curValue : propertyValues) {
+         rows.append(JunctionTableRow{primaryKey, curValue, itemNumber});
+         ++itemNumber;
+      }
+      return;
+   }
+
+   QVector<JunctionTableRow> numberJunctionTableRows(int const primaryKey, QVector<int> const & propertyValues) {
+      QVector<JunctionTableRow> rows;
+      numberJunctionTableRows(primaryKey, propertyValues, rows);
+      return rows;
+   }
+
    /**
     * \brief Delete rows relating to a particular object from a junction table
     *
+    * \param statementCache
     * \param junctionTable
     * \param primaryKey
     * \param connection
     *
     * \return \c true if succeeded, \c false otherwise
     */
-   bool deleteFromJunctionTableDefinition(ObjectStore::JunctionTableDefinition const & junctionTable,
+   bool deleteFromJunctionTableDefinition(StatementCache & statementCache,
+                                          ObjectStore::JunctionTableDefinition const & junctionTable,
                                           QVariant const & primaryKey,
                                           QSqlDatabase & connection) {
 
@@ -439,15 +715,22 @@ namespace {
       QString const thisPrimaryKeyBindName =
          QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
 
-      // Construct the DELETE query
-      QString queryString{"DELETE FROM "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream <<
-         junctionTable.tableName << " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) <<
-         " = " << thisPrimaryKeyBindName << ";";
-
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
+      // Construct the DELETE query (or reuse the one we constructed previously)
+      auto cachedStatement = statementCache.get(
+         connection,
+         StatementKind::JunctionDelete,
+         junctionTable.tableName,
+         [&]() {
+            QString queryString{"DELETE FROM "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream <<
+               junctionTable.tableName << " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) <<
+               " = " << thisPrimaryKeyBindName << ";";
+            return queryString;
+         }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
 
       // Bind the primary key value
       sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
@@ -463,6 +746,176 @@ namespace {
       return true;
    }
 
+   /**
+    * \brief Run a statement on a single row of a junction table, identified by the IDs of the objects it links.  Used
+    *        by \c syncJunctionTableDefinition to delete a row or change its order.
+    *
+    * \param statementCache
+    * \param junctionTable
+    * \param kind  Either \c StatementKind::JunctionDeleteRow or \c StatementKind::JunctionUpdateOrder
+    * \param primaryKey
+    * \param otherPrimaryKey
+    * \param itemNumber  New value for the order column.  Ignored for \c StatementKind::JunctionDeleteRow
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execOnJunctionTableRow(StatementCache & statementCache,
+                               ObjectStore::JunctionTableDefinition const & junctionTable,
+                               StatementKind const kind,
+                               QVariant const & primaryKey,
+                               int const otherPrimaryKey,
+                               int const itemNumber,
+                               QSqlDatabase & connection) {
+      QString const thisPrimaryKeyBindName  = QString{":"} + *GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable);
+      QString const otherPrimaryKeyBindName = QString{":"} + *GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable);
+      QString const orderByBindName         = QString{":"} + *GetJunctionTableDefinitionOrderByColumn(junctionTable);
+
+      //
+      // The SQL will be one of:
+      //
+      //    DELETE FROM tablename WHERE thisColumn = :thisColumn AND otherColumn = :otherColumn;
+      //    UPDATE tablename SET orderColumn = :orderColumn WHERE thisColumn = :thisColumn AND otherColumn = :otherColumn;
+      //
+      auto cachedStatement = statementCache.get(
+         connection,
+         kind,
+         junctionTable.tableName,
+         [&]() {
+            QString queryString;
+            QTextStream queryStringAsStream{&queryString};
+            if (kind == StatementKind::JunctionUpdateOrder) {
+               queryStringAsStream <<
+                  "UPDATE " << junctionTable.tableName << " SET " <<
+                  GetJunctionTableDefinitionOrderByColumn(junctionTable) << " = " << orderByBindName;
+            } else {
+               queryStringAsStream << "DELETE FROM " << junctionTable.tableName;
+            }
+            queryStringAsStream <<
+               " WHERE " << GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable) << " = " <<
+               thisPrimaryKeyBindName << " AND " << GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable) <<
+               " = " << otherPrimaryKeyBindName << ";";
+            return queryString;
+         }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
+
+      sqlQuery.bindValue(thisPrimaryKeyBindName, primaryKey);
+      sqlQuery.bindValue(otherPrimaryKeyBindName, otherPrimaryKey);
+      if (kind == StatementKind::JunctionUpdateOrder) {
+         sqlQuery.bindValue(orderByBindName, itemNumber);
+      }
+      qDebug().noquote() << Q_FUNC_INFO << queryString << "Bind values:" << BoundValuesToString(sqlQuery);
+
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      return true;
+   }
+
+   /**
+    * \brief Bring the rows in a junction table for one object into line with the object's property, doing only the
+    *        minimum number of deletes, inserts and order updates.
+    *
+    *        If we don't know what's currently in the DB, or if either the old or new list contains the same ID more
+    *        than once (in which case we can't identify individual rows by the IDs they link), we fall back to deleting
+    *        all the object's rows and re-inserting them.
+    *
+    * \param statementCache
+    * \param junctionTable
+    * \param primaryKey
+    * \param persistedValues  What we last wrote to (or read from) the DB for this object and junction table, or
+    *                         \c nullptr if not known
+    * \param newValues  What the object's property currently holds
+    * \param connection
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool syncJunctionTableDefinition(StatementCache & statementCache,
+                                    ObjectStore::JunctionTableDefinition const & junctionTable,
+                                    QVariant const & primaryKey,
+                                    QVector<int> const * persistedValues,
+                                    QVector<int> const & newValues,
+                                    QSqlDatabase & connection) {
+      if (persistedValues && *persistedValues == newValues) {
+         qDebug() <<
+            Q_FUNC_INFO << "No change to" << junctionTable.tableName << "rows for #" << primaryKey.toInt();
+         return true;
+      }
+
+      //
+      // QHash maps each ID to its position in the list.  If the number of entries in the hash is less than the number
+      // of entries in the list, then the list contains duplicates.
+      //
+      QHash<int, int> newPositions;
+      newPositions.reserve(newValues.size());
+      for (int ii = 0; ii < newValues.size(); ++ii) {
+         newPositions.insert(newValues.at(ii), ii);
+      }
+      QHash<int, int> oldPositions;
+      if (persistedValues) {
+         oldPositions.reserve(persistedValues->size());
+         for (int ii = 0; ii < persistedValues->size(); ++ii) {
+            oldPositions.insert(persistedValues->at(ii), ii);
+         }
+      }
+
+      if (!persistedValues ||
+          newPositions.size() != newValues.size() ||
+          oldPositions.size() != persistedValues->size()) {
+         qDebug() << Q_FUNC_INFO << "Rewriting all" << junctionTable.tableName << "rows for #" << primaryKey.toInt();
+         if (!deleteFromJunctionTableDefinition(statementCache, junctionTable, primaryKey, connection)) {
+            return false;
+         }
+         return insertJunctionTableRows(statementCache,
+                                        junctionTable,
+                                        numberJunctionTableRows(primaryKey.toInt(), newValues),
+                                        connection);
+      }
+
+      bool const hasOrderColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+
+      // Remove the rows that are no longer needed
+      for (int oldValue : *persistedValues) {
+         if (!newPositions.contains(oldValue)) {
+            if (!execOnJunctionTableRow(statementCache,
+                                        junctionTable,
+                                        StatementKind::JunctionDeleteRow,
+                                        primaryKey,
+                                        oldValue,
+                                        0,
+                                        connection)) {
+               return false;
+            }
+         }
+      }
+
+      // Add the new rows and, if order matters, renumber the existing rows that have moved
+      QVector<JunctionTableRow> rowsToInsert;
+      for (int ii = 0; ii < newValues.size(); ++ii) {
+         int const newValue = newValues.at(ii);
+         if (!oldPositions.contains(newValue)) {
+            rowsToInsert.append(JunctionTableRow{primaryKey.toInt(), newValue, ii + 1});
+         } else if (hasOrderColumn && oldPositions.value(newValue) != ii) {
+            if (!execOnJunctionTableRow(statementCache,
+                                        junctionTable,
+                                        StatementKind::JunctionUpdateOrder,
+                                        primaryKey,
+                                        newValue,
+                                        ii + 1,
+                                        connection)) {
+               return false;
+            }
+         }
+      }
+
+      return insertJunctionTableRows(statementCache, junctionTable, rowsToInsert, connection);
+   }
+
    /**
     * \brief Force a QVariant to be a specific type.  Called from \c unwrapAndMapAsNeeded
     */
@@ -532,17 +985,77 @@ namespace {
 // This private implementation class holds all private non-virtual members of ObjectStore
 class ObjectStore::impl {
 public:
+   //
+   // For an indexed property, a map from property value (converted to QString) to the IDs of the objects having that
+   // value, plus the reverse map so we know what to remove when the value changes or the object goes away.  For a
+   // list property (eg Recipe::hopIds), each element of the list is a separate key.
+   //
+   struct SecondaryIndex {
+      QHash<QString, QSet<int> > idsByKey;
+      QHash<int, QStringList> keysById;
+   };
+
+   /**
+    * \brief What we need to write one junction table property of one object -- see \c RowWrite
+    */
+   struct JunctionTableWrite {
+      JunctionTableDefinition const * junctionTable;
+      // What we believed to be in the DB for this property when the write was captured, if we knew
+      std::optional<QVector<int> > persistedValues;
+      QVector<int> newValues;
+   };
+
+   /**
+    * \brief A copy, taken on the thread that owns the object store, of everything we need to write some or all of the
+    *        properties of one object to the DB.  The write itself is normally done on the DB writer thread (see
+    *        \c DbWriter), which must not read the object, as it belongs to another thread and can change at any time.
+    */
+   struct RowWrite {
+      int primaryKey;
+      // Index in primaryTable.tableFields and (converted, ready to bind) value of each primary table column to write
+      QVector<QPair<int, QVariant> > columnValues;
+      QVector<JunctionTableWrite> junctionTableWrites;
+      // See checkForWriteFailures() and execJunctionTableWrite()
+      unsigned int writeFailuresSeen;
+   };
+
+   /**
+    * \brief What has been done to the objects in this store since \c ObjectStore::startTransactionJournal() was called
+    */
+   struct TransactionJournal {
+      // Objects inserted, by primary key
+      QHash<int, std::shared_ptr<QObject> > insertedObjects;
+      // Objects removed from the cache (by soft or hard delete), by primary key
+      QHash<int, std::shared_ptr<QObject> > removedObjects;
+      // Primary keys of objects updated
+      QSet<int> updatedIds;
+   };
 
    /**
     * Constructor
     */
-   impl(TypeLookup               const & typeLookup,
-        TableDefinition          const & primaryTable,
-        JunctionTableDefinitions const & junctionTables) : typeLookup{typeLookup},
-                                                           primaryTable{primaryTable},
-                                                           junctionTables{junctionTables},
-                                                           allObjects{},
-                                                           database{nullptr} {
+   impl(TypeLookup                const & typeLookup,
+        TableDefinition           const & primaryTable,
+        JunctionTableDefinitions  const & junctionTables,
+        SecondaryIndexDefinitions const & secondaryIndexDefinitions) :
+      typeLookup{typeLookup},
+      primaryTable{primaryTable},
+      junctionTables{junctionTables},
+      allObjects{},
+      database{nullptr},
+      statementCache{},
+      queuedPropertyUpdates{},
+      queuedPropertyUpdatesLookup{},
+      flushTimer{},
+      persistedJunctionValues{},
+      secondaryIndexDefinitions{secondaryIndexDefinitions},
+      secondaryIndexes{},
+      loaded{false},
+      writeFailures{0},
+      writeFailuresSeen{0},
+      bulkInsertDepth{0},
+      deferredInsertedIds{},
+      transactionJournals{} {
       return;
    }
 
@@ -834,155 +1347,431 @@ public:
    }
 
    /**
-    * \brief Update the specified property on an object
-    *
-    *        NB: Caller is responsible for handling transactions
-    *
-    * \return \c true if succeeded, \c false otherwise
+    * \brief Start capturing a write for the object with the supplied primary key.  See \c RowWrite.
     */
-   bool updatePropertyInDb(QSqlDatabase & connection, QObject const & object, BtStringConst const & propertyName) {
-      // We'll need some of this info even if it's a junction table property we're updating
-      BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
-      QVariant const        primaryKey       {this->getPrimaryKey(object)};
+   RowWrite newRowWrite(int const primaryKey) {
+      this->checkForWriteFailures();
+      RowWrite rowWrite;
+      rowWrite.primaryKey = primaryKey;
+      rowWrite.writeFailuresSeen = this->writeFailuresSeen;
+      return rowWrite;
+   }
 
-      //
-      // First check whether this is a simple property.  (If not we look for it in the ones we store in junction
-      // tables.)
-      //
+   /**
+    * \brief If any writes for this store have failed since we last checked, then what we think is stored in the
+    *        junction tables may be wrong, so forget it.  (The next write of each junction table property will then
+    *        rewrite all its rows.)
+    *
+    *        We can't do this on the writer thread at the point of failure, as \c persistedJunctionValues belongs to the
+    *        thread that owns the object store.
+    */
+   void checkForWriteFailures() {
+      unsigned int const writeFailures = this->writeFailures.load();
+      if (writeFailures != this->writeFailuresSeen) {
+         qWarning() <<
+            Q_FUNC_INFO << "Write(s) to" << this->primaryTable.tableName << "failed, so will rewrite junction tables";
+         this->persistedJunctionValues.clear();
+         this->writeFailuresSeen = writeFailures;
+      }
+      return;
+   }
+
+   /**
+    * \brief Take a copy of a primary table field, converted and ready to bind to a query
+    */
+   QVariant captureColumnValue(QObject const & object, TableField const & fieldDefn) {
+      QVariant bindValue{object.property(*fieldDefn.propertyName)};
+
+      // Fix-up the QVariant if needed, including converting enums to strings
+      this->unwrapAndMapAsNeeded(this->primaryTable, fieldDefn, bindValue);
+
+      if (fieldDefn.foreignKeyTo) {
+         //
+         // If the columns if a foreign key and the caller is setting it to a non-positive value then we actually
+         // need to store NULL in the DB.  (In the code we store foreign key IDs as ints, and use -1 to mean null.
+         // In the DB we need to store NULL explicitly because, if we try to store -1, we'll get a foreign key
+         // constraint violation as the DB is unable to find a row in the related table with primary key -1.)
+         //
+         // Firstly, we assert it's a coding error if we've created a foreign key column that's not an int.  For the
+         // moment at least, we don't support other types of primary/foreign key.
+         //
+         Q_ASSERT(ObjectStore::FieldType::Int == fieldDefn.fieldType);
+         if (bindValue.toInt() <= 0) {
+            qDebug() << Q_FUNC_INFO << "Treating" << bindValue << "foreign key value as NULL";
+            bindValue = QVariant(QVariant::Int);
+         }
+      }
+      return bindValue;
+   }
+
+   /**
+    * \brief Take a copy of a junction table property, along with what we last wrote to the DB for it
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool captureJunctionTableValues(QObject const & object,
+                                   JunctionTableDefinition const & junctionTable,
+                                   RowWrite & rowWrite) {
+      JunctionTableWrite junctionTableWrite;
+      junctionTableWrite.junctionTable = &junctionTable;
+      if (!readJunctionTableProperty(junctionTable, object, rowWrite.primaryKey, junctionTableWrite.newValues)) {
+         return false;
+      }
+      auto const & persistedValuesForTable = this->persistedJunctionValues.value(*junctionTable.tableName);
+      auto persistedValues = persistedValuesForTable.constFind(rowWrite.primaryKey);
+      if (persistedValues != persistedValuesForTable.cend()) {
+         junctionTableWrite.persistedValues = *persistedValues;
+      }
+      rowWrite.junctionTableWrites.append(junctionTableWrite);
+      return true;
+   }
+
+   /**
+    * \brief Take a copy of all the stored properties of an object
+    *
+    * \param object
+    * \param rowWrite
+    * \param includePrimaryKey  Whether to include the primary key column in \c rowWrite.columnValues.  (This is needed
+    *                           for updates and for inserts where we are writing the primary key -- see
+    *                           \c execInsert.)
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool captureObject(QObject const & object, RowWrite & rowWrite, bool const includePrimaryKey) {
+      rowWrite.columnValues.reserve(this->primaryTable.tableFields.size());
+      for (int ii = (includePrimaryKey ? 0 : 1); ii < this->primaryTable.tableFields.size(); ++ii) {
+         rowWrite.columnValues.append(
+            qMakePair(ii, this->captureColumnValue(object, this->primaryTable.tableFields[ii]))
+         );
+      }
+      for (auto const & junctionTable : this->junctionTables) {
+         if (!this->captureJunctionTableValues(object, junctionTable, rowWrite)) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /**
+    * \brief Take a copy of one stored property of an object
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool captureProperty(QObject const & object, BtStringConst const & propertyName, RowWrite & rowWrite) {
+      //
+      // First check whether this is a simple property.  (If not we look for it in the ones we store in junction
+      // tables.)
+      //
       auto matchingFieldDefn = std::find_if(
          this->primaryTable.tableFields.begin(),
          this->primaryTable.tableFields.end(),
          [propertyName](TableField const & fd) {return fd.propertyName == propertyName;}
       );
-
       if (matchingFieldDefn != this->primaryTable.tableFields.end()) {
-         //
-         // We're updating a simple property
-         //
-         // Construct the SQL, which will be of the form
-         //
-         //    UPDATE tablename
-         //    SET columnName = :columnName
-         //    WHERE primaryKeyColumn = :primaryKeyColumn;
-         //
-         QString queryString{"UPDATE "};
-         QTextStream queryStringAsStream{&queryString};
-         queryStringAsStream << this->primaryTable.tableName << " SET ";
+         rowWrite.columnValues.append(
+            qMakePair(static_cast<int>(matchingFieldDefn - this->primaryTable.tableFields.begin()),
+                      this->captureColumnValue(object, *matchingFieldDefn))
+         );
+         return true;
+      }
 
-         BtStringConst const & columnToUpdateInDb = matchingFieldDefn->columnName;
+      auto matchingJunctionTableDefinitionDefn = std::find_if(
+         this->junctionTables.begin(),
+         this->junctionTables.end(),
+         [propertyName](JunctionTableDefinition const & jt) {
+            return GetJunctionTableDefinitionPropertyName(jt) == propertyName;
+         }
+      );
 
-         queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
-         queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+      // It's a coding error if we couldn't find the property either as a simple field or an associative entity
+      if (matchingJunctionTableDefinitionDefn == this->junctionTables.end()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to find rule for storing property" << object.metaObject()->className() << "::" <<
+            propertyName << "in either" << this->primaryTable.tableName << "or any associated table";
+         Q_ASSERT(false);
+         return false;
+      }
 
-         qDebug() <<
-            Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
-            "with database query" << queryString;
+      return this->captureJunctionTableValues(object, *matchingJunctionTableDefinitionDefn, rowWrite);
+   }
 
-         //
-         // Bind the values
-         //
-         BtSqlQuery sqlQuery{connection};
-         sqlQuery.prepare(queryString);
-         QVariant propertyBindValue{object.property(*propertyName)};
-         auto fieldDefn = std::find_if(
-            this->primaryTable.tableFields.begin(),
-            this->primaryTable.tableFields.end(),
-            [propertyName](TableField const & fd){return propertyName == fd.propertyName;}
+   /**
+    * \brief Once we've captured a write and queued it, we assume that the junction table rows it writes will be what
+    *        is in the DB, so that the next write only has to change what's different.  If the write fails, we'll find
+    *        out in \c checkForWriteFailures().
+    */
+   void notePersistedJunctionValues(RowWrite const & rowWrite, int const primaryKey) {
+      for (auto const & junctionTableWrite : rowWrite.junctionTableWrites) {
+         this->persistedJunctionValues[*junctionTableWrite.junctionTable->tableName].insert(
+            primaryKey,
+            junctionTableWrite.newValues
          );
+      }
+      return;
+   }
 
-         // It's a coding error if we're trying to update a property that's not in the field definitions
-         Q_ASSERT(fieldDefn != this->primaryTable.tableFields.end());
-
-         // Fix-up the QVariant if needed, including converting enums to strings
-         this->unwrapAndMapAsNeeded(this->primaryTable, *fieldDefn, propertyBindValue);
-
-         if (fieldDefn->foreignKeyTo) {
-            //
-            // If the columns if a foreign key and the caller is setting it to a non-positive value then we actually
-            // need to store NULL in the DB.  (In the code we store foreign key IDs as ints, and use -1 to mean null.
-            // In the DB we need to store NULL explicitly because, if we try to store -1, we'll get a foreign key
-            // constraint violation as the DB is unable to find a row in the related table with primary key -1.)
-            //
-            // Firstly, we assert it's a coding error if we've created a foreign key column that's not an int.  For the
-            // moment at least, we don't support other types of primary/foreign key.
-            //
-            Q_ASSERT(ObjectStore::FieldType::Int == fieldDefn->fieldType);
-            if (propertyBindValue.toInt() <= 0) {
-               qDebug() << Q_FUNC_INFO << "Treating" << propertyBindValue << "foreign key value as NULL";
-               propertyBindValue = QVariant(QVariant::Int);
+   /**
+    * \brief Queue a write for this store on the DB writer thread, noting if it fails (see \c checkForWriteFailures())
+    */
+   std::future<bool> enqueueWrite(QString const & description, DbWriter::Operation operation) {
+      impl * const self = this;
+      return this->database->writer().enqueue(
+         description,
+         [self, operation](QSqlDatabase & connection) {
+            bool succeeded = false;
+            try {
+               succeeded = operation(connection);
+            } catch (...) {
+               // DbWriter will log the exception and report the failure, but it doesn't know about our counter
+               ++self->writeFailures;
+               throw;
             }
+            if (!succeeded) {
+               ++self->writeFailures;
+            }
+            return succeeded;
          }
-         sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), propertyBindValue);
-         sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
-         qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+      );
+   }
 
-         //
-         // Run the query
-         //
-         if (!sqlQuery.exec()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-            return false;
-         }
-      } else {
-         //
-         // The property we've been given isn't a simple property, so look for it in the ones we store in junction
-         // tables
-         //
-         auto matchingJunctionTableDefinitionDefn = std::find_if(
-            this->junctionTables.begin(),
-            this->junctionTables.end(),
-            [propertyName](JunctionTableDefinition const & jt) {
-               return GetJunctionTableDefinitionPropertyName(jt) == propertyName;
+   /**
+    * \brief Queue writes of individual properties (as captured by \c captureProperty()) to be done in one transaction
+    */
+   std::future<bool> enqueuePropertyUpdates(QVector<RowWrite> const & rowWrites) {
+      impl * const self = this;
+      return this->enqueueWrite(
+         QString{"update of %1 %2 propert%3"}.arg(rowWrites.size()).arg(*this->primaryTable.tableName).arg(
+            rowWrites.size() == 1 ? "y" : "ies"
+         ),
+         [self, rowWrites](QSqlDatabase & connection) {
+            // Start transaction
+            // (By the magic of RAII, this will abort if we return from this function without calling
+            // dbTransaction.commit()
+            DbTransaction dbTransaction{*self->database, connection};
+            for (auto const & rowWrite : rowWrites) {
+               if (!self->execPropertyUpdates(connection, rowWrite)) {
+                  return false;
+               }
             }
-         );
+            return dbTransaction.commit();
+         }
+      );
+   }
 
-         // It's a coding error if we couldn't find the property either as a simple field or an associative entity
-         if (matchingJunctionTableDefinitionDefn == this->junctionTables.end()) {
-            qCritical() <<
-               Q_FUNC_INFO << "Unable to find rule for storing property" << object.metaObject()->className() << "::" <<
-               propertyName << "in either" << this->primaryTable.tableName << "or any associated table";
-            Q_ASSERT(false);
+   //
+   // The exec... member functions below are (normally) run on the DB writer thread, so they must only use what's in
+   // the supplied RowWrite and the table definitions, and not the objects themselves nor anything else in the store.
+   // (The statement cache is OK, as it has its own mutex.)
+   //
+
+   /**
+    * \brief Write one column of one row
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execUpdateColumn(QSqlDatabase & connection,
+                         int const primaryKey,
+                         int const fieldIndex,
+                         QVariant const & bindValue) {
+      //
+      // Construct the SQL, which will be of the form
+      //
+      //    UPDATE tablename
+      //    SET columnName = :columnName
+      //    WHERE primaryKeyColumn = :primaryKeyColumn;
+      //
+      BtStringConst const & primaryKeyColumn {this->getPrimaryKeyColumn()};
+      TableField const & fieldDefn = this->primaryTable.tableFields[fieldIndex];
+      BtStringConst const & columnToUpdateInDb = fieldDefn.columnName;
+
+      auto cachedStatement = this->statementCache.get(
+         connection,
+         StatementKind::UpdateProperty,
+         fieldDefn.propertyName,
+         [&]() {
+            QString queryString{"UPDATE "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << this->primaryTable.tableName << " SET ";
+            queryStringAsStream << " " << columnToUpdateInDb << " = :" << columnToUpdateInDb;
+            queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+            return queryString;
          }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
 
-         //
-         // As elsewhere, the simplest way to update a junction table is to blat any rows relating to the current object
-         // and then write out data based on the current property values.
-         //
-         qDebug() <<
-            Q_FUNC_INFO << "Updating" << object.metaObject()->className() << "property" << propertyName <<
-            "in junction table" << matchingJunctionTableDefinitionDefn->tableName;
-         if (!deleteFromJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, primaryKey, connection)) {
+      qDebug() <<
+         Q_FUNC_INFO << "Updating" << this->primaryTable.tableName << "#" << primaryKey << "property" <<
+         fieldDefn.propertyName << "with database query" << queryString;
+
+      sqlQuery.bindValue(QString{":%1"}.arg(*columnToUpdateInDb), bindValue);
+      sqlQuery.bindValue(QString{":%1"}.arg(*primaryKeyColumn), primaryKey);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+      return true;
+   }
+
+   /**
+    * \brief Write one junction table property of one object, touching only the rows that need to change since we last
+    *        wrote or read them.
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execJunctionTableWrite(QSqlDatabase & connection,
+                               int const primaryKey,
+                               JunctionTableWrite const & junctionTableWrite,
+                               unsigned int const writeFailuresSeen) {
+      qDebug() <<
+         Q_FUNC_INFO << "Updating property" << GetJunctionTableDefinitionPropertyName(*junctionTableWrite.junctionTable) <<
+         "in junction table" << junctionTableWrite.junctionTable->tableName;
+      //
+      // If a write for this store has failed since the RowWrite was captured then it might have been one that the
+      // persisted values were relying on, so we have to rewrite all the rows
+      //
+      bool const persistedValuesTrusted =
+         junctionTableWrite.persistedValues && this->writeFailures.load() == writeFailuresSeen;
+      return syncJunctionTableDefinition(this->statementCache,
+                                         *junctionTableWrite.junctionTable,
+                                         primaryKey,
+                                         persistedValuesTrusted ? &*junctionTableWrite.persistedValues : nullptr,
+                                         junctionTableWrite.newValues,
+                                         connection);
+   }
+
+   /**
+    * \brief Write the properties captured by \c captureProperty()
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execPropertyUpdates(QSqlDatabase & connection, RowWrite const & rowWrite) {
+      for (auto const & columnValue : rowWrite.columnValues) {
+         if (!this->execUpdateColumn(connection, rowWrite.primaryKey, columnValue.first, columnValue.second)) {
             return false;
          }
-         if (!insertIntoJunctionTableDefinition(*matchingJunctionTableDefinitionDefn, object, primaryKey, connection)) {
+      }
+      for (auto const & junctionTableWrite : rowWrite.junctionTableWrites) {
+         if (!this->execJunctionTableWrite(connection,
+                                           rowWrite.primaryKey,
+                                           junctionTableWrite,
+                                           rowWrite.writeFailuresSeen)) {
             return false;
          }
       }
+      return true;
+   }
+
+   /**
+    * \brief Write all the properties of an object, as captured by \c captureObject() with \c includePrimaryKey set
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execUpdate(QSqlDatabase & connection, RowWrite const & rowWrite) {
+      //
+      // Construct the SQL, which will be of the form
+      //
+      //    UPDATE tablename
+      //    SET firstColumn = :firstColumn, secondColumn = :secondColumn, ...
+      //    WHERE primaryKeyColumn = :primaryKeyColumn;
+      //
+      // The SQL is the same every time for a given table, so we construct and prepare it once per connection and then
+      // reuse it.
+      //
+      QString const primaryKeyColumn {*this->getPrimaryKeyColumn()};
+      auto cachedStatement = this->statementCache.get(
+         connection,
+         StatementKind::Update,
+         BtString::NULL_STR,
+         [&]() {
+            QString queryString{"UPDATE "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << this->primaryTable.tableName << " SET ";
+
+            bool skippedPrimaryKey = false;
+            bool firstFieldOutput = false;
+            for (auto const & fieldDefn: this->primaryTable.tableFields) {
+               if (!skippedPrimaryKey) {
+                  skippedPrimaryKey = true;
+               } else {
+                  if (!firstFieldOutput) {
+                     firstFieldOutput = true;
+                  } else {
+                     queryStringAsStream << ", ";
+                  }
+                  queryStringAsStream << " " << fieldDefn.columnName << " = :" << fieldDefn.columnName;
+               }
+            }
+
+            queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+            return queryString;
+         }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
+
+      //
+      // Bind the values.  Note that, because we're using bind names, it doesn't matter that the order in which we do the
+      // binds is different than the order in which the fields appear in the query.
+      //
+      for (auto const & columnValue : rowWrite.columnValues) {
+         sqlQuery.bindValue(QString{":"} + *this->primaryTable.tableFields[columnValue.first].columnName,
+                            columnValue.second);
+      }
+
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
 
-      // If we made it this far then everything worked
+      //
+      // Now update data in the junction tables.  Rather than blat all the rows relating to the current object and
+      // rewrite them, we compare the current property values with what we last wrote to the DB, and just do the
+      // deletes, inserts and order updates needed to sync them.  (For a large recipe, a change to one ingredient would
+      // otherwise rewrite dozens of rows.)
+      //
+      for (auto const & junctionTableWrite : rowWrite.junctionTableWrites) {
+         if (!this->execJunctionTableWrite(connection,
+                                           rowWrite.primaryKey,
+                                           junctionTableWrite,
+                                           rowWrite.writeFailuresSeen)) {
+            return false;
+         }
+      }
       return true;
    }
 
    /**
-    * \brief Insert an object in the database
+    * \brief Insert an object in the database, as captured by \c captureObject()
     *
     *        NB: Caller is responsible for handling transactions
     *
     * \param connection
-    * \param object
+    * \param rowWrite
     * \param writePrimaryKey Normally this is \c false, meaning we are going to let the DB assign a primary key to the
     *                        new object we are inserting.  However, if we are writing existing objects out to a new
     *                        database, then this will be \c true, meaning we write out the existing primary keys (to
     *                        keep any foreign key references to them valid.  (In this latter circumstance, we are also
     *                        assuming the caller has disabled foreign key constraints for the duration of the
-    *                        transaction.)
+    *                        transaction.)  Must match the \c includePrimaryKey parameter to \c captureObject().
     *
     * \return the primary key of the inserted object, or -1 if there was an error.  Note that, in the case that
     *         \c writePrimaryKey is \c false (ie we are inserting a new object), it is the \b caller's responsibility to
     *         update the object with its new primary key.
     */
-   int insertObjectInDb(QSqlDatabase & connection, QObject const & object, bool writePrimaryKey) {
+   int execInsert(QSqlDatabase & connection, RowWrite const & rowWrite, bool writePrimaryKey) {
       //
       // Construct the SQL, which will be of the form
       //
@@ -992,39 +1781,37 @@ public:
       // We omit the primary key column because we can't know its value in advance.  We'll find out what value the DB
       // assigned to it after the query was run -- see below.
       //
-      QString queryString{"INSERT INTO "};
-      QTextStream queryStringAsStream{&queryString};
-      queryStringAsStream << this->primaryTable.tableName << " (";
-      this->appendColumNames(queryStringAsStream, writePrimaryKey, false);
-      queryStringAsStream << ") VALUES (";
-      this->appendColumNames(queryStringAsStream, writePrimaryKey, true);
-      queryStringAsStream << ");";
+      // The SQL only depends on whether we are writing the primary key, so we only need to construct it once for each
+      // case (per connection).
+      //
+      auto cachedStatement = this->statementCache.get(
+         connection,
+         writePrimaryKey ? StatementKind::InsertWithPrimaryKey : StatementKind::Insert,
+         BtString::NULL_STR,
+         [&]() {
+            QString queryString{"INSERT INTO "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << this->primaryTable.tableName << " (";
+            this->appendColumNames(queryStringAsStream, writePrimaryKey, false);
+            queryStringAsStream << ") VALUES (";
+            this->appendColumNames(queryStringAsStream, writePrimaryKey, true);
+            queryStringAsStream << ");";
+            return queryString;
+         }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
 
       qDebug() <<
-         Q_FUNC_INFO << "Inserting" << object.metaObject()->className() << "main table row with database query " <<
+         Q_FUNC_INFO << "Inserting" << this->primaryTable.tableName << "main table row with database query " <<
          queryString;
 
       //
       // Bind the values
       //
-      BtSqlQuery sqlQuery{connection};
-      sqlQuery.prepare(queryString);
-      for (int ii = (writePrimaryKey ? 0 : 1); ii < this->primaryTable.tableFields.size(); ++ii) {
-         auto const & fieldDefn = this->primaryTable.tableFields[ii];
-
-         QVariant bindValue{object.property(*fieldDefn.propertyName)};
-
-         // Fix-up the QVariant if needed, including converting enums to strings
-         this->unwrapAndMapAsNeeded(this->primaryTable, fieldDefn, bindValue);
-
-         if (fieldDefn.foreignKeyTo && bindValue.toInt() <= 0) {
-            // If the field is a foreign key and the value we would otherwise put in it is not a valid key (eg we are
-            // inserting a Recipe on which the Equipment has not yet been set) then the query would barf at the invalid
-            // key.  So, in this case, we need to insert NULL.
-            bindValue = QVariant();
-         }
-
-         sqlQuery.bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
+      for (auto const & columnValue : rowWrite.columnValues) {
+         sqlQuery.bindValue(QString{":"} + *this->primaryTable.tableFields[columnValue.first].columnName,
+                            columnValue.second);
       }
 
       qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
@@ -1038,7 +1825,7 @@ public:
          return -1;
       }
 
-      int currentPrimaryKey = object.property(*this->getPrimaryKeyProperty()).toInt();
+      int const currentPrimaryKey = rowWrite.primaryKey;
       int primaryKeyInDb;
       if (writePrimaryKey) {
          //
@@ -1081,21 +1868,24 @@ public:
          if (currentPrimaryKey > 0) {
             // This is almost certainly a coding error
             qCritical() <<
-               Q_FUNC_INFO << "Wrote new" << object.metaObject()->className() << " to database (with primary key " <<
+               Q_FUNC_INFO << "Wrote new" << this->primaryTable.tableName << " to database (with primary key " <<
                primaryKeyInDb << ") but it already had primary key" << currentPrimaryKey;
             Q_ASSERT(false); // Stop here on debug build
          }
       }
 
       qDebug() <<
-         Q_FUNC_INFO << object.metaObject()->className() << "#" << primaryKeyInDb << "inserted in database using" <<
+         Q_FUNC_INFO << this->primaryTable.tableName << "#" << primaryKeyInDb << "inserted in database using" <<
          queryString;
 
       //
       // Now save data to the junction tables
       //
-      for (auto const & junctionTable : this->junctionTables) {
-         if (!insertIntoJunctionTableDefinition(junctionTable, object, primaryKeyInDb, connection)) {
+      for (auto const & junctionTableWrite : rowWrite.junctionTableWrites) {
+         if (!insertJunctionTableRows(this->statementCache,
+                                      *junctionTableWrite.junctionTable,
+                                      numberJunctionTableRows(primaryKeyInDb, junctionTableWrite.newValues),
+                                      connection)) {
             qCritical() <<
                Q_FUNC_INFO << "Error writing to junction tables:" << connection.lastError().text();
             return -1;
@@ -1105,11 +1895,454 @@ public:
       return primaryKeyInDb;
    }
 
+   /**
+    * \brief Insert a number of objects, keeping their existing primary keys, using multi-row INSERT statements for
+    *        both the primary table and the junction tables.  Used for writing all objects to a new database (see
+    *        \c ObjectStore::writeAllToNewDb()), where running one statement per row means one round-trip per row,
+    *        which is very slow for PostgreSQL.
+    *
+    *        As in \c insertJunctionTableRows(), each statement inserts a power-of-two number of rows, using positional
+    *        bind values.  The SQL will be of the form:
+    *
+    *           INSERT INTO tablename (firstColumn, secondColumn, ...)
+    *           VALUES (?, ?, ...), (?, ?, ...), ..., (?, ?, ...);
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \param connection
+    * \param rowWrites  Captured (by \c captureObject()) including the primary key column
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execBulkInsertWithPrimaryKey(QSqlDatabase & connection, QVector<RowWrite> const & rowWrites) {
+      int const numColumns = this->primaryTable.tableFields.size();
+      int rowsPerStatement = rowsPerMultiRowInsert(connection, numColumns, maxRowsPerBulkInsert);
+
+      qDebug() <<
+         Q_FUNC_INFO << "Inserting" << rowWrites.size() << "row(s) into" << this->primaryTable.tableName <<
+         "with up to" << rowsPerStatement << "row(s) per statement";
+
+      for (int rowsDone = 0; rowsDone < rowWrites.size(); ) {
+         while (rowsPerStatement > rowWrites.size() - rowsDone) {
+            rowsPerStatement /= 2;
+         }
+
+         auto cachedStatement = this->statementCache.get(
+            connection,
+            StatementKind::BulkInsertWithPrimaryKey,
+            QString::number(rowsPerStatement),
+            [&]() {
+               QString queryString{"INSERT INTO "};
+               QTextStream queryStringAsStream{&queryString};
+               queryStringAsStream << this->primaryTable.tableName << " (";
+               this->appendColumNames(queryStringAsStream, true, false);
+               queryStringAsStream << ") VALUES ";
+               QString placeholders{"("};
+               for (int ii = 0; ii < numColumns; ++ii) {
+                  placeholders += (ii == 0 ? "?" : ", ?");
+               }
+               placeholders += ")";
+               for (int ii = 0; ii < rowsPerStatement; ++ii) {
+                  queryStringAsStream << (ii == 0 ? "" : ", ") << placeholders;
+               }
+               queryStringAsStream << ";";
+               return queryString;
+            }
+         );
+         QString const & queryString = cachedStatement->queryString;
+         BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
+
+         int bindPosition = 0;
+         for (int ii = rowsDone; ii < rowsDone + rowsPerStatement; ++ii) {
+            // Because the primary key was included in the capture, columnValues is in the same order as tableFields
+            Q_ASSERT(rowWrites.at(ii).columnValues.size() == numColumns);
+            for (auto const & columnValue : rowWrites.at(ii).columnValues) {
+               sqlQuery.bindValue(bindPosition++, columnValue.second);
+            }
+         }
+
+         if (!sqlQuery.exec()) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+            return false;
+         }
+         rowsDone += rowsPerStatement;
+      }
+
+      //
+      // Now the junction tables.  We gather up the rows for all the objects so that, eg, hop additions for lots of
+      // different recipes get written together.
+      //
+      for (auto const & junctionTable : this->junctionTables) {
+         QVector<JunctionTableRow> rows;
+         for (auto const & rowWrite : rowWrites) {
+            for (auto const & junctionTableWrite : rowWrite.junctionTableWrites) {
+               if (junctionTableWrite.junctionTable == &junctionTable) {
+                  numberJunctionTableRows(rowWrite.primaryKey, junctionTableWrite.newValues, rows);
+               }
+            }
+         }
+         if (!insertJunctionTableRows(this->statementCache, junctionTable, rows, connection)) {
+            qCritical() <<
+               Q_FUNC_INFO << "Error writing to junction table" << junctionTable.tableName << ":" <<
+               connection.lastError().text();
+            return false;
+         }
+      }
+
+      return true;
+   }
+
+   /**
+    * \brief Delete an object, and its junction table rows, from the database
+    *
+    *        NB: Caller is responsible for handling transactions
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool execHardDelete(QSqlDatabase & connection, int const id) {
+      //
+      // Construct the SQL, which will be of the form
+      //
+      //    DELETE FROM tablename
+      //    WHERE primaryKeyColumn = :primaryKeyColumn;
+      //
+      BtStringConst const & primaryKeyColumn = this->getPrimaryKeyColumn();
+      auto cachedStatement = this->statementCache.get(
+         connection,
+         StatementKind::HardDelete,
+         BtString::NULL_STR,
+         [&]() {
+            QString queryString{"DELETE FROM "};
+            QTextStream queryStringAsStream{&queryString};
+            queryStringAsStream << this->primaryTable.tableName;
+            queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+            return queryString;
+         }
+      );
+      QString const & queryString = cachedStatement->queryString;
+      BtSqlQuery & sqlQuery = cachedStatement->sqlQuery;
+      qDebug() <<
+         Q_FUNC_INFO << "Deleting main table row #" << id << "with database query " << queryString;
+
+      //
+      // Bind the value
+      //
+      QVariant primaryKey{id};
+      sqlQuery.bindValue(QString{":"} + *primaryKeyColumn, primaryKey);
+      qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
+
+      //
+      // Run the query
+      //
+      if (!sqlQuery.exec()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return false;
+      }
+
+      //
+      // Now remove data in the junction tables
+      //
+      for (auto const & junctionTable : this->junctionTables) {
+         if (!deleteFromJunctionTableDefinition(this->statementCache, junctionTable, primaryKey, connection)) {
+            // We'll have already logged errors in deleteFromJunctionTableDefinition().  Not much more we can do other
+            // than bail here.
+            return false;
+         }
+      }
+      return true;
+   }
+
+   /**
+    * \brief Discard what we know about the junction table rows stored in the DB for an object (eg because the object
+    *        has been deleted or because a transaction that wrote them was rolled back)
+    */
+   void forgetPersistedJunctionValues(int const primaryKey) {
+      for (auto & persistedValuesForTable : this->persistedJunctionValues) {
+         persistedValuesForTable.remove(primaryKey);
+      }
+      return;
+   }
+
+   /**
+    * \brief Set up empty secondary indexes for all the indexed properties.
+    *
+    *        NB: We can't do this in the constructor, as, for the object store singletons, there are no guarantees about
+    *        whether the index definitions have been initialised at the point the store is constructed.
+    */
+   void resetSecondaryIndexes() {
+      this->secondaryIndexes.clear();
+      for (auto const propertyName : this->secondaryIndexDefinitions) {
+         this->secondaryIndexes.insert(**propertyName, SecondaryIndex{});
+      }
+      return;
+   }
+
+   /**
+    * \brief Get the key under which a property value is stored in a secondary index
+    */
+   static QString secondaryIndexKey(QVariant const & value) {
+      return value.toString();
+   }
+
+   /**
+    * \brief Get the key(s) under which an object's property value is stored in a secondary index.  This is usually one
+    *        key, but a list of IDs gives one key per ID.
+    */
+   static QStringList secondaryIndexKeys(QVariant const & value) {
+      QStringList keys;
+      if (value.userType() == qMetaTypeId<QVector<int> >()) {
+         QVector<int> const ids = value.value<QVector<int> >();
+         keys.reserve(ids.size());
+         for (int const id : ids) {
+            keys.append(QString::number(id));
+         }
+         keys.removeDuplicates();
+      } else {
+         keys.append(secondaryIndexKey(value));
+      }
+      return keys;
+   }
+
+   /**
+    * \brief Set (or reset) the entry for an object in one secondary index from the object's current property value
+    */
+   void indexProperty(SecondaryIndex & secondaryIndex,
+                      QString const & propertyName,
+                      int const primaryKey,
+                      QObject const & object) {
+      QStringList const newKeys = secondaryIndexKeys(object.property(propertyName.toLatin1().constData()));
+      auto existing = secondaryIndex.keysById.constFind(primaryKey);
+      if (existing != secondaryIndex.keysById.cend()) {
+         if (*existing == newKeys) {
+            return;
+         }
+         for (auto const & oldKey : *existing) {
+            secondaryIndex.idsByKey[oldKey].remove(primaryKey);
+         }
+      }
+      secondaryIndex.keysById.insert(primaryKey, newKeys);
+      for (auto const & newKey : newKeys) {
+         secondaryIndex.idsByKey[newKey].insert(primaryKey);
+      }
+      return;
+   }
+
+   /**
+    * \brief Add or refresh the entries for an object in all secondary indexes
+    */
+   void indexObject(int const primaryKey, QObject const & object) {
+      for (auto ii = this->secondaryIndexes.begin(); ii != this->secondaryIndexes.end(); ++ii) {
+         this->indexProperty(ii.value(), ii.key(), primaryKey, object);
+      }
+      return;
+   }
+
+   /**
+    * \brief Refresh the entry for an object in the secondary index for the supplied property, if there is one
+    */
+   void indexObjectProperty(int const primaryKey, QObject const & object, BtStringConst const & propertyName) {
+      auto secondaryIndex = this->secondaryIndexes.find(*propertyName);
+      if (secondaryIndex != this->secondaryIndexes.end()) {
+         this->indexProperty(secondaryIndex.value(), secondaryIndex.key(), primaryKey, object);
+      }
+      return;
+   }
+
+   /**
+    * \brief Remove an object from all secondary indexes (eg because it has been deleted)
+    */
+   void unindexObject(int const primaryKey) {
+      for (auto & secondaryIndex : this->secondaryIndexes) {
+         auto existing = secondaryIndex.keysById.find(primaryKey);
+         if (existing != secondaryIndex.keysById.end()) {
+            for (auto const & oldKey : *existing) {
+               secondaryIndex.idsByKey[oldKey].remove(primaryKey);
+            }
+            secondaryIndex.keysById.erase(existing);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Add a property update to the write-behind queue, and make sure it will get written.  See
+    *        \c ObjectStore::updateProperty for more details.
+    */
+   void queuePropertyUpdate(ObjectStore const & objectStore, int const primaryKey, BtStringConst const & propertyName) {
+      //
+      // Property names are always compile-time constants (eg PropertyNames::Hop::alpha), so it's safe to hold on to
+      // the underlying pointer.  If the property is already queued, there's nothing to do, as we always write the
+      // current value.
+      //
+      auto const lookupKey = qMakePair(primaryKey, QByteArray{*propertyName});
+      if (this->queuedPropertyUpdatesLookup.contains(lookupKey)) {
+         return;
+      }
+      this->queuedPropertyUpdatesLookup.insert(lookupKey);
+      this->queuedPropertyUpdates.append(qMakePair(primaryKey, *propertyName));
+
+      if (this->queuedPropertyUpdates.size() >= maxQueuedPropertyUpdates) {
+         //
+         // We don't wait for the write here, as the whole point is not to hold up whatever is making all the changes.
+         // If it fails, DbWriter will have logged it, and counted it in both our writeFailures and the result of the
+         // next DbWriter::waitForIdle() (eg via FlushAllObjectStores()), which is how callers find out.
+         //
+         objectStore.flush();
+         return;
+      }
+
+      //
+      // A zero-interval single-shot timer fires once the event loop has processed all pending events -- ie as soon as
+      // whatever burst of changes we're in the middle of has finished.  We create the timer on first use rather than in
+      // the constructor because object stores are constructed before the QApplication object exists.
+      //
+      if (!this->flushTimer) {
+         this->flushTimer = std::make_unique<QTimer>();
+         this->flushTimer->setSingleShot(true);
+         this->flushTimer->setInterval(0);
+         QObject::connect(this->flushTimer.get(), &QTimer::timeout, &objectStore, &ObjectStore::flush);
+      }
+      if (!this->flushTimer->isActive()) {
+         this->flushTimer->start();
+      }
+      return;
+   }
+
+   /**
+    * \brief Note, in the current transaction journal (if there is one) that an object was inserted.  See
+    *        \c ObjectStore::startTransactionJournal().
+    */
+   void journalInsert(int const primaryKey, std::shared_ptr<QObject> object) {
+      if (!this->transactionJournals.isEmpty()) {
+         this->transactionJournals.last().insertedObjects.insert(primaryKey, object);
+      }
+      return;
+   }
+
+   /**
+    * \brief Note, in the current transaction journal (if there is one) that an object was removed from the cache
+    */
+   void journalRemoval(int const primaryKey, std::shared_ptr<QObject> object) {
+      if (!this->transactionJournals.isEmpty() && object) {
+         this->transactionJournals.last().removedObjects.insert(primaryKey, object);
+      }
+      return;
+   }
+
+   /**
+    * \brief Note, in the current transaction journal (if there is one) that an object was updated
+    */
+   void journalUpdate(int const primaryKey) {
+      if (!this->transactionJournals.isEmpty()) {
+         this->transactionJournals.last().updatedIds.insert(primaryKey);
+      }
+      return;
+   }
+
+   /**
+    * \brief After a transaction has been rolled back, reread the table (and its junction tables) and put what's in the
+    *        DB back into the supplied objects.  Also resets what we know about the junction table contents.
+    */
+   void reloadFromDb(ObjectStore const & objectStore, QSet<int> const & primaryKeys) {
+      auto loadedData = objectStore.readAllFromDb(*this->database);
+      if (!loadedData->succeeded) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to reread" << this->primaryTable.tableName << "after rollback, so" <<
+            primaryKeys.size() << "object(s) may not match the DB";
+         return;
+      }
+
+      //
+      // We've just read everything that's in the junction tables, so we can go back to trusting our knowledge of it.
+      // We need to do this before setting any properties below, so that the writes it triggers are no-ops.
+      //
+      this->writeFailuresSeen = this->writeFailures.load();
+      for (int jj = 0; jj < this->junctionTables.size(); ++jj) {
+         auto & persistedValuesForTable = this->persistedJunctionValues[*this->junctionTables.at(jj).tableName];
+         persistedValuesForTable.clear();
+         for (int const objectKey : this->allObjects.keys()) {
+            persistedValuesForTable.insert(objectKey, loadedData->junctionTableValues.at(jj).value(objectKey));
+         }
+      }
+
+      QHash<int, int> rowByPrimaryKey;
+      for (int ii = 0; ii < loadedData->primaryKeys.size(); ++ii) {
+         rowByPrimaryKey.insert(loadedData->primaryKeys.at(ii), ii);
+      }
+
+      for (int const primaryKey : primaryKeys) {
+         auto object = this->allObjects.value(primaryKey);
+         if (!object || !rowByPrimaryKey.contains(primaryKey)) {
+            continue;
+         }
+         qDebug() <<
+            Q_FUNC_INFO << "Reloading" << object->metaObject()->className() << "#" << primaryKey << "from" <<
+            this->primaryTable.tableName;
+         NamedParameterBundle const & namedParameterBundle =
+            loadedData->namedParameterBundles.at(rowByPrimaryKey.value(primaryKey));
+         // Primary key is the first field, and isn't going to have changed
+         for (int ii = 1; ii < this->primaryTable.tableFields.size(); ++ii) {
+            BtStringConst const & propertyName = this->primaryTable.tableFields.at(ii).propertyName;
+            if (propertyName.isNull()) {
+               continue;
+            }
+            QVariant const valueInDb = namedParameterBundle.get(propertyName);
+            if (object->property(*propertyName) != valueInDb) {
+               object->setProperty(*propertyName, valueInDb);
+            }
+         }
+         for (int jj = 0; jj < this->junctionTables.size(); ++jj) {
+            auto const & junctionTable = this->junctionTables.at(jj);
+            QVector<int> const otherKeys = loadedData->junctionTableValues.at(jj).value(primaryKey);
+            BtStringConst const & propertyName = GetJunctionTableDefinitionPropertyName(junctionTable);
+            // See comments in ObjectStore::loadAll() for why we set junction table properties the way we do
+            if (junctionTable.assumedNumEntries == ObjectStore::MAX_ONE_ENTRY) {
+               if (!otherKeys.isEmpty()) {
+                  object->setProperty(*propertyName, otherKeys.first());
+               }
+            } else {
+               object->setProperty(*propertyName, QVariant::fromValue(otherKeys));
+            }
+         }
+         this->indexObject(primaryKey, *object);
+      }
+      return;
+   }
+
    TypeLookup const & typeLookup;
    TableDefinition const & primaryTable;
    JunctionTableDefinitions const & junctionTables;
    QHash<int, std::shared_ptr<QObject> > allObjects;
    Database * database;
+   StatementCache statementCache;
+   // Write-behind queue of (primary key, property name) pairs -- see ObjectStore::updateProperty()
+   QVector<QPair<int, char const *> > queuedPropertyUpdates;
+   // Same contents as queuedPropertyUpdates, to allow quick checking for duplicates
+   QSet<QPair<int, QByteArray> > queuedPropertyUpdatesLookup;
+   std::unique_ptr<QTimer> flushTimer;
+   //
+   // For each junction table (by name), the list of "other" IDs that we last wrote to, or read from, the DB for each
+   // object.  This allows us to write only what has changed when an object's junction table properties are updated.
+   // If there is no entry for an object then we don't know what's in the DB, and will rewrite all its rows.
+   //
+   QHash<QString, QHash<int, QVector<int> > > persistedJunctionValues;
+   SecondaryIndexDefinitions const & secondaryIndexDefinitions;
+   // Secondary indexes, by property name
+   QHash<QString, SecondaryIndex> secondaryIndexes;
+   // Set once loadAll() has succeeded
+   bool loaded;
+   // Number of writes for this store that have failed on the DB writer thread -- see checkForWriteFailures()
+   std::atomic<unsigned int> writeFailures;
+   // The value of writeFailures when persistedJunctionValues was last known to be good
+   unsigned int writeFailuresSeen;
+   // Number of calls to startBulkInsert() not yet matched by a call to finishBulkInsert()
+   unsigned int bulkInsertDepth;
+   // IDs of objects inserted during a bulk insert, for which we have yet to emit a signal
+   QVector<int> deferredInsertedIds;
+   // One entry for each call to ObjectStore::startTransactionJournal() not yet matched by finishTransactionJournal()
+   QVector<TransactionJournal> transactionJournals;
 };
 
 QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
@@ -1130,10 +2363,11 @@ QString ObjectStore::getDisplayName(ObjectStore::FieldType const fieldType) {
    Q_ASSERT(false);
 }
 
-ObjectStore::ObjectStore(TypeLookup               const & typeLookup,
-                         TableDefinition          const & primaryTable,
-                         JunctionTableDefinitions const & junctionTables) :
-   pimpl{ std::make_unique<impl>(typeLookup, primaryTable, junctionTables) } {
+ObjectStore::ObjectStore(TypeLookup                const & typeLookup,
+                         TableDefinition           const & primaryTable,
+                         JunctionTableDefinitions  const & junctionTables,
+                         SecondaryIndexDefinitions const & secondaryIndexes) :
+   pimpl{ std::make_unique<impl>(typeLookup, primaryTable, junctionTables, secondaryIndexes) } {
    qDebug() << Q_FUNC_INFO << "Construct of object store for primary table" << this->pimpl->primaryTable.tableName;
    // We have seen a circumstance where primaryTable.tableName is null, which shouldn't be possible.  This is some
    // diagnostic to try to find out why.
@@ -1195,12 +2429,14 @@ bool ObjectStore::createTables(Database & database, QSqlDatabase & connection) c
 bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connection) const {
    // This is all pretty much the same structure as createTables(), so I won't repeat all the comments here
 
-   if (!addForeignKeysToTable(database, connection, this->pimpl->primaryTable)) {
+   if (!addForeignKeysToTable(database, connection, this->pimpl->primaryTable) ||
+       !addForeignKeyIndexesToTable(connection, this->pimpl->primaryTable)) {
       return false;
    }
 
    for (auto const & junctionTable : this->pimpl->junctionTables) {
-      if (!addForeignKeysToTable(database, connection, junctionTable)) {
+      if (!addForeignKeysToTable(database, connection, junctionTable) ||
+          !addForeignKeyIndexesToTable(connection, junctionTable)) {
          return false;
       }
    }
@@ -1208,19 +2444,18 @@ bool ObjectStore::addTableConstraints(Database & database, QSqlDatabase & connec
    return true;
 }
 
-void ObjectStore::loadAll(Database * database) {
-   if (database) {
-      this->pimpl->database = database;
-   } else {
-      this->pimpl->database = &Database::instance();
-   }
+std::shared_ptr<ObjectStore::LoadedData> ObjectStore::readAllFromDb(Database & database) const {
+   auto loadedData = std::make_shared<LoadedData>();
 
    // Start transaction
    // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
    //
    // .:TBD:. In theory we don't need a transaction if we're _only_ reading data...
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
+   //
+   // NB: We may be running on a worker thread here (see LoadAllObjectStores()), in which case Database::sqlDatabase()
+   //     gives us a connection for that thread.
+   QSqlDatabase connection = database.sqlDatabase();
+   DbTransaction dbTransaction{database, connection};
 
    //
    // Using QSqlTableModel would save us having to write a SELECT statement, however it is a bit hard to use it to
@@ -1237,17 +2472,46 @@ void ObjectStore::loadAll(Database * database) {
    this->pimpl->appendColumNames(queryStringAsStream, true, false);
    queryStringAsStream << "\n FROM " << this->pimpl->primaryTable.tableName << ";";
    BtSqlQuery sqlQuery{connection};
+   // We only ever step forward through the results, and telling Qt this saves it caching rows we've already read
+   sqlQuery.setForwardOnly(true);
    sqlQuery.prepare(queryString);
    if (!sqlQuery.exec()) {
       qCritical() <<
          Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return;
+      return loadedData;
    }
 
    qDebug() <<
       Q_FUNC_INFO << "Reading main table rows from" << this->pimpl->primaryTable.tableName <<
       "database table using query " << queryString;
 
+   //
+   // Looking up a column by name in QSqlQuery::value() is a linear search through the record's fields, which adds up
+   // when done for every field of every row.  So we resolve the column indexes once here and then read by index.
+   //
+   auto const & tableFields = this->pimpl->primaryTable.tableFields;
+   QVector<int> columnIndexes;
+   columnIndexes.reserve(tableFields.size());
+   QSqlRecord const record = sqlQuery.record();
+   for (auto const & fieldDefn : tableFields) {
+      int const columnIndex = record.indexOf(*fieldDefn.columnName);
+      if (columnIndex < 0) {
+         qCritical() <<
+            Q_FUNC_INFO << "Unable to find column" << fieldDefn.columnName << "in results of query" << queryString;
+         return loadedData;
+      }
+      columnIndexes.append(columnIndex);
+   }
+
+   //
+   // If the DB driver can tell us how many rows we're getting, we can avoid repeated reallocations as we store them.
+   // (QSqlQuery::size() returns -1 where this is not supported, eg for SQLite.)
+   //
+   if (sqlQuery.size() > 0) {
+      loadedData->namedParameterBundles.reserve(sqlQuery.size());
+      loadedData->primaryKeys.reserve(sqlQuery.size());
+   }
+
    while (sqlQuery.next()) {
       //
       // We want to pull all the fields for the current row from the database and use them to construct a new
@@ -1283,6 +2547,7 @@ void ObjectStore::loadAll(Database * database) {
       // QHash.
       //
       NamedParameterBundle namedParameterBundle;
+      namedParameterBundle.reserve(tableFields.size());
       int primaryKey = -1;
 
       //
@@ -1293,8 +2558,9 @@ void ObjectStore::loadAll(Database * database) {
       //     allow a wider range of types.
       //
       bool readPrimaryKey = false;
-      for (auto const & fieldDefn : this->pimpl->primaryTable.tableFields) {
-         QVariant fieldValue = sqlQuery.value(*fieldDefn.columnName);
+      for (int ii = 0; ii < tableFields.size(); ++ii) {
+         auto const & fieldDefn = tableFields.at(ii);
+         QVariant fieldValue = sqlQuery.value(columnIndexes.at(ii));
          //qDebug() <<
          //   Q_FUNC_INFO << "Reading col" << fieldDefn.columnName << "(=" << fieldValue << ") into property" <<
          //   fieldDefn.propertyName;
@@ -1323,22 +2589,16 @@ void ObjectStore::loadAll(Database * database) {
          }
       }
 
-      // Get a new object...
-      auto object = this->createNewObject(namedParameterBundle);
-
-      // ...and store it
-      // It's a coding error if we have two objects with the same primary key
-      Q_ASSERT(!this->pimpl->allObjects.contains(primaryKey));
-      this->pimpl->allObjects.insert(primaryKey, object);
-      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
-      // enable for debugging.
-//      qDebug() <<
-//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
-//         this->metaObject()->className();
+      //
+      // We don't create the object here, as we might not be on the thread that is going to own it.  That happens in
+      // loadAll().
+      //
+      loadedData->namedParameterBundles.append(std::move(namedParameterBundle));
+      loadedData->primaryKeys.append(primaryKey);
    }
 
    qDebug() <<
-      Q_FUNC_INFO << "Read" << this->pimpl->allObjects.size() << "entries from primary table" <<
+      Q_FUNC_INFO << "Read" << loadedData->primaryKeys.size() << "entries from primary table" <<
       this->pimpl->primaryTable.tableName;
 
    //
@@ -1375,28 +2635,96 @@ void ObjectStore::loadAll(Database * database) {
       if (!sqlQuery.exec()) {
          qCritical() <<
             Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
+         return loadedData;
+      }
+
+      qDebug() << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
+
+      //
+      // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory, then loop
+      // through this to pass the data to the relevant objects.
+      //
+      int previousPrimaryKey = -1;
+      QMap< int, QVector<int> > thisToOtherKeys;
+      while (sqlQuery.next()) {
+         int thisPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable)).toInt();
+         int otherPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable)).toInt();
+         qDebug() << Q_FUNC_INFO << "Interim store of" << thisPrimaryKey << "<->" << otherPrimaryKey;
+
+         if (thisPrimaryKey != previousPrimaryKey) {
+            thisToOtherKeys.insert(thisPrimaryKey, QVector<int>{});
+            previousPrimaryKey = thisPrimaryKey;
+         }
+         Q_ASSERT(thisToOtherKeys.contains(thisPrimaryKey));
+         thisToOtherKeys[thisPrimaryKey].append(otherPrimaryKey);
+      }
+
+      loadedData->junctionTableValues.append(thisToOtherKeys);
+   }
+
+   dbTransaction.commit();
+   loadedData->succeeded = true;
+   return loadedData;
+}
+
+void ObjectStore::loadAll(Database * database, std::shared_ptr<LoadedData> loadedData) {
+   if (database) {
+      this->pimpl->database = database;
+   } else {
+      this->pimpl->database = &Database::instance();
+   }
+
+   //
+   // If we weren't given the data (or the attempt to read it elsewhere failed), read it now
+   //
+   if (!loadedData || !loadedData->succeeded) {
+      if (loadedData) {
+         qInfo() <<
+            Q_FUNC_INFO << "Earlier read of" << this->pimpl->primaryTable.tableName << "failed; retrying on this thread";
+      }
+      loadedData = this->readAllFromDb(*this->pimpl->database);
+      if (!loadedData->succeeded) {
          return;
       }
+   }
+
+   this->pimpl->resetSecondaryIndexes();
+   for (int ii = 0; ii < loadedData->primaryKeys.size(); ++ii) {
+      int const primaryKey = loadedData->primaryKeys.at(ii);
+
+      // Get a new object...
+      auto object = this->createNewObject(loadedData->namedParameterBundles[ii]);
+
+      // ...and store it
+      // It's a coding error if we have two objects with the same primary key
+      Q_ASSERT(!this->pimpl->allObjects.contains(primaryKey));
+      this->pimpl->allObjects.insert(primaryKey, object);
+      // Normally leave this debug output commented, as it generates a lot of logging at start-up, but can be useful to
+      // enable for debugging.
+//      qDebug() <<
+//         Q_FUNC_INFO << "Cached" << object->metaObject()->className() << "#" << primaryKey << "in" <<
+//         this->metaObject()->className();
+   }
+
+   qDebug() <<
+      Q_FUNC_INFO << "Created" << this->pimpl->allObjects.size() << "objects from primary table" <<
+      this->pimpl->primaryTable.tableName;
 
-      qDebug() << Q_FUNC_INFO << "Reading junction table rows from database query " << queryString;
+   Q_ASSERT(loadedData->junctionTableValues.size() == this->pimpl->junctionTables.size());
+   // What we're about to record as being in the junction tables is now what we trust (see checkForWriteFailures())
+   this->pimpl->writeFailuresSeen = this->pimpl->writeFailures.load();
+   for (int jj = 0; jj < this->pimpl->junctionTables.size(); ++jj) {
+      auto const & junctionTable = this->pimpl->junctionTables.at(jj);
+      auto const & thisToOtherKeys = loadedData->junctionTableValues.at(jj);
 
       //
-      // The simplest way to process the data is first to build the ID-to-ordered-list-of-IDs map in memory, then loop
-      // through this to pass the data to the relevant objects.
+      // Remember what's in the DB for each object so that subsequent updates can just write what has changed.  Objects
+      // with no rows in the junction table need an (empty) entry too.
       //
-      int previousPrimaryKey = -1;
-      QMap< int, QVector<int> > thisToOtherKeys;
-      while (sqlQuery.next()) {
-         int thisPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionThisPrimaryKeyColumn(junctionTable)).toInt();
-         int otherPrimaryKey = sqlQuery.value(*GetJunctionTableDefinitionOtherPrimaryKeyColumn(junctionTable)).toInt();
-         qDebug() << Q_FUNC_INFO << "Interim store of" << thisPrimaryKey << "<->" << otherPrimaryKey;
-
-         if (thisPrimaryKey != previousPrimaryKey) {
-            thisToOtherKeys.insert(thisPrimaryKey, QVector<int>{});
-            previousPrimaryKey = thisPrimaryKey;
-         }
-         Q_ASSERT(thisToOtherKeys.contains(thisPrimaryKey));
-         thisToOtherKeys[thisPrimaryKey].append(otherPrimaryKey);
+      auto & persistedValuesForTable = this->pimpl->persistedJunctionValues[*junctionTable.tableName];
+      persistedValuesForTable.clear();
+      for (int const objectKey : this->pimpl->allObjects.keys()) {
+         persistedValuesForTable.insert(objectKey, thisToOtherKeys.value(objectKey));
       }
 
       for (auto currentMapping = thisToOtherKeys.cbegin();
@@ -1459,7 +2787,7 @@ void ObjectStore::loadAll(Database * database) {
                Q_FUNC_INFO << "Unable to set property" << GetJunctionTableDefinitionPropertyName(junctionTable) <<
                "on" << currentObject->metaObject()->className();
             Q_ASSERT(false); // Stop here on a debug build
-            return;          // Continue but abort the transaction on a non-debug build
+            return;          // Continue on a non-debug build
          }
 
          // This is useful for debugging but I usually leave it commented out as it generates a lot of logging at
@@ -1473,10 +2801,159 @@ void ObjectStore::loadAll(Database * database) {
       }
    }
 
-   dbTransaction.commit();
+   //
+   // Now all the properties are set (including from junction tables), we can build the secondary indexes
+   //
+   for (auto ii = this->pimpl->allObjects.cbegin(); ii != this->pimpl->allObjects.cend(); ++ii) {
+      this->pimpl->indexObject(ii.key(), *ii.value());
+   }
+
+   this->pimpl->loaded = true;
    return;
 }
 
+bool ObjectStore::isLoaded() const {
+   return this->pimpl->loaded;
+}
+
+bool ObjectStore::writeSnapshot(QDataStream & out) const {
+   auto const & tableFields = this->pimpl->primaryTable.tableFields;
+
+   //
+   // We start with the table and column names, so that readSnapshot() can check that it's reading something that was
+   // written with the same table layout.
+   //
+   QStringList columnNames;
+   for (auto const & fieldDefn : tableFields) {
+      columnNames.append(*fieldDefn.columnName);
+   }
+   out << QString{*this->pimpl->primaryTable.tableName} << columnNames;
+
+   // Writing in primary key order means the same data always gives the same snapshot
+   QList<int> primaryKeys = this->pimpl->allObjects.keys();
+   std::sort(primaryKeys.begin(), primaryKeys.end());
+
+   //
+   // Each row is written as the values we would bind to an INSERT or UPDATE for this object, ie the same values that
+   // readAllFromDb() would get back from the DB.
+   //
+   out << static_cast<qint32>(primaryKeys.size());
+   QVector<QVariant> rowValues(tableFields.size());
+   for (int const primaryKey : primaryKeys) {
+      QObject const & object = *this->pimpl->allObjects.value(primaryKey);
+      for (int ii = 0; ii < tableFields.size(); ++ii) {
+         auto const & fieldDefn = tableFields.at(ii);
+         QVariant fieldValue = object.property(*fieldDefn.propertyName);
+         this->pimpl->unwrapAndMapAsNeeded(this->pimpl->primaryTable, fieldDefn, fieldValue);
+         rowValues[ii] = fieldValue;
+      }
+      out << rowValues;
+   }
+
+   //
+   // Then the junction table contents, in the same form that readAllFromDb() builds them, ie only objects that have
+   // at least one row in the junction table get an entry, and the other IDs are in the same order that the query
+   // there returns them: by the order column if the junction table has one (eg for instructions in a recipe, where
+   // the order is the whole point), or by ID otherwise.
+   //
+   out << static_cast<qint32>(this->pimpl->junctionTables.size());
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      bool const hasOrderColumn = !GetJunctionTableDefinitionOrderByColumn(junctionTable).isNull();
+      QMap<int, QVector<int> > thisToOtherKeys;
+      for (int const primaryKey : primaryKeys) {
+         QVector<int> otherKeys;
+         if (!readJunctionTableProperty(junctionTable,
+                                        *this->pimpl->allObjects.value(primaryKey),
+                                        QVariant{primaryKey},
+                                        otherKeys)) {
+            return false;
+         }
+         if (!otherKeys.isEmpty()) {
+            if (!hasOrderColumn) {
+               std::sort(otherKeys.begin(), otherKeys.end());
+            }
+            thisToOtherKeys.insert(primaryKey, otherKeys);
+         }
+      }
+      out << QString{*junctionTable.tableName} << thisToOtherKeys;
+   }
+
+   return out.status() == QDataStream::Ok;
+}
+
+std::shared_ptr<ObjectStore::LoadedData> ObjectStore::readSnapshot(QDataStream & in) const {
+   auto loadedData = std::make_shared<LoadedData>();
+   auto const & tableFields = this->pimpl->primaryTable.tableFields;
+
+   QString tableName;
+   QStringList columnNames;
+   in >> tableName >> columnNames;
+   QStringList expectedColumnNames;
+   for (auto const & fieldDefn : tableFields) {
+      expectedColumnNames.append(*fieldDefn.columnName);
+   }
+   if (tableName != *this->pimpl->primaryTable.tableName || columnNames != expectedColumnNames) {
+      qWarning() <<
+         Q_FUNC_INFO << "Snapshot has" << tableName << columnNames << "but expected" <<
+         this->pimpl->primaryTable.tableName << expectedColumnNames;
+      return loadedData;
+   }
+
+   qint32 numRows = 0;
+   in >> numRows;
+   if (in.status() != QDataStream::Ok || numRows < 0) {
+      return loadedData;
+   }
+   loadedData->namedParameterBundles.reserve(numRows);
+   loadedData->primaryKeys.reserve(numRows);
+   QVector<QVariant> rowValues;
+   for (qint32 rowNum = 0; rowNum < numRows; ++rowNum) {
+      in >> rowValues;
+      if (in.status() != QDataStream::Ok || rowValues.size() != tableFields.size()) {
+         qWarning() << Q_FUNC_INFO << "Snapshot data for" << tableName << "is corrupt at row" << rowNum;
+         return loadedData;
+      }
+
+      // Same processing as in readAllFromDb().  By convention, the primary key is the first field.
+      NamedParameterBundle namedParameterBundle;
+      namedParameterBundle.reserve(tableFields.size());
+      for (int ii = 0; ii < tableFields.size(); ++ii) {
+         auto const & fieldDefn = tableFields.at(ii);
+         QVariant & fieldValue = rowValues[ii];
+         this->pimpl->wrapAndUnmapAsNeeded(this->pimpl->primaryTable, fieldDefn, fieldValue);
+         namedParameterBundle.insert(fieldDefn.propertyName, fieldValue);
+      }
+      loadedData->primaryKeys.append(rowValues.at(0).toInt());
+      loadedData->namedParameterBundles.append(std::move(namedParameterBundle));
+   }
+
+   qint32 numJunctionTables = 0;
+   in >> numJunctionTables;
+   if (numJunctionTables != this->pimpl->junctionTables.size()) {
+      return loadedData;
+   }
+   for (auto const & junctionTable : this->pimpl->junctionTables) {
+      QString junctionTableName;
+      QMap<int, QVector<int> > thisToOtherKeys;
+      in >> junctionTableName >> thisToOtherKeys;
+      if (junctionTableName != *junctionTable.tableName) {
+         qWarning() <<
+            Q_FUNC_INFO << "Snapshot has junction table" << junctionTableName << "but expected" <<
+            junctionTable.tableName;
+         return loadedData;
+      }
+      loadedData->junctionTableValues.append(thisToOtherKeys);
+   }
+
+   if (in.status() != QDataStream::Ok) {
+      qWarning() << Q_FUNC_INFO << "Error reading snapshot data for" << tableName;
+      return loadedData;
+   }
+
+   loadedData->succeeded = true;
+   return loadedData;
+}
+
 bool ObjectStore::contains(int id) const {
    return this->pimpl->allObjects.contains(id);
 }
@@ -1507,12 +2984,41 @@ QList<std::shared_ptr<QObject> > ObjectStore::getByIds(QVector<int> const & list
 }
 
 int ObjectStore::insert(std::shared_ptr<QObject> object) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
+   //
+   // We take a copy of everything we need to write now, but the write itself happens on the DB writer thread (see
+   // DbWriter).  We need to wait for it here because the caller needs the primary key the DB generates, but waiting
+   // also has the benefit that the insert is ordered after any writes that were queued before it.
+   //
+   impl::RowWrite rowWrite = this->pimpl->newRowWrite(this->pimpl->getPrimaryKey(*object).toInt());
+   if (!this->pimpl->captureObject(*object, rowWrite, false)) {
+      qCritical() << Q_FUNC_INFO << "Unable to read" << object->metaObject()->className() << "to insert";
+      return -1;
+   }
 
-   int primaryKey = this->pimpl->insertObjectInDb(connection, *object, false);
+   impl * const storeImpl = this->pimpl.get();
+   std::optional<int> const primaryKeyInDb = this->pimpl->database->writer().enqueueForResult<int>(
+      QString{"insert into %1"}.arg(*this->pimpl->primaryTable.tableName),
+      [storeImpl, rowWrite](QSqlDatabase & connection) -> std::optional<int> {
+         // Start transaction
+         // (By the magic of RAII, this will abort if we return from this function without calling
+         // dbTransaction.commit()
+         DbTransaction dbTransaction{*storeImpl->database, connection};
+         int const primaryKey = storeImpl->execInsert(connection, rowWrite, false);
+         if (primaryKey <= 0 || !dbTransaction.commit()) {
+            ++storeImpl->writeFailures;
+            return std::nullopt;
+         }
+         return primaryKey;
+      }
+   ).get();
+   if (!primaryKeyInDb) {
+      // Errors will already have been logged where they occurred, but we want to flag which object we failed to store
+      qCritical() <<
+         Q_FUNC_INFO << "Failed to insert" << object->metaObject()->className() << "into" <<
+         this->pimpl->primaryTable.tableName;
+      return -1;
+   }
+   int const primaryKey = *primaryKeyInDb;
 
    //
    // Add the object to our list of all objects of this type (asserting that it should be impossible for an object with
@@ -1520,13 +3026,13 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
    //
    Q_ASSERT(!this->pimpl->allObjects.contains(primaryKey));
    this->pimpl->allObjects.insert(primaryKey, object);
-
-   // Everything succeeded if we got this far so we can wrap up the transaction
-   dbTransaction.commit();
+   this->pimpl->indexObject(primaryKey, *object);
+   this->pimpl->notePersistedJunctionValues(rowWrite, primaryKey);
+   this->pimpl->journalInsert(primaryKey, object);
 
    //
    // Now we tell the object what its primary key is.  Note that we must do this _after_ the database transaction is
-   // finished as there are some circumstances where this call will trigger the start of another database transaction.
+   // finished as there are some circumstances where this call will trigger another write to the database.
    //
    BtStringConst const & primaryKeyProperty = this->pimpl->getPrimaryKeyProperty();
    bool setPrimaryKeyOk = object->setProperty(*primaryKeyProperty, primaryKey);
@@ -1539,99 +3045,174 @@ int ObjectStore::insert(std::shared_ptr<QObject> object) {
    }
 
    //
-   // Tell any bits of the UI that need to know that there's a new object
+   // Tell any bits of the UI that need to know that there's a new object -- either now, or, if we're in the middle of a
+   // bulk insert, along with all the other new objects at the end of it.
    //
-   emit this->signalObjectInserted(primaryKey);
+   if (this->pimpl->bulkInsertDepth > 0) {
+      this->pimpl->deferredInsertedIds.append(primaryKey);
+   } else {
+      emit this->signalObjectInserted(primaryKey);
+   }
    return primaryKey;
 }
 
-void ObjectStore::update(std::shared_ptr<QObject> object) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
+void ObjectStore::startBulkInsert() {
+   ++this->pimpl->bulkInsertDepth;
+   return;
+}
+
+void ObjectStore::finishBulkInsert() {
+   if (this->pimpl->bulkInsertDepth == 0) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Bulk insert not started on" << this->pimpl->primaryTable.tableName;
+      Q_ASSERT(false);
+      return;
+   }
+   if (--this->pimpl->bulkInsertDepth > 0 || this->pimpl->deferredInsertedIds.isEmpty()) {
+      return;
+   }
 
    //
-   // Construct the SQL, which will be of the form
-   //
-   //    UPDATE tablename
-   //    SET firstColumn = :firstColumn, secondColumn = :secondColumn, ...
-   //    WHERE primaryKeyColumn = :primaryKeyColumn;
-   //
-   // .:TBD:. A small optimisation might be to construct this just once rather than every time this function is called
+   // Take a copy of the list and clear it before emitting the signal, in case anything connected to the signal inserts
+   // more objects.
    //
-   QString queryString{"UPDATE "};
-   QTextStream queryStringAsStream{&queryString};
-   queryStringAsStream << this->pimpl->primaryTable.tableName << " SET ";
+   QVector<int> const insertedIds = this->pimpl->deferredInsertedIds;
+   this->pimpl->deferredInsertedIds.clear();
+   qDebug() <<
+      Q_FUNC_INFO << "Signalling" << insertedIds.size() << "object(s) inserted in" << this->pimpl->primaryTable.tableName;
+   emit this->signalObjectsInserted(insertedIds);
+   return;
+}
 
-   QString  const primaryKeyColumn {*this->pimpl->getPrimaryKeyColumn()};
-   QVariant const primaryKey       {this->pimpl->getPrimaryKey(*object)};
+void ObjectStore::startTransactionJournal() {
+   this->pimpl->transactionJournals.append(impl::TransactionJournal{});
+   return;
+}
 
-   bool skippedPrimaryKey = false;
-   bool firstFieldOutput = false;
-   for (auto const & fieldDefn: this->pimpl->primaryTable.tableFields) {
-      if (!skippedPrimaryKey) {
-         skippedPrimaryKey = true;
-      } else {
-         if (!firstFieldOutput) {
-            firstFieldOutput = true;
-         } else {
-            queryStringAsStream << ", ";
+void ObjectStore::finishTransactionJournal(bool const committed) {
+   if (this->pimpl->transactionJournals.isEmpty()) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Transaction journal not started on" << this->pimpl->primaryTable.tableName;
+      Q_ASSERT(false);
+      return;
+   }
+   impl::TransactionJournal const journal = this->pimpl->transactionJournals.takeLast();
+
+   if (committed) {
+      // If we're nested, what happened here is now part of the enclosing transaction, and is undone if that is
+      if (!this->pimpl->transactionJournals.isEmpty()) {
+         impl::TransactionJournal & enclosingJournal = this->pimpl->transactionJournals.last();
+         for (auto ii = journal.insertedObjects.cbegin(); ii != journal.insertedObjects.cend(); ++ii) {
+            enclosingJournal.insertedObjects.insert(ii.key(), ii.value());
+         }
+         for (auto ii = journal.removedObjects.cbegin(); ii != journal.removedObjects.cend(); ++ii) {
+            enclosingJournal.removedObjects.insert(ii.key(), ii.value());
          }
-         queryStringAsStream << " " << fieldDefn.columnName << " = :" << fieldDefn.columnName;
+         enclosingJournal.updatedIds.unite(journal.updatedIds);
       }
+      return;
    }
 
-   queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
+   if (journal.insertedObjects.isEmpty() && journal.removedObjects.isEmpty() && journal.updatedIds.isEmpty()) {
+      return;
+   }
+   qWarning() <<
+      Q_FUNC_INFO << "Transaction rolled back, so undoing" << journal.insertedObjects.size() << "insert(s)," <<
+      journal.removedObjects.size() << "delete(s) and updates to" << journal.updatedIds.size() << "object(s) in" <<
+      this->pimpl->primaryTable.tableName;
 
    //
-   // Bind the values.  Note that, because we're using bind names, it doesn't matter that the order in which we do the
-   // binds is different than the order in which the fields appear in the query.
+   // Whatever we noted about the junction tables since the transaction started is now wrong.  Until reloadFromDb() below
+   // tells us what's really there, we don't know.
    //
-   BtSqlQuery sqlQuery{connection};
-   sqlQuery.prepare(queryString);
-   for (auto const & fieldDefn: this->pimpl->primaryTable.tableFields) {
-      QVariant bindValue{object->property(*fieldDefn.propertyName)};
+   this->pimpl->persistedJunctionValues.clear();
 
-      // Fix-up the QVariant if needed, including converting enums to strings
-      this->pimpl->unwrapAndMapAsNeeded(this->pimpl->primaryTable, fieldDefn, bindValue);
-
-      sqlQuery.bindValue(QString{":"} + *fieldDefn.columnName, bindValue);
-   }
+   BtStringConst const & primaryKeyProperty = this->pimpl->getPrimaryKeyProperty();
 
    //
-   // Run the query
+   // Objects inserted in the transaction are no longer in the DB, so they shouldn't be in the cache either.  Resetting
+   // their primary keys puts them in the same state as a newly-created object (as for hard delete), and means we can't
+   // end up with two objects claiming the same key when the DB hands it out again.
    //
-   if (!sqlQuery.exec()) {
-      qCritical() <<
-         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return;
+   for (auto ii = journal.insertedObjects.cbegin(); ii != journal.insertedObjects.cend(); ++ii) {
+      int const primaryKey = ii.key();
+      auto object = ii.value();
+      object->setProperty(*primaryKeyProperty, -1);
+      if (journal.removedObjects.contains(primaryKey)) {
+         // Inserted and deleted in the same transaction, so already gone from the cache
+         continue;
+      }
+      this->pimpl->allObjects.remove(primaryKey);
+      this->pimpl->unindexObject(primaryKey);
+      // If nobody was told about the insert (because we are in a bulk insert), there's no need to tell them about the
+      // delete
+      if (this->pimpl->deferredInsertedIds.removeAll(primaryKey) == 0) {
+         emit this->signalObjectDeleted(primaryKey, object);
+      }
    }
 
    //
-   // Now update data in the junction tables
+   // Objects deleted in the transaction are still in the DB, so go back in the cache.  Their properties (including, for
+   // soft delete, the "deleted" flag) might not match the DB, so they get reloaded along with everything that was
+   // updated.
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
-      qDebug() <<
-         Q_FUNC_INFO << "Updating property " << GetJunctionTableDefinitionPropertyName(junctionTable) <<
-         " in junction table " << junctionTable.tableName;
-
-      //
-      // The simplest thing to do with each junction table is to blat any rows relating to the current object and then
-      // write out data based on the current property values.  This may often mean we're deleting rows and rewriting
-      // them but, for the small quantity of data we're talking about, it doesn't seem worth the complexity of
-      // optimising (eg read what's in the DB, compare with what's in the object property, work out what deletes,
-      // inserts and updates are needed to sync them, etc.
-      //
-      if (!deleteFromJunctionTableDefinition(junctionTable, primaryKey, connection)) {
-         return;
-      }
-      if (!insertIntoJunctionTableDefinition(junctionTable, *object, primaryKey, connection)) {
-         return;
+   QSet<int> idsToReload = journal.updatedIds;
+   for (auto ii = journal.removedObjects.cbegin(); ii != journal.removedObjects.cend(); ++ii) {
+      int const primaryKey = ii.key();
+      if (journal.insertedObjects.contains(primaryKey) || this->pimpl->allObjects.contains(primaryKey)) {
+         continue;
       }
+      auto object = ii.value();
+      object->setProperty(*primaryKeyProperty, primaryKey);
+      this->pimpl->allObjects.insert(primaryKey, object);
+      this->pimpl->indexObject(primaryKey, *object);
+      idsToReload.insert(primaryKey);
+      emit this->signalObjectInserted(primaryKey);
+   }
+   for (int const primaryKey : journal.insertedObjects.keys()) {
+      idsToReload.remove(primaryKey);
    }
 
-   dbTransaction.commit();
+   this->pimpl->reloadFromDb(*this, idsToReload);
+   return;
+}
+
+void ObjectStore::update(std::shared_ptr<QObject> object) {
+   // Write any queued property updates first so that they can't subsequently overwrite what we're writing here
+   this->flush();
+
+   int const primaryKey = this->pimpl->getPrimaryKey(*object).toInt();
+
+   // Any of the object's properties might have changed, so bring the in-memory indexes up to date
+   this->pimpl->indexObject(primaryKey, *object);
+   this->pimpl->journalUpdate(primaryKey);
+
+   //
+   // Take a copy of everything we need to write, and queue the write for the DB writer thread.  There's no need to
+   // wait for it to happen -- anything that subsequently reads or writes the DB will be queued behind it.
+   //
+   impl::RowWrite rowWrite = this->pimpl->newRowWrite(primaryKey);
+   if (!this->pimpl->captureObject(*object, rowWrite, true)) {
+      qCritical() <<
+         Q_FUNC_INFO << "Unable to read" << object->metaObject()->className() << "#" << primaryKey << "to update";
+      return;
+   }
+   this->pimpl->notePersistedJunctionValues(rowWrite, primaryKey);
+
+   impl * const storeImpl = this->pimpl.get();
+   this->pimpl->enqueueWrite(
+      QString{"update of %1 #%2"}.arg(*this->pimpl->primaryTable.tableName).arg(primaryKey),
+      [storeImpl, rowWrite](QSqlDatabase & connection) {
+         // Start transaction
+         // (By the magic of RAII, this will abort if we return from this function without calling
+         // dbTransaction.commit()
+         DbTransaction dbTransaction{*storeImpl->database, connection};
+         if (!storeImpl->execUpdate(connection, rowWrite)) {
+            return false;
+         }
+         return dbTransaction.commit();
+      }
+   );
    return;
 }
 
@@ -1671,35 +3252,138 @@ int ObjectStore::insertOrUpdate(QObject & object) {
    return this->pimpl->getPrimaryKey(object).toInt();
 }
 
-void ObjectStore::updateProperty(QObject const & object, BtStringConst const & propertyName) {
-   // Start transaction
-   // (By the magic of RAII, this will abort if we return from this function without calling dbTransaction.commit()
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
+void ObjectStore::updateProperty(QObject const & object,
+                                 BtStringConst const & propertyName,
+                                 WriteMode const writeMode) {
+   int const primaryKey = this->pimpl->getPrimaryKey(object).toInt();
 
-   if (!this->pimpl->updatePropertyInDb(connection, object, propertyName)) {
-      // Something went wrong.  Bailing out here will abort the transaction and avoid sending the signal.
-      return;
-   }
+   // The in-memory indexes are always updated straight away, even if the DB write is deferred
+   this->pimpl->indexObjectProperty(primaryKey, object, propertyName);
+   this->pimpl->journalUpdate(primaryKey);
 
-   // Everything went fine so we can commit the transaction
-   dbTransaction.commit();
+   //
+   // We can only defer the write if there is (or will be) an event loop to run our flush timer, and if we're on the
+   // thread that owns this object store (as otherwise the timer can't be started from here).
+   //
+   if (writeMode == WriteMode::Deferred &&
+       QCoreApplication::instance() &&
+       QThread::currentThread() == this->thread()) {
+      this->pimpl->queuePropertyUpdate(*this, primaryKey, propertyName);
+   } else {
+      impl::RowWrite rowWrite = this->pimpl->newRowWrite(primaryKey);
+      if (!this->pimpl->captureProperty(object, propertyName, rowWrite)) {
+         // Something went wrong.  Bailing out here will avoid sending the signal.
+         return;
+      }
+      this->pimpl->notePersistedJunctionValues(rowWrite, primaryKey);
+
+      // The caller wants the change to be in the DB when we return, so we have to wait for the DB writer thread
+      if (!this->pimpl->enqueuePropertyUpdates(QVector<impl::RowWrite>{rowWrite}).get()) {
+         // Something went wrong.  Errors will have been logged on the writer thread.
+         return;
+      }
+   }
 
    // Tell any bits of the UI that need to know that the property was updated
-   emit this->signalPropertyChanged(this->pimpl->getPrimaryKey(object).toInt(), propertyName);
+   emit this->signalPropertyChanged(primaryKey, propertyName);
 
    return;
 }
 
+std::future<bool> ObjectStore::flush() const {
+   if (this->pimpl->queuedPropertyUpdates.isEmpty()) {
+      return readyFuture(true);
+   }
+
+   if (this->pimpl->flushTimer) {
+      this->pimpl->flushTimer->stop();
+   }
+
+   //
+   // Take a copy of the queue and clear it before we start, so that we're in a consistent state if anything we call
+   // ends up queueing more updates.  Every update we take off the queue is either written below or, if we can't read
+   // the value to write, logged and reported through the returned future.
+   //
+   auto const queuedPropertyUpdates = this->pimpl->queuedPropertyUpdates;
+   this->pimpl->queuedPropertyUpdates.clear();
+   this->pimpl->queuedPropertyUpdatesLookup.clear();
+
+   qDebug() <<
+      Q_FUNC_INFO << "Writing" << queuedPropertyUpdates.size() << "queued property update(s) to" <<
+      this->pimpl->primaryTable.tableName;
+
+   //
+   // We read the current property values here, on the thread that owns the objects, and hand them to the DB writer
+   // thread to write in a single transaction.
+   //
+   QVector<impl::RowWrite> rowWrites;
+   rowWrites.reserve(queuedPropertyUpdates.size());
+   bool captureFailed = false;
+   for (auto const & queuedPropertyUpdate : queuedPropertyUpdates) {
+      int const primaryKey = queuedPropertyUpdate.first;
+      //
+      // If the object was removed from the cache since the update was queued, there's nothing to write.  (Callers that
+      // remove objects from the cache are expected to have called flush() first if they needed the update written.)
+      //
+      auto object = this->pimpl->allObjects.value(primaryKey);
+      if (!object) {
+         qDebug() <<
+            Q_FUNC_INFO << "Skipping queued update of" << queuedPropertyUpdate.second << "on" <<
+            this->pimpl->primaryTable.tableName << "#" << primaryKey << "as no longer in object store";
+         continue;
+      }
+      impl::RowWrite rowWrite = this->pimpl->newRowWrite(primaryKey);
+      if (!this->pimpl->captureProperty(*object, BtStringConst{queuedPropertyUpdate.second}, rowWrite)) {
+         // Something went wrong with this one update.  There's no reason not to write all the others.
+         qCritical() <<
+            Q_FUNC_INFO << "Error reading queued update of" << queuedPropertyUpdate.second << "on" <<
+            this->pimpl->primaryTable.tableName << "#" << primaryKey << ", so it will not be written";
+         captureFailed = true;
+         continue;
+      }
+      rowWrites.append(rowWrite);
+   }
+
+   if (rowWrites.isEmpty()) {
+      return readyFuture(!captureFailed);
+   }
+
+   for (auto const & rowWrite : rowWrites) {
+      this->pimpl->notePersistedJunctionValues(rowWrite, rowWrite.primaryKey);
+   }
+   std::future<bool> written = this->pimpl->enqueuePropertyUpdates(rowWrites);
+   if (!captureFailed) {
+      return written;
+   }
+   // Callers waiting on the result still need to wait for the updates we could read to be written
+   return std::async(std::launch::deferred, [written = std::move(written)]() mutable { written.get(); return false; });
+}
+
+int ObjectStore::numQueuedPropertyUpdates() const {
+   return this->pimpl->queuedPropertyUpdates.size();
+}
+
 std::shared_ptr<QObject>  ObjectStore::defaultSoftDelete(int id) {
    //
    // We assume on soft-delete that there is nothing to do on related objects - eg if a Mash is soft deleted (ie marked
    // deleted but remains in the DB) then there isn't actually anything we need to do with its MashSteps.
    //
    qDebug() << Q_FUNC_INFO << "Soft delete item #" << id;
+   //
+   // Once the object is out of the cache, we won't be able to write any queued updates for it, so do them now.  Unlike
+   // with hard delete, the row stays in the DB, so we need to know whether they made it.
+   //
+   if (!this->flush().get()) {
+      qCritical() <<
+         Q_FUNC_INFO << "Unable to write queued update(s) to" << this->pimpl->primaryTable.tableName << "#" << id <<
+         "before soft delete";
+   }
    auto object = this->pimpl->allObjects.value(id);
    if (this->pimpl->allObjects.contains(id)) {
       this->pimpl->allObjects.remove(id);
+      this->pimpl->forgetPersistedJunctionValues(id);
+      this->pimpl->unindexObject(id);
+      this->pimpl->journalRemoval(id, object);
 
       // Tell any bits of the UI that need to know that an object was deleted
       emit this->signalObjectDeleted(id, object);
@@ -1716,61 +3400,39 @@ std::shared_ptr<QObject>  ObjectStore::defaultHardDelete(int id) {
    // generically.
    //
    qDebug() << Q_FUNC_INFO << "Hard delete item #" << id;
-   auto object = this->pimpl->allObjects.value(id);
-   QSqlDatabase connection = this->pimpl->database->sqlDatabase();
-   DbTransaction dbTransaction{*this->pimpl->database, connection};
-
-   //
-   // Construct the SQL, which will be of the form
-   //
-   //    DELETE FROM tablename
-   //    WHERE primaryKeyColumn = :primaryKeyColumn;
-   //
-   // .:TBD:. A small optimisation might be to construct this just once rather than every time this function is called
-   //
-   QString queryString{"DELETE FROM "};
-   QTextStream queryStringAsStream{&queryString};
-   queryStringAsStream << this->pimpl->primaryTable.tableName;
-   BtStringConst const & primaryKeyColumn = this->pimpl->getPrimaryKeyColumn();
-   queryStringAsStream << " WHERE " << primaryKeyColumn << " = :" << primaryKeyColumn << ";";
-   qDebug() <<
-      Q_FUNC_INFO << "Deleting main table row #" << id << "with database query " << queryString;
-
-   //
-   // Bind the value
-   //
-   QVariant primaryKey{id};
-   BtSqlQuery sqlQuery{connection};
-   sqlQuery.prepare(queryString);
-   sqlQuery.bindValue(QString{":"} + *primaryKeyColumn, primaryKey);
-   qDebug().noquote() << Q_FUNC_INFO << "Bind values:" << BoundValuesToString(sqlQuery);
-
    //
-   // Run the query
+   // Queued updates need to be written before the row they apply to disappears.  We don't need to wait for them, as the
+   // delete is queued behind them on the DB writer thread, and, if they fail, the row is going anyway.
    //
-   if (!sqlQuery.exec()) {
-      qCritical() <<
-         Q_FUNC_INFO << "Error executing database query " << queryString << ": " << sqlQuery.lastError().text();
-      return object;
-   }
+   this->flush();
+   auto object = this->pimpl->allObjects.value(id);
 
    //
-   // Now remove data in the junction tables
+   // The delete itself happens on the DB writer thread, and we don't need to wait for it.  (Anything that subsequently
+   // reads or writes the DB will be queued behind it.)
    //
-   for (auto const & junctionTable : this->pimpl->junctionTables) {
-      if (!deleteFromJunctionTableDefinition(junctionTable, primaryKey, connection)) {
-         // We'll have already logged errors in deleteFromJunctionTableDefinition().  Not much more we can do other than
-         // bail here.
-         return object;
+   impl * const storeImpl = this->pimpl.get();
+   this->pimpl->enqueueWrite(
+      QString{"delete of %1 #%2"}.arg(*this->pimpl->primaryTable.tableName).arg(id),
+      [storeImpl, id](QSqlDatabase & connection) {
+         // Start transaction
+         // (By the magic of RAII, this will abort if we return from this function without calling
+         // dbTransaction.commit()
+         DbTransaction dbTransaction{*storeImpl->database, connection};
+         if (!storeImpl->execHardDelete(connection, id)) {
+            return false;
+         }
+         return dbTransaction.commit();
       }
-   }
-
-   dbTransaction.commit();
+   );
 
    //
    // Remove the object from the cache
    //
    this->pimpl->allObjects.remove(id);
+   this->pimpl->forgetPersistedJunctionValues(id);
+   this->pimpl->unindexObject(id);
+   this->pimpl->journalRemoval(id, object);
 
    // Tell any bits of the UI that need to know that an object was deleted
    emit this->signalObjectDeleted(id, object);
@@ -1831,11 +3493,45 @@ QList<QObject *> ObjectStore::findAllMatching(std::function<bool(QObject *)> con
    return convertedResults;
 }
 
+QList<std::shared_ptr<QObject> > ObjectStore::findAllWithPropertyValue(BtStringConst const & propertyName,
+                                                                       QVariant const & value) const {
+   auto secondaryIndex = this->pimpl->secondaryIndexes.constFind(*propertyName);
+   if (secondaryIndex == this->pimpl->secondaryIndexes.cend()) {
+      // No index, so we have to look at everything
+      QString const key = impl::secondaryIndexKey(value);
+      return this->findAllMatching(
+         [&](std::shared_ptr<QObject> obj) {
+            return impl::secondaryIndexKeys(obj->property(*propertyName)).contains(key);
+         }
+      );
+   }
+
+   QList<std::shared_ptr<QObject> > listToReturn;
+   QSet<int> const ids = secondaryIndex->idsByKey.value(impl::secondaryIndexKey(value));
+   listToReturn.reserve(ids.size());
+   for (int const id : ids) {
+      listToReturn.append(this->pimpl->allObjects.value(id));
+   }
+   return listToReturn;
+}
+
+bool ObjectStore::hasSecondaryIndex(BtStringConst const & propertyName) const {
+   return this->pimpl->secondaryIndexes.contains(*propertyName);
+}
+
 QList<std::shared_ptr<QObject> > ObjectStore::getAll() const {
    // QHash already knows how to return a QList of its values
    return this->pimpl->allObjects.values();
 }
 
+int ObjectStore::numObjects() const {
+   return this->pimpl->allObjects.size();
+}
+
+BtStringConst const & ObjectStore::primaryTableName() const {
+   return this->pimpl->primaryTable.tableName;
+}
+
 QList<QObject *> ObjectStore::getAllRaw() const {
    QList<QObject *> listToReturn;
    listToReturn.reserve(this->pimpl->allObjects.size());
@@ -1846,21 +3542,58 @@ QList<QObject *> ObjectStore::getAllRaw() const {
    return listToReturn;
 }
 
-bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const {
+void ObjectStore::setMaxRowsPerJunctionInsert(int const maxRows) {
+   maxRowsPerJunctionInsert = std::max(1, maxRows);
+   return;
+}
+
+ObjectStore::StatementCacheStats ObjectStore::statementCacheStats() const {
+   return this->pimpl->statementCache.stats();
+}
+
+void ObjectStore::clearStatementCache(QString const & connectionName) const {
+   this->pimpl->statementCache.clear(connectionName);
+   return;
+}
+
+bool ObjectStore::writeAllToNewDb(Database & databaseNew,
+                                  QSqlDatabase & connectionNew,
+                                  std::function<void(int)> const & progress) const {
    //
    // This is primarily used when someone is migrating data from, say, SQLite to PostgreSQL.
    //
    // We've got all the data cached in memory, so we just need to write it to the new database ... with a couple of
    // twists.  The assumption here is that we're already inside a transaction and that foreign key constraints are
-   // turned off.  So we just need to tell our insert member function to write to a different DB than normal and not to
-   // try to do anything with transactions ... AND we want to keep all the existing primary key values the same, rather
-   // than let the DB generate new ones when we do the inserts, so the third parameter to this->pimpl->insertObjectInDb
-   // is true.
+   // turned off.  So we just need to write to a different DB than normal and not to try to do anything with
+   // transactions ... AND we want to keep all the existing primary key values the same, rather than let the DB
+   // generate new ones when we do the inserts, so we include the primary key when capturing each object.
    //
-   for (auto object : this->pimpl->allObjects) {
-      if (this->pimpl->insertObjectInDb(connectionNew, *object, true) <= 0) {
+   // Rather than one INSERT per object, we capture objects a chunk at a time and write each chunk with multi-row
+   // INSERTs.  We don't need foreign keys to be satisfied (as they are turned off), so the order of objects doesn't
+   // matter.
+   //
+   int objectsWritten = 0;
+   QVector<ObjectStore::impl::RowWrite> chunk;
+   chunk.reserve(std::min(objectsPerBulkWriteChunk, static_cast<int>(this->pimpl->allObjects.size())));
+   for (auto ii = this->pimpl->allObjects.cbegin(); ii != this->pimpl->allObjects.cend(); ) {
+      auto const & object = ii.value();
+      ObjectStore::impl::RowWrite rowWrite = this->pimpl->newRowWrite(ii.key());
+      if (!this->pimpl->captureObject(*object, rowWrite, true)) {
          return false;
       }
+      chunk.append(rowWrite);
+      ++ii;
+
+      if (chunk.size() >= objectsPerBulkWriteChunk || ii == this->pimpl->allObjects.cend()) {
+         if (!this->pimpl->execBulkInsertWithPrimaryKey(connectionNew, chunk)) {
+            return false;
+         }
+         objectsWritten += chunk.size();
+         chunk.clear();
+         if (progress) {
+            progress(objectsWritten);
+         }
+      }
    }
 
    //
@@ -1870,9 +3603,7 @@ bool ObjectStore::writeAllToNewDb(Database & databaseNew, QSqlDatabase & connect
    // Note that we only need to do this for the primary key on primaryTable.  We make no use of the primary key IDs on
    // junction tables and we always let the DB auto-generate them, even when writing all data to a new DB.
    //
-   // We _could_ call databaseNew.updatePrimaryKeySequenceIfNecessary() in this->pimpl->insertObjectInDb() every time we
-   // explicitly insert an ID in primaryTable, but it's currently not necessary as this is the only place we ask
-   // this->pimpl->insertObjectInDb() to do that.
+   // We only explicitly insert IDs in primaryTable here, so this is the only place we need to do this.
    //
    databaseNew.updatePrimaryKeySequenceIfNecessary(connectionNew,
                                                    this->pimpl->primaryTable.tableName,
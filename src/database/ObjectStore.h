@@ -21,15 +21,19 @@
 #pragma once
 #include <functional>
 
+#include <future>
 #include <memory> // For PImpl
 #include <optional>
 
+#include <QDataStream>
+#include <QMap>
 #include <QObject>
 #include <QSqlDatabase>
 #include <QString>
 #include <QVector>
 
 #include "model/NamedEntity.h"
+#include "model/NamedParameterBundle.h"
 #include "utils/BtStringConst.h"
 #include "utils/EnumStringMapping.h"
 #include "utils/TypeLookup.h"
@@ -195,6 +199,24 @@ public:
    // This isn't strictly necessary, but it makes various declarations more concise
    typedef QVector<JunctionTableDefinition> JunctionTableDefinitions;
 
+   /**
+    * \brief The names of the properties for which the store should maintain an in-memory secondary index (value ->
+    *        IDs of objects having that value), to make \c findAllWithPropertyValue() quick for them.  Indexed
+    *        properties need to be of a type (eg \c int or \c QString) that converts sensibly to \c QString, and they
+    *        need to be set via setters that notify the store (ie call \c updateProperty()) once an object is stored.
+    */
+   typedef QVector<BtStringConst const *> SecondaryIndexDefinitions;
+
+   /**
+    * \brief Usage statistics for the cache of prepared SQL statements that each \c ObjectStore keeps.  A "miss" means
+    *        we had to construct and prepare a new statement; a "hit" means we were able to reuse one we already had.
+    */
+   struct StatementCacheStats {
+      unsigned int hits;
+      unsigned int misses;
+      int numStatements;
+   };
+
    /**
     * \brief Constructor sets up mappings but does not read in data from DB
     *
@@ -202,10 +224,12 @@ public:
     *                   this object type are "optional" (ie wrapped in \c std::optional)
     * \param primaryTable  First in the list should be the primary key
     * \param junctionTables  Optional
+    * \param secondaryIndexes  Optional
     */
-   ObjectStore(TypeLookup               const & typeLookup,
-               TableDefinition          const & primaryTable,
-               JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{});
+   ObjectStore(TypeLookup                const & typeLookup,
+               TableDefinition           const & primaryTable,
+               JunctionTableDefinitions  const & junctionTables   = JunctionTableDefinitions{},
+               SecondaryIndexDefinitions const & secondaryIndexes = SecondaryIndexDefinitions{});
 
    ~ObjectStore();
 
@@ -223,17 +247,71 @@ public:
    bool createTables(Database & database, QSqlDatabase & connection) const;
 
    /**
-    * \brief Add (eg foreign key) constraints to the table(s) for the objects handled by this store
+    * \brief Add (eg foreign key) constraints to the table(s) for the objects handled by this store, along with an index
+    *        on each foreign key column
     */
    bool addTableConstraints(Database & database, QSqlDatabase & connection) const;
 
+   /**
+    * \brief Everything \c readAllFromDb() reads from the DB for one object store, for \c loadAll() to use to create
+    *        objects.  This is just data (no \c QObject instances), so it can be created on one thread and used on
+    *        another.
+    */
+   struct LoadedData {
+      //! Set to \c true once all the DB reads have succeeded
+      bool succeeded = false;
+      //! Constructor parameters for each object, read from the primary table
+      QVector<NamedParameterBundle> namedParameterBundles{};
+      //! Primary key of each object, in the same order as \c namedParameterBundles
+      QVector<int> primaryKeys{};
+      //! For each junction table (in the same order as they were defined), the ordered "other" IDs for each object
+      QVector<QMap<int, QVector<int> > > junctionTableValues{};
+   };
+
+   /**
+    * \brief Read from the database all the data needed to create the objects handled by this store, but don't create
+    *        the objects.
+    *
+    *        This is split out from \c loadAll() so that the reading can be done on a worker thread (with that thread's
+    *        own DB connection), whilst object creation (which has to happen on the thread that will own the objects)
+    *        is done afterwards by \c loadAll().  See \c LoadAllObjectStores().
+    *
+    * \param database
+    *
+    * \return The data read.  Check its \c succeeded member to see whether all the reads worked.
+    */
+   std::shared_ptr<LoadedData> readAllFromDb(Database & database) const;
+
    /**
     * \brief Load from database all objects handled by this store
     *
     * \param database Sets and stores the Database this store is going to work with.  If not supplied (or set to
     *                 nullptr) then the store will use \c Database::getInstance()
+    * \param loadedData If supplied, and it was read successfully, the result of an earlier call to
+    *                   \c readAllFromDb().  Otherwise, we'll call \c readAllFromDb() ourselves.
     */
-   void loadAll(Database * database = nullptr);
+   void loadAll(Database * database = nullptr, std::shared_ptr<LoadedData> loadedData = nullptr);
+
+   /**
+    * \brief Returns \c true if \c loadAll() has completed successfully, \c false otherwise
+    */
+   bool isLoaded() const;
+
+   /**
+    * \brief Write everything this store holds to a snapshot stream, in the same form as it is stored in the DB, so
+    *        that \c readSnapshot() can later turn it back into what \c readAllFromDb() would have read.  Any queued
+    *        property updates should be flushed first.  See \c WriteObjectStoreSnapshot().
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool writeSnapshot(QDataStream & out) const;
+
+   /**
+    * \brief Read back what \c writeSnapshot() wrote.
+    *
+    * \return The data read.  Check its \c succeeded member to see whether the snapshot was usable.
+    */
+   std::shared_ptr<LoadedData> readSnapshot(QDataStream & in) const;
 
    /**
     * \brief Create a new object of the type we are handling, using the parameters read from the DB.  Subclass needs to
@@ -244,7 +322,10 @@ public:
    /**
     * \brief Insert a new object in the DB (and in our cache list)
     *
-    * \return The ID of what was inserted
+    *        The write is done on the DB writer thread (see \c DbWriter), but we wait for it as we need the primary key
+    *        the DB assigns.
+    *
+    * \return The ID of what was inserted, or -1 if there was an error
     */
    virtual int insert(std::shared_ptr<QObject> object);
 
@@ -255,7 +336,8 @@ public:
    template <typename D> void insert(D) = delete;
 
    /**
-    * \brief Update an existing object in the DB
+    * \brief Update an existing object in the DB.  The write is queued for the DB writer thread (see \c DbWriter), and
+    *        we don't wait for it.
     */
    virtual void update(std::shared_ptr<QObject> object);
 
@@ -290,10 +372,95 @@ public:
     */
    template <typename D> void insertOrUpdate(D) = delete;
 
+   /**
+    * \brief Whether \c updateProperty() should write to the DB straight away or queue the change to be written along
+    *        with others
+    */
+   enum class WriteMode {
+      //! Queue the change and write it (in a single transaction with any other queued changes) when the event loop
+      //  is next idle.  This is the default, as it means, eg, scaling a recipe does one DB commit rather than dozens.
+      Deferred,
+      //! Write the change in its own transaction before returning.  Use this when the caller needs the change to be
+      //  durable as soon as the call returns.
+      Immediate
+   };
+
    /**
     * \brief Update a single property of an existing object in the DB
+    *
+    *        By default, the write is deferred (see \c WriteMode and \c flush()).  Either way, \c signalPropertyChanged
+    *        is emitted before this function returns, because the in-memory object (which is what everything other
+    *        than the DB reads from) has already been updated.
+    *
+    *        Note that we only queue the object ID and the property name.  The value written is whatever the property
+    *        holds at the time of writing, so multiple changes to the same property are coalesced into one write.
+    *
+    *        Deferral is only possible on the thread that owns the object store and once the application's event loop
+    *        exists.  Otherwise we fall back to an immediate write.
+    *
+    * \param object
+    * \param propertyName
+    * \param writeMode
     */
-   void updateProperty(QObject const & object, BtStringConst const & propertyName);
+   void updateProperty(QObject const & object,
+                       BtStringConst const & propertyName,
+                       WriteMode const writeMode = WriteMode::Deferred);
+
+   /**
+    * \brief Pass any queued property updates (see \c updateProperty()) to the DB writer thread (see \c DbWriter) to be
+    *        written in a single transaction.  Called automatically shortly after updates are queued, but also needs to
+    *        be called explicitly before anything that reads the DB directly (eg copying the DB file for a backup) and
+    *        before the DB is closed -- in which case, the caller will also need to wait for the DB writer thread.
+    *        (\c FlushAllObjectStores() does both.)
+    *
+    *        NB: This is a const member function for the same reason as \c writeAllToNewDb() -- it does not change the
+    *        objects held by the store, only what's been written to the DB.
+    *
+    *        If we cannot read the value of one of the queued properties, we log it and skip that one update, but
+    *        still write all the others.
+    *
+    * \return Future that becomes ready, once the updates have been written, with \c true if they all succeeded (or
+    *         there was nothing to do), or \c false if the write failed or we could not read any of the property values
+    *         to write.  Callers that don't need to wait for the write are free to discard this.
+    */
+   std::future<bool> flush() const;
+
+   /**
+    * \brief Number of property updates waiting to be passed to the DB writer thread by \c flush().  (Multiple updates
+    *        of the same property of the same object count as one.)  Mostly useful for testing.
+    */
+   int numQueuedPropertyUpdates() const;
+
+   /**
+    * \brief Start a bulk insert, during which \c insert() does not emit \c signalObjectInserted for each new object.
+    *        Instead, we emit \c signalObjectsInserted once, for all of them, when the bulk insert is finished.  Calls
+    *        can be nested, in which case the signal is emitted when the outermost bulk insert is finished.  Normally
+    *        called via \c BulkImportSession rather than directly.
+    */
+   void startBulkInsert();
+
+   /**
+    * \brief Finish a bulk insert started with \c startBulkInsert()
+    */
+   void finishBulkInsert();
+
+   /**
+    * \brief Start recording which objects get inserted, updated or deleted, so that, if the DB transaction they are
+    *        written in is rolled back, \c finishTransactionJournal() can bring what we hold in memory back into line
+    *        with the DB.  Calls can be nested, to match nested transactions.  Normally called via
+    *        \c ObjectStoreTransaction rather than directly.
+    */
+   void startTransactionJournal();
+
+   /**
+    * \brief Finish what was started by \c startTransactionJournal()
+    *
+    * \param committed If \c true, the transaction was committed, and what we recorded just becomes part of any
+    *                  enclosing journal.  If \c false, it was rolled back, so objects inserted since the journal
+    *                  started are removed from the cache (and have their primary keys reset), objects deleted since
+    *                  then are put back, and objects updated since then are reloaded from the DB.
+    */
+   void finishTransactionJournal(bool const committed);
 
    /**
     * \brief Remove the object from our local in-memory cache
@@ -391,6 +558,22 @@ public:
     */
    QList<QObject *> findAllMatching(std::function<bool(QObject *)> const & matchFunction) const;
 
+   /**
+    * \brief Special case of \c findAllMatching for finding all the objects whose given property has a given value.
+    *        If the property has a secondary index (see \c SecondaryIndexDefinitions) then this is a hash lookup
+    *        rather than a search of every object in the store.
+    *
+    * \param propertyName
+    * \param value
+    */
+   QList<std::shared_ptr<QObject> > findAllWithPropertyValue(BtStringConst const & propertyName,
+                                                             QVariant const & value) const;
+
+   /**
+    * \brief Returns \c true if \c propertyName has a secondary index in this store, \c false otherwise
+    */
+   bool hasSecondaryIndex(BtStringConst const & propertyName) const;
+
    /**
     * \brief Special case of \c findAllMatching that returns a list of all cached objects of a given type
     */
@@ -406,10 +589,48 @@ public:
     *
     * \param databaseNew
     * \param connectionNew
+    * \param progress  If set, called periodically with the number of objects written so far
     *
     * \return \c true if succeeded \c false otherwise
     */
-   bool writeAllToNewDb(Database & databaseNew, QSqlDatabase & connectionNew) const;
+   bool writeAllToNewDb(Database & databaseNew,
+                        QSqlDatabase & connectionNew,
+                        std::function<void(int)> const & progress = nullptr) const;
+
+   /**
+    * \brief Number of objects in the store
+    */
+   int numObjects() const;
+
+   /**
+    * \brief Name of the DB table in which the store's objects live (eg for progress messages)
+    */
+   BtStringConst const & primaryTableName() const;
+
+   /**
+    * \brief Set the maximum number of rows we write to a junction table in a single multi-row INSERT statement.
+    *        (The actual number will also be limited by what the DB allows.)  Setting this to 1 means every row is
+    *        inserted with a separate statement, which is mostly useful for testing and benchmarking.
+    *
+    * \param maxRows
+    */
+   static void setMaxRowsPerJunctionInsert(int const maxRows);
+
+   /**
+    * \brief Get usage statistics for the prepared statement cache
+    */
+   StatementCacheStats statementCacheStats() const;
+
+   /**
+    * \brief Release all prepared statements held for the named DB connection.  This needs to be called before the
+    *        connection is closed and removed (otherwise Qt will complain that the connection is still in use).
+    *
+    *        NB: This is a const member function because, from the point of view of callers, it does not change the
+    *        contents of the object store -- it just discards statements that we can reconstruct on demand.
+    *
+    * \param connectionName
+    */
+   void clearStatementCache(QString const & connectionName) const;
 
 signals:
    /**
@@ -453,6 +674,15 @@ signals:
     */
    void signalObjectInserted(int id);
 
+   /**
+    * \brief Signal emitted, instead of \c signalObjectInserted, at the end of a bulk insert (see \c startBulkInsert()),
+    *        so that recipients can deal with all the new objects in one go -- eg when a large BeerXML file is
+    *        imported.  Anything that connects to \c signalObjectInserted will normally want to connect to this too.
+    *
+    * \param ids The primary keys of the newly inserted objects, in the order they were inserted
+    */
+   void signalObjectsInserted(QVector<int> const & ids);
+
    /**
     * \brief Signal emitted when an object is deleted.  Replaces
     *
@@ -484,7 +714,8 @@ signals:
     *            void Database::changedInventory(DatabaseConstants::DbTableId, int, QVariant);
     *
     *        Note that this signal is only emitted when \c updateProperty() is called, NOT when \c update() is called
-    *        (as in the latter case we won't know which, if any, properties were changed).
+    *        (as in the latter case we won't know which, if any, properties were changed).  Also, if the update was
+    *        deferred, the signal is emitted when the update is queued rather than when it is written to the DB.
     *
     * \param id The primary key of the object that changed.  (Recipient will already know which class, as, eg, will
     *           connect slot to \c ObjectStoreTyped<InventoryFermentable>::getInstance(),
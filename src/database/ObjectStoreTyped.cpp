@@ -18,9 +18,20 @@
  */
 #include "database/ObjectStoreTyped.h"
 
+#include <future>
 #include  <mutex> // for std::once_flag
+#include <vector>
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QThreadPool>
+
+#include "database/Database.h"
 #include "database/DbTransaction.h"
+#include "database/DbWriter.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
@@ -583,7 +594,9 @@ namespace {
          {ObjectStore::FieldType::Double, "tertiary_temp",       PropertyNames::Recipe::tertiaryTemp_c      },
          {ObjectStore::FieldType::Enum,   "type",                PropertyNames::Recipe::type,           &RECIPE_STEP_TYPE_ENUM},
          {ObjectStore::FieldType::Int,    "ancestor_id",         PropertyNames::Recipe::ancestorId,           nullptr,                &PRIMARY_TABLE<Recipe>},
-         {ObjectStore::FieldType::Bool,   "locked",              PropertyNames::Recipe::locked              }
+         {ObjectStore::FieldType::Bool,   "locked",              PropertyNames::Recipe::locked              },
+         {ObjectStore::FieldType::String, "calc_fingerprint",    PropertyNames::Recipe::calcFingerprint     },
+         {ObjectStore::FieldType::String, "calc_results",        PropertyNames::Recipe::calcResults         }
       }
    };
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<Recipe> {
@@ -698,10 +711,62 @@ namespace {
    template<> ObjectStore::JunctionTableDefinitions const JUNCTION_TABLES<BrewNote> {};
 
 
+   //
+   // Properties we look things up by often enough that it's worth keeping secondary indexes for them.  By default, for
+   // NamedEntity subclasses, this is the parent key (used to find all the "instances of use" of a Hop, Fermentable,
+   // etc) and the name (used to check for name clashes).
+   //
+   template<class NE> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES {
+      &PropertyNames::NamedEntity::parentKey,
+      &PropertyNames::NamedEntity::name
+   };
+   // Inventory objects don't have names or parents
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryFermentable> {};
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryHop>         {};
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryMisc>        {};
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<InventoryYeast>       {};
+   // BrewNotes and MashSteps are looked up by the Recipe / Mash they belong to
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<BrewNote> {
+      &PropertyNames::NamedEntity::parentKey,
+      &PropertyNames::NamedEntity::name,
+      &PropertyNames::BrewNote::recipeId
+   };
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<MashStep> {
+      &PropertyNames::NamedEntity::parentKey,
+      &PropertyNames::NamedEntity::name,
+      &PropertyNames::MashStep::mashId
+   };
+   //
+   // For Recipes, we also index the IDs of everything they use, which gives us a reverse lookup from an ingredient (or
+   // Equipment, Mash, etc) to the Recipe(s) using it.  See Recipe::findOwningRecipe().
+   //
+   template<> ObjectStore::SecondaryIndexDefinitions const SECONDARY_INDEXES<Recipe> {
+      &PropertyNames::NamedEntity::parentKey,
+      &PropertyNames::NamedEntity::name,
+      &PropertyNames::Recipe::equipmentId,
+      &PropertyNames::Recipe::mashId,
+      &PropertyNames::Recipe::styleId,
+      &PropertyNames::Recipe::fermentableIds,
+      &PropertyNames::Recipe::hopIds,
+      &PropertyNames::Recipe::instructionIds,
+      &PropertyNames::Recipe::miscIds,
+      &PropertyNames::Recipe::saltIds,
+      &PropertyNames::Recipe::waterIds,
+      &PropertyNames::Recipe::yeastIds
+   };
+
    //
    // This should give us all the singleton instances
    //
-   template<class NE> ObjectStoreTyped<NE> ostSingleton{NE::typeLookup, PRIMARY_TABLE<NE>, JUNCTION_TABLES<NE>};
+   template<class NE> ObjectStoreTyped<NE> ostSingleton{
+      NE::typeLookup, PRIMARY_TABLE<NE>, JUNCTION_TABLES<NE>, SECONDARY_INDEXES<NE>
+   };
+
+   //
+   // Each singleton has a flag to ensure its loadAll() is called exactly once, whether that's from
+   // LoadAllObjectStores() at start-up or on first use via ObjectStoreTyped<NE>::getInstance().
+   //
+   template<class NE> std::once_flag ostInitFlag;
 
 }
 
@@ -709,11 +774,7 @@ namespace {
 template<class NE>
 ObjectStoreTyped<NE> & ObjectStoreTyped<NE>::getInstance() {
    // C++11 provides a thread-safe way to ensure singleton.loadAll() is called exactly once
-   //
-   // NB: It's easier to just pass in nullptr to ObjectStoreTyped<NE>::loadAll than to do all the magic casting to
-   //     allow std::call_once to invoke it with the default parameter (which is nullptr).
-   static std::once_flag initFlag;
-   std::call_once(initFlag, &ObjectStoreTyped<NE>::loadAll, &ostSingleton<NE>, nullptr);
+   std::call_once(ostInitFlag<NE>, []() { ostSingleton<NE>.loadAll(); });
 
    return ostSingleton<NE>;
 }
@@ -759,6 +820,251 @@ namespace {
    };
 }
 
+namespace {
+   /**
+    * \brief Reads all the data for one object store on a worker thread (with that thread's own DB connection)
+    */
+   class ObjectStoreReader : public QRunnable {
+   public:
+      ObjectStoreReader(ObjectStore const & objectStore,
+                        Database & database,
+                        std::shared_ptr<ObjectStore::LoadedData> & loadedData) : objectStore{objectStore},
+                                                                                 database{database},
+                                                                                 loadedData{loadedData} {
+         return;
+      }
+
+      void run() override {
+         try {
+            this->loadedData = this->objectStore.readAllFromDb(this->database);
+         } catch (QString const & errorMessage) {
+            // Database::sqlDatabase() throws if it can't open a connection.  We leave loadedData null so that the
+            // object store will try again itself on the main thread.
+            qWarning() << Q_FUNC_INFO << "Unable to read in worker thread:" << errorMessage;
+         }
+         // The worker thread belongs to the thread pool, so we should not leave a connection open on it
+         this->database.closeConnectionForThisThread();
+         return;
+      }
+
+   private:
+      ObjectStore const & objectStore;
+      Database & database;
+      std::shared_ptr<ObjectStore::LoadedData> & loadedData;
+   };
+
+   /**
+    * \brief Create the objects for one object store from data already read from the DB (unless the store has already
+    *        been loaded by someone calling \c ObjectStoreTyped<NE>::getInstance()).
+    */
+   template<class NE> void finishLoad(Database & database, std::shared_ptr<ObjectStore::LoadedData> loadedData) {
+      std::call_once(ostInitFlag<NE>, [&]() { ostSingleton<NE>.loadAll(&database, loadedData); });
+      return;
+   }
+
+   struct StoreLoader {
+      ObjectStore const & objectStore;
+      void (*finishLoad)(Database &, std::shared_ptr<ObjectStore::LoadedData>);
+   };
+
+   //
+   // The order here matters: objects are created in this order, and things that are referred to by foreign key need
+   // to exist before the things that refer to them.  Eg Recipe needs Mash, Style, Equipment etc to be loaded first.
+   //
+   QVector<StoreLoader> const StoreLoadersInDependencyOrder {
+      {ostSingleton<InventoryFermentable>, finishLoad<InventoryFermentable>},
+      {ostSingleton<InventoryHop>,         finishLoad<InventoryHop>        },
+      {ostSingleton<InventoryMisc>,        finishLoad<InventoryMisc>       },
+      {ostSingleton<InventoryYeast>,       finishLoad<InventoryYeast>      },
+      {ostSingleton<Equipment>,            finishLoad<Equipment>           },
+      {ostSingleton<Fermentable>,          finishLoad<Fermentable>         },
+      {ostSingleton<Hop>,                  finishLoad<Hop>                 },
+      {ostSingleton<Instruction>,          finishLoad<Instruction>         },
+      {ostSingleton<Misc>,                 finishLoad<Misc>                },
+      {ostSingleton<Salt>,                 finishLoad<Salt>                },
+      {ostSingleton<Style>,                finishLoad<Style>               },
+      {ostSingleton<Water>,                finishLoad<Water>               },
+      {ostSingleton<Yeast>,                finishLoad<Yeast>               },
+      {ostSingleton<Mash>,                 finishLoad<Mash>                },
+      {ostSingleton<MashStep>,             finishLoad<MashStep>            },
+      {ostSingleton<Recipe>,               finishLoad<Recipe>              },
+      {ostSingleton<BrewNote>,             finishLoad<BrewNote>            }
+   };
+}
+
+namespace {
+   //
+   // Snapshot file layout is:
+   //    header, written with QDataStream: magic number, format version, DB file stamp, SHA-1 of payload, payload size
+   //    payload: each object store's ObjectStore::writeSnapshot() output, in StoreLoadersInDependencyOrder order
+   //
+   // Bump snapshotFormatVersion if the layout changes.  (Changes to the table layouts are caught by the checks in
+   // ObjectStore::readSnapshot().)
+   //
+   quint32 const snapshotMagic = 0x42545353; // "BTSS"
+   quint32 const snapshotFormatVersion = 1;
+   QDataStream::Version const snapshotStreamVersion = QDataStream::Qt_5_9;
+}
+
+QMap<ObjectStore const *, std::shared_ptr<ObjectStore::LoadedData> > ReadObjectStoreSnapshot(Database & database) {
+   QMap<ObjectStore const *, std::shared_ptr<ObjectStore::LoadedData> > results;
+
+   QString const snapshotFileName = database.snapshotFileName();
+   if (snapshotFileName.isEmpty()) {
+      return results;
+   }
+   QFile snapshotFile{snapshotFileName};
+   if (!snapshotFile.exists() || !snapshotFile.open(QIODevice::ReadOnly)) {
+      qDebug() << Q_FUNC_INFO << "No usable snapshot file" << snapshotFileName;
+      return results;
+   }
+
+   //
+   // Mapping the file into memory means we don't copy the (potentially large) payload before parsing it.  The
+   // mapping remains valid until the file is closed (ie until we return).
+   //
+   qint64 const fileSize = snapshotFile.size();
+   uchar const * const mappedFile = snapshotFile.map(0, fileSize);
+   if (!mappedFile) {
+      qWarning() << Q_FUNC_INFO << "Unable to map" << snapshotFileName << ":" << snapshotFile.errorString();
+      return results;
+   }
+   QByteArray const fileContents = QByteArray::fromRawData(reinterpret_cast<char const *>(mappedFile), fileSize);
+
+   QDataStream headerStream{fileContents};
+   headerStream.setVersion(snapshotStreamVersion);
+   quint32 magic = 0;
+   quint32 formatVersion = 0;
+   QByteArray fileStamp;
+   QByteArray checksum;
+   quint64 payloadSize = 0;
+   headerStream >> magic >> formatVersion >> fileStamp >> checksum >> payloadSize;
+   qint64 const payloadOffset = headerStream.device()->pos();
+   if (headerStream.status() != QDataStream::Ok ||
+       magic != snapshotMagic ||
+       formatVersion != snapshotFormatVersion ||
+       payloadSize != static_cast<quint64>(fileSize - payloadOffset)) {
+      qInfo() << Q_FUNC_INFO << "Ignoring snapshot file" << snapshotFileName << "with unexpected header";
+      return results;
+   }
+   if (fileStamp != database.fileStamp()) {
+      qInfo() <<
+         Q_FUNC_INFO << "Ignoring snapshot file" << snapshotFileName << "as DB has changed since it was written";
+      return results;
+   }
+
+   QByteArray const payload = QByteArray::fromRawData(reinterpret_cast<char const *>(mappedFile + payloadOffset),
+                                                      static_cast<int>(payloadSize));
+   if (QCryptographicHash::hash(payload, QCryptographicHash::Sha1) != checksum) {
+      qWarning() << Q_FUNC_INFO << "Ignoring snapshot file" << snapshotFileName << "with bad checksum";
+      return results;
+   }
+
+   QDataStream payloadStream{payload};
+   payloadStream.setVersion(snapshotStreamVersion);
+   for (auto const & storeLoader : StoreLoadersInDependencyOrder) {
+      auto loadedData = storeLoader.objectStore.readSnapshot(payloadStream);
+      if (!loadedData->succeeded) {
+         results.clear();
+         return results;
+      }
+      results.insert(&storeLoader.objectStore, loadedData);
+   }
+
+   qInfo() << Q_FUNC_INFO << "Read object stores from snapshot file" << snapshotFileName;
+   return results;
+}
+
+bool WriteObjectStoreSnapshot(Database & database) {
+   QString const snapshotFileName = database.snapshotFileName();
+   if (snapshotFileName.isEmpty()) {
+      return false;
+   }
+
+   //
+   // If a store never got loaded (eg because nothing used it) then we don't know its contents, and can't write a
+   // snapshot.  Any existing snapshot will be rejected next time if the DB has changed since it was written.
+   //
+   for (auto const & storeLoader : StoreLoadersInDependencyOrder) {
+      if (!storeLoader.objectStore.isLoaded()) {
+         qDebug() << Q_FUNC_INFO << "Not writing snapshot as not all object stores are loaded";
+         return false;
+      }
+   }
+
+   QByteArray payload;
+   {
+      QDataStream payloadStream{&payload, QIODevice::WriteOnly};
+      payloadStream.setVersion(snapshotStreamVersion);
+      for (auto const & storeLoader : StoreLoadersInDependencyOrder) {
+         if (!storeLoader.objectStore.writeSnapshot(payloadStream)) {
+            qWarning() << Q_FUNC_INFO << "Unable to write object store snapshot";
+            return false;
+         }
+      }
+   }
+
+   //
+   // QSaveFile writes to a temporary file and only replaces the real one on commit(), so we can never leave a
+   // half-written snapshot behind.
+   //
+   QSaveFile snapshotFile{snapshotFileName};
+   if (!snapshotFile.open(QIODevice::WriteOnly)) {
+      qWarning() << Q_FUNC_INFO << "Unable to open" << snapshotFileName << ":" << snapshotFile.errorString();
+      return false;
+   }
+   QDataStream headerStream{&snapshotFile};
+   headerStream.setVersion(snapshotStreamVersion);
+   headerStream <<
+      snapshotMagic << snapshotFormatVersion << database.fileStamp() <<
+      QCryptographicHash::hash(payload, QCryptographicHash::Sha1) << static_cast<quint64>(payload.size());
+   snapshotFile.write(payload);
+   if (headerStream.status() != QDataStream::Ok || !snapshotFile.commit()) {
+      qWarning() << Q_FUNC_INFO << "Error writing" << snapshotFileName << ":" << snapshotFile.errorString();
+      return false;
+   }
+
+   qInfo() << Q_FUNC_INFO << "Wrote" << payload.size() << "bytes of object store data to" << snapshotFileName;
+   return true;
+}
+
+void LoadAllObjectStores(Database & database) {
+   qDebug() << Q_FUNC_INFO;
+
+   //
+   // If we have an up-to-date snapshot, we don't need to read anything from the DB
+   //
+   QVector<std::shared_ptr<ObjectStore::LoadedData>> loadedData(StoreLoadersInDependencyOrder.size());
+   auto const fromSnapshot = ReadObjectStoreSnapshot(database);
+   if (!fromSnapshot.isEmpty()) {
+      for (int ii = 0; ii < StoreLoadersInDependencyOrder.size(); ++ii) {
+         loadedData[ii] = fromSnapshot.value(&StoreLoadersInDependencyOrder.at(ii).objectStore);
+      }
+   } else {
+      //
+      // Do all the DB reads in parallel.  We use our own pool rather than the global one so that waitForDone() only
+      // waits for our work.
+      //
+      QThreadPool threadPool;
+      for (int ii = 0; ii < StoreLoadersInDependencyOrder.size(); ++ii) {
+         // Thread pool takes ownership of the runnable (because autoDelete() defaults to true)
+         threadPool.start(
+            new ObjectStoreReader(StoreLoadersInDependencyOrder.at(ii).objectStore, database, loadedData[ii])
+         );
+      }
+      threadPool.waitForDone();
+   }
+
+   //
+   // Objects need to live on this thread, so we create them here, in dependency order.  If a read failed on the worker
+   // thread (eg because it couldn't get past the lock held by this thread's connection), loadAll() will retry it here.
+   //
+   for (int ii = 0; ii < StoreLoadersInDependencyOrder.size(); ++ii) {
+      StoreLoadersInDependencyOrder.at(ii).finishLoad(database, loadedData.at(ii));
+   }
+   return;
+}
+
 bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
    qDebug() << Q_FUNC_INFO;
    for (auto ii : AllObjectStores) {
@@ -774,7 +1080,11 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection) {
    return true;
 }
 
-bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connectionNew) {
+bool WriteAllObjectStoresToNewDb(
+   Database & newDatabase,
+   QSqlDatabase & connectionNew,
+   std::function<void(QString const & tableName, int objectsWritten, int objectsTotal)> const & progress
+) {
    //
    // Start transaction
    // By the magic of RAII, this will abort if we exit this function (including by throwing an exception) without
@@ -783,12 +1093,284 @@ bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connecti
    //
    DbTransaction dbTransaction{newDatabase, connectionNew, DbTransaction::DISABLE_FOREIGN_KEYS};
 
+   int objectsTotal = 0;
    for (ObjectStore const * objectStore : AllObjectStores) {
-      if (!objectStore->writeAllToNewDb(newDatabase, connectionNew)) {
-         return false;
+      objectsTotal += objectStore->numObjects();
+   }
+   qInfo() << Q_FUNC_INFO << "Writing" << objectsTotal << "objects to new DB";
+
+   bool succeeded = true;
+   int objectsWrittenBefore = 0;
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      QString const tableName{*objectStore->primaryTableName()};
+      if (progress) {
+         progress(tableName, objectsWrittenBefore, objectsTotal);
+      }
+      bool const wroteStore = objectStore->writeAllToNewDb(
+         newDatabase,
+         connectionNew,
+         [&](int objectsWritten) {
+            if (progress) {
+               progress(tableName, objectsWrittenBefore + objectsWritten, objectsTotal);
+            }
+            return;
+         }
+      );
+      if (!wroteStore) {
+         succeeded = false;
+         break;
       }
+      objectsWrittenBefore += objectStore->numObjects();
+      qDebug() << Q_FUNC_INFO << "Written" << objectsWrittenBefore << "of" << objectsTotal << "objects";
    }
 
-   dbTransaction.commit();
-   return true;
+   if (succeeded) {
+      succeeded = dbTransaction.commit();
+   }
+
+   //
+   // We won't be writing anything else to the new DB via the object stores, and the caller is going to remove the
+   // connection, so we need to let go of any statements we prepared on it.
+   //
+   ClearAllObjectStoreStatementCaches(connectionNew.connectionName());
+   return succeeded;
+}
+
+bool FlushAllObjectStores() {
+   bool succeeded = true;
+   std::vector<std::future<bool> > flushes;
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      flushes.push_back(objectStore->flush());
+   }
+   for (auto & flush : flushes) {
+      if (!flush.get()) {
+         succeeded = false;
+      }
+   }
+   if (!Database::instance().writer().waitForIdle()) {
+      succeeded = false;
+   }
+   return succeeded;
+}
+
+// This private implementation class holds all private non-virtual members of ObjectStoreTransaction
+class ObjectStoreTransaction::impl {
+public:
+   //
+   // The transaction on the DB writer's connection.  This is begun, committed and destroyed by operations on the DB
+   // writer, so the connection and DbTransaction are only ever touched on the thread doing the writes.  We share it
+   // with those operations, as they can outlive us.
+   //
+   struct WriterTransaction {
+      QSqlDatabase connection;
+      std::unique_ptr<DbTransaction> dbTransaction;
+      // Value of DbWriter::numFailures() when the transaction began, so we can tell if anything inside it failed
+      unsigned int failuresAtStart = 0;
+   };
+
+   impl() : writerTransaction{std::make_shared<WriterTransaction>()},
+            finished{false} {
+      return;
+   }
+
+   ~impl() = default;
+
+   /**
+    * \brief Finish the writer transaction, either by committing or rolling back, waiting for the DB writer to do so.
+    *        If it was rolled back, the object stores are told to undo what they did in memory during the transaction.
+    *
+    * \param commit If \c true, we commit the transaction -- unless any write inside it failed, in which case we roll
+    *               back the whole thing.
+    *
+    * \return \c true if the transaction was committed or successfully rolled back as requested, \c false otherwise
+    */
+   bool finish(bool const commit) {
+      this->finished = true;
+      //
+      // Make sure any property updates made inside the transaction are written inside it.  We need to know if any of
+      // these fail (including because the values couldn't be read), as well as the writes that are already queued.
+      //
+      auto flushes = std::make_shared<std::vector<std::future<bool> > >();
+      for (ObjectStore const * objectStore : AllObjectStores) {
+         flushes->push_back(objectStore->flush());
+      }
+      auto transaction = this->writerTransaction;
+      DbWriter & writer = Database::instance().writer();
+      auto committed = std::make_shared<bool>(false);
+      bool const succeeded = writer.enqueue(
+         commit ? "Commit object store transaction" : "Roll back object store transaction",
+         [transaction, commit, flushes, committed, &writer](QSqlDatabase &) {
+            if (!transaction->dbTransaction) {
+               return false;
+            }
+            bool result = false;
+            if (commit) {
+               //
+               // Everything written in the transaction was queued ahead of us, so has already been run, and the flushes
+               // are already done.  If any write failed, its own DbTransaction will only have rolled back its own
+               // savepoint, so it's up to us to make the transaction all or nothing.
+               //
+               bool allWritesSucceeded = (writer.numFailures() == transaction->failuresAtStart);
+               for (auto & flush : *flushes) {
+                  if (!flush.get()) {
+                     allWritesSucceeded = false;
+                  }
+               }
+               if (allWritesSucceeded) {
+                  *committed = transaction->dbTransaction->commit();
+               } else {
+                  qCritical() << Q_FUNC_INFO << "Rolling back object store transaction as write(s) in it failed";
+               }
+               if (!*committed) {
+                  transaction->dbTransaction->rollBack();
+               }
+               result = *committed;
+            } else {
+               result = transaction->dbTransaction->rollBack();
+            }
+            // Either way, the DbTransaction needs to be destroyed here on the thread that owns the connection.
+            transaction->dbTransaction.reset();
+            transaction->connection = QSqlDatabase{};
+            return result;
+         }
+      ).get();
+
+      //
+      // Now the DB is in its final state, the object stores can either merge what they recorded into any enclosing
+      // transaction or, if we rolled back, bring the in-memory objects back into line with the DB.
+      //
+      for (ObjectStore const * objectStore : AllObjectStores) {
+         // AllObjectStores holds const pointers for the benefit of other callers, but the object stores themselves
+         // are not const
+         const_cast<ObjectStore *>(objectStore)->finishTransactionJournal(*committed);
+      }
+      return succeeded;
+   }
+
+   std::shared_ptr<WriterTransaction> writerTransaction;
+   bool finished;
+};
+
+ObjectStoreTransaction::ObjectStoreTransaction() : pimpl{std::make_unique<impl>()} {
+   // Any updates queued before we started get written ahead of us
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      objectStore->flush();
+      const_cast<ObjectStore *>(objectStore)->startTransactionJournal();
+   }
+
+   Database & database = Database::instance();
+   auto transaction = this->pimpl->writerTransaction;
+   database.writer().enqueue(
+      "Begin object store transaction",
+      [&database, transaction](QSqlDatabase & connection) {
+         transaction->connection = connection;
+         transaction->dbTransaction = std::make_unique<DbTransaction>(database, transaction->connection);
+         //
+         // Everything queued ahead of us has now run, so only failures from here on count against this transaction.
+         // That includes this operation, if the DbTransaction couldn't be begun, as DbWriter will count the failure
+         // once we return.
+         //
+         transaction->failuresAtStart = database.writer().numFailures();
+         return transaction->dbTransaction->begun();
+      }
+   );
+   return;
+}
+
+ObjectStoreTransaction::~ObjectStoreTransaction() {
+   if (!this->pimpl->finished) {
+      qWarning() << Q_FUNC_INFO << "Rolling back uncommitted object store transaction";
+      // We have to wait for the rollback, so that the object stores can then reload what's in the DB
+      this->pimpl->finish(false);
+   }
+   return;
+}
+
+bool ObjectStoreTransaction::commit() {
+   if (this->pimpl->finished) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Object store transaction already finished";
+      Q_ASSERT(false);
+      return false;
+   }
+   bool const committed = this->pimpl->finish(true);
+   if (!committed) {
+      qCritical() << Q_FUNC_INFO << "Unable to commit object store transaction";
+   }
+   return committed;
+}
+
+void ObjectStoreTransaction::rollBack() {
+   if (this->pimpl->finished) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Object store transaction already finished";
+      Q_ASSERT(false);
+      return;
+   }
+   if (!this->pimpl->finish(false)) {
+      qCritical() << Q_FUNC_INFO << "Error rolling back object store transaction";
+   }
+   return;
+}
+
+BulkImportSession::BulkImportSession() : objectStoreTransaction{}, finished{false} {
+   qDebug() << Q_FUNC_INFO << "Starting bulk import session";
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      // AllObjectStores holds const pointers for the benefit of other callers, but the object stores themselves are
+      // not const
+      const_cast<ObjectStore *>(objectStore)->startBulkInsert();
+   }
+   return;
+}
+
+BulkImportSession::~BulkImportSession() {
+   if (!this->finished) {
+      qWarning() << Q_FUNC_INFO << "Rolling back uncommitted bulk import session";
+      this->objectStoreTransaction.rollBack();
+      this->finishBulkInsert();
+   }
+   return;
+}
+
+bool BulkImportSession::commit() {
+   if (this->finished) {
+      // This is a coding error
+      qCritical() << Q_FUNC_INFO << "Bulk import session already finished";
+      Q_ASSERT(false);
+      return false;
+   }
+   bool const committed = this->objectStoreTransaction.commit();
+   if (!committed) {
+      qCritical() << Q_FUNC_INFO << "Unable to commit bulk import session";
+   }
+   this->finishBulkInsert();
+   return committed;
+}
+
+void BulkImportSession::finishBulkInsert() {
+   this->finished = true;
+   //
+   // Now that the DB writes are finished, tell the rest of the program about all the new objects.  (If we are nested
+   // inside another session, the object stores will hold on to the IDs until that one finishes.)
+   //
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      const_cast<ObjectStore *>(objectStore)->finishBulkInsert();
+   }
+   qDebug() << Q_FUNC_INFO << "Finished bulk import session";
+   return;
+}
+
+void ClearAllObjectStoreStatementCaches(QString const & connectionName) {
+   unsigned int totalHits = 0;
+   unsigned int totalMisses = 0;
+   for (ObjectStore const * objectStore : AllObjectStores) {
+      auto const stats = objectStore->statementCacheStats();
+      totalHits   += stats.hits;
+      totalMisses += stats.misses;
+      objectStore->clearStatementCache(connectionName);
+   }
+   qInfo() <<
+      Q_FUNC_INFO << "Released prepared statements for connection" << connectionName << "- cache usage so far:" <<
+      totalHits << "hit(s)," << totalMisses << "miss(es)";
+   return;
 }
@@ -22,6 +22,7 @@
 #include <memory>
 
 #include <QDebug>
+#include <QMap>
 
 #include "database/ObjectStore.h"
 #include "model/NamedEntity.h"
@@ -39,10 +40,11 @@ public:
     *
     * \param primaryTable First in the list of fields in this table defn should be the primary key
     */
-   ObjectStoreTyped(TypeLookup               const & typeLookup,
-                    TableDefinition          const & primaryTable,
-                    JunctionTableDefinitions const & junctionTables = JunctionTableDefinitions{}) :
-      ObjectStore(typeLookup, primaryTable, junctionTables) {
+   ObjectStoreTyped(TypeLookup                const & typeLookup,
+                    TableDefinition           const & primaryTable,
+                    JunctionTableDefinitions  const & junctionTables   = JunctionTableDefinitions{},
+                    SecondaryIndexDefinitions const & secondaryIndexes = SecondaryIndexDefinitions{}) :
+      ObjectStore(typeLookup, primaryTable, junctionTables, secondaryIndexes) {
       return;
    }
 
@@ -278,6 +280,20 @@ public:
       );
    }
 
+   /**
+    * \brief Find all objects whose given property has the given value.  See \c ObjectStore::findAllWithPropertyValue.
+    */
+   QList<std::shared_ptr<NE> > findAllWithPropertyValue(BtStringConst const & propertyName,
+                                                        QVariant const & value) const {
+      return this->convertShared(this->ObjectStore::findAllWithPropertyValue(propertyName, value));
+   }
+   /**
+    * \brief Raw pointer version of \c findAllWithPropertyValue
+    */
+   QList<NE *> findAllRawWithPropertyValue(BtStringConst const & propertyName, QVariant const & value) const {
+      return this->convertRaw(this->ObjectStore::findAllWithPropertyValue(propertyName, value));
+   }
+
    /**
     * \brief Special case of \c findAllMatching that returns a list of all cached objects of a given type
     */
@@ -392,6 +408,37 @@ private:
    ObjectStoreTyped& operator=(ObjectStoreTyped&& other) = delete;
 };
 
+/**
+ * \brief Load all the object stores, doing the DB reads in parallel on worker threads and then creating the objects
+ *        on the calling thread in foreign key dependency order.  Should be called once, at start-up, after the
+ *        database has been loaded.  (Any object store that is accessed before this is called will just load itself
+ *        on first use, as before.)
+ *
+ *        If there is a snapshot (see \c WriteObjectStoreSnapshot()) that is still valid for the DB, we read the data
+ *        from that instead of from the DB.
+ *
+ * \param database
+ */
+void LoadAllObjectStores(Database & database);
+
+/**
+ * \brief Read the snapshot written by \c WriteObjectStoreSnapshot(), provided it is intact and the DB has not changed
+ *        since it was written.  This is what \c LoadAllObjectStores() uses in place of reading the DB.
+ *
+ * \return The data for each object store, or an empty map if there is no usable snapshot
+ */
+QMap<ObjectStore const *, std::shared_ptr<ObjectStore::LoadedData> > ReadObjectStoreSnapshot(Database & database);
+
+/**
+ * \brief Write a snapshot of all the object stores to \c Database::snapshotFileName(), so that the next call to
+ *        \c LoadAllObjectStores() can read from that rather than the DB, provided the DB has not changed in between
+ *        (as determined by \c Database::fileStamp()).  Should be called when nothing else is going to write to the DB,
+ *        after all object stores have been flushed.
+ *
+ * \return \c true if the snapshot was written, \c false otherwise
+ */
+bool WriteObjectStoreSnapshot(Database & database);
+
 /**
  * \brief Does what it says on the tin.  Note that it is the caller's responsibility to handle transactions.
  *
@@ -407,8 +454,128 @@ bool CreateAllDatabaseTables(Database & database, QSqlDatabase & connection);
  *
  *        Caller's responsibility to have called \c CreateAllDatabaseTables
  *
+ * \param newDatabase
+ * \param connectionNew
+ * \param progress  If set, called periodically with the table being written, and the number of objects written so far
+ *                  and in total (across all tables)
+ *
  * \return \c true if succeeded \c false otherwise
  */
-bool WriteAllObjectStoresToNewDb(Database & newDatabase, QSqlDatabase & connectionNew);
+bool WriteAllObjectStoresToNewDb(
+   Database & newDatabase,
+   QSqlDatabase & connectionNew,
+   std::function<void(QString const & tableName, int objectsWritten, int objectsTotal)> const & progress = nullptr
+);
+
+/**
+ * \brief Release the prepared statements that all object stores are holding for the named DB connection.  Must be
+ *        called before the connection is removed.
+ *
+ * \param connectionName
+ */
+void ClearAllObjectStoreStatementCaches(QString const & connectionName);
+
+/**
+ * \brief Write all queued property updates in all object stores to the DB, and wait for the DB writer thread to finish
+ *        all outstanding writes.  See \c ObjectStore::flush and \c DbWriter.
+ *
+ * \return \c true if succeeded \c false otherwise (including if any write on the DB writer thread has failed since the
+ *         last call)
+ */
+bool FlushAllObjectStores();
+
+/**
+ * \brief RAII class for making a group of object store operations (eg copying a Recipe, which inserts lots of objects)
+ *        atomic, and for having them cost one commit to the DB rather than one each.
+ *
+ *        Constructing one starts a transaction on the DB writer (see \c DbWriter), and every write queued after that,
+ *        until the \c ObjectStoreTransaction is committed or destroyed, is part of that transaction.  (The
+ *        \c DbTransaction that each write uses becomes a savepoint inside it -- see comments in DbTransaction.h.)
+ *        Queued property updates (see \c ObjectStore::updateProperty()) are flushed at the start and the end so that
+ *        they end up on the right side of the transaction boundaries.
+ *
+ *        If any write in the transaction fails, \c commit() rolls back the whole transaction rather than committing
+ *        what's left.  If the \c ObjectStoreTransaction goes out of scope without \c commit() having been called then
+ *        the DB changes are also rolled back.  On rollback, the object stores undo what they did in memory: objects
+ *        inserted during the transaction are removed from the stores (and have their primary keys reset), deleted
+ *        ones are put back, and updated ones are reloaded from the DB (see \c ObjectStore::startTransactionJournal()).
+ *        This is still for dealing with errors rather than for "cancel" functionality, as any object that was changed
+ *        without being stored is not touched.
+ *
+ *        Can be nested, in which case the inner one becomes a savepoint in the outer one.  Should only be used on the
+ *        thread that owns the object stores.
+ */
+class ObjectStoreTransaction {
+public:
+   ObjectStoreTransaction();
+   ~ObjectStoreTransaction();
+
+   /**
+    * \brief Commit the transaction, waiting for the DB writer to finish doing so
+    *
+    * \return \c true if the commit succeeded, \c false otherwise (in which case the whole transaction has been
+    *         rolled back)
+    */
+   bool commit();
+
+   /**
+    * \brief Roll back the transaction now, rather than when the object goes out of scope, waiting for the DB writer to
+    *        finish doing so
+    */
+   void rollBack();
+
+private:
+   // Private implementation details - see https://herbsutter.com/gotw/_100/
+   class impl;
+   std::unique_ptr<impl> pimpl;
+
+   // RAII class shouldn't be getting copied or moved
+   ObjectStoreTransaction(ObjectStoreTransaction const &) = delete;
+   ObjectStoreTransaction & operator=(ObjectStoreTransaction const &) = delete;
+   ObjectStoreTransaction(ObjectStoreTransaction &&) = delete;
+   ObjectStoreTransaction & operator=(ObjectStoreTransaction &&) = delete;
+};
+
+/**
+ * \brief Mini RAII class for importing a lot of objects (eg from a BeerXML file) in one go.  For the time that it's in
+ *        scope:
+ *          - All DB writes are done in a single \c ObjectStoreTransaction, which is committed by \c commit().  So,
+ *            eg, importing all the default data is one commit rather than thousands.  If the session goes out of
+ *            scope without \c commit() having been called (eg because the import failed part way through) then
+ *            everything written during the session is rolled back.
+ *          - Object stores do not emit \c ObjectStore::signalObjectInserted for each new object, but instead emit one
+ *            \c ObjectStore::signalObjectsInserted at the end of the session (see \c ObjectStore::startBulkInsert()).
+ *
+ *        Sessions can be nested, in which case the signals are emitted when the outermost one ends.  Should only be
+ *        used on the thread that owns the object stores.
+ */
+class BulkImportSession {
+public:
+   BulkImportSession();
+   ~BulkImportSession();
+
+   /**
+    * \brief Commit everything written during the session, and emit the signals for the new objects.  Should be called
+    *        at most once.
+    *
+    * \return \c true if the commit succeeded, \c false otherwise (in which case the import has been rolled back)
+    */
+   bool commit();
+
+private:
+   ObjectStoreTransaction objectStoreTransaction;
+   bool finished;
+
+   /**
+    * \brief Tell the object stores the bulk insert is over, so they can emit their signals
+    */
+   void finishBulkInsert();
+
+   // RAII class shouldn't be getting copied or moved
+   BulkImportSession(BulkImportSession const &) = delete;
+   BulkImportSession & operator=(BulkImportSession const &) = delete;
+   BulkImportSession(BulkImportSession &&) = delete;
+   BulkImportSession & operator=(BulkImportSession &&) = delete;
+};
 
 #endif
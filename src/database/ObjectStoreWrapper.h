@@ -164,8 +164,10 @@ namespace ObjectStoreWrapper {
       return ObjectStoreTyped<NE>::getInstance().insertOrUpdate(static_cast<QObject &>(ne));
    }
 
-   template<class NE> void updateProperty(NE const & ne, BtStringConst const & propertyName) {
-      ObjectStoreTyped<NE>::getInstance().updateProperty(ne, propertyName);
+   template<class NE> void updateProperty(NE const & ne,
+                                          BtStringConst const & propertyName,
+                                          ObjectStore::WriteMode const writeMode = ObjectStore::WriteMode::Deferred) {
+      ObjectStoreTyped<NE>::getInstance().updateProperty(ne, propertyName, writeMode);
       return;
    }
 
@@ -0,0 +1,269 @@
+/*
+ * database/SqliteBackup.cpp is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "database/SqliteBackup.h"
+
+#include <algorithm>
+
+#include <sqlite3.h>
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QSqlDatabase>
+#include <QSqlDriver>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QVariant>
+
+namespace {
+   //
+   // How long to pause between steps, to give other connections a chance to get at the DB.  (This is also how long we
+   // wait before retrying if the source DB is busy.)
+   //
+   int constexpr pauseBetweenSteps_ms = 5;
+
+   //
+   // If some other connection holds a lock on the source DB for longer than this many retries, we give up rather than
+   // hang.  (With the pause above, this is at least 10 seconds.)
+   //
+   int constexpr maxBusyRetries = 2000;
+
+   /**
+    * \brief Get the SQLite handle from a Qt SQLite connection, or \c nullptr if it's not one.  See
+    *        https://doc.qt.io/qt-5/qsqldriver.html#handle.
+    */
+   sqlite3 * getSqliteHandle(QSqlDatabase const & connection) {
+      QVariant const handle = connection.driver()->handle();
+      if (!handle.isValid() || qstrcmp(handle.typeName(), "sqlite3*") != 0) {
+         qCritical() << Q_FUNC_INFO << "Connection has no SQLite handle (driver handle is" << handle.typeName() << ")";
+         return nullptr;
+      }
+      return *static_cast<sqlite3 * const *>(handle.constData());
+   }
+
+   /**
+    * \brief Ask the Qt SQLite driver which SQLite it's using, and compare that with the library we're linked against
+    */
+   bool checkDriverUsesLinkedSqlite() {
+      QString const linkedVersion{sqlite3_libversion()};
+      QString const linkedSourceId{sqlite3_sourceid()};
+      QString driverVersion;
+      QString driverSourceId;
+
+      // An in-memory DB is enough to ask the question, and means we don't touch any real DB file with the driver
+      QString const connectionName{"SqliteBackup-libraryCheck"};
+      {
+         QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+         connection.setDatabaseName(":memory:");
+         if (connection.open()) {
+            QSqlQuery sqlQuery{connection};
+            if (sqlQuery.exec("SELECT sqlite_version(), sqlite_source_id()") && sqlQuery.next()) {
+               driverVersion  = sqlQuery.value(0).toString();
+               driverSourceId = sqlQuery.value(1).toString();
+            } else {
+               qCritical() << Q_FUNC_INFO << "Unable to query SQLite version:" << sqlQuery.lastError().text();
+            }
+            connection.close();
+         } else {
+            qCritical() << Q_FUNC_INFO << "Unable to open in-memory DB:" << connection.lastError().text();
+         }
+      }
+      QSqlDatabase::removeDatabase(connectionName);
+
+      bool const sameLibrary = !driverVersion.isEmpty() &&
+                               driverVersion == linkedVersion &&
+                               driverSourceId == linkedSourceId;
+      if (sameLibrary) {
+         qInfo() << Q_FUNC_INFO << "Qt SQLite driver and Brewtarget both use SQLite" << linkedVersion;
+      } else {
+         qWarning() <<
+            Q_FUNC_INFO << "Qt SQLite driver uses SQLite" << driverVersion << "(" << driverSourceId << ") but we are "
+            "linked against" << linkedVersion << "(" << linkedSourceId << "), so online backup is not available";
+      }
+      return sameLibrary;
+   }
+}
+
+SqliteBackup::SqliteBackup(QString const & sourceFileName,
+                           QString const & destinationFileName,
+                           int const pagesPerStep,
+                           QObject * parent) :
+   QThread{parent},
+   m_sourceFileName{sourceFileName},
+   m_destinationFileName{destinationFileName},
+   m_pagesPerStep{pagesPerStep},
+   m_succeeded{false},
+   m_bytesCopied{0},
+   m_elapsed_ms{0} {
+   return;
+}
+
+SqliteBackup::~SqliteBackup() {
+   // It's not safe to destroy a QThread that is still running
+   this->wait();
+   return;
+}
+
+bool SqliteBackup::succeeded() const {
+   return this->m_succeeded.load();
+}
+
+QString const & SqliteBackup::destinationFileName() const {
+   return this->m_destinationFileName;
+}
+
+bool SqliteBackup::driverUsesLinkedSqlite() {
+   // Initialisation of a function-local static is thread-safe, so this also stops two threads doing the check at once
+   static bool const result = checkDriverUsesLinkedSqlite();
+   return result;
+}
+
+qint64 SqliteBackup::bytesCopied() const {
+   return this->m_bytesCopied.load();
+}
+
+qint64 SqliteBackup::elapsed_ms() const {
+   return this->m_elapsed_ms.load();
+}
+
+bool SqliteBackup::backupNow() {
+   this->run();
+   return this->succeeded();
+}
+
+void SqliteBackup::run() {
+   QElapsedTimer timer;
+   timer.start();
+
+   //
+   // Qt connections can only be used on the thread that created them, so we make our own, and remove it once we're
+   // done.  (The QSqlDatabase object has to be gone before we can do that, hence the extra scope.)
+   //
+   QString const connectionName = QString{"SqliteBackup-%1"}.arg(reinterpret_cast<quintptr>(this), 0, 36);
+   bool succeeded = false;
+   {
+      QSqlDatabase connection = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      connection.setDatabaseName(this->m_sourceFileName);
+      if (!connection.open()) {
+         qCritical() <<
+            Q_FUNC_INFO << "Could not open" << this->m_sourceFileName << "to back it up:" <<
+            connection.lastError().text();
+      } else {
+         succeeded = this->doBackup(connection);
+         connection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+
+   qint64 const elapsed_ms = timer.elapsed();
+   qint64 const bytesCopied = succeeded ? QFileInfo{this->m_destinationFileName}.size() : 0;
+   this->m_elapsed_ms.store(elapsed_ms);
+   this->m_bytesCopied.store(bytesCopied);
+   this->m_succeeded.store(succeeded);
+
+   if (succeeded) {
+      // Avoid dividing by zero for tiny DBs
+      double const elapsed_s = std::max(elapsed_ms, static_cast<qint64>(1)) / 1000.0;
+      qInfo() <<
+         Q_FUNC_INFO << "Backed up" << this->m_sourceFileName << "to" << this->m_destinationFileName << "(" <<
+         bytesCopied << "bytes) in" << elapsed_ms << "ms (" <<
+         (static_cast<double>(bytesCopied) / (1024.0 * 1024.0) / elapsed_s) << "MiB/s)";
+   } else {
+      qWarning() <<
+         Q_FUNC_INFO << "Backup of" << this->m_sourceFileName << "to" << this->m_destinationFileName << "failed";
+   }
+   return;
+}
+
+bool SqliteBackup::doBackup(QSqlDatabase & connection) {
+   //
+   // If the driver has its own copy of SQLite, then its sqlite3 handle means nothing to our copy.  We also don't want
+   // to open the DB file directly with our copy, as two copies of SQLite in one process don't know about each other's
+   // file locks, which can corrupt the DB.  See
+   // https://www.sqlite.org/howtocorrupt.html#multiple_copies_of_sqlite_linked_into_the_same_application.
+   //
+   if (!SqliteBackup::driverUsesLinkedSqlite()) {
+      qCritical() << Q_FUNC_INFO << "Refusing to back up with a different SQLite library from the Qt driver";
+      return false;
+   }
+
+   sqlite3 * sourceHandle = getSqliteHandle(connection);
+   if (!sourceHandle) {
+      return false;
+   }
+
+   // Start from an empty file, so we don't pick up a stale write-ahead log from some previous file of the same name
+   QFile::remove(this->m_destinationFileName);
+   QFile::remove(this->m_destinationFileName + "-wal");
+
+   sqlite3 * destinationHandle = nullptr;
+   int returnCode = sqlite3_open_v2(this->m_destinationFileName.toUtf8().constData(),
+                                    &destinationHandle,
+                                    SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE,
+                                    nullptr);
+   if (returnCode != SQLITE_OK) {
+      qCritical() <<
+         Q_FUNC_INFO << "Could not create" << this->m_destinationFileName << ":" <<
+         (destinationHandle ? sqlite3_errmsg(destinationHandle) : sqlite3_errstr(returnCode));
+      // Per https://www.sqlite.org/c3ref/open.html, we have to close the handle even if the open failed
+      sqlite3_close(destinationHandle);
+      return false;
+   }
+
+   sqlite3_backup * backup = sqlite3_backup_init(destinationHandle, "main", sourceHandle, "main");
+   if (!backup) {
+      qCritical() << Q_FUNC_INFO << "Could not start backup:" << sqlite3_errmsg(destinationHandle);
+      sqlite3_close(destinationHandle);
+      return false;
+   }
+
+   int busyRetries = 0;
+   do {
+      returnCode = sqlite3_backup_step(backup, this->m_pagesPerStep);
+      int const pagesTotal = sqlite3_backup_pagecount(backup);
+      emit this->progress(pagesTotal - sqlite3_backup_remaining(backup), pagesTotal);
+
+      if (returnCode == SQLITE_BUSY || returnCode == SQLITE_LOCKED) {
+         if (++busyRetries > maxBusyRetries) {
+            qWarning() << Q_FUNC_INFO << "Giving up as source DB has been busy for too long";
+            break;
+         }
+      } else {
+         busyRetries = 0;
+      }
+
+      if (returnCode != SQLITE_DONE) {
+         sqlite3_sleep(pauseBetweenSteps_ms);
+      }
+   } while (returnCode == SQLITE_OK || returnCode == SQLITE_BUSY || returnCode == SQLITE_LOCKED);
+
+   // sqlite3_backup_finish() releases everything associated with the backup, regardless of whether it succeeded
+   sqlite3_backup_finish(backup);
+   bool const succeeded = (returnCode == SQLITE_DONE);
+   if (!succeeded) {
+      qCritical() << Q_FUNC_INFO << "Backup failed:" << sqlite3_errstr(returnCode);
+   }
+
+   sqlite3_close(destinationHandle);
+   if (!succeeded) {
+      QFile::remove(this->m_destinationFileName);
+   }
+   return succeeded;
+}
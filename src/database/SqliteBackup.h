@@ -0,0 +1,122 @@
+/*
+ * database/SqliteBackup.h is part of Brewtarget, and is copyright the following
+ * authors 2026:
+ *   • agent <agent@local>
+ *
+ * Brewtarget is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Brewtarget is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef DATABASE_SQLITEBACKUP_H
+#define DATABASE_SQLITEBACKUP_H
+#pragma once
+
+#include <atomic>
+
+#include <QSqlDatabase>
+#include <QString>
+#include <QThread>
+
+/**
+ * \class SqliteBackup
+ *
+ * \brief Copies a live SQLite database to a backup file, on a background thread, using SQLite's online backup API
+ *        (see https://www.sqlite.org/backup.html).
+ *
+ *        Unlike copying the DB file, this is safe while other connections (eg the \c DbWriter thread) are writing: the
+ *        backup is always a consistent snapshot of the DB, including anything still in the write-ahead log.  We copy
+ *        \c pagesPerStep pages at a time and pause briefly between steps, so the source DB is only ever locked for
+ *        short periods.  If the DB is written to (by another connection) part way through, SQLite restarts the backup
+ *        automatically.
+ *
+ *        The backup opens its own connection to the source DB, through the Qt SQLite driver, and borrows the driver's
+ *        \c sqlite3 handle.  This only works if the driver uses the same SQLite library that we are linked against.
+ *        That's not the case where Qt bundles its own copy of SQLite (as in the official Windows and Mac builds of
+ *        Qt), and passing the driver's handle to our library would then be undefined behaviour.  So we check at run
+ *        time (see \c driverUsesLinkedSqlite()) and refuse to do the backup if the libraries differ.
+ *
+ *        Typical use is either:
+ *           - to call \c start() and connect to \c QThread::finished to find out when it's done (eg from the GUI);
+ *           - or, if the caller has nothing better to do, to call \c backupNow(), which does the backup on the
+ *             calling thread.
+ */
+class SqliteBackup : public QThread {
+   Q_OBJECT
+
+public:
+   /**
+    * \param sourceFileName  The SQLite DB file to back up
+    * \param destinationFileName  The backup file.  Overwritten if it already exists.
+    * \param pagesPerStep  How many pages to copy each time we lock the source DB
+    * \param parent
+    */
+   SqliteBackup(QString const & sourceFileName,
+                QString const & destinationFileName,
+                int const pagesPerStep = 256,
+                QObject * parent = nullptr);
+   virtual ~SqliteBackup();
+
+   /**
+    * \brief Do the backup on the calling thread (rather than calling \c start() to do it in the background)
+    *
+    * \return \c true if succeeded, \c false otherwise
+    */
+   bool backupNow();
+
+   /**
+    * \brief Whether the backup (once finished) succeeded
+    */
+   bool succeeded() const;
+
+   QString const & destinationFileName() const;
+
+   /**
+    * \brief Whether the Qt SQLite driver is using the same SQLite library as we are linked against, judged by
+    *        comparing the version and source ID that each reports.  (A match doesn't strictly prove it's the same copy
+    *        of the library, but a mismatch proves it isn't.)  The check is only done once, as the answer can't change
+    *        while we're running.
+    *
+    *        If this returns \c false, the backup will fail, so callers should copy the DB file some other way.
+    */
+   static bool driverUsesLinkedSqlite();
+
+   /**
+    * \brief Size of the backup, valid once finished
+    */
+   qint64 bytesCopied() const;
+
+   /**
+    * \brief How long the backup took, in milliseconds, valid once finished
+    */
+   qint64 elapsed_ms() const;
+
+signals:
+   /**
+    * \brief Emitted (from the backup thread) after each step
+    */
+   void progress(int pagesCopied, int pagesTotal);
+
+protected:
+   virtual void run() override;
+
+private:
+   QString const m_sourceFileName;
+   QString const m_destinationFileName;
+   int const m_pagesPerStep;
+   std::atomic<bool> m_succeeded;
+   std::atomic<qint64> m_bytesCopied;
+   std::atomic<qint64> m_elapsed_ms;
+
+   bool doBackup(QSqlDatabase & connection);
+};
+
+#endif
@@ -36,6 +36,7 @@
 #include "Localization.h"
 #include "Logging.h"
 #include "PersistentSettings.h"
+#include "RecipeAnalyser.h"
 #include "xml/BeerXml.h"
 
 namespace {
@@ -62,6 +63,22 @@ namespace {
       Database::instance().createBlank(filename);
       exit(0);
    }
+
+   /*!
+    * \brief Calculates the stats of every recipe in the database and writes them to the given file, without starting
+    *        the GUI.  See \c RecipeAnalyser.
+    */
+   void analyseAllRecipes(const QString & filename) {
+      Application::setInteractive(false);
+      if (!Application::initialize()) {
+         qCritical() << "Unable to load database";
+         Application::cleanup();
+         exit(1);
+      }
+      bool const succeeded = RecipeAnalyser::analyseAll(filename);
+      Application::cleanup();
+      exit(succeeded ? 0 : 1);
+   }
 }
 
 int main(int argc, char **argv) {
@@ -100,6 +117,13 @@ int main(int argc, char **argv) {
    parser.addOption(importFromXmlOption);
    QCommandLineOption const createBlankDBOption("create-blank", "Creates an empty database in <file>", "file");
    parser.addOption(createBlankDBOption);
+   QCommandLineOption const analyseAllOption{
+      "analyse-all",
+      "Calculates OG, FG, ABV, IBU, colour and calories for all recipes and writes them to <file> (as JSON if the name "
+      "ends in .json, otherwise as CSV)",
+      "file"
+   };
+   parser.addOption(analyseAllOption);
    /*!
     * \brief Forces the application to a specific user directory.
     *
@@ -190,6 +214,7 @@ int main(int argc, char **argv) {
 
    if (parser.isSet(importFromXmlOption)) importFromXml(parser.value(importFromXmlOption));
    if (parser.isSet(createBlankDBOption)) createBlankDb(parser.value(createBlankDBOption));
+   if (parser.isSet(analyseAllOption)) analyseAllRecipes(parser.value(analyseAllOption));
 
    try {
       qInfo() <<
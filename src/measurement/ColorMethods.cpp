@@ -99,7 +99,11 @@ void ColorMethods::saveColorFormulaSettings() {
 
 
 double ColorMethods::mcuToSrm(double mcu) {
-   switch (ColorMethods::colorFormula) {
+   return ColorMethods::mcuToSrm(ColorMethods::colorFormula, mcu);
+}
+
+double ColorMethods::mcuToSrm(ColorType formula, double mcu) {
+   switch (formula) {
       case ColorMethods::MOREY:
          return morey(mcu);
       case ColorMethods::DANIEL:
@@ -107,7 +111,7 @@ double ColorMethods::mcuToSrm(double mcu) {
       case ColorMethods::MOSHER:
          return mosher(mcu);
       default:
-         qCritical() << QObject::tr("Invalid color formula type: %1").arg(ColorMethods::colorFormula);
+         qCritical() << QObject::tr("Invalid color formula type: %1").arg(formula);
          return morey(mcu);
    }
 }
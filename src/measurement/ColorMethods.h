@@ -42,6 +42,9 @@ namespace ColorMethods {
 
    //! Depending on selected algorithm, convert malt color units to SRM.
    double mcuToSrm(double mcu);
+
+   //! As above, but using the specified algorithm rather than the selected one.  (Safe to call from any thread.)
+   double mcuToSrm(ColorType formula, double mcu);
 }
 
 #endif
@@ -22,75 +22,120 @@
 #include "measurement/IbuMethods.h"
 
 #include <cmath>
+#include <iterator>
 
 #include <QDebug>
 #include <QObject>
 #include <QString>
 
-#include "Algorithms.h"
 #include "measurement/Unit.h"
 #include "PersistentSettings.h"
 
 
 namespace {
    // The Tinseth, Rager and Garetz methods are explained and discussed at http://www.realbeer.com/hops/FAQ.html
-
-   double tinseth(double AArating,
-                  double hops_grams,
-                  double finalVolume_liters,
-                  double wort_grav,
-                  double minutes) {
-      return (
-         (AArating * hops_grams * 1000) /
-         finalVolume_liters) * ((1.0 - exp(-0.04 * minutes)) / 4.15) * (1.65 * pow(0.000125, (wort_grav - 1))
-      );
+   //
+   // Each formula is written as a "kernel" that does a whole hop schedule in one go.  Everything that depends only on
+   // the volume and gravity (which are the same for all hops in a recipe) is worked out once, before the loop, so the
+   // loop body is just straight-line arithmetic on the i-th element of each array, with no branches and no function
+   // calls other than exp/tanh.  This lets the compiler vectorise it.
+
+   void tinseth(std::size_t const numHops,
+                double const * AAratings,
+                double const * hops_grams,
+                double const * minutes,
+                double const finalVolume_liters,
+                double const wort_grav,
+                double * ibus) {
+      double const bignessFactor = 1.65 * std::pow(0.000125, wort_grav - 1.0);
+      double const scale = 1000.0 * bignessFactor / (4.15 * finalVolume_liters);
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         ibus[ii] = AAratings[ii] * hops_grams[ii] * (1.0 - std::exp(-0.04 * minutes[ii])) * scale;
+      }
+      return;
    }
 
-   double rager(double AArating,
-                double hops_grams,
-                double finalVolume_liters,
-                double wort_grav,
-                double minutes) {
-      double utilization = (18.11 + 13.86 * tanh((minutes - 31.32) / 18.17)) / 100.0;
-
-      double gravityFactor = (wort_grav > 1.050) ? (wort_grav - 1.050)/0.2 : 0.0;
-
-      return (hops_grams * utilization * AArating * 1000) / (finalVolume_liters * (1 + gravityFactor));
+   void rager(std::size_t const numHops,
+              double const * AAratings,
+              double const * hops_grams,
+              double const * minutes,
+              double const finalVolume_liters,
+              double const wort_grav,
+              double * ibus) {
+      double const gravityFactor = (wort_grav > 1.050) ? (wort_grav - 1.050)/0.2 : 0.0;
+      // The 1000 converts AA ratings to mg/g.  The 100 converts utilization from percent.
+      double const scale = 1000.0 / (100.0 * finalVolume_liters * (1.0 + gravityFactor));
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         double const utilization_pct = 18.11 + 13.86 * std::tanh((minutes[ii] - 31.32) / 18.17);
+         ibus[ii] = hops_grams[ii] * AAratings[ii] * utilization_pct * scale;
+      }
+      return;
    }
 
+   //
+   // Greg Noonan's utilization polynomial (in minutes), lowest order coefficient first.  (This used to be a Polynomial
+   // object, but we evaluate it inline so the loop below can be vectorised.)
+   //
+   constexpr double noonanCoefficients[] = {
+       0.7000029428,
+      -0.08868853463,
+       0.02720809386,
+      -0.002340415323,
+       0.00009925450081,
+      -0.000002102006144,
+       0.00000002132644293,
+      -0.00000000008229488217
+   };
+
+   //
+   // Noonan's gravity adjustment, based on a 60 minute boil.  Each entry is the highest gravity it applies to and the
+   // factor to use.  Anything above the last gravity uses the last factor.
+   //
+   struct NoonanUtilizationFactor {
+      double maxGravity;
+      double factor;
+   };
+   constexpr NoonanUtilizationFactor noonanUtilizationFactors[] = {
+      {1.050, 1     },
+      {1.065, 0.9286},
+      {1.085, 0.8571},
+      {1.100, 0.75  }
+   };
+
    /*!
     * \brief Calculates the IBU by Greg Noonans formula
     */
-   double noonan(double AArating,
-                 double hops_grams,
-                 double finalVolume_liters,
-                 double wort_grav,
-                 double minutes) {
-      double volumeFactor = (Measurement::Units::us_gallons.toCanonical(5.0).quantity())/ finalVolume_liters;
-      double hopsFactor = hops_grams/ (Measurement::Units::ounces.toCanonical(1.0).quantity() * 1000.0);
-      static Polynomial p(Polynomial() << 0.7000029428 << -0.08868853463 << 0.02720809386 << -0.002340415323 << 0.00009925450081 << -0.000002102006144 << 0.00000002132644293 << -0.00000000008229488217);
-
-      //using 60 minutes as a general table
-      double utilizationFactorTable[4][2] =  {
-                        {1.050, 1},
-                        {1.065, 0.9286},
-                        {1.085, 0.8571},
-                        {1.100, 0.75}
-                     };
-
-      double utilizationFactor;
-
-      if(wort_grav <= utilizationFactorTable[0][0]) {
-         utilizationFactor = utilizationFactorTable[0][1];
-      } else if(wort_grav <= utilizationFactorTable[1][0]) {
-         utilizationFactor = utilizationFactorTable[1][1];
-      } else if(wort_grav <= utilizationFactorTable[2][0]) {
-         utilizationFactor = utilizationFactorTable[2][1];
-      } else {
-         utilizationFactor = utilizationFactorTable[3][1];
+   void noonan(std::size_t const numHops,
+               double const * AAratings,
+               double const * hops_grams,
+               double const * minutes,
+               double const finalVolume_liters,
+               double const wort_grav,
+               double * ibus) {
+      // These are constants, but toCanonical() isn't constexpr, so we work them out once on first use
+      static double const fiveGallons_liters = Measurement::Units::us_gallons.toCanonical(5.0).quantity();
+      static double const oneOunce_grams     = Measurement::Units::ounces.toCanonical(1.0).quantity() * 1000.0;
+
+      double utilizationFactor = noonanUtilizationFactors[std::size(noonanUtilizationFactors) - 1].factor;
+      for (auto const & entry : noonanUtilizationFactors) {
+         if (wort_grav <= entry.maxGravity) {
+            utilizationFactor = entry.factor;
+            break;
+         }
       }
 
-      return(volumeFactor * ( hopsFactor * (100 * AArating) * p.eval(minutes) ) * utilizationFactor);
+      double const volumeFactor = fiveGallons_liters / finalVolume_liters;
+      // The 100 converts AA ratings to percent
+      double const scale = volumeFactor * utilizationFactor * 100.0 / oneOunce_grams;
+      for (std::size_t ii = 0; ii < numHops; ++ii) {
+         // Horner's method
+         double utilization = 0.0;
+         for (auto jj = std::rbegin(noonanCoefficients); jj != std::rend(noonanCoefficients); ++jj) {
+            utilization = utilization * minutes[ii] + *jj;
+         }
+         ibus[ii] = hops_grams[ii] * AAratings[ii] * utilization * scale;
+      }
+      return;
    }
 }
 
@@ -139,11 +184,40 @@ double IbuMethods::getIbus(double AArating,
                            double finalVolume_liters,
                            double wort_grav,
                            double minutes) {
-   switch(IbuMethods::ibuFormula) {
-      case IbuMethods::TINSETH: return tinseth(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
-      case IbuMethods::RAGER:   return rager(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
-      case IbuMethods::NOONAN:  return noonan(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+   return IbuMethods::getIbus(IbuMethods::ibuFormula, AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+}
+
+double IbuMethods::getIbus(IbuType formula,
+                           double AArating,
+                           double hops_grams,
+                           double finalVolume_liters,
+                           double wort_grav,
+                           double minutes) {
+   double ibus = 0.0;
+   IbuMethods::getIbus(formula, 1, &AArating, &hops_grams, &minutes, finalVolume_liters, wort_grav, &ibus);
+   return ibus;
+}
+
+void IbuMethods::getIbus(IbuType formula,
+                         std::size_t numHops,
+                         double const * AAratings,
+                         double const * hops_grams,
+                         double const * minutes,
+                         double finalVolume_liters,
+                         double wort_grav,
+                         double * ibus) {
+   switch(formula) {
+      case IbuMethods::TINSETH:
+         tinseth(numHops, AAratings, hops_grams, minutes, finalVolume_liters, wort_grav, ibus);
+         return;
+      case IbuMethods::RAGER:
+         rager(numHops, AAratings, hops_grams, minutes, finalVolume_liters, wort_grav, ibus);
+         return;
+      case IbuMethods::NOONAN:
+         noonan(numHops, AAratings, hops_grams, minutes, finalVolume_liters, wort_grav, ibus);
+         return;
    }
-   qCritical() << Q_FUNC_INFO << QObject::tr("Unrecognized IBU formula type. %1").arg(IbuMethods::ibuFormula);
-   return tinseth(AArating, hops_grams, finalVolume_liters, wort_grav, minutes);
+   qCritical() << Q_FUNC_INFO << QObject::tr("Unrecognized IBU formula type. %1").arg(formula);
+   tinseth(numHops, AAratings, hops_grams, minutes, finalVolume_liters, wort_grav, ibus);
+   return;
 }
@@ -22,6 +22,8 @@
 #define MEASUREMENT_IBUMETHODS_H
 #pragma once
 
+#include <cstddef>
+
 class QString;
 
 /*!
@@ -57,6 +59,38 @@ namespace IbuMethods {
     * \param minutes - minutes that the hops are in the boil
     */
    double getIbus(double AArating, double hops_grams, double finalVolume_liters, double wort_grav, double minutes);
+
+   /*!
+    * \brief As above, but using the specified algorithm rather than the selected one.  (Unlike the above, this does
+    *        not read any global state, so is safe to call from any thread.)
+    */
+   double getIbus(IbuType formula,
+                  double AArating,
+                  double hops_grams,
+                  double finalVolume_liters,
+                  double wort_grav,
+                  double minutes);
+
+   /*!
+    * \brief Calculates IBUs for a whole hop schedule in one go, using the specified algorithm.  This is much faster than
+    *        calling the above once per hop when there are lots of hops to do (eg when analysing many recipes, or
+    *        plotting utilization curves), as the formula is selected once per call, and the per-hop part of each
+    *        formula is a simple loop that the compiler can vectorise.
+    *
+    *        The hops are given as "structure of arrays": hop \c i has AA rating \c AAratings[i], mass
+    *        \c hops_grams[i] and boil time \c minutes[i].  Each array must have \c numHops elements.  Volume and
+    *        gravity are the same for all hops.  Like the previous function, this does not read any global state.
+    *
+    * \param ibus Output: \c ibus[i] is set to the IBUs from hop \c i.  Must have room for \c numHops elements.
+    */
+   void getIbus(IbuType formula,
+                std::size_t numHops,
+                double const * AAratings,
+                double const * hops_grams,
+                double const * minutes,
+                double finalVolume_liters,
+                double wort_grav,
+                double * ibus);
 }
 
 #endif
@@ -44,7 +44,7 @@
 //         I found to avoid copying this data on to the heap (which would be unnecessary since it's const and known at
 //         compile time).
 //
-Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
+Measurement::SucroseConversion constexpr Measurement::sucroseConversions[] = {
    // Refractive Index at 20°C  ||  % sucrose or degree Brix  ||  Apparent specific gravity @ 20/20 °C
    {  1.3330,                       0.0,                          1.00000  },
    {  1.3331,                       0.1,                          1.00039  }, // The PDF has this as 0.0 Brix, but I think that's clearly a typo
@@ -177,7 +177,7 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.3522,                      12.8,                          1.05174  },
    {  1.3523,                      12.9,                          1.05216  },
    {  1.3525,                      13.0,                          1.05259  },
-   {  1.3626,                      13.1,                          1.05301  },
+   {  1.3526,                      13.1,                          1.05301  }, // The PDF has the RI as 1.3626, but, from plotting the data, I think that's a typo
    {  1.3528,                      13.2,                          1.05343  },
    {  1.3529,                      13.3,                          1.05386  },
    {  1.3531,                      13.4,                          1.05428  },
@@ -190,7 +190,7 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.3542,                      14.1,                          1.05726  },
    {  1.3544,                      14.2,                          1.05769  },
    {  1.3545,                      14.3,                          1.05811  },
-   {  1.3447,                      14.4,                          1.05854  },
+   {  1.3546,                      14.4,                          1.05854  }, // The PDF has the RI as 1.3447, but, from plotting the data, I think that's a typo
    {  1.3548,                      14.5,                          1.05897  },
    {  1.3550,                      14.6,                          1.05940  },
    {  1.3552,                      14.7,                          1.05982  },
@@ -396,17 +396,17 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.3896,                      34.7,                          1.15201  },
    {  1.3898,                      34.8,                          1.15250  },
    {  1.3900,                      34.9,                          1.15300  },
-   {  1.13902,                     35.0,                          1.15350  },
+   {  1.3902,                      35.0,                          1.15350  }, // The PDF has the RI as 1.13902, but I think that's clearly a typo
    {  1.3904,                      35.1,                          1.15399  },
    {  1.3906,                      35.2,                          1.15449  },
    {  1.3908,                      35.3,                          1.15498  },
    {  1.3909,                      35.4,                          1.15548  },
-   {  1.13911,                     35.5,                          1.15598  },
+   {  1.3911,                      35.5,                          1.15598  }, // The PDF has the RI as 1.13911, but I think that's clearly a typo
    {  1.3913,                      35.6,                          1.15648  },
    {  1.3915,                      35.7,                          1.15698  },
    {  1.3916,                      35.8,                          1.15747  },
    {  1.3918,                      35.9,                          1.15797  },
-   {  1.13920,                     36.0,                          1.15847  },
+   {  1.3920,                      36.0,                          1.15847  }, // The PDF has the RI as 1.13920, but I think that's clearly a typo
    {  1.3922,                      36.1,                          1.15897  },
    {  1.3924,                      36.2,                          1.15947  },
    {  1.3926,                      36.3,                          1.15997  },
@@ -434,7 +434,7 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.3968,                      38.5,                          1.17107  },
    {  1.3970,                      38.6,                          1.17158  },
    {  1.3972,                      38.7,                          1.17209  },
-   {  1.37974,                     38.8,                          1.17260  },
+   {  1.3974,                      38.8,                          1.17260  }, // The PDF has the RI as 1.37974, but I think that's clearly a typo
    {  1.3976,                      38.9,                          1.17311  },
    {  1.3978,                      39.0,                          1.17362  },
    {  1.3980,                      39.1,                          1.17413  },
@@ -573,7 +573,7 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.4252,                      52.4,                          1.24537  },
    {  1.4254,                      52.5,                          1.24593  },
    {  1.4256,                      52.6,                          1.24649  },
-   {  1.4248,                      52.7,                          1.24705  },
+   {  1.4258,                      52.7,                          1.24705  }, // The PDF has the RI as 1.4248, but, from plotting the data, I think that's a typo
    {  1.4260,                      52.8,                          1.24761  },
    {  1.4262,                      52.9,                          1.24818  },
    {  1.4265,                      53.0,                          1.24874  },
@@ -612,7 +612,7 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
    {  1.4337,                      56.3,                          1.26752  }, // The PDF has the SG as 1.26772, but, from plotting the data, I think that's a typo
    {  1.4339,                      56.4,                          1.26810  },
    {  1.4341,                      56.5,                          1.26868  },
-   {  1.4313,                      56.6,                          1.26925  },
+   {  1.4343,                      56.6,                          1.26925  }, // The PDF has the RI as 1.4313, but, from plotting the data, I think that's a typo
    {  1.4345,                      56.7,                          1.26983  },
    {  1.4348,                      56.8,                          1.27041  },
    {  1.4350,                      56.9,                          1.27098  },
@@ -850,3 +850,88 @@ Measurement::SucroseConversion const Measurement::sucroseConversions[] = {
 };
 
 size_t constexpr Measurement::sucroseConversions_size = std::size(Measurement::sucroseConversions);
+
+namespace {
+   using Measurement::SucroseConversion;
+   using Measurement::sucroseConversions;
+   using Measurement::sucroseConversions_size;
+
+   constexpr bool isStrictlyIncreasing(double SucroseConversion::* column) {
+      for (size_t ii = 1; ii < sucroseConversions_size; ++ii) {
+         if (!(sucroseConversions[ii].*column > sucroseConversions[ii - 1].*column)) {
+            return false;
+         }
+      }
+      return true;
+   }
+
+   constexpr size_t numBucketsFor(double SucroseConversion::* column, double bucketWidth) {
+      double const range = sucroseConversions[sucroseConversions_size - 1].*column - sucroseConversions[0].*column;
+      return static_cast<size_t>(range / bucketWidth) + 1;
+   }
+
+   template<size_t numBuckets>
+   constexpr std::array<std::uint16_t, numBuckets> makeStartRows(double SucroseConversion::* column,
+                                                                 double bucketWidth) {
+      std::array<std::uint16_t, numBuckets> startRows{};
+      size_t row = 0;
+      for (size_t bucket = 0; bucket < numBuckets; ++bucket) {
+         double const bucketStart = sucroseConversions[0].*column + static_cast<double>(bucket) * bucketWidth;
+         while (row + 1 < sucroseConversions_size && sucroseConversions[row + 1].*column < bucketStart) {
+            ++row;
+         }
+         startRows[bucket] = static_cast<std::uint16_t>(row);
+      }
+      return startRows;
+   }
+
+   static_assert(sucroseConversions_size <= 65536, "Row numbers must fit in std::uint16_t");
+   static_assert(isStrictlyIncreasing(&SucroseConversion::refractiveIndexAt20C), "Refractive index not increasing");
+   static_assert(isStrictlyIncreasing(&SucroseConversion::degreesBrix         ), "Brix not increasing"            );
+   static_assert(isStrictlyIncreasing(&SucroseConversion::apparentSgAt2020C   ), "Specific gravity not increasing");
+
+   //
+   // Bucket widths are (roughly) half the smallest gap between rows, which is 0.0001 for refractive index, 0.1 for
+   // Brix and 0.00038 for SG.
+   //
+   double constexpr refractiveIndexBucketWidth = 0.00005;
+   double constexpr brixBucketWidth            = 0.05;
+   double constexpr sgBucketWidth              = 0.0002;
+
+   auto constexpr refractiveIndexStartRows =
+      makeStartRows<numBucketsFor(&SucroseConversion::refractiveIndexAt20C, refractiveIndexBucketWidth)>(
+         &SucroseConversion::refractiveIndexAt20C, refractiveIndexBucketWidth
+      );
+   auto constexpr brixStartRows =
+      makeStartRows<numBucketsFor(&SucroseConversion::degreesBrix, brixBucketWidth)>(
+         &SucroseConversion::degreesBrix, brixBucketWidth
+      );
+   auto constexpr sgStartRows =
+      makeStartRows<numBucketsFor(&SucroseConversion::apparentSgAt2020C, sgBucketWidth)>(
+         &SucroseConversion::apparentSgAt2020C, sgBucketWidth
+      );
+}
+
+Measurement::SucroseConversionIndex constexpr Measurement::sucroseConversionsByRefractiveIndex {
+   &SucroseConversion::refractiveIndexAt20C,
+   sucroseConversions[0].refractiveIndexAt20C,
+   refractiveIndexBucketWidth,
+   refractiveIndexStartRows.size(),
+   refractiveIndexStartRows.data()
+};
+
+Measurement::SucroseConversionIndex constexpr Measurement::sucroseConversionsByBrix {
+   &SucroseConversion::degreesBrix,
+   sucroseConversions[0].degreesBrix,
+   brixBucketWidth,
+   brixStartRows.size(),
+   brixStartRows.data()
+};
+
+Measurement::SucroseConversionIndex constexpr Measurement::sucroseConversionsBySg {
+   &SucroseConversion::apparentSgAt2020C,
+   sucroseConversions[0].apparentSgAt2020C,
+   sgBucketWidth,
+   sgStartRows.size(),
+   sgStartRows.data()
+};
@@ -21,6 +21,7 @@
 #pragma once
 
 #include <cstddef> // For size_t
+#include <cstdint>
 
 namespace Measurement {
 
@@ -33,6 +34,29 @@ namespace Measurement {
    extern SucroseConversion const sucroseConversions[];
 
    extern size_t const sucroseConversions_size;
+
+   /**
+    * \brief Lets us find where a value lies in one of the columns of \c sucroseConversions in constant time, rather
+    *        than by binary search.  (All three columns are strictly increasing.)
+    *
+    *        The range of values in the column is divided into \c numBuckets buckets of equal width, \c bucketWidth,
+    *        starting at \c lowest.  \c startRows[i] is the last row whose value is less than the start of bucket
+    *        \c i (or 0 if there isn't one).  Buckets are narrower than the smallest gap between rows, so the row we want
+    *        is never more than a step or two away from there.
+    *
+    *        The indexes are generated at compile time from \c sucroseConversions.
+    */
+   struct SucroseConversionIndex {
+      double SucroseConversion::* column;
+      double lowest;
+      double bucketWidth;
+      size_t numBuckets;
+      std::uint16_t const * startRows;
+   };
+
+   extern SucroseConversionIndex const sucroseConversionsByRefractiveIndex;
+   extern SucroseConversionIndex const sucroseConversionsByBrix;
+   extern SucroseConversionIndex const sucroseConversionsBySg;
 }
 
 #endif
@@ -330,5 +330,5 @@ void Fermentable::setMaxInBatch_pct(double var) {
 }
 
 Recipe * Fermentable::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
@@ -221,7 +221,7 @@ void Hop::setInventoryAmount(double num) { InventoryUtils::setAmount(*this, num)
 
 
 Recipe * Hop::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
 
 bool hopLessThanByTime(Hop const * lhs, Hop const * rhs) {
@@ -49,18 +49,16 @@ public:
       }
 
       // ...otherwise we have to ask the recipe object store to find our recipe
-      auto result = ObjectStoreTyped<Recipe>::getInstance().findFirstMatching(
-         [this](std::shared_ptr<Recipe> rec) {return rec->uses(instruction);}
-      );
+      Recipe * result = Recipe::findOwningRecipe(this->instruction);
 
-      if (!result.has_value()) {
+      if (!result) {
          qCritical() << Q_FUNC_INFO << "Unable to find Recipe for Instruction #" << this->instruction.key();
          return nullptr;
       }
 
-      this->recipe = result.value();
+      this->recipe = ObjectStoreWrapper::getSharedFromRaw(result);
 
-      return result.value();
+      return this->recipe;
    }
 
 private:
@@ -185,5 +183,5 @@ int Instruction::instructionNumber() const {
 }
 
 Recipe * Instruction::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
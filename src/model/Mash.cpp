@@ -366,8 +366,13 @@ QList< std::shared_ptr<MashStep> > Mash::mashSteps() const {
          mashSteps.append(ObjectStoreWrapper::getById<MashStep>(ii));
       }
    } else {
-      mashSteps = ObjectStoreWrapper::findAllMatching<MashStep>(
-         [mashId](std::shared_ptr<MashStep> const ms) {return ms->getMashId() == mashId && !ms->deleted();}
+      mashSteps = ObjectStoreTyped<MashStep>::getInstance().findAllWithPropertyValue(PropertyNames::MashStep::mashId,
+                                                                                     mashId);
+      mashSteps.erase(
+         std::remove_if(mashSteps.begin(),
+                        mashSteps.end(),
+                        [](std::shared_ptr<MashStep> const ms) { return ms->deleted(); }),
+         mashSteps.end()
       );
 
       // Now we've got the MashSteps, we need to make sure they're in the right order
@@ -461,7 +466,7 @@ std::shared_ptr<MashStep> Mash::removeMashStep(std::shared_ptr<MashStep> mashSte
 }
 
 Recipe * Mash::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
 
 void Mash::hardDeleteOwnedEntities() {
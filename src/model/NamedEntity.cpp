@@ -329,9 +329,10 @@ QVector<int> NamedEntity::getParentAndChildrenIds() const {
    results.append(parent->m_key);
 
    // ...now find all the children, ie all the other ingredients of this type whose parent is the ingredient we just
-   // found
-   QList<std::shared_ptr<QObject> > children = this->getObjectStoreTypedInstance().findAllMatching(
-      [parent](std::shared_ptr<QObject> obj) { return std::static_pointer_cast<NamedEntity>(obj)->getParentKey() == parent->key(); }
+   // found.  (The object store keeps an index on parent key, so this doesn't need to look at every object.)
+   QList<std::shared_ptr<QObject> > children = this->getObjectStoreTypedInstance().findAllWithPropertyValue(
+      PropertyNames::NamedEntity::parentKey,
+      parent->key()
    );
    for (auto child : children) {
       results.append(std::static_pointer_cast<NamedEntity>(child)->key());
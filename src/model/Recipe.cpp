@@ -21,13 +21,19 @@
  */
 #include "model/Recipe.h"
 
+#include <array>
 #include <cmath> // For pow/log
+#include <mutex> // For std::call_once
+#include <optional>
 
 #include <QDate>
 #include <QDebug>
 #include <QInputDialog>
 #include <QList>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QObject>
+#include <QTimer>
 
 #include "Algorithms.h"
 #include "database/ObjectStoreWrapper.h"
@@ -51,6 +57,7 @@
 #include "PersistentSettings.h"
 #include "PhysicalConstants.h"
 #include "PreInstruction.h"
+#include "RecipeCalculator.h"
 
 namespace {
    /**
@@ -71,13 +78,7 @@ namespace {
       // (NB: The parent of the NamedEntity is not the same thing as its parent recipe.  We should perhaps find some
       // different terms!)
       //
-      auto matchingRecipe = ObjectStoreTyped<Recipe>::getInstance().findFirstMatching(
-         // NB: Important to do the lambda capture of var here by reference, otherwise we'll be passing in a copy of
-         //     var, which won't have an ID and therefore will never give a match.
-         [&var](Recipe * recipe) {
-            return recipe->uses(var);
-         }
-      );
+      Recipe * matchingRecipe = Recipe::findOwningRecipe(var);
       if (matchingRecipe == nullptr) {
          // The parameter is not already used in a recipe, so we'll be able to add it without making a copy
          // Note that we can't just take the address of var and use it to make a new shared_ptr as that would mean
@@ -178,6 +179,203 @@ namespace {
       {"Partial Mash", Recipe::Type::PartialMash},
       {"All Grain",    Recipe::Type::AllGrain}
    };
+
+   using CalcNode = Recipe::CalcNode;
+
+   Recipe::CalcNodes calcNodes(std::initializer_list<CalcNode> nodes) {
+      Recipe::CalcNodes result;
+      for (auto node : nodes) {
+         result.set(static_cast<std::size_t>(node));
+      }
+      return result;
+   }
+
+   Recipe::CalcNodes const allCalcNodes = Recipe::CalcNodes{}.set();
+
+   /**
+    * \brief The edges of the calculation graph: which nodes take the outputs of the given node as (some of) their
+    *        inputs.  See comments in the recalc functions for what depends on what.
+    */
+   Recipe::CalcNodes dependentsOf(CalcNode const node) {
+      switch (node) {
+         // Grain absorption in the mash feeds into the volume estimates
+         case CalcNode::GrainsInMash:    return calcNodes({CalcNode::VolumeEstimates});
+         // Colour, gravities and IBUs are all relative to the (final) volume
+         case CalcNode::VolumeEstimates: return calcNodes({CalcNode::Color, CalcNode::OgFg, CalcNode::IBU});
+         case CalcNode::Color:           return calcNodes({CalcNode::SRMColor});
+         // Hop utilisation depends on OG
+         case CalcNode::OgFg:            return calcNodes({CalcNode::ABV, CalcNode::IBU, CalcNode::Calories});
+         default:                        break;
+      }
+      return Recipe::CalcNodes{};
+   }
+
+   bool isOneOf(QString const & propertyName, std::initializer_list<BtStringConst const *> candidates) {
+      for (auto candidate : candidates) {
+         if (propertyName == **candidate) {
+            return true;
+         }
+      }
+      return false;
+   }
+
+   /**
+    * \brief Which calculation nodes take as input the given property of a contained object of the given class.  If
+    *        the property name is empty (eg because the object was added or removed) or is not one we know about, we
+    *        return every node that could depend on an object of that class.
+    */
+   Recipe::CalcNodes calcNodesAffectedBy(QString const & className, QString const & propertyName) {
+      // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
+      // ::staticMetaObject.className() is a bit more clunky but it's safer.
+      if (className == Hop::staticMetaObject.className()) {
+         // Hops only contribute to bitterness
+         return calcNodes({CalcNode::IBU});
+      }
+
+      if (className == Fermentable::staticMetaObject.className()) {
+         if (propertyName == *PropertyNames::Fermentable::color_srm) {
+            return calcNodes({CalcNode::Color});
+         }
+         if (propertyName == *PropertyNames::Fermentable::ibuGalPerLb) {
+            return calcNodes({CalcNode::IBU});
+         }
+         if (isOneOf(propertyName, {&PropertyNames::Fermentable::yield_pct,
+                                    &PropertyNames::Fermentable::moisture_pct,
+                                    &PropertyNames::Fermentable::addAfterBoil})) {
+            return calcNodes({CalcNode::OgFg, CalcNode::BoilGrav});
+         }
+         if (isOneOf(propertyName, {&PropertyNames::Fermentable::type,
+                                    &PropertyNames::Fermentable::isMashed})) {
+            return calcNodes({CalcNode::GrainsInMash, CalcNode::VolumeEstimates, CalcNode::OgFg, CalcNode::BoilGrav});
+         }
+         // Amount feeds into pretty much everything, as does adding or removing a fermentable.  (Even the name matters,
+         // per Recipe::isFermentableSugar()!)
+         return allCalcNodes;
+      }
+
+      if (className == Yeast::staticMetaObject.className()) {
+         // Attenuation determines FG
+         return calcNodes({CalcNode::OgFg});
+      }
+
+      if (className == Equipment::staticMetaObject.className()) {
+         if (propertyName == *PropertyNames::Equipment::hopUtilization_pct) {
+            return calcNodes({CalcNode::IBU});
+         }
+         if (isOneOf(propertyName, {&PropertyNames::Equipment::boilTime_min,
+                                    &PropertyNames::Equipment::evapRate_lHr})) {
+            return calcNodes({CalcNode::VolumeEstimates, CalcNode::OgFg, CalcNode::IBU});
+         }
+         if (isOneOf(propertyName, {&PropertyNames::Equipment::grainAbsorption_LKg,
+                                    &PropertyNames::Equipment::lauterDeadspace_l,
+                                    &PropertyNames::Equipment::topUpKettle_l,
+                                    &PropertyNames::Equipment::topUpWater_l,
+                                    &PropertyNames::Equipment::trubChillerLoss_l})) {
+            return calcNodes({CalcNode::VolumeEstimates, CalcNode::OgFg});
+         }
+         return allCalcNodes;
+      }
+
+      if (className == Mash::staticMetaObject.className()) {
+         // The mash water determines the wort we get from the mash
+         return calcNodes({CalcNode::VolumeEstimates});
+      }
+
+      // Nothing else (Misc, Salt, Water, Instruction, etc) feeds into the calculated properties
+      return Recipe::CalcNodes{};
+   }
+
+   //
+   // Our copy of PersistentSettings::CalcSettings -- see Recipe::calcSettings().  Recipe calculations can run on worker
+   // threads (eg see RecipeAnalyser), so access is guarded by a mutex.  The copy is refreshed on whichever thread
+   // changes the setting, so worker threads only ever read the copy (apart from the very first time, if that's on a
+   // worker thread).
+   //
+   QMutex calcSettingsMutex;
+   PersistentSettings::CalcSettings calcSettingsCopy{};
+   std::once_flag calcSettingsInitFlag;
+
+   void refreshCalcSettings() {
+      PersistentSettings::CalcSettings const calcSettings = PersistentSettings::readCalcSettings();
+      QMutexLocker locker(&calcSettingsMutex);
+      calcSettingsCopy = calcSettings;
+      return;
+   }
+
+   //
+   // Functions for taking the snapshot of a Recipe and its contents that RecipeCalculator works on
+   //
+   RecipeCalculator::FermentableInput toCalcInput(Fermentable * fermentable) {
+      return RecipeCalculator::FermentableInput{
+         fermentable->type(),
+         fermentable->isMashed(),
+         fermentable->addAfterBoil(),
+         Recipe::isFermentableSugar(fermentable),
+         fermentable->amount_kg(),
+         fermentable->yield_pct(),
+         fermentable->moisture_pct(),
+         fermentable->color_srm(),
+         fermentable->ibuGalPerLb()
+      };
+   }
+
+   RecipeCalculator::HopInput toCalcInput(Hop const & hop) {
+      return RecipeCalculator::HopInput{hop.alpha_pct(), hop.amount_kg(), hop.time_min(), hop.use(), hop.form()};
+   }
+
+   // NB: Equipment can't be const here as Equipment::grainAbsorption_LKg() isn't
+   RecipeCalculator::EquipmentInput toCalcInput(Equipment & equipment) {
+      return RecipeCalculator::EquipmentInput{
+         equipment.grainAbsorption_LKg(),
+         equipment.lauterDeadspace_l(),
+         equipment.topUpKettle_l(),
+         equipment.topUpWater_l(),
+         equipment.trubChillerLoss_l(),
+         equipment.boilTime_min(),
+         equipment.evapRate_lHr(),
+         equipment.hopUtilization_pct()
+      };
+   }
+
+   RecipeCalculator::Inputs buildCalcInputs(Recipe & recipe) {
+      RecipeCalculator::Inputs inputs;
+      inputs.batchSize_l    = recipe.batchSize_l();
+      inputs.boilSize_l     = recipe.boilSize_l();
+      inputs.efficiency_pct = recipe.efficiency_pct();
+
+      QList<Fermentable *> const fermentables = recipe.fermentables();
+      inputs.fermentables.reserve(fermentables.size());
+      for (auto fermentable : fermentables) {
+         inputs.fermentables.push_back(toCalcInput(fermentable));
+      }
+
+      QList<Hop *> const hops = recipe.hops();
+      inputs.hops.reserve(hops.size());
+      for (auto hop : hops) {
+         inputs.hops.push_back(toCalcInput(*hop));
+      }
+
+      for (auto yeast : recipe.yeasts()) {
+         inputs.yeastAttenuations_pct.push_back(yeast->attenuation_pct());
+      }
+
+      Equipment * equipment = recipe.equipment();
+      if (equipment) {
+         inputs.equipment = toCalcInput(*equipment);
+      }
+
+      Mash * mash = recipe.mash();
+      if (mash) {
+         inputs.totalMashWater_l = mash->totalMashWater_l();
+      }
+
+      PersistentSettings::CalcSettings const calcSettings = Recipe::calcSettings();
+      inputs.settings = RecipeCalculator::Settings{IbuMethods::ibuFormula,
+                                                   ColorMethods::colorFormula,
+                                                   calcSettings.firstWortHopAdjustment,
+                                                   calcSettings.mashHopAdjustment};
+      return inputs;
+   }
 }
 
 
@@ -196,7 +394,16 @@ public:
       miscIds{},
       saltIds{},
       waterIds{},
-      yeastIds{} {
+      yeastIds{},
+      dirtyCalcNodes{},
+      calcNodeEvaluations{},
+      recalcBatchDepth{0},
+      recalcScheduled{false},
+      passCalcInputs{},
+      calcFingerprint{},
+      calcResults{},
+      storedCalcInputs{},
+      storedCalcResults{} {
       return;
    }
 
@@ -302,6 +509,218 @@ public:
       return;
    }
 
+   /**
+    * \brief Run the recalc function for a single calculation node
+    *
+    * \return \c true if any of the node's outputs changed (so nodes that depend on it need to be re-run), \c false
+    *         otherwise
+    */
+   bool evaluate(Recipe::CalcNode const node) {
+      QVector<double> const outputsBefore = this->outputsOf(node);
+      switch (node) {
+         case Recipe::CalcNode::GrainsInMash:    this->recipe.recalcGrainsInMash_kg(); break;
+         case Recipe::CalcNode::Grains:          this->recipe.recalcGrains_kg();       break;
+         case Recipe::CalcNode::VolumeEstimates: this->recipe.recalcVolumeEstimates(); break;
+         case Recipe::CalcNode::Color:           this->recipe.recalcColor_srm();       break;
+         case Recipe::CalcNode::SRMColor:        this->recipe.recalcSRMColor();        break;
+         case Recipe::CalcNode::OgFg:            this->recipe.recalcOgFg();            break;
+         case Recipe::CalcNode::ABV:             this->recipe.recalcABV_pct();         break;
+         case Recipe::CalcNode::BoilGrav:        this->recipe.recalcBoilGrav();        break;
+         case Recipe::CalcNode::IBU:             this->recipe.recalcIBU();             break;
+         case Recipe::CalcNode::Calories:        this->recipe.recalcCalories();        break;
+      }
+      ++this->calcNodeEvaluations[static_cast<std::size_t>(node)];
+      // We deliberately compare exactly here: any change at all means dependent values need recalculating
+      return this->outputsOf(node) != outputsBefore;
+   }
+
+   /**
+    * \brief Get the inputs for RecipeCalculator.  During a pass of \c Recipe::recalcNodes(), these are gathered once
+    *        and shared by all the calculations (unless something changes part way through); otherwise they are
+    *        gathered afresh each time.
+    */
+   std::shared_ptr<RecipeCalculator::Inputs const> calcInputs() {
+      if (this->passCalcInputs) {
+         return this->passCalcInputs;
+      }
+      return std::make_shared<RecipeCalculator::Inputs const>(buildCalcInputs(this->recipe));
+   }
+
+   /**
+    * \brief Run one step of RecipeCalculator on top of the current calculated values
+    */
+   RecipeCalculator::Results runCalculatorStep(void (*step)(RecipeCalculator::Inputs const &,
+                                                            RecipeCalculator::Results &)) {
+      RecipeCalculator::Results results = this->currentResults();
+      step(*this->calcInputs(), results);
+      return results;
+   }
+
+   /**
+    * \brief The current calculated values
+    */
+   RecipeCalculator::Results currentResults() const {
+      RecipeCalculator::Results results;
+      results.grainsInMash_kg       = this->recipe.m_grainsInMash_kg;
+      results.grains_kg             = this->recipe.m_grains_kg;
+      results.wortFromMash_l        = this->recipe.m_wortFromMash_l;
+      results.boilVolume_l          = this->recipe.m_boilVolume_l;
+      results.postBoilVolume_l      = this->recipe.m_postBoilVolume_l;
+      results.finalVolume_l         = this->recipe.m_finalVolume_l;
+      results.finalVolumeNoLosses_l = this->recipe.m_finalVolumeNoLosses_l;
+      results.color_srm             = this->recipe.m_color_srm;
+      results.SRMColor              = this->recipe.m_SRMColor;
+      results.og                    = this->recipe.m_og;
+      results.fg                    = this->recipe.m_fg;
+      results.og_fermentable        = this->recipe.m_og_fermentable;
+      results.fg_fermentable        = this->recipe.m_fg_fermentable;
+      results.ABV_pct               = this->recipe.m_ABV_pct;
+      results.boilGrav              = this->recipe.m_boilGrav;
+      results.IBU                   = this->recipe.m_IBU;
+      results.calories              = this->recipe.m_calories;
+      results.ibus.reserve(this->recipe.m_ibus.size());
+      for (auto const hopIbus : this->recipe.m_ibus) {
+         results.ibus.push_back(hopIbus);
+      }
+      return results;
+   }
+
+   /**
+    * \brief If we have stored results (see \c calcFingerprint and \c calcResults) and they were calculated from the
+    *        same inputs we have now, use them rather than recalculating everything.  Only meant to be called before
+    *        the first calculation pass (ie when \c m_uninitializedCalcs is set), so we don't emit any signals.
+    *
+    * \return \c true if the stored results were used, \c false if everything needs to be recalculated
+    */
+   bool restoreStoredResults() {
+      if (this->calcFingerprint.isEmpty()) {
+         return false;
+      }
+
+      // If the fingerprint doesn't match, these will be the inputs for the recalculation
+      this->passCalcInputs = std::make_shared<RecipeCalculator::Inputs const>(buildCalcInputs(this->recipe));
+      if (RecipeCalculator::fingerprint(*this->passCalcInputs) != this->calcFingerprint) {
+         qDebug() << Q_FUNC_INFO << "Inputs for Recipe #" << this->recipe.key() << "have changed since last stored";
+         return false;
+      }
+
+      RecipeCalculator::Results results;
+      if (!RecipeCalculator::fromJson(this->calcResults, *this->passCalcInputs, results)) {
+         return false;
+      }
+
+      this->recipe.m_grainsInMash_kg       = results.grainsInMash_kg;
+      this->recipe.m_grains_kg             = results.grains_kg;
+      this->recipe.m_wortFromMash_l        = results.wortFromMash_l;
+      this->recipe.m_boilVolume_l          = results.boilVolume_l;
+      this->recipe.m_postBoilVolume_l      = results.postBoilVolume_l;
+      this->recipe.m_finalVolume_l         = results.finalVolume_l;
+      this->recipe.m_finalVolumeNoLosses_l = results.finalVolumeNoLosses_l;
+      this->recipe.m_color_srm             = results.color_srm;
+      this->recipe.m_SRMColor              = results.SRMColor;
+      this->recipe.m_og                    = results.og;
+      this->recipe.m_fg                    = results.fg;
+      this->recipe.m_og_fermentable        = results.og_fermentable;
+      this->recipe.m_fg_fermentable        = results.fg_fermentable;
+      this->recipe.m_ABV_pct               = results.ABV_pct;
+      this->recipe.m_boilGrav              = results.boilGrav;
+      this->recipe.m_IBU                   = results.IBU;
+      this->recipe.m_calories              = results.calories;
+      this->recipe.m_ibus.clear();
+      for (auto const hopIbus : results.ibus) {
+         this->recipe.m_ibus.append(hopIbus);
+      }
+      this->storedCalcInputs  = this->passCalcInputs;
+      this->storedCalcResults = results;
+      return true;
+   }
+
+   /**
+    * \brief After a calculation pass, update the stored results (and queue them to be written to the DB) if they or
+    *        the inputs they came from have changed.  Most passes change neither (eg because an edit was undone, or
+    *        only touched something the calculations don't use), so we compare the inputs and results themselves
+    *        first, and only hash and serialise them when they differ.
+    */
+   void storeResults() {
+      std::shared_ptr<RecipeCalculator::Inputs const> const inputs = this->calcInputs();
+      RecipeCalculator::Results const results = this->currentResults();
+      bool const inputsChanged  = !this->storedCalcInputs  || !(*this->storedCalcInputs  == *inputs);
+      bool const resultsChanged = !this->storedCalcResults || !(*this->storedCalcResults == results);
+      this->storedCalcInputs  = inputs;
+      this->storedCalcResults = results;
+
+      // Even if the inputs or results have changed, their serialised forms might not have, in which case we don't need
+      // to write anything
+      bool fingerprintChanged = false;
+      if (inputsChanged) {
+         QString const newFingerprint = RecipeCalculator::fingerprint(*inputs);
+         fingerprintChanged = newFingerprint != this->calcFingerprint;
+         this->calcFingerprint = newFingerprint;
+      }
+      bool calcResultsChanged = false;
+      if (resultsChanged) {
+         QString const newResults = RecipeCalculator::toJson(results);
+         calcResultsChanged = newResults != this->calcResults;
+         this->calcResults = newResults;
+      }
+
+      // These aren't user-visible, so there's no need for them to be in the DB straight away.  Deferring the writes
+      // means they get batched up with everything else that's changed (see ObjectStore::WriteMode).
+      if (this->recipe.key() > 0) {
+         if (fingerprintChanged) {
+            ObjectStoreWrapper::updateProperty(this->recipe,
+                                               PropertyNames::Recipe::calcFingerprint,
+                                               ObjectStore::WriteMode::Deferred);
+         }
+         if (calcResultsChanged) {
+            ObjectStoreWrapper::updateProperty(this->recipe,
+                                               PropertyNames::Recipe::calcResults,
+                                               ObjectStore::WriteMode::Deferred);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief Store a newly-calculated value and, if it changed, tell everyone (unless we haven't finished initialising)
+    */
+   void updateCalculated(double & calculatedValue, double const newValue, BtStringConst const & propertyName) {
+      if (!qFuzzyCompare(calculatedValue, newValue)) {
+         calculatedValue = newValue;
+         if (!this->recipe.m_uninitializedCalcs) {
+            emit this->recipe.changed(this->recipe.metaProperty(*propertyName), calculatedValue);
+         }
+      }
+      return;
+   }
+
+   /**
+    * \brief The values a calculation node sets, including any that are used internally but aren't exposed as
+    *        properties (eg \c m_finalVolumeNoLosses_l).
+    */
+   QVector<double> outputsOf(Recipe::CalcNode const node) const {
+      switch (node) {
+         case Recipe::CalcNode::GrainsInMash:    return {this->recipe.m_grainsInMash_kg};
+         case Recipe::CalcNode::Grains:          return {this->recipe.m_grains_kg};
+         case Recipe::CalcNode::VolumeEstimates: return {this->recipe.m_wortFromMash_l,
+                                                         this->recipe.m_boilVolume_l,
+                                                         this->recipe.m_postBoilVolume_l,
+                                                         this->recipe.m_finalVolume_l,
+                                                         this->recipe.m_finalVolumeNoLosses_l};
+         case Recipe::CalcNode::Color:           return {this->recipe.m_color_srm};
+         case Recipe::CalcNode::SRMColor:        return {static_cast<double>(this->recipe.m_SRMColor.rgba())};
+         case Recipe::CalcNode::OgFg:            return {this->recipe.m_og,
+                                                         this->recipe.m_fg,
+                                                         this->recipe.m_og_fermentable,
+                                                         this->recipe.m_fg_fermentable};
+         case Recipe::CalcNode::ABV:             return {this->recipe.m_ABV_pct};
+         case Recipe::CalcNode::BoilGrav:        return {this->recipe.m_boilGrav};
+         case Recipe::CalcNode::IBU:             return {this->recipe.m_IBU};
+         case Recipe::CalcNode::Calories:        return {this->recipe.m_calories};
+      }
+      return {};
+   }
+
    // Member variables
    Recipe & recipe;
    QVector<int> fermentableIds;
@@ -312,6 +731,22 @@ public:
    QVector<int> waterIds;
    QVector<int> yeastIds;
 
+   // Calculation nodes waiting to be run (see Recipe::recalcNodes())
+   Recipe::CalcNodes dirtyCalcNodes;
+   std::array<unsigned int, Recipe::numCalcNodes> calcNodeEvaluations;
+   // How many Recipe::RecalcBatch objects currently exist for this Recipe
+   int recalcBatchDepth;
+   // Whether we've asked the event loop to run the calculations in dirtyCalcNodes
+   bool recalcScheduled;
+   // Inputs shared by all the calculations in the current pass of Recipe::recalcNodes() (if any)
+   std::shared_ptr<RecipeCalculator::Inputs const> passCalcInputs;
+   // Stored copy of the calculated values and the fingerprint of the inputs they came from (see storeResults())
+   QString calcFingerprint;
+   QString calcResults;
+   // What calcFingerprint and calcResults were made from, if we know, so storeResults() can cheaply tell when they
+   // need updating
+   std::shared_ptr<RecipeCalculator::Inputs const> storedCalcInputs;
+   std::optional<RecipeCalculator::Results>        storedCalcResults;
 };
 
 template<> QVector<int> & Recipe::impl::accessIds<Fermentable>() { return this->fermentableIds; }
@@ -474,6 +909,7 @@ Recipe::Recipe(QString name) :
    m_og                {1.0                          },
    m_fg                {1.0                          },
    m_locked            {false                        },
+   m_uninitializedCalcs{true                         },
    m_ancestor_id       {-1                           },
    m_ancestors         {},
    m_hasDescendants    {false                        } {
@@ -515,12 +951,19 @@ Recipe::Recipe(NamedParameterBundle const & namedParameterBundle) :
    m_og                {namedParameterBundle.val<double      >(PropertyNames::Recipe::og                )},
    m_fg                {namedParameterBundle.val<double      >(PropertyNames::Recipe::fg                )},
    m_locked            {namedParameterBundle.val<bool        >(PropertyNames::Recipe::locked            )},
+   m_uninitializedCalcs{true},
    m_ancestor_id       {namedParameterBundle.val<int         >(PropertyNames::Recipe::ancestorId        )},
    m_ancestors         {},
    m_hasDescendants    {false} {
    // At this stage, we haven't set any Hops, Fermentables, etc.  This is deliberate because the caller typically needs
    // to access subsidiary records to obtain this info.   Callers will usually use setters (setHopIds, etc but via
    // setProperty) to finish constructing the object.
+   //
+   // If we have stored calculated values, we'll use them (rather than recalculating everything) once we have the
+   // Hops, Fermentables, etc to check them against -- see Recipe::recalcNodes().  They won't be there if, eg, we're
+   // being created from BeerXML.
+   this->pimpl->calcFingerprint = namedParameterBundle.val<QString>(PropertyNames::Recipe::calcFingerprint, QString{});
+   this->pimpl->calcResults     = namedParameterBundle.val<QString>(PropertyNames::Recipe::calcResults,     QString{});
    return;
 }
 
@@ -560,6 +1003,7 @@ Recipe::Recipe(Recipe const & other) :
    m_og                {other.m_og                },
    m_fg                {other.m_fg                },
    m_locked            {other.m_locked            },
+   m_uninitializedCalcs{true                      },
    // Copying a Recipe doesn't copy its descendants
    m_ancestor_id       {-1                        },
    m_ancestors         {},
@@ -1332,6 +1776,29 @@ template<> bool Recipe::uses<Style> (Style const & var) const {
    return var.key() == this->styleId;
 }
 
+template<class NE> Recipe * Recipe::findOwningRecipe(NE const & var) {
+   if (var.key() <= 0) {
+      // Something that isn't stored can't be in a Recipe
+      return nullptr;
+   }
+   auto recipes = ObjectStoreTyped<Recipe>::getInstance().findAllRawWithPropertyValue(propertyToPropertyName<NE>(),
+                                                                                     var.key());
+   if (recipes.isEmpty()) {
+      return nullptr;
+   }
+   return recipes.first();
+}
+template Recipe * Recipe::findOwningRecipe(Equipment    const & var);
+template Recipe * Recipe::findOwningRecipe(Fermentable  const & var);
+template Recipe * Recipe::findOwningRecipe(Hop          const & var);
+template Recipe * Recipe::findOwningRecipe(Instruction  const & var);
+template Recipe * Recipe::findOwningRecipe(Mash         const & var);
+template Recipe * Recipe::findOwningRecipe(Misc         const & var);
+template Recipe * Recipe::findOwningRecipe(Salt         const & var);
+template Recipe * Recipe::findOwningRecipe(Style        const & var);
+template Recipe * Recipe::findOwningRecipe(Water        const & var);
+template Recipe * Recipe::findOwningRecipe(Yeast        const & var);
+
 template<class NE> std::shared_ptr<NE> Recipe::remove(std::shared_ptr<NE> var) {
    // It's a coding error to supply a null shared pointer
    Q_ASSERT(var);
@@ -1345,7 +1812,7 @@ template<class NE> std::shared_ptr<NE> Recipe::remove(std::shared_ptr<NE> var) {
       Q_ASSERT(false);
    } else {
       this->propagatePropertyChange(propertyToPropertyName<NE>());
-      this->recalcIBU(); // .:TODO:. Don't need to do this recalculation when it's Instruction
+      this->recalcIfNeeded(var->metaObject()->className());
    }
 
    //
@@ -1446,6 +1913,8 @@ void Recipe::setEquipment(Equipment * var) {
    std::shared_ptr<Equipment> equipmentToAdd = copyIfNeeded(*var);
    this->equipmentId = equipmentToAdd->key();
    this->propagatePropertyChange(propertyToPropertyName<Equipment>());
+
+   this->recalcIfNeeded(Equipment::staticMetaObject.className());
    return;
 }
 
@@ -1470,7 +1939,7 @@ void Recipe::setMash(Mash * var) {
    connect(mashToAdd.get(), &NamedEntity::changed, this, &Recipe::acceptChangeToContainedObject);
    emit this->changed(this->metaProperty(*PropertyNames::Recipe::mash), QVariant::fromValue<Mash *>(mashToAdd.get()));
 
-   this->recalcAll();
+   this->recalcIfNeeded(Mash::staticMetaObject.className());
 
    return;
 }
@@ -1541,10 +2010,9 @@ void Recipe::setBatchSize_l(double var) {
                                    this->m_batchSize_l,
                                    this->enforceMin(var, "batch size"));
 
-   // NOTE: this is bad, but we have to call recalcAll(), because the estimated
-   // boil/batch volumes depend on the target volumes when there are no mash
-   // steps to actually provide an estimate for the volumes.
-   recalcAll();
+   // The estimated final volume is based on the batch size, and the IBUs from hopped extracts also depend on it
+   this->deferRecalc(calcNodes({CalcNode::VolumeEstimates, CalcNode::IBU}));
+   return;
 }
 
 void Recipe::setBoilSize_l(double var) {
@@ -1553,10 +2021,9 @@ void Recipe::setBoilSize_l(double var) {
                                    this->m_boilSize_l,
                                    this->enforceMin(var, "boil size"));
 
-   // NOTE: this is bad, but we have to call recalcAll(), because the estimated
-   // boil/batch volumes depend on the target volumes when there are no mash
-   // steps to actually provide an estimate for the volumes.
-   recalcAll();
+   // The estimated boil volume falls back to the boil size when there are no mash steps to actually provide an
+   // estimate for the volumes, and the boil gravity is always based on it.
+   this->deferRecalc(calcNodes({CalcNode::VolumeEstimates, CalcNode::BoilGrav}));
    return;
 }
 
@@ -1574,10 +2041,10 @@ void Recipe::setEfficiency_pct(double var) {
                                    this->m_efficiency_pct,
                                    this->enforceMinAndMax(var, "efficiency", 0.0, 100.0, 70.0));
 
-   // If you change the efficency, you really should recalc. And I'm afraid it
-   // means recalc all, since og and fg will change, which means your ratios
-   // change
-   recalcAll();
+   // If you change the efficency, og and fg will change, which means everything downstream of them (ABV, IBUs,
+   // calories) does too
+   this->deferRecalc(calcNodes({CalcNode::OgFg, CalcNode::BoilGrav}));
+   return;
 }
 
 void Recipe::setAsstBrewer(const QString & var) {
@@ -1749,6 +2216,20 @@ void Recipe::setAncestorId(int ancestorId, bool notify) {
    return;
 }
 
+void Recipe::setCalcFingerprint(QString const & val) {
+   // Only called by ObjectStore, so no need to notify anyone or write anything back to the DB.  We no longer know
+   // what inputs the fingerprint came from though.
+   this->pimpl->calcFingerprint = val;
+   this->pimpl->storedCalcInputs.reset();
+   return;
+}
+
+void Recipe::setCalcResults(QString const & val) {
+   this->pimpl->calcResults = val;
+   this->pimpl->storedCalcResults.reset();
+   return;
+}
+
 void Recipe::setAncestor(Recipe & ancestor) {
    //
    // Typical usage is:
@@ -1820,124 +2301,102 @@ Recipe * Recipe::revertToPreviousVersion() {
 //==========================Calculated Getters============================
 
 double Recipe::og() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_og;
 }
 
 double Recipe::fg() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_fg;
 }
 
 double Recipe::color_srm() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_color_srm;
 }
 
 double Recipe::ABV_pct() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_ABV_pct;
 }
 
 double Recipe::IBU() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_IBU;
 }
 
 QList<double> Recipe::IBUs() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_ibus;
 }
 
 double Recipe::boilGrav() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_boilGrav;
 }
 
 double Recipe::calories12oz() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_calories;
 }
 
 double Recipe::calories33cl() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_calories * 3.3 / 3.55;
 }
 
 double Recipe::wortFromMash_l() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_wortFromMash_l;
 }
 
 double Recipe::boilVolume_l() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_boilVolume_l;
 }
 
 double Recipe::postBoilVolume_l() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_postBoilVolume_l;
 }
 
 double Recipe::finalVolume_l() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_finalVolume_l;
 }
 
 QColor Recipe::SRMColor() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_SRMColor;
 }
 
 double Recipe::grainsInMash_kg() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_grainsInMash_kg;
 }
 
 double Recipe::grains_kg() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return m_grains_kg;
 }
 
 double Recipe::points() {
-   if (m_uninitializedCalcs) {
-      recalcAll();
-   }
+   this->flushDeferredRecalc();
    return (m_og - 1.0) * 1e3;
 }
 
+RecipeCalculator::Inputs Recipe::calculatorInputs() {
+   return buildCalcInputs(*this);
+}
+
+QString Recipe::calcFingerprint() const {
+   return this->pimpl->calcFingerprint;
+}
+
+QString Recipe::calcResults() const {
+   return this->pimpl->calcResults;
+}
+
 //=========================Relational Getters=============================
 Style * Recipe::style() const {
    return ObjectStoreWrapper::getByIdRaw<Style>(this->styleId);
@@ -1970,12 +2429,8 @@ QVector<int> Recipe::getInstructionIds() const {
 QList<BrewNote *> Recipe::brewNotes() const {
    // The Recipe owns its BrewNotes, but, for the moment at least, it's the BrewNote that knows which Recipe it's in
    // rather than the Recipe which knows which BrewNotes it has, so we have to ask.
-   int const recipeId = this->key();
-   return ObjectStoreTyped<BrewNote>::getInstance().findAllMatching(
-      [recipeId](BrewNote const * bn) {
-         return bn->getRecipeId() == recipeId;
-      }
-   );
+   return ObjectStoreTyped<BrewNote>::getInstance().findAllRawWithPropertyValue(PropertyNames::BrewNote::recipeId,
+                                                                                 this->key());
 }
 
 template<typename NE> QList< std::shared_ptr<NE> > Recipe::getAll() const {
@@ -2039,432 +2494,209 @@ bool    Recipe::locked()             const { return m_locked;             }
 //=============================Adders and Removers========================================
 
 
-double Recipe::batchSizeNoLosses_l() {
-   double ret = batchSize_l();
-   Equipment * e = equipment();
-   if (e) {
-      ret += e->trubChillerLoss_l();
-   }
-
-   return ret;
-}
-
 //==============================Recalculators==================================
 
-void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged) {
-   qDebug() << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged;
-   // We could just compare with "Hop", "Equipment", etc but there's then no compile-time checking of typos.  Using
-   // ::staticMetaObject.className() is a bit more clunky but it's safer.
-
-   if (classNameOfWhatWasAddedOrChanged == Hop::staticMetaObject.className()) {
-      this->recalcIBU();
-      return;
-   }
-
-   if (classNameOfWhatWasAddedOrChanged == Equipment::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == Fermentable::staticMetaObject.className() ||
-       classNameOfWhatWasAddedOrChanged == Mash::staticMetaObject.className()) {
-      this->recalcAll();
-      return;
-   }
-
-   if (classNameOfWhatWasAddedOrChanged == Yeast::staticMetaObject.className()) {
-      this->recalcOgFg();
-      this->recalcABV_pct();
-      return;
+void Recipe::recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged, QString propertyName) {
+   qDebug() << Q_FUNC_INFO << classNameOfWhatWasAddedOrChanged << propertyName;
+   CalcNodes const nodes = calcNodesAffectedBy(classNameOfWhatWasAddedOrChanged, propertyName);
+   if (nodes.any()) {
+      this->deferRecalc(nodes);
    }
-
    return;
 }
 
-void Recipe::recalcAll() {
+void Recipe::recalcNodes(CalcNodes const nodes) {
    // WARNING
-   // Infinite recursion possible, since these methods will emit changed(),
-   // causing other objects to call finalVolume_l() for example, which may
-   // cause another call to recalcAll() and so on.
+   // Infinite recursion possible, since the recalc functions will emit changed(), causing other objects to call
+   // finalVolume_l() for example, which may cause another call in here and so on.
    //
    // GSG: Now only emit when _uninitializedCalcs is true, which helps some.
+   this->pimpl->dirtyCalcNodes |= nodes;
 
-   // Someone has already called this function back in the call stack, so return to avoid recursion.
+   // Someone has already called this function back in the call stack, so return to avoid recursion.  The nodes we
+   // just marked dirty will get picked up by the loop below in that call.
    if (! m_recalcMutex.tryLock()) {
       return;
    }
 
-   // Times are in seconds, and are cumulative.
-   recalcGrainsInMash_kg(); // 0.01
-   recalcGrains_kg(); // 0.03
-   recalcVolumeEstimates(); // 0.06
-   recalcColor_srm(); // 0.08
-   recalcSRMColor(); // 0.08
-   recalcOgFg(); // 0.11
-   recalcABV_pct(); // 0.12
-   recalcBoilGrav(); // 0.14
-   recalcIBU(); // 0.15
-   recalcCalories();
-
-   m_uninitializedCalcs = false;
-
-   m_recalcMutex.unlock();
-}
-
-void Recipe::recalcABV_pct() {
-   double ret;
-
-   // The complex formula, and variations comes from Ritchie Products Ltd, (Zymurgy, Summer 1995, vol. 18, no. 2)
-   // Michael L. Hall’s article Brew by the Numbers: Add Up What’s in Your Beer, and Designing Great Beers by Daniels.
-   ret = (76.08 * (m_og_fermentable - m_fg_fermentable) / (1.775 - m_og_fermentable)) * (m_fg_fermentable / 0.794);
-
-   if (! qFuzzyCompare(ret, m_ABV_pct)) {
-      m_ABV_pct = ret;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::ABV_pct), m_ABV_pct);
+   if (m_uninitializedCalcs) {
+      // Anything marked dirty while we were being loaded is already accounted for in the stored results (if we can
+      // use them)
+      if (this->pimpl->restoreStoredResults()) {
+         this->pimpl->dirtyCalcNodes.reset();
+      } else {
+         this->pimpl->dirtyCalcNodes = allCalcNodes;
       }
    }
-}
-
-void Recipe::recalcColor_srm() {
-   Fermentable * ferm;
-   double mcu = 0.0;
-   double ret;
-   int i;
-
-   QList<Fermentable *> ferms = fermentables();
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-      ferm = ferms[i];
-         // Conversion factor for lb/gal to kg/l = 8.34538.
-      mcu += ferm->color_srm() * 8.34538 * ferm->amount_kg() / m_finalVolumeNoLosses_l;
-   }
 
-   ret = ColorMethods::mcuToSrm(mcu);
-
-   if (! qFuzzyCompare(m_color_srm, ret)) {
-      m_color_srm = ret;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::color_srm), m_color_srm);
+   bool const evaluatingAny = this->pimpl->dirtyCalcNodes.any();
+   while (this->pimpl->dirtyCalcNodes.any()) {
+      // Because nodes are numbered in dependency order, the lowest-numbered dirty node can't depend on any of the
+      // others that are dirty, so it's safe to run it now.
+      std::size_t index = 0;
+      while (!this->pimpl->dirtyCalcNodes.test(index)) {
+         ++index;
       }
-   }
+      this->pimpl->dirtyCalcNodes.reset(index);
 
-   return;
-}
-
-void Recipe::recalcIBU() {
-   int i;
-   double ibus = 0.0;
-   double tmp = 0.0;
+      // Gather the inputs for this pass, unless we already did and nothing has changed since
+      if (!this->pimpl->passCalcInputs) {
+         this->pimpl->passCalcInputs = std::make_shared<RecipeCalculator::Inputs const>(buildCalcInputs(*this));
+      }
 
-   // Bitterness due to hops...
-   m_ibus.clear();
-   QList<Hop *> hhops = hops();
-   for (i = 0; i < hhops.size(); ++i) {
-      tmp = ibuFromHop(hhops[i]);
-      m_ibus.append(tmp);
-      ibus += tmp;
+      CalcNode const node = static_cast<CalcNode>(index);
+      if (this->pimpl->evaluate(node)) {
+         this->pimpl->dirtyCalcNodes |= dependentsOf(node);
+      }
    }
 
-   // Bitterness due to hopped extracts...
-   QList<Fermentable *> ferms = fermentables();
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-         // Conversion factor for lb/gal to kg/l = 8.34538.
-      ibus +=
-         ferms[i]->ibuGalPerLb() *
-         (ferms[i]->amount_kg() / batchSize_l()) / 8.34538;
+   if (evaluatingAny) {
+      this->pimpl->storeResults();
    }
 
-   if (! qFuzzyCompare(ibus, m_IBU)) {
-      m_IBU = ibus;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::IBU), m_IBU);
-      }
-   }
+   this->pimpl->passCalcInputs.reset();
+   m_uninitializedCalcs = false;
 
+   m_recalcMutex.unlock();
    return;
 }
 
-void Recipe::recalcVolumeEstimates() {
-   double waterAdded_l;
-   double absorption_lKg;
-   double tmp = 0.0;
-   double tmp_wfm = 0.0;
-   double tmp_bv = 0.0;
-   double tmp_fv = 0.0;
-   double tmp_pbv = 0.0;
-
-   // wortFromMash_l ==========================
-   if (mash() == nullptr) {
-      m_wortFromMash_l = 0.0;
-   } else {
-      waterAdded_l = mash()->totalMashWater_l();
-      if (equipment() != nullptr) {
-         absorption_lKg = equipment()->grainAbsorption_LKg();
-      } else {
-         absorption_lKg = PhysicalConstants::grainAbsorption_Lkg;
-      }
-
-      tmp_wfm = (waterAdded_l - absorption_lKg * m_grainsInMash_kg);
-   }
-
-   // boilVolume_l ==============================
-
-   if (equipment() != nullptr) {
-      tmp = tmp_wfm - equipment()->lauterDeadspace_l() + equipment()->topUpKettle_l();
-   } else {
-      tmp = tmp_wfm;
+void Recipe::deferRecalc(CalcNodes const nodes) {
+   this->pimpl->dirtyCalcNodes |= nodes;
+   // If we're part way through a recalculation pass, its inputs are now out of date
+   this->pimpl->passCalcInputs.reset();
+   if (this->pimpl->recalcBatchDepth > 0 || this->pimpl->recalcScheduled) {
+      // Someone else is going to run the calculations
+      return;
    }
 
-   // Need to account for extract/sugar volume also.
-   QList<Fermentable *> ferms = fermentables();
-   foreach (Fermentable * f, ferms) {
-      Fermentable::Type type = f->type();
-      if (type == Fermentable::Type::Extract) {
-         tmp += f->amount_kg() / PhysicalConstants::liquidExtractDensity_kgL;
-      } else if (type == Fermentable::Type::Sugar) {
-         tmp += f->amount_kg() / PhysicalConstants::sucroseDensity_kgL;
-      } else if (type == Fermentable::Type::Dry_Extract) {
-         tmp += f->amount_kg() / PhysicalConstants::dryExtractDensity_kgL;
+   this->pimpl->recalcScheduled = true;
+   // Using this as the context object means the call is dropped if we get deleted in the meantime
+   QTimer::singleShot(0, this, [this]() {
+      this->pimpl->recalcScheduled = false;
+      if (this->pimpl->recalcBatchDepth == 0) {
+         this->flushDeferredRecalc();
       }
-   }
+   });
+   return;
+}
 
-   if (tmp <= 0.0) {
-      tmp = boilSize_l();   // Give up.
+void Recipe::flushDeferredRecalc() {
+   if (m_uninitializedCalcs || this->pimpl->dirtyCalcNodes.any()) {
+      this->recalcNodes(CalcNodes{});
    }
+   return;
+}
 
-   tmp_bv = tmp;
+void Recipe::recalcAll() {
+   this->recalcNodes(allCalcNodes);
+   return;
+}
 
-   // finalVolume_l ==============================
+Recipe::RecalcBatch::RecalcBatch(Recipe & recipe) : recipe{recipe} {
+   ++this->recipe.pimpl->recalcBatchDepth;
+   return;
+}
 
-   // NOTE: the following figure is not based on the other volume estimates
-   // since we want to show og,fg,ibus,etc. as if the collected wort is correct.
-   m_finalVolumeNoLosses_l = batchSizeNoLosses_l();
-   if (equipment() != nullptr) {
-      //_finalVolumeNoLosses_l = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l();
-      tmp_fv = equipment()->wortEndOfBoil_l(tmp_bv) + equipment()->topUpWater_l() - equipment()->trubChillerLoss_l();
-   } else {
-      m_finalVolume_l = tmp_bv - 4.0; // This is just shooting in the dark. Can't do much without an equipment.
-      //_finalVolumeNoLosses_l = _finalVolume_l;
+Recipe::RecalcBatch::~RecalcBatch() {
+   if (--this->recipe.pimpl->recalcBatchDepth == 0) {
+      this->recipe.flushDeferredRecalc();
    }
+   return;
+}
 
-   // postBoilVolume_l ===========================
-
-   if (equipment() != nullptr) {
-      tmp_pbv = equipment()->wortEndOfBoil_l(tmp_bv);
-   } else {
-      tmp_pbv = batchSize_l(); // Give up.
-   }
+unsigned int Recipe::calcNodeEvaluations(CalcNode const node) const {
+   return this->pimpl->calcNodeEvaluations[static_cast<std::size_t>(node)];
+}
 
-   if (! qFuzzyCompare(tmp_wfm, m_wortFromMash_l)) {
-      m_wortFromMash_l = tmp_wfm;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::wortFromMash_l), m_wortFromMash_l);
-      }
-   }
+//
+// Each of the recalc functions below runs one step of RecipeCalculator on top of the current calculated values, then
+// stores (and announces) whatever that step calculated.  See comments in RecipeCalculator.h.
+//
+void Recipe::recalcABV_pct() {
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcABV);
+   this->pimpl->updateCalculated(m_ABV_pct, results.ABV_pct, PropertyNames::Recipe::ABV_pct);
+   return;
+}
 
-   if (! qFuzzyCompare(tmp_bv, m_boilVolume_l)) {
-      m_boilVolume_l = tmp_bv;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::boilVolume_l), m_boilVolume_l);
-      }
-   }
+void Recipe::recalcColor_srm() {
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcColor);
+   this->pimpl->updateCalculated(m_color_srm, results.color_srm, PropertyNames::Recipe::color_srm);
+   return;
+}
 
-   if (! qFuzzyCompare(tmp_fv, m_finalVolume_l)) {
-      m_finalVolume_l = tmp_fv;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::finalVolume_l), m_finalVolume_l);
-      }
+void Recipe::recalcIBU() {
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcIBU);
+   m_ibus.clear();
+   for (double const hopIbus : results.ibus) {
+      m_ibus.append(hopIbus);
    }
+   this->pimpl->updateCalculated(m_IBU, results.IBU, PropertyNames::Recipe::IBU);
+   return;
+}
 
-   if (! qFuzzyCompare(tmp_pbv, m_postBoilVolume_l)) {
-      m_postBoilVolume_l = tmp_pbv;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::postBoilVolume_l), m_postBoilVolume_l);
-      }
-   }
+void Recipe::recalcVolumeEstimates() {
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcVolumeEstimates);
+   // Not a property, so there's no signal to emit when it changes
+   m_finalVolumeNoLosses_l = results.finalVolumeNoLosses_l;
+   this->pimpl->updateCalculated(m_wortFromMash_l,   results.wortFromMash_l,   PropertyNames::Recipe::wortFromMash_l  );
+   this->pimpl->updateCalculated(m_boilVolume_l,     results.boilVolume_l,     PropertyNames::Recipe::boilVolume_l    );
+   this->pimpl->updateCalculated(m_finalVolume_l,    results.finalVolume_l,    PropertyNames::Recipe::finalVolume_l   );
+   this->pimpl->updateCalculated(m_postBoilVolume_l, results.postBoilVolume_l, PropertyNames::Recipe::postBoilVolume_l);
    return;
 }
 
 void Recipe::recalcGrainsInMash_kg() {
-   int i, size;
-   double ret = 0.0;
-   Fermentable * ferm;
-
-   QList<Fermentable *> ferms = fermentables();
-   size = ferms.size();
-   for (i = 0; i < size; ++i) {
-      ferm = ferms[i];
-
-      if (ferm->type() == Fermentable::Type::Grain && ferm->isMashed()) {
-         ret += ferm->amount_kg();
-      }
-   }
-
-   if (! qFuzzyCompare(ret, m_grainsInMash_kg)) {
-      m_grainsInMash_kg = ret;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::grainsInMash_kg), m_grainsInMash_kg);
-      }
-   }
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcGrainsInMash);
+   this->pimpl->updateCalculated(m_grainsInMash_kg, results.grainsInMash_kg, PropertyNames::Recipe::grainsInMash_kg);
    return;
 }
 
 void Recipe::recalcGrains_kg() {
-   int i, size;
-   double ret = 0.0;
-
-   QList<Fermentable *> ferms = fermentables();
-   size = ferms.size();
-   for (i = 0; i < size; ++i) {
-      ret += ferms[i]->amount_kg();
-   }
-
-   if (! qFuzzyCompare(ret, m_grains_kg)) {
-      m_grains_kg = ret;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::grains_kg), m_grains_kg);
-      }
-   }
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcGrains);
+   this->pimpl->updateCalculated(m_grains_kg, results.grains_kg, PropertyNames::Recipe::grains_kg);
+   return;
 }
 
 void Recipe::recalcSRMColor() {
-   QColor tmp = Algorithms::srmToColor(m_color_srm);
-
-   if (tmp != m_SRMColor) {
-      m_SRMColor = tmp;
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcSRMColor);
+   if (results.SRMColor != m_SRMColor) {
+      m_SRMColor = results.SRMColor;
       if (!m_uninitializedCalcs) {
          emit changed(metaProperty(*PropertyNames::Recipe::SRMColor), m_SRMColor);
       }
    }
+   return;
 }
 
-// the formula in here are taken from http://hbd.org/ensmingr/
 void Recipe::recalcCalories() {
-   double startPlato, finishPlato, RE, abw, oog, ffg, tmp;
-
-   oog = m_og;
-   ffg = m_fg;
-
-   // Need to translate OG and FG into plato
-   startPlato  = -463.37 + (668.72 * oog) - (205.35 * oog * oog);
-   finishPlato = -463.37 + (668.72 * ffg) - (205.35 * ffg * ffg);
-
-   // RE (real extract)
-   RE = (0.1808 * startPlato) + (0.8192 * finishPlato);
-
-   // Alcohol by weight?
-   abw = (startPlato - RE) / (2.0665 - (0.010665 * startPlato));
-
-   // The final results of this formular are calories per 100 ml.
-   // The 3.55 puts it in terms of 12 oz. I really should have stored it
-   // without that adjust.
-   tmp = ((6.9 * abw) + 4.0 * (RE - 0.1)) * ffg * 3.55;
-
-   //! If there are no fermentables in the recipe, if there is no mash, etc.,
-   //  then the calories/12 oz ends up negative. Since negative doesn't make
-   //  sense, set it to 0
-   if (tmp < 0) {
-      tmp = 0;
-   }
-
-   if (! qFuzzyCompare(tmp, m_calories)) {
-      m_calories = tmp;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::calories), m_calories);
-      }
-   }
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcCalories);
+   this->pimpl->updateCalculated(m_calories, results.calories, PropertyNames::Recipe::calories);
+   return;
 }
 
 // other efficiency calculations need access to the maximum theoretical sugars
 // available. The only way I can see of doing that which doesn't suck is to
 // split that calcuation out of recalcOgFg();
 QHash<QString, double> Recipe::calcTotalPoints() {
-   int i;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double sugar_kg                  = 0.0;
-   double nonFermentableSugars_kg    = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-
-   Fermentable * ferm;
+   RecipeCalculator::Sugars const sugars = RecipeCalculator::totalSugars(*this->pimpl->calcInputs());
 
-   QList<Fermentable *> ferms = fermentables();
    QHash<QString, double> ret;
-
-   for (i = 0; static_cast<int>(i) < ferms.size(); ++i) {
-      ferm = ferms[i];
-
-      // If we have some sort of non-grain, we have to ignore efficiency.
-      if (ferm->isSugar() || ferm->isExtract()) {
-         sugar_kg_ignoreEfficiency += ferm->equivSucrose_kg();
-
-         if (ferm->addAfterBoil()) {
-            lateAddition_kg_ignoreEff += ferm->equivSucrose_kg();
-         }
-
-         if (!isFermentableSugar(ferm)) {
-            nonFermentableSugars_kg += ferm->equivSucrose_kg();
-         }
-      } else {
-         sugar_kg += ferm->equivSucrose_kg();
-
-         if (ferm->addAfterBoil()) {
-            lateAddition_kg += ferm->equivSucrose_kg();
-         }
-      }
-   }
-
-   ret.insert("sugar_kg", sugar_kg);
-   ret.insert("nonFermentableSugars_kg", nonFermentableSugars_kg);
-   ret.insert("sugar_kg_ignoreEfficiency", sugar_kg_ignoreEfficiency);
-   ret.insert("lateAddition_kg", lateAddition_kg);
-   ret.insert("lateAddition_kg_ignoreEff", lateAddition_kg_ignoreEff);
-
+   ret.insert("sugar_kg",                  sugars.sugar_kg);
+   ret.insert("nonFermentableSugars_kg",   sugars.nonFermentableSugars_kg);
+   ret.insert("sugar_kg_ignoreEfficiency", sugars.sugar_kg_ignoreEfficiency);
+   ret.insert("lateAddition_kg",           sugars.lateAddition_kg);
+   ret.insert("lateAddition_kg_ignoreEff", sugars.lateAddition_kg_ignoreEff);
    return ret;
-
 }
 
 void Recipe::recalcBoilGrav() {
-   double sugar_kg = 0.0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double lateAddition_kg           = 0.0;
-   double lateAddition_kg_ignoreEff = 0.0;
-   double ret;
-   QHash<QString, double> sugars;
-
-   sugars = calcTotalPoints();
-   sugar_kg = sugars.value("sugar_kg");
-   sugar_kg_ignoreEfficiency = sugars.value("sugar_kg_ignoreEfficiency");
-   lateAddition_kg = sugars.value("lateAddition_kg");
-   lateAddition_kg_ignoreEff = sugars.value("lateAddition_kg_ignoreEff");
-
-   // Since the efficiency refers to how much sugar we get into the fermenter,
-   // we need to adjust for that here.
-   sugar_kg = (efficiency_pct() / 100.0 * (sugar_kg - lateAddition_kg) + sugar_kg_ignoreEfficiency -
-               lateAddition_kg_ignoreEff);
-
-   ret = Algorithms::PlatoToSG_20C20C(Algorithms::getPlato(sugar_kg, boilSize_l()));
-
-   if (! qFuzzyCompare(ret, m_boilGrav)) {
-      m_boilGrav = ret;
-      if (!m_uninitializedCalcs) {
-         emit changed(metaProperty(*PropertyNames::Recipe::boilGrav), m_boilGrav);
-      }
-   }
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcBoilGrav);
+   this->pimpl->updateCalculated(m_boilGrav, results.boilGrav, PropertyNames::Recipe::boilGrav);
+   return;
 }
 
 void Recipe::recalcOgFg() {
-   int i;
-   double plato;
-   double sugar_kg = 0;
-   double sugar_kg_ignoreEfficiency = 0.0;
-   double nonFermentableSugars_kg = 0.0;
-   double kettleWort_l = 0.0;
-   double postBoilWort_l = 0.0;
-   double ratio = 0.0;
-   double ferm_kg = 0.0;
-   double attenuation_pct = 0.0;
-   double tmp_og, tmp_fg, tmp_pnts, tmp_ferm_pnts, tmp_nonferm_pnts;
-   Yeast * yeast;
-
-   m_og_fermentable = m_fg_fermentable = 0.0;
-
    // The first time through really has to get the _og and _fg from the
    // database, not use the initialized values of 1. I (maf) tried putting
    // this in the initialize, but it just hung. So I moved it here, but only
@@ -2473,85 +2705,20 @@ void Recipe::recalcOgFg() {
    // GSG: This doesn't work, this og and fg are already set to 1.0 so
    // until we load these values from the database on startup, we have
    // to calculate.
+   //
+   // These days, if the stored calculated values are still valid, we use them at start-up and don't come here at all --
+   // see Recipe::impl::restoreStoredResults().
    if (m_uninitializedCalcs) {
       m_og = Localization::toDouble(*this, PropertyNames::Recipe::og, Q_FUNC_INFO);
       m_fg = Localization::toDouble(*this, PropertyNames::Recipe::fg, Q_FUNC_INFO);
    }
 
-   // Find out how much sugar we have.
-   QHash<QString, double> sugars = calcTotalPoints();
-   sugar_kg                  = sugars.value("sugar_kg");  // Mass of sugar that *is* affected by mash efficiency
-   sugar_kg_ignoreEfficiency =
-      sugars.value("sugar_kg_ignoreEfficiency");  // Mass of sugar that *is not* affected by mash efficiency
-   nonFermentableSugars_kg    =
-      sugars.value("nonFermentableSugars_kg");  // Mass of sugar that is not fermentable (also counted in sugar_kg_ignoreEfficiency)
-
-   // We might lose some sugar in the form of Trub/Chiller loss and lauter deadspace.
-   if (equipment() != nullptr) {
-
-      kettleWort_l = (m_wortFromMash_l - equipment()->lauterDeadspace_l()) + equipment()->topUpKettle_l();
-      postBoilWort_l = equipment()->wortEndOfBoil_l(kettleWort_l);
-      ratio = (postBoilWort_l - equipment()->trubChillerLoss_l()) / postBoilWort_l;
-      if (ratio > 1.0) { // Usually happens when we don't have a mash yet.
-         ratio = 1.0;
-      } else if (ratio < 0.0) {
-         ratio = 0.0;
-      } else if (Algorithms::isNan(ratio)) {
-         ratio = 1.0;
-      }
-      // Ignore this again since it should be included in efficiency.
-      //sugar_kg *= ratio;
-      sugar_kg_ignoreEfficiency *= ratio;
-      if (nonFermentableSugars_kg != 0.0) {
-         nonFermentableSugars_kg *= ratio;
-      }
-   }
-
-   // Total sugars after accounting for efficiency and mash losses. Implicitly includes non-fermentable sugars
-   sugar_kg = sugar_kg * efficiency_pct() / 100.0 + sugar_kg_ignoreEfficiency;
-   plato = Algorithms::getPlato(sugar_kg, m_finalVolumeNoLosses_l);
-
-   tmp_og = Algorithms::PlatoToSG_20C20C(plato);    // og from all sugars
-   tmp_pnts = (tmp_og - 1) * 1000.0; // points from all sugars
-   if (nonFermentableSugars_kg != 0.0) {
-      ferm_kg = sugar_kg - nonFermentableSugars_kg;  // Mass of only fermentable sugars
-      plato = Algorithms::getPlato(ferm_kg, m_finalVolumeNoLosses_l);   // Plato from fermentable sugars
-      m_og_fermentable = Algorithms::PlatoToSG_20C20C(plato);    // og from only fermentable sugars
-      plato = Algorithms::getPlato(nonFermentableSugars_kg, m_finalVolumeNoLosses_l);   // Plate from non-fermentable sugars
-      tmp_nonferm_pnts = ((Algorithms::PlatoToSG_20C20C(plato)) - 1) * 1000.0; // og points from non-fermentable sugars
-   } else {
-      m_og_fermentable = tmp_og;
-      tmp_nonferm_pnts = 0;
-   }
-
-   // Calculage FG
-   QList<Yeast *> yeasties = yeasts();
-   for (i = 0; static_cast<int>(i) < yeasties.size(); ++i) {
-      yeast = yeasties[i];
-      // Get the yeast with the greatest attenuation.
-      if (yeast->attenuation_pct() > attenuation_pct) {
-         attenuation_pct = yeast->attenuation_pct();
-      }
-   }
-   // This means we have yeast, but they neglected to provide attenuation percentages.
-   if (yeasties.size() > 0 && attenuation_pct <= 0.0)  {
-      attenuation_pct = 75.0; // 75% is an average attenuation.
-   }
-
-   if (nonFermentableSugars_kg != 0.0) {
-      tmp_ferm_pnts = (tmp_pnts - tmp_nonferm_pnts) * (1.0 - attenuation_pct / 100.0); // fg points from fermentable sugars
-      tmp_pnts = tmp_ferm_pnts + tmp_nonferm_pnts;  // FG points from both fermentable and non-fermentable sugars
-      //tmp_pnts *= (1.0 - attenuation_pct/100.0);  // WTF, this completely ignores all the calculations about non-fermentable sugars and just converts everything!
-      tmp_fg =  1 + tmp_pnts / 1000.0; // new FG value
-      m_fg_fermentable =  1 + tmp_ferm_pnts / 1000.0; // FG from fermentables only
-   } else {
-      tmp_pnts *= (1.0 - attenuation_pct / 100.0);
-      tmp_fg =  1 + tmp_pnts / 1000.0;
-      m_fg_fermentable = tmp_fg;
-   }
+   RecipeCalculator::Results const results = this->pimpl->runCalculatorStep(RecipeCalculator::calcOgFg);
+   m_og_fermentable = results.og_fermentable;
+   m_fg_fermentable = results.fg_fermentable;
 
-   if (! qFuzzyCompare(m_og, tmp_og)) {
-      m_og     = tmp_og;
+   if (! qFuzzyCompare(m_og, results.og)) {
+      m_og     = results.og;
       // NOTE: We don't want to do this on the first load of the recipe.
       // NOTE: We are we recalculating all of these on load? Shouldn't we be
       // reading these values from the database somehow?
@@ -2567,82 +2734,48 @@ void Recipe::recalcOgFg() {
       }
    }
 
-   if (! qFuzzyCompare(tmp_fg, m_fg)) {
-      m_fg     = tmp_fg;
+   if (! qFuzzyCompare(results.fg, m_fg)) {
+      m_fg     = results.fg;
       if (!m_uninitializedCalcs) {
          this->propagatePropertyChange(PropertyNames::Recipe::fg, false);
          emit changed(metaProperty(*PropertyNames::Recipe::fg), m_fg);
       }
    }
+   return;
 }
 
 //====================================Helpers===========================================
 
-double Recipe::ibuFromHop(Hop const * hop) {
-   Equipment * equip = equipment();
-   double ibus = 0.0;
-   double fwhAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::firstWortHopAdjustment, 1.1).toString(),
-      Q_FUNC_INFO
-   );
-   double mashHopAdjust = Localization::toDouble(
-      PersistentSettings::value(PersistentSettings::Names::mashHopAdjustment, 0).toString(),
-      Q_FUNC_INFO
+PersistentSettings::CalcSettings Recipe::calcSettings() {
+   std::call_once(
+      calcSettingsInitFlag,
+      []() {
+         //
+         // Connecting to a functor with no context object gives a direct connection, so we refresh on whichever thread
+         // changed the setting, before PersistentSettings::insert() or remove() returns.  We connect before the first
+         // read so that we can't miss a change made in between.
+         //
+         QObject::connect(&PersistentSettings::changeNotifier(),
+                          &PersistentSettings::ChangeNotifier::settingChanged,
+                          [](QString const & fullyQualifiedKey) {
+                             if (PersistentSettings::affectsCalcSettings(fullyQualifiedKey)) {
+                                refreshCalcSettings();
+                             }
+                             return;
+                          });
+         refreshCalcSettings();
+         return;
+      }
    );
+   QMutexLocker locker(&calcSettingsMutex);
+   return calcSettingsCopy;
+}
 
+double Recipe::ibuFromHop(Hop const * hop) {
    if (hop == nullptr) {
       return 0.0;
    }
-
-   double AArating = hop->alpha_pct() / 100.0;
-   double grams = hop->amount_kg() * 1000.0;
-   double minutes = hop->time_min();
-   // Assume 100% utilization until further notice
-   double hopUtilization = 1.0;
-   // Assume 60 min boil until further notice
-   int boilTime = 60;
-
-   // NOTE: we used to carefully calculate the average boil gravity and use it in the
-   // IBU calculations. However, due to John Palmer
-   // (http://homebrew.stackexchange.com/questions/7343/does-wort-gravity-affect-hop-utilization),
-   // it seems more appropriate to just use the OG directly, since it is the total
-   // amount of break material that truly affects the IBUs.
-
-   if (equip) {
-      hopUtilization = equip->hopUtilization_pct() / 100.0;
-      boilTime = static_cast<int>(equip->boilTime_min());
-   }
-
-   if (hop->use() == Hop::Use::Boil) {
-      ibus = IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, minutes);
-   } else if (hop->use() == Hop::Use::First_Wort) {
-      ibus = fwhAdjust * IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, boilTime);
-   } else if (hop->use() == Hop::Use::Mash && mashHopAdjust > 0.0) {
-      ibus = mashHopAdjust * IbuMethods::getIbus(AArating, grams, m_finalVolumeNoLosses_l, m_og, boilTime);
-   }
-
-   // Adjust for hop form. Tinseth's table was created from whole cone data,
-   // and it seems other formulae are optimized that way as well. So, the
-   // utilization is considered unadjusted for whole cones, and adjusted
-   // up for plugs and pellets.
-   //
-   // - http://www.realbeer.com/hops/FAQ.html
-   // - https://groups.google.com/forum/#!topic"brewtarget.h"lp/mv2qvWBC4sU
-   switch (hop->form()) {
-      case Hop::Form::Plug:
-         hopUtilization *= 1.02;
-         break;
-      case Hop::Form::Pellet:
-         hopUtilization *= 1.10;
-         break;
-      default:
-         break;
-   }
-
-   // Adjust for hop utilization.
-   ibus *= hopUtilization;
-
-   return ibus;
+   return RecipeCalculator::ibuFromHop(*this->pimpl->calcInputs(), toCalcInput(*hop), m_og, m_finalVolumeNoLosses_l);
 }
 
 // this was fixed, but not with an at
@@ -2753,14 +2886,14 @@ QStringList Recipe::getReagents(QList<Salt *> salts, Salt::WhenToAdd wanted) {
 
 //==========================Accept changes from ingredients====================
 
-void Recipe::acceptChangeToContainedObject([[maybe_unused]] QMetaProperty prop,
+void Recipe::acceptChangeToContainedObject(QMetaProperty prop,
                                            [[maybe_unused]] QVariant val) {
    // This tells us which object sent us the signal
    QObject * signalSender = this->sender();
    if (signalSender != nullptr) {
       QString signalSenderClassName = signalSender->metaObject()->className();
       qDebug() << Q_FUNC_INFO << "Signal received from " << signalSenderClassName;
-      this->recalcIfNeeded(signalSenderClassName);
+      this->recalcIfNeeded(signalSenderClassName, prop.name());
    } else {
       qDebug() << Q_FUNC_INFO << "No sender";
    }
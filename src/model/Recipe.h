@@ -24,6 +24,7 @@
 #define MODEL_RECIPE_H
 #pragma once
 
+#include <bitset>
 #include <memory> // For PImpl
 
 #include <QColor>
@@ -40,6 +41,7 @@
 #include "model/Hop.h" // Dammit! Have to include these for Hop::Use (see hopSteps()) and Misc::Use (see miscSteps()).
 #include "model/Misc.h"
 #include "model/Salt.h"  // Needed for Salt::WhenToAdd (see getReagents())
+#include "PersistentSettings.h"
 
 //======================================================================================================================
 //========================================== Start of property name constants ==========================================
@@ -57,6 +59,8 @@ AddPropertyName(boilTime_min      )
 AddPropertyName(boilVolume_l      )
 AddPropertyName(brewer            )
 AddPropertyName(brewNotes         )
+AddPropertyName(calcFingerprint   )
+AddPropertyName(calcResults       )
 AddPropertyName(calories          )
 AddPropertyName(carbonationTemp_c )
 AddPropertyName(carbonation_vols  )
@@ -124,6 +128,7 @@ class PreInstruction;
 class Style;
 class Water;
 class Yeast;
+namespace RecipeCalculator { struct Inputs; }
 
 
 /*!
@@ -162,6 +167,28 @@ public:
    // This allows us to store the above enum class in a QVariant
    Q_ENUM(Type)
 
+   /**
+    * \brief The calculated properties (OG, IBU, colour, etc) are computed by a handful of "recalc" functions, which we
+    *        treat as the nodes of a dependency graph.  When an input changes, we only re-run the nodes it feeds into,
+    *        plus, transitively, the nodes that depend on any node whose outputs actually changed.
+    *
+    *        NB: Nodes are listed in dependency order (ie a node only ever depends on nodes earlier in the list).
+    */
+   enum class CalcNode {
+      GrainsInMash,
+      Grains,
+      VolumeEstimates,
+      Color,
+      SRMColor,
+      OgFg,
+      ABV,
+      BoilGrav,
+      IBU,
+      Calories
+   };
+   static std::size_t constexpr numCalcNodes = static_cast<std::size_t>(CalcNode::Calories) + 1;
+   using CalcNodes = std::bitset<numCalcNodes>;
+
    //! \brief The \b Type
    Q_PROPERTY(Type type READ type WRITE setType /*NOTIFY changed*/ /*changedType*/)
    //! \brief The brewer.
@@ -258,6 +285,13 @@ public:
    //! \brief The beer color as a displayable QColor.
    Q_PROPERTY(QColor SRMColor READ SRMColor /*WRITE*/ /*NOTIFY changed*/ STORED false)
 
+   // Stored copies of the calculated properties, so they don't all have to be recalculated at start-up.
+   // NB: the setters are only intended for use by ObjectStore.
+   //! \brief Fingerprint of the inputs the stored calculated values came from.  See \c RecipeCalculator::fingerprint().
+   Q_PROPERTY(QString calcFingerprint READ calcFingerprint WRITE setCalcFingerprint)
+   //! \brief The calculated values, serialised.  See \c RecipeCalculator::toJson().
+   Q_PROPERTY(QString calcResults     READ calcResults     WRITE setCalcResults    )
+
    // Relational properties.
    // NB: the setBlahId() calls are needed by ObjectStore and are not intended for more general use.
    //! \brief The mash.
@@ -361,6 +395,12 @@ public:
     */
    template<class T> bool uses(T const & var) const;
 
+   /*!
+    * \brief Returns a Recipe that uses \c var (ie for which \c uses(var) is \c true), or \c nullptr if there isn't
+    *        one.  This is a lookup in the Recipe object store's indexes, so it does not have to check every Recipe.
+    */
+   template<class T> static Recipe * findOwningRecipe(T const & var);
+
    int instructionNumber(Instruction const & ins) const;
    /*!
     * \brief Swap instructions \c ins1 and \c ins2
@@ -440,6 +480,21 @@ public:
    double grains_kg();
    QList<double> IBUs();
 
+   /**
+    * \brief A snapshot of everything the calculated getters depend on, so that the same calculations can be done
+    *        elsewhere (eg on another thread -- see \c RecipeAnalyser) with \c RecipeCalculator::calculate().
+    */
+   RecipeCalculator::Inputs calculatorInputs();
+
+   /**
+    * \brief Our copy of the \c PersistentSettings::CalcSettings used in all Recipe calculations.  This is refreshed
+    *        whenever \c PersistentSettings says one of the settings has changed, and is safe to call from any thread.
+    */
+   static PersistentSettings::CalcSettings calcSettings();
+
+   QString calcFingerprint() const;
+   QString calcResults()     const;
+
    // Relational getters
    template<typename NE> QList< std::shared_ptr<NE> > getAll() const;
    QList<Hop *>          hops()                                const;
@@ -489,6 +544,8 @@ public:
    void setWaterIds      (QVector<int> waterIds);
    void setYeastIds      (QVector<int> yeastIds);
    void setAncestorId    (int ancestorId, bool notify = true);
+   void setCalcFingerprint(QString const & val);
+   void setCalcResults    (QString const & val);
 
    // Other junk.
    QVector<PreInstruction> mashInstructions(double timeRemaining, double totalWaterAdded_l, unsigned int size);
@@ -517,6 +574,38 @@ public:
    QStringList getReagents(QList<Salt *> salts, Salt::WhenToAdd wanted);
    QHash<QString, double> calcTotalPoints();
 
+   /**
+    * \brief How many times the given calculation node has been evaluated since this Recipe was constructed.  Mostly
+    *        useful for testing that a change to an input only triggers the calculations that depend on it.
+    */
+   unsigned int calcNodeEvaluations(CalcNode const node) const;
+
+   /**
+    * \brief Changes to a Recipe or its ingredients don't trigger recalculation of calculated values (OG, IBU, etc)
+    *        straight away.  Instead, we note which calculations are affected and do them all in one go, either the
+    *        next time round the event loop or the next time one of the calculated values is read, whichever is sooner.
+    *        This means that, eg, dropping ten hops on a recipe results in one recalculation (and one set of
+    *        \c changed signals for the calculated values) rather than ten.
+    *
+    *        For code that makes a lot of changes in one go without returning to the event loop, this RAII class
+    *        extends the deferral to the end of its scope (unless a calculated value is read before then).  Can be
+    *        nested, in which case the recalculation happens at the end of the outermost one.
+    */
+   class RecalcBatch {
+   public:
+      RecalcBatch(Recipe & recipe);
+      ~RecalcBatch();
+
+   private:
+      Recipe & recipe;
+
+      // RAII class shouldn't be getting copied or moved
+      RecalcBatch(RecalcBatch const &) = delete;
+      RecalcBatch & operator=(RecalcBatch const &) = delete;
+      RecalcBatch(RecalcBatch &&) = delete;
+      RecalcBatch & operator=(RecalcBatch &&) = delete;
+   };
+
    // Setters that are not slots
    void setType              (Type    const   val);
    void setBrewer            (QString const & val);
@@ -634,7 +723,7 @@ private:
 
    bool m_locked;
 
-   // True when constructed, indicates whether recalcAll has been called.
+   // True when constructed, indicates whether recalcAll has been called (or stored results have been restored instead)
    bool m_uninitializedCalcs;
    QMutex m_uninitializedCalcsMutex;
    QMutex m_recalcMutex;
@@ -644,12 +733,34 @@ private:
    mutable QList<Recipe *> m_ancestors;
    mutable bool m_hasDescendants;
 
-   // Batch size without losses.
-   double batchSizeNoLosses_l();
-
    // Some recalculators for calculated properties.
 
-   void recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged);
+   /**
+    * \brief Recalculate whatever depends on a contained object that was added, removed or changed.
+    *
+    * \param classNameOfWhatWasAddedOrChanged
+    * \param propertyName  If a property of the contained object changed, its name.  If this is empty, or is a property
+    *                      we don't know about, we assume anything that could depend on the object needs recalculating.
+    */
+   void recalcIfNeeded(QString classNameOfWhatWasAddedOrChanged, QString propertyName = QString{});
+
+   /**
+    * \brief Run the specified calculation nodes, plus any nodes downstream of them whose inputs actually changed.
+    *        If calculations have not yet been initialised, all nodes are run.
+    */
+   void recalcNodes(CalcNodes const nodes);
+
+   /**
+    * \brief Mark the specified calculation nodes as needing to be run, and arrange for that to happen on the next
+    *        turn of the event loop (or at the end of the current \c RecalcBatch).  See comment on \c RecalcBatch.
+    */
+   void deferRecalc(CalcNodes const nodes);
+
+   /**
+    * \brief Run any calculations that are pending (or that have never been run).  Called before we return any
+    *        calculated value.
+    */
+   void flushDeferredRecalc();
 
    /* Recalculates all the calculated properties.
     *
@@ -211,5 +211,5 @@ double Salt::SO4() const {
 }
 
 Recipe * Salt::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
@@ -271,5 +271,5 @@ double Style::abvMin_pct() const { return m_abvMin_pct; }
 double Style::abvMax_pct() const { return m_abvMax_pct; }
 
 Recipe * Style::getOwningRecipe() {
-   return ObjectStoreWrapper::findFirstMatching<Recipe>( [this](Recipe * rec) {return rec->uses(*this);} );
+   return Recipe::findOwningRecipe(*this);
 }
@@ -144,6 +144,8 @@ void FermentableTableModel::observeDatabase(bool val) {
 
       this->removeAll();
       connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectInserted, this, &FermentableTableModel::addFermentable);
+      connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectsInserted, this,
+              [this](QVector<int> const & fermIds) { this->addFermentables(ObjectStoreWrapper::getByIds<Fermentable>(fermIds)); return; });
       connect(&ObjectStoreTyped<Fermentable>::getInstance(), &ObjectStoreTyped<Fermentable>::signalObjectDeleted,  this, &FermentableTableModel::removeFermentable);
       this->addFermentables(ObjectStoreWrapper::getAll<Fermentable>());
    } else {
@@ -195,7 +197,7 @@ void FermentableTableModel::addFermentables(QList<std::shared_ptr<Fermentable> >
    qDebug() << Q_FUNC_INFO << QString("After de-duping, adding %1 fermentables").arg(tmp.size());
 
    int size = this->rows.size();
-   if (size+tmp.size()) {
+   if (tmp.size()) {
       beginInsertRows( QModelIndex(), size, size+tmp.size()-1 );
       this->rows.append(tmp);
 
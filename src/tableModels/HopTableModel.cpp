@@ -104,6 +104,8 @@ void HopTableModel::observeDatabase(bool val) {
       removeAll();
       connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectInserted, this,
               &HopTableModel::addHop);
+      connect(&ObjectStoreTyped<Hop>::getInstance(), &ObjectStoreTyped<Hop>::signalObjectsInserted, this,
+              [this](QVector<int> const & hopIds) { this->addHops(ObjectStoreWrapper::getByIds<Hop>(hopIds)); return; });
       connect(&ObjectStoreTyped<Hop>::getInstance(),
               &ObjectStoreTyped<Hop>::signalObjectDeleted,
               this,
@@ -167,7 +169,7 @@ void HopTableModel::addHops(QList< std::shared_ptr<Hop> > hops) {
    }
 
    int size = this->rows.size();
-   if (size + tmp.size()) {
+   if (tmp.size()) {
       beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
       this->rows.append(tmp);
 
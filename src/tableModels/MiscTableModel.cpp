@@ -94,6 +94,8 @@ void MiscTableModel::observeDatabase(bool val) {
       observeRecipe(nullptr);
       removeAll();
       connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectInserted,  this, &MiscTableModel::addMisc);
+      connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectsInserted, this,
+              [this](QVector<int> const & miscIds) { this->addMiscs(ObjectStoreWrapper::getByIds<Misc>(miscIds)); return; });
       connect(&ObjectStoreTyped<Misc>::getInstance(), &ObjectStoreTyped<Misc>::signalObjectDeleted,   this, &MiscTableModel::removeMisc);
       this->addMiscs(ObjectStoreWrapper::getAll<Misc>());
    } else {
@@ -140,7 +142,7 @@ void MiscTableModel::addMiscs(QList<std::shared_ptr<Misc> > miscs) {
    auto tmp = this->removeDuplicates(miscs, this->recObs);
 
    int size = this->rows.size();
-   if (size+tmp.size()) {
+   if (tmp.size()) {
       beginInsertRows( QModelIndex(), size, size+tmp.size()-1 );
       this->rows.append(tmp);
 
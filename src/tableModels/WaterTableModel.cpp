@@ -87,6 +87,10 @@ void WaterTableModel::observeDatabase(bool val) {
               &ObjectStoreTyped<Water>::signalObjectInserted,
               this,
               &WaterTableModel::addWater);
+      connect(&ObjectStoreTyped<Water>::getInstance(),
+              &ObjectStoreTyped<Water>::signalObjectsInserted,
+              this,
+              [this](QVector<int> const & waterIds) { this->addWaters(ObjectStoreWrapper::getByIds<Water>(waterIds)); return; });
       connect(&ObjectStoreTyped<Water>::getInstance(),
               &ObjectStoreTyped<Water>::signalObjectDeleted,
               this,
@@ -137,7 +141,7 @@ void WaterTableModel::addWaters(QList<std::shared_ptr<Water> > waters) {
    auto tmp = this->removeDuplicates(waters);
 
    int size = rows.size();
-   if (size + tmp.size()) {
+   if (tmp.size()) {
       beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
       rows.append(tmp);
 
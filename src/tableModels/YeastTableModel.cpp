@@ -135,6 +135,10 @@ void YeastTableModel::observeDatabase(bool val) {
               &ObjectStoreTyped<Yeast>::signalObjectInserted,
               this,
               &YeastTableModel::addYeast);
+      connect(&ObjectStoreTyped<Yeast>::getInstance(),
+              &ObjectStoreTyped<Yeast>::signalObjectsInserted,
+              this,
+              [this](QVector<int> const & yeastIds) { this->addYeasts(ObjectStoreWrapper::getByIds<Yeast>(yeastIds)); return; });
       connect(&ObjectStoreTyped<Yeast>::getInstance(),
               &ObjectStoreTyped<Yeast>::signalObjectDeleted,
               this,
@@ -151,7 +155,7 @@ void YeastTableModel::addYeasts(QList<std::shared_ptr<Yeast> > yeasts) {
    auto tmp = this->removeDuplicates(yeasts, this->recObs);
 
    int size = this->rows.size();
-   if (size + tmp.size()) {
+   if (tmp.size()) {
       beginInsertRows(QModelIndex(), size, size + tmp.size() - 1);
       this->rows.append(tmp);
 
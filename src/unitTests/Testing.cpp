@@ -23,16 +23,30 @@
  */
 #include "unitTests/Testing.h"
 
+#include <algorithm>
+#include <array>
 #include <cmath>
 #include <exception>
 #include <iostream> // For std::cout
 #include <math.h>
 #include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 #include <xercesc/util/PlatformUtils.hpp>
 
 #include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QSqlError>
+#include <QSqlRecord>
 #include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
 #include <QtTest/QtTest>
 #if QT_VERSION < QT_VERSION_CHECK(5,10,0)
 #include <QtGlobal> // For qrand() -- which is superseded by QRandomGenerator in later versions of Qt
@@ -43,20 +57,32 @@
 
 #include "Algorithms.h"
 #include "config.h"
+#include "database/BtSqlQuery.h"
+#include "database/Database.h"
+#include "database/DatabaseSchemaHelper.h"
+#include "database/DbTransaction.h"
+#include "database/DbWriter.h"
+#include "database/ObjectStoreTyped.h"
 #include "database/ObjectStoreWrapper.h"
+#include "database/SqliteBackup.h"
 #include "Localization.h"
 #include "Logging.h"
 #include "measurement/Measurement.h"
+#include "measurement/SucroseConversion.h"
 #include "measurement/Unit.h"
 #include "measurement/UnitSystem.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
 #include "model/Hop.h"
+#include "model/Instruction.h"
 #include "model/Mash.h"
 #include "model/MashStep.h"
 #include "model/NamedParameterBundle.h"
 #include "model/Recipe.h"
 #include "PersistentSettings.h"
+#include "RecipeAnalyser.h"
+#include "RecipeCalculator.h"
+#include "utils/OptionalHelpers.h"
 
 namespace {
 
@@ -792,6 +818,1235 @@ void Testing::testLogRotation() {
    return;
 }
 
+void Testing::testJunctionTableBatchInsert() {
+   //
+   // Make enough hops for a recipe to need several multi-row statements (including a "remainder" that isn't a whole
+   // batch).
+   //
+   int const numHops = 1000;
+   QVector<int> hopIds;
+   for (int ii = 0; ii < numHops; ++ii) {
+      auto hop = std::make_shared<Hop>(QString{"Benchmark hop %1"}.arg(ii));
+      hopIds.append(ObjectStoreWrapper::insert(hop));
+   }
+
+   //
+   // Insert the same recipe content with one row per INSERT statement and then with the default batching.  Each time,
+   // check the right rows made it into the DB.
+   //
+   auto timeRecipeInsert = [&hopIds](int const maxRowsPerInsert) {
+      ObjectStore::setMaxRowsPerJunctionInsert(maxRowsPerInsert);
+      auto recipe = std::make_shared<Recipe>(QString{"Batch insert benchmark %1"}.arg(maxRowsPerInsert));
+      recipe->setHopIds(hopIds);
+      QElapsedTimer timer;
+      timer.start();
+      int const recipeId = ObjectStoreWrapper::insert(recipe);
+      qint64 const elapsed_ms = timer.elapsed();
+      qInfo() <<
+         Q_FUNC_INFO << "Inserting recipe with" << hopIds.size() << "hops using up to" << maxRowsPerInsert <<
+         "row(s) per statement took" << elapsed_ms << "ms";
+
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT hop_id FROM hop_in_recipe WHERE recipe_id = :recipe_id ORDER BY hop_id;");
+      sqlQuery.bindValue(":recipe_id", recipeId);
+      if (!sqlQuery.exec()) {
+         qCritical() << Q_FUNC_INFO << "Error reading back junction rows:" << sqlQuery.lastError().text();
+      }
+      QVector<int> hopIdsInDb;
+      while (sqlQuery.next()) {
+         hopIdsInDb.append(sqlQuery.value(0).toInt());
+      }
+      return hopIdsInDb;
+   };
+
+   QVector<int> const oneRowAtATime = timeRecipeInsert(1);
+   QVector<int> const batched       = timeRecipeInsert(256);
+   QCOMPARE(oneRowAtATime, hopIds);
+   QCOMPARE(batched, hopIds);
+   return;
+}
+
+void Testing::testObjectStoreLoadBenchmark() {
+   //
+   // Make sure there are enough rows in the hop table for the timing to mean something
+   //
+   int const numHops = 2000;
+   for (int ii = 0; ii < numHops; ++ii) {
+      auto hop = std::make_shared<Hop>(QString{"Load benchmark hop %1"}.arg(ii));
+      ObjectStoreWrapper::insert(hop);
+   }
+   int const numHopsInStore = ObjectStoreWrapper::getAll<Hop>().size();
+
+   //
+   // As a baseline, read the same table the way readAllFromDb() used to: looking up every field of every row by column
+   // name, with no reserving of the bundle or result vector.  Timing both in the same run (rather than across builds)
+   // gives a before/after comparison on the same machine, DB and disk cache.
+   //
+   auto readAllByColumnName = [numHopsInStore]() {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      if (!sqlQuery.exec("SELECT * FROM hop")) {
+         qCritical() << Q_FUNC_INFO << "Error reading hops:" << sqlQuery.lastError().text();
+      }
+      QStringList columnNames;
+      QSqlRecord const record = sqlQuery.record();
+      for (int ii = 0; ii < record.count(); ++ii) {
+         columnNames.append(record.fieldName(ii));
+      }
+      QVector<QHash<QString, QVariant> > rows;
+      while (sqlQuery.next()) {
+         QHash<QString, QVariant> row;
+         for (auto const & columnName : columnNames) {
+            row.insert(columnName, sqlQuery.value(columnName));
+         }
+         rows.append(row);
+      }
+      return rows.size() == numHopsInStore;
+   };
+
+   //
+   // Read the table a few times each way so that one slow run (eg a cold disk cache) doesn't skew things
+   //
+   int const numRuns = 5;
+   qint64 totalElapsedByName_ns  = 0;
+   qint64 totalElapsedByIndex_ns = 0;
+   for (int ii = 0; ii < numRuns; ++ii) {
+      QElapsedTimer timer;
+      timer.start();
+      bool const readAllByName = readAllByColumnName();
+      totalElapsedByName_ns += timer.nsecsElapsed();
+      QVERIFY(readAllByName);
+
+      timer.restart();
+      auto loadedData = ObjectStoreTyped<Hop>::getInstance().readAllFromDb(Database::instance());
+      totalElapsedByIndex_ns += timer.nsecsElapsed();
+
+      QVERIFY(loadedData->succeeded);
+      QCOMPARE(loadedData->primaryKeys.size(), numHopsInStore);
+      QCOMPARE(loadedData->namedParameterBundles.size(), numHopsInStore);
+   }
+   double const averageByName_ms  = static_cast<double>(totalElapsedByName_ns ) / numRuns / 1000000.0;
+   double const averageByIndex_ms = static_cast<double>(totalElapsedByIndex_ns) / numRuns / 1000000.0;
+   qInfo() <<
+      Q_FUNC_INFO << "Reading" << numHopsInStore << "hops from the DB by column name took an average of" <<
+      averageByName_ms << "ms; readAllFromDb() took an average of" << averageByIndex_ms << "ms (" <<
+      (averageByIndex_ms > 0.0 ? averageByName_ms / averageByIndex_ms : 0.0) << "x)";
+   return;
+}
+
+namespace {
+   //! \brief If \c value holds \c std::optional<T>, replace it with either \c T or null
+   template<typename T> void unwrapIfOptional(QVariant & value) {
+      if (value.userType() == qMetaTypeId<std::optional<T> >()) {
+         Optional::removeOptionalWrapper<T>(value);
+      }
+      return;
+   }
+
+   /**
+    * \brief The same value can legitimately come back in a different QVariant type from the DB and from a snapshot (eg
+    *        SQLite gives us integers as qlonglong), and optional values are wrapped in \c std::optional (see
+    *        \c Optional), so we unwrap and then compare either as QVariants or, failing that, as strings.
+    */
+   QVariant unwrappedForComparison(QVariant value) {
+      unwrapIfOptional<bool        >(value);
+      unwrapIfOptional<int         >(value);
+      unwrapIfOptional<unsigned int>(value);
+      unwrapIfOptional<double      >(value);
+      unwrapIfOptional<QString     >(value);
+      unwrapIfOptional<QDate       >(value);
+      return value;
+   }
+
+   /**
+    * \brief Compare everything an object store read from a snapshot with what it read from the DB
+    *
+    * \return Description of the first difference, or an empty string if there are none
+    */
+   QString firstDifference(ObjectStore::LoadedData const & fromSnapshot, ObjectStore::LoadedData const & fromDb) {
+      if (fromSnapshot.primaryKeys.size() != fromDb.primaryKeys.size()) {
+         return QString{"%1 rows in snapshot but %2 in DB"}.arg(fromSnapshot.primaryKeys.size())
+                                                          .arg(fromDb.primaryKeys.size());
+      }
+
+      // The snapshot is in primary key order, but the DB doesn't have to give us rows in any particular order
+      QHash<int, int> dbIndexByKey;
+      for (int ii = 0; ii < fromDb.primaryKeys.size(); ++ii) {
+         dbIndexByKey.insert(fromDb.primaryKeys.at(ii), ii);
+      }
+      for (int ii = 0; ii < fromSnapshot.primaryKeys.size(); ++ii) {
+         int const primaryKey = fromSnapshot.primaryKeys.at(ii);
+         if (!dbIndexByKey.contains(primaryKey)) {
+            return QString{"Row #%1 is in snapshot but not in DB"}.arg(primaryKey);
+         }
+         NamedParameterBundle const & snapshotRow = fromSnapshot.namedParameterBundles.at(ii);
+         NamedParameterBundle const & dbRow       = fromDb.namedParameterBundles.at(dbIndexByKey.value(primaryKey));
+         if (snapshotRow.size() != dbRow.size()) {
+            return QString{"Row #%1 has %2 properties in snapshot but %3 in DB"}.arg(primaryKey)
+                                                                                 .arg(snapshotRow.size())
+                                                                                 .arg(dbRow.size());
+         }
+         for (auto property = snapshotRow.cbegin(); property != snapshotRow.cend(); ++property) {
+            if (!dbRow.contains(property.key())) {
+               return QString{"Row #%1 property %2 is in snapshot but not in DB"}.arg(primaryKey).arg(property.key());
+            }
+            QVariant const snapshotValue = unwrappedForComparison(property.value());
+            QVariant const dbValue       = unwrappedForComparison(dbRow.value(property.key()));
+            if (snapshotValue != dbValue && snapshotValue.toString() != dbValue.toString()) {
+               return QString{"Row #%1 property %2 is \"%3\" in snapshot but \"%4\" in DB"}.arg(primaryKey)
+                                                                                          .arg(property.key())
+                                                                                          .arg(snapshotValue.toString())
+                                                                                          .arg(dbValue.toString());
+            }
+         }
+      }
+
+      // Order matters for some junction tables (eg instructions in a recipe), so we compare the lists as they are
+      if (fromSnapshot.junctionTableValues != fromDb.junctionTableValues) {
+         return QString{"Junction table contents differ"};
+      }
+      return QString{};
+   }
+
+   /**
+    * \brief Compare what every object store gets from the snapshot with what it gets from the DB
+    */
+   QString firstDifference(QMap<ObjectStore const *, std::shared_ptr<ObjectStore::LoadedData> > const & fromSnapshot,
+                           Database & database) {
+      for (auto store = fromSnapshot.cbegin(); store != fromSnapshot.cend(); ++store) {
+         auto const fromDb = store.key()->readAllFromDb(database);
+         if (!store.value() || !store.value()->succeeded || !fromDb->succeeded) {
+            return QString{"Unable to read %1"}.arg(*store.key()->primaryTableName());
+         }
+         QString const difference = firstDifference(*store.value(), *fromDb);
+         if (!difference.isEmpty()) {
+            return QString{"%1: %2"}.arg(*store.key()->primaryTableName()).arg(difference);
+         }
+      }
+      return QString{};
+   }
+}
+
+void Testing::testObjectStoreSnapshot() {
+   //
+   // Make sure there's a recipe with some junction table rows, including instructions in an order that isn't the
+   // order of their IDs
+   //
+   auto recipe = std::make_shared<Recipe>(QString{"Snapshot test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   for (int ii = 0; ii < 3; ++ii) {
+      recipe->add<Hop>(std::make_shared<Hop>(QString{"Snapshot test hop %1"}.arg(ii)));
+      auto instruction = recipe->add<Instruction>(
+         std::make_shared<Instruction>(QString{"Snapshot test step %1"}.arg(ii))
+      );
+      instruction->setDirections(QString{"Do step %1"}.arg(ii));
+      instruction->setInterval(10.0 * ii);
+   }
+   QList<Instruction *> const instructions = recipe->instructions();
+   QCOMPARE(instructions.size(), 3);
+   recipe->swapInstructions(instructions.first(), instructions.last());
+   QVector<int> const instructionIds = recipe->getInstructionIds();
+   QVERIFY(!std::is_sorted(instructionIds.cbegin(), instructionIds.cend()));
+   QVERIFY(FlushAllObjectStores());
+
+   auto const & recipeStore = ObjectStoreTyped<Recipe>::getInstance();
+   QByteArray snapshot;
+   {
+      QDataStream out{&snapshot, QIODevice::WriteOnly};
+      QVERIFY(recipeStore.writeSnapshot(out));
+   }
+   QDataStream in{snapshot};
+   auto fromSnapshot = recipeStore.readSnapshot(in);
+   auto fromDb = recipeStore.readAllFromDb(Database::instance());
+   QVERIFY(fromSnapshot->succeeded);
+   QVERIFY(fromDb->succeeded);
+
+   // Every persisted property of every row, and every junction table row, in order, should match
+   QString const difference = firstDifference(*fromSnapshot, *fromDb);
+   QVERIFY2(difference.isEmpty(), qPrintable(difference));
+
+   // Including the instructions, which need to stay in the order the recipe has them
+   bool foundInstructions = false;
+   for (auto const & thisToOtherKeys : fromSnapshot->junctionTableValues) {
+      if (thisToOtherKeys.value(recipe->key()) == instructionIds) {
+         foundInstructions = true;
+      }
+   }
+   QVERIFY(foundInstructions);
+   return;
+}
+
+void Testing::testObjectStoreSnapshotFile() {
+   Database & database = Database::instance();
+   QString const snapshotFileName = database.snapshotFileName();
+   if (snapshotFileName.isEmpty()) {
+      QSKIP("Object store snapshots are not used for this DB");
+   }
+   QFile::remove(snapshotFileName);
+
+   //
+   // Closing the DB should write a snapshot, and it should be what we read when the DB is next opened, as it would be
+   // on the next start-up.  Part of this is that the file stamp, which is taken when the DB is closed and checked
+   // once it has been opened again, has to be the same either way.
+   //
+   database.unload();
+   QByteArray const fileStampWhenClosed = database.fileStamp();
+   bool const reloaded = database.load();
+   QVERIFY(reloaded);
+   QVERIFY(QFile::exists(snapshotFileName));
+   QCOMPARE(database.fileStamp(), fileStampWhenClosed);
+
+   auto const fromSnapshot = ReadObjectStoreSnapshot(database);
+   QVERIFY2(!fromSnapshot.isEmpty(), "Snapshot was not used");
+   QVERIFY(fromSnapshot.contains(&ObjectStoreTyped<Recipe>::getInstance()));
+   QString const difference = firstDifference(fromSnapshot, database);
+   QVERIFY2(difference.isEmpty(), qPrintable(difference));
+
+   //
+   // A snapshot whose payload has been corrupted should be rejected, so that we fall back to reading the DB
+   //
+   QByteArray snapshotContents;
+   {
+      QFile snapshotFile{snapshotFileName};
+      QVERIFY(snapshotFile.open(QIODevice::ReadOnly));
+      snapshotContents = snapshotFile.readAll();
+   }
+   QVERIFY(!snapshotContents.isEmpty());
+   auto writeSnapshotFile = [&snapshotFileName](QByteArray const & contents) {
+      QFile snapshotFile{snapshotFileName};
+      return snapshotFile.open(QIODevice::WriteOnly | QIODevice::Truncate) &&
+             snapshotFile.write(contents) == contents.size();
+   };
+   QByteArray corruptedContents{snapshotContents};
+   int const lastByte = corruptedContents.size() - 1;
+   corruptedContents[lastByte] = static_cast<char>(~corruptedContents.at(lastByte));
+   QVERIFY(writeSnapshotFile(corruptedContents));
+   QVERIFY2(ReadObjectStoreSnapshot(database).isEmpty(), "Corrupted snapshot was used");
+   QVERIFY(writeSnapshotFile(snapshotContents));
+   QVERIFY(!ReadObjectStoreSnapshot(database).isEmpty());
+
+   //
+   // Once the DB has been written to, the snapshot is stale and should also be rejected
+   //
+   auto hop = std::make_shared<Hop>(QString{"Snapshot file test hop"});
+   ObjectStoreWrapper::insert(hop);
+   QVERIFY(FlushAllObjectStores());
+   QVERIFY(database.fileStamp() != fileStampWhenClosed);
+   QVERIFY2(ReadObjectStoreSnapshot(database).isEmpty(), "Stale snapshot was used");
+   return;
+}
+
+void Testing::testDbWriter() {
+   DbWriter & writer = Database::instance().writer();
+   QVERIFY(writer.waitForIdle());
+
+   //
+   // Operations should run in the order they were queued, and give us their results
+   //
+   int const numOperations = 100;
+   QMutex mutex;
+   QVector<int> runOrder;
+   QVector<int> expectedOrder;
+   std::future<bool> lastResult;
+   for (int ii = 0; ii < numOperations; ++ii) {
+      expectedOrder.append(ii);
+      lastResult = writer.enqueue(
+         QString{"test operation %1"}.arg(ii),
+         [&mutex, &runOrder, ii](QSqlDatabase &) {
+            QMutexLocker locker(&mutex);
+            runOrder.append(ii);
+            return true;
+         }
+      );
+   }
+   std::optional<int> const result = writer.enqueueForResult<int>(
+      "test operation with result",
+      [](QSqlDatabase &) -> std::optional<int> { return 42; }
+   ).get();
+   QVERIFY(lastResult.get());
+   QVERIFY(result && *result == 42);
+   QCOMPARE(runOrder, expectedOrder);
+
+   // A failure should be reported both through the operation's future and by the next waitForIdle() (only)
+   QVERIFY(!writer.enqueue("failing test operation", [](QSqlDatabase &) { return false; }).get());
+   QVERIFY(!writer.waitForIdle());
+   QVERIFY(writer.waitForIdle());
+
+   // An exception thrown by an operation should be reported as a failure, rather than terminating the program
+   QVERIFY(!writer.enqueue(
+      "throwing test operation",
+      [](QSqlDatabase &) -> bool { throw std::runtime_error{"Test exception"}; }
+   ).get());
+   QVERIFY(!writer.waitForIdle());
+   QVERIFY(!writer.enqueueForResult<int>(
+      "throwing test operation with result",
+      [](QSqlDatabase &) -> std::optional<int> { throw std::runtime_error{"Test exception"}; }
+   ).get());
+   QVERIFY(!writer.waitForIdle());
+
+   //
+   // A (deferred) property change should be in the DB once we've flushed the object stores
+   //
+   auto hop = std::make_shared<Hop>(QString{"DB writer test hop"});
+   int const hopId = ObjectStoreWrapper::insert(hop);
+   hop->setName("DB writer test hop renamed");
+   QVERIFY(FlushAllObjectStores());
+   QSqlDatabase connection = Database::instance().sqlDatabase();
+   BtSqlQuery sqlQuery{connection};
+   sqlQuery.prepare("SELECT name FROM hop WHERE id = :id;");
+   sqlQuery.bindValue(":id", hopId);
+   QVERIFY(sqlQuery.exec() && sqlQuery.next());
+   QCOMPARE(sqlQuery.value(0).toString(), QString{"DB writer test hop renamed"});
+   return;
+}
+
+void Testing::testDbTransactionNesting() {
+   // Make sure the DB writer isn't in the middle of anything
+   QVERIFY(FlushAllObjectStores());
+
+   Database & database = Database::instance();
+   QSqlDatabase connection = database.sqlDatabase();
+   BtSqlQuery sqlQuery{connection};
+   QVERIFY(sqlQuery.exec("CREATE TEMPORARY TABLE transaction_nesting_test (val INTEGER)"));
+
+   auto insertValue = [&connection](int val) {
+      BtSqlQuery insertQuery{connection};
+      insertQuery.prepare("INSERT INTO transaction_nesting_test (val) VALUES (:val);");
+      insertQuery.bindValue(":val", val);
+      return insertQuery.exec();
+   };
+
+   {
+      DbTransaction outerTransaction{database, connection};
+      QVERIFY(insertValue(1));
+      {
+         DbTransaction committedInnerTransaction{database, connection};
+         QVERIFY(insertValue(2));
+         QVERIFY(committedInnerTransaction.commit());
+      }
+      {
+         // Not committed, so should be rolled back when it goes out of scope
+         DbTransaction abandonedInnerTransaction{database, connection};
+         QVERIFY(insertValue(3));
+      }
+      QVERIFY(insertValue(4));
+      QVERIFY(outerTransaction.commit());
+   }
+
+   QVector<int> values;
+   QVERIFY(sqlQuery.exec("SELECT val FROM transaction_nesting_test ORDER BY val"));
+   while (sqlQuery.next()) {
+      values.append(sqlQuery.value(0).toInt());
+   }
+   QCOMPARE(values, (QVector<int>{1, 2, 4}));
+
+   QVERIFY(sqlQuery.exec("DROP TABLE transaction_nesting_test"));
+   return;
+}
+
+void Testing::testForeignKeyIndexes() {
+   Database & database = Database::instance();
+   if (database.dbType() != Database::DbType::SQLITE) {
+      QSKIP("EXPLAIN QUERY PLAN output is specific to SQLite");
+   }
+
+   QSqlDatabase connection = database.sqlDatabase();
+   BtSqlQuery sqlQuery{connection};
+   QVector<QPair<QString, QString> > const foreignKeyColumns{
+      {"hop_in_recipe", "recipe_id"},
+      {"hop_in_recipe", "hop_id"   },
+      {"brewnote",      "recipe_id"}
+   };
+   for (auto const & foreignKeyColumn : foreignKeyColumns) {
+      QString const tableName  = foreignKeyColumn.first;
+      QString const columnName = foreignKeyColumn.second;
+      QVERIFY(sqlQuery.exec(QString("EXPLAIN QUERY PLAN DELETE FROM %1 WHERE %2 = 1").arg(tableName, columnName)));
+      // The last column of each row of the plan is a human-readable description of that step
+      QString plan;
+      while (sqlQuery.next()) {
+         plan += sqlQuery.value(3).toString() + "\n";
+      }
+      qDebug() << Q_FUNC_INFO << "Query plan for deleting from" << tableName << "by" << columnName << ":" << plan;
+      QVERIFY2(plan.contains(QString("INDEX idx_%1_%2").arg(tableName, columnName)), qPrintable(plan));
+   }
+   return;
+}
+
+void Testing::testOnlineBackup() {
+   Database & database = Database::instance();
+   if (database.dbType() != Database::DbType::SQLITE) {
+      QSKIP("Online backup is specific to SQLite");
+   }
+
+   // Make sure there's something in the DB that the backup will have to pick up from the write-ahead log
+   auto hop = std::make_shared<Hop>("Backup Test Hop");
+   ObjectStoreWrapper::insert(hop);
+   QVERIFY(FlushAllObjectStores());
+
+   QTemporaryDir backupDir;
+   QVERIFY(backupDir.isValid());
+   QString const backupFileName = backupDir.filePath("backup.sqlite");
+   QVERIFY(database.backupToFile(backupFileName));
+
+   auto countHops = [](QSqlDatabase & connection) {
+      BtSqlQuery sqlQuery{connection};
+      if (!sqlQuery.exec("SELECT COUNT(*) FROM hop") || !sqlQuery.next()) {
+         return -1;
+      }
+      return sqlQuery.value(0).toInt();
+   };
+
+   QSqlDatabase connection = database.sqlDatabase();
+   int const hopsInDb = countHops(connection);
+   QVERIFY(hopsInDb > 0);
+
+   //
+   // QVERIFY etc return from the function on failure, so we keep them out of the scope of the connection, to make sure
+   // it always gets removed
+   //
+   QString const backupConnectionName{"testOnlineBackup"};
+   bool opened = false;
+   int hopsInBackup = -1;
+   {
+      QSqlDatabase backupConnection = QSqlDatabase::addDatabase("QSQLITE", backupConnectionName);
+      backupConnection.setDatabaseName(backupFileName);
+      opened = backupConnection.open();
+      if (opened) {
+         hopsInBackup = countHops(backupConnection);
+         backupConnection.close();
+      }
+   }
+   QSqlDatabase::removeDatabase(backupConnectionName);
+   QVERIFY(opened);
+   QCOMPARE(hopsInBackup, hopsInDb);
+
+   // If the Qt driver has its own SQLite, SqliteBackup should refuse, rather than mix up the two libraries
+   if (!SqliteBackup::driverUsesLinkedSqlite()) {
+      SqliteBackup backup{database.sqlDatabase().databaseName(), backupDir.filePath("refused.sqlite")};
+      QVERIFY(!backup.backupNow());
+   }
+   return;
+}
+
+void Testing::testRecipeRecalcGraph() {
+   auto recipe = std::make_shared<Recipe>(QString{"Recalc graph test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   recipe->setEquipment(this->equipFiveGalNoLoss.get());
+   recipe->add<Fermentable>(this->twoRow);
+   recipe->add<Hop>(this->cascade_4pct);
+
+   QList<Hop *> hops = recipe->hops();
+   QCOMPARE(hops.size(), 1);
+   // NB: Reading a calculated value ensures all the calculations have been initialised
+   double const ibuBefore = recipe->IBU();
+
+   std::array<unsigned int, Recipe::numCalcNodes> evaluationsBefore;
+   for (std::size_t ii = 0; ii < Recipe::numCalcNodes; ++ii) {
+      evaluationsBefore[ii] = recipe->calcNodeEvaluations(static_cast<Recipe::CalcNode>(ii));
+   }
+
+   // Changing the alpha acid of a hop should only affect bitterness, so IBU should be the only thing recalculated
+   hops.first()->setAlpha_pct(hops.first()->alpha_pct() * 2.0);
+   QVERIFY(recipe->IBU() > ibuBefore);
+   for (std::size_t ii = 0; ii < Recipe::numCalcNodes; ++ii) {
+      auto const node = static_cast<Recipe::CalcNode>(ii);
+      QCOMPARE(recipe->calcNodeEvaluations(node) - evaluationsBefore[ii],
+               node == Recipe::CalcNode::IBU ? 1u : 0u);
+   }
+
+   // Inside a RecalcBatch, nothing should be recalculated until the end, and then each calculation only once
+   for (std::size_t ii = 0; ii < Recipe::numCalcNodes; ++ii) {
+      evaluationsBefore[ii] = recipe->calcNodeEvaluations(static_cast<Recipe::CalcNode>(ii));
+   }
+   {
+      Recipe::RecalcBatch recalcBatch{*recipe};
+      recipe->setBatchSize_l(recipe->batchSize_l() * 2.0);
+      recipe->setEfficiency_pct(recipe->efficiency_pct() - 10.0);
+      hops.first()->setAmount_kg(hops.first()->amount_kg() * 2.0);
+      for (std::size_t ii = 0; ii < Recipe::numCalcNodes; ++ii) {
+         QCOMPARE(recipe->calcNodeEvaluations(static_cast<Recipe::CalcNode>(ii)), evaluationsBefore[ii]);
+      }
+   }
+   for (std::size_t ii = 0; ii < Recipe::numCalcNodes; ++ii) {
+      QVERIFY(recipe->calcNodeEvaluations(static_cast<Recipe::CalcNode>(ii)) - evaluationsBefore[ii] <= 1u);
+   }
+   std::size_t const ibuIndex = static_cast<std::size_t>(Recipe::CalcNode::IBU);
+   QCOMPARE(recipe->calcNodeEvaluations(Recipe::CalcNode::IBU) - evaluationsBefore[ibuIndex], 1u);
+   return;
+}
+
+void Testing::testRecipeCalculator() {
+   // A simple all-grain recipe, described entirely with plain values (ie no Recipe, Hop, etc objects)
+   RecipeCalculator::Inputs inputs;
+   inputs.batchSize_l    = 20.0;
+   inputs.boilSize_l     = 25.0;
+   inputs.efficiency_pct = 70.0;
+   inputs.fermentables.push_back(
+      RecipeCalculator::FermentableInput{Fermentable::Type::Grain, true, false, true, 5.0, 70.0, 0.0, 2.0, 0.0}
+   );
+   inputs.hops.push_back(RecipeCalculator::HopInput{4.0, 0.085, 60.0, Hop::Use::Boil, Hop::Form::Leaf});
+   inputs.yeastAttenuations_pct.push_back(75.0);
+   inputs.totalMashWater_l = 30.0;
+   inputs.settings = RecipeCalculator::Settings{IbuMethods::TINSETH, ColorMethods::MOREY, 1.1, 0.0};
+
+   RecipeCalculator::Results const results = RecipeCalculator::calculate(inputs);
+   QCOMPARE(results.grains_kg, 5.0);
+   QCOMPARE(results.finalVolumeNoLosses_l, inputs.batchSize_l);
+   QVERIFY2(results.og > 1.040 && results.og < 1.070, "Implausible OG");
+   QVERIFY2(results.fg > 1.0 && results.fg < results.og, "Implausible FG");
+   QVERIFY2(results.ABV_pct > 3.0 && results.ABV_pct < 8.0, "Implausible ABV");
+   QCOMPARE(results.ibus.size(), static_cast<std::size_t>(1));
+   QVERIFY2(results.IBU > 10.0 && results.IBU < 60.0, "Implausible IBU");
+
+   // IBUs are proportional to the amount of hops, and the calculation is a pure function of its inputs
+   inputs.hops.push_back(inputs.hops.front());
+   RecipeCalculator::Results const doubleHopped = RecipeCalculator::calculate(inputs);
+   QVERIFY(fuzzyComp(doubleHopped.IBU, 2.0 * results.IBU, 1e-9));
+   QCOMPARE(doubleHopped.og, results.og);
+   return;
+}
+
+void Testing::testRecipeResultsStorage() {
+   RecipeCalculator::Inputs inputs;
+   inputs.batchSize_l    = 20.0;
+   inputs.boilSize_l     = 25.0;
+   inputs.efficiency_pct = 70.0;
+   inputs.fermentables.push_back(
+      RecipeCalculator::FermentableInput{Fermentable::Type::Grain, true, false, true, 5.0, 70.0, 0.0, 2.0, 0.0}
+   );
+   inputs.hops.push_back(RecipeCalculator::HopInput{4.0, 0.085, 60.0, Hop::Use::Boil, Hop::Form::Leaf});
+   inputs.hops.push_back(RecipeCalculator::HopInput{6.0, 0.030, 15.0, Hop::Use::Boil, Hop::Form::Pellet});
+   inputs.yeastAttenuations_pct.push_back(75.0);
+   inputs.totalMashWater_l = 30.0;
+   inputs.settings = RecipeCalculator::Settings{IbuMethods::TINSETH, ColorMethods::MOREY, 1.1, 0.0};
+   RecipeCalculator::Results const results = RecipeCalculator::calculate(inputs);
+
+   // Stored results should come back as they were, and the fingerprint should change if any of the inputs do
+   RecipeCalculator::Results restored;
+   QVERIFY(RecipeCalculator::fromJson(RecipeCalculator::toJson(results), inputs, restored));
+   QCOMPARE(restored.og, results.og);
+   QCOMPARE(restored.IBU, results.IBU);
+   QCOMPARE(restored.ibus, results.ibus);
+   QCOMPARE(restored.SRMColor, results.SRMColor);
+   QString const fingerprint = RecipeCalculator::fingerprint(inputs);
+   QCOMPARE(RecipeCalculator::fingerprint(inputs), fingerprint);
+   RecipeCalculator::Inputs changedInputs{inputs};
+   QVERIFY(changedInputs == inputs);
+   changedInputs.hops.back().time_min = 30.0;
+   QVERIFY(!(changedInputs == inputs));
+   QVERIFY(RecipeCalculator::fingerprint(changedInputs) != fingerprint);
+
+   //
+   // A Recipe should only queue its stored results to be written to the DB when they change, and then as deferred
+   // writes.  (We don't return to the event loop in this test, so the write-behind queue isn't flushed behind our
+   // back.)
+   //
+   auto recipe = std::make_shared<Recipe>(QString{"Results storage test recipe"});
+   int const recipeId = ObjectStoreWrapper::insert(recipe);
+   recipe->setEquipment(this->equipFiveGalNoLoss.get());
+   recipe->add<Fermentable>(this->twoRow);
+   recipe->add<Hop>(this->cascade_4pct);
+   // NB: Reading a calculated value ensures all the calculations have been initialised
+   double const ibuBefore = recipe->IBU();
+   QVERIFY(FlushAllObjectStores());
+   auto const & recipeStore = ObjectStoreTyped<Recipe>::getInstance();
+   QCOMPARE(recipeStore.numQueuedPropertyUpdates(), 0);
+   QString const fingerprintBefore = recipe->calcFingerprint();
+   QString const calcResultsBefore = recipe->calcResults();
+   QVERIFY(!fingerprintBefore.isEmpty());
+   QVERIFY(!calcResultsBefore.isEmpty());
+
+   // A recalculation that ends up where it started shouldn't write anything
+   Hop * hop = recipe->hops().first();
+   double const alpha_pct = hop->alpha_pct();
+   {
+      Recipe::RecalcBatch recalcBatch{*recipe};
+      hop->setAlpha_pct(alpha_pct * 2.0);
+      hop->setAlpha_pct(alpha_pct);
+   }
+   QCOMPARE(recipe->IBU(), ibuBefore);
+   QCOMPARE(recipe->calcFingerprint(), fingerprintBefore);
+   QCOMPARE(recipe->calcResults(), calcResultsBefore);
+   QCOMPARE(recipeStore.numQueuedPropertyUpdates(), 0);
+
+   // A real change should queue both the fingerprint and the results, and nothing gets written until we flush
+   hop->setAlpha_pct(alpha_pct * 2.0);
+   QVERIFY(recipe->IBU() > ibuBefore);
+   QVERIFY(recipe->calcFingerprint() != fingerprintBefore);
+   QVERIFY(recipe->calcResults() != calcResultsBefore);
+   QCOMPARE(recipeStore.numQueuedPropertyUpdates(), 2);
+   auto readStored = [recipeId]() {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT calc_fingerprint FROM recipe WHERE id = :id;");
+      sqlQuery.bindValue(":id", recipeId);
+      if (!sqlQuery.exec() || !sqlQuery.next()) {
+         return QString{};
+      }
+      return sqlQuery.value(0).toString();
+   };
+   QCOMPARE(readStored(), fingerprintBefore);
+   QVERIFY(FlushAllObjectStores());
+   QCOMPARE(readStored(), recipe->calcFingerprint());
+   return;
+}
+
+void Testing::testIbuBatchKernel() {
+   //
+   // Whole-schedule IBU calculation should agree with doing one hop at a time, for every formula.  We use an odd number
+   // of hops, more than fit in a vector register, so that, if the compiler has vectorised the kernels, both the
+   // vectorised loop and the scalar remainder are exercised.  (Doing one hop at a time only ever hits the latter.)  The
+   // gravities cover each branch of the Rager and Noonan gravity adjustments.
+   //
+   std::size_t constexpr numHops = 11;
+   double const AAratings[numHops] = {0.04, 0.12, 0.065, 0.15, 0.03, 0.08, 0.055, 0.10, 0.045, 0.135, 0.07};
+   double const grams[numHops]     = {85.0, 20.0, 30.0,  5.0,  150.0, 42.5, 28.35, 12.0, 60.0, 7.5,   33.0};
+   double const minutes[numHops]   = {60.0, 15.0, 0.0,   90.0, 5.0,   30.0, 45.0,  1.0,  75.0, 10.0,  20.0};
+   for (auto formula : {IbuMethods::TINSETH, IbuMethods::RAGER, IbuMethods::NOONAN}) {
+      for (double const wortGravity : {1.040, 1.060, 1.080, 1.095, 1.120}) {
+         double ibus[numHops];
+         IbuMethods::getIbus(formula, numHops, AAratings, grams, minutes, 20.0, wortGravity, ibus);
+         for (std::size_t ii = 0; ii < numHops; ++ii) {
+            double const perHopIbus = IbuMethods::getIbus(formula,
+                                                          AAratings[ii],
+                                                          grams[ii],
+                                                          20.0,
+                                                          wortGravity,
+                                                          minutes[ii]);
+            QVERIFY(fuzzyComp(ibus[ii], perHopIbus, 1e-9));
+         }
+      }
+   }
+
+   //
+   // Since the per-hop version is itself a call to the kernel, also check one value by hand: 1oz of 6.4% AA hops boiled
+   // for 60 minutes in 5 US gallons of 1.050 wort should give about 22 IBUs by Tinseth's formula.
+   //
+   double const tinsethIbus = IbuMethods::getIbus(IbuMethods::TINSETH, 0.064, 28.35, 18.93, 1.050, 60.0);
+   QVERIFY2(tinsethIbus > 21.5 && tinsethIbus < 22.5, "Tinseth IBUs differ from hand calculation");
+   return;
+}
+
+void Testing::testSucroseConversionLookups() {
+   using Measurement::SucroseConversion;
+
+   //
+   // Reference implementation of the conversions, using a binary search of the whole table, as we used to do.  The
+   // indexed lookups in Algorithms should give exactly the same answers.
+   //
+   auto referenceConversion = [](double const value,
+                                 double SucroseConversion::* const fromColumn,
+                                 double SucroseConversion::* const toColumn) {
+      SucroseConversion const * const first = &Measurement::sucroseConversions[0];
+      SucroseConversion const * const last  = first + Measurement::sucroseConversions_size - 1;
+      if (value >= last->*fromColumn) {
+         return last->*toColumn;
+      }
+      if (value <= first->*fromColumn) {
+         return first->*toColumn;
+      }
+      SucroseConversion const * const firstLarger = std::lower_bound(
+         first, last, value, [fromColumn](SucroseConversion const & row, double val) { return row.*fromColumn < val; }
+      );
+      if (firstLarger->*fromColumn == value) {
+         return firstLarger->*toColumn;
+      }
+      SucroseConversion const * const lastSmaller = firstLarger - 1;
+      double const positionInRange =
+         (value - lastSmaller->*fromColumn) / (firstLarger->*fromColumn - lastSmaller->*fromColumn);
+      return positionInRange * (firstLarger->*toColumn - lastSmaller->*toColumn) + lastSmaller->*toColumn;
+   };
+
+   struct Lookup {
+      double SucroseConversion::* fromColumn;
+      double SucroseConversion::* toColumn;
+      double (*convert)(double);
+   };
+   std::array<Lookup, 4> const lookups {{
+      {&SucroseConversion::apparentSgAt2020C,    &SucroseConversion::degreesBrix,          &Algorithms::SgAt20CToBrix             },
+      {&SucroseConversion::degreesBrix,          &SucroseConversion::apparentSgAt2020C,    &Algorithms::BrixToSgAt20C             },
+      {&SucroseConversion::refractiveIndexAt20C, &SucroseConversion::degreesBrix,          &Algorithms::RefractiveIndexAt20CToBrix},
+      {&SucroseConversion::degreesBrix,          &SucroseConversion::refractiveIndexAt20C, &Algorithms::BrixToRefractiveIndexAt20C},
+   }};
+
+   // Sweep just inside the table, so we're not testing the out-of-range warnings (and SG <= 1.0 special case) here
+   int const numSteps = 20000;
+   for (Lookup const & lookup : lookups) {
+      double const lowest  = Measurement::sucroseConversions[1].*lookup.fromColumn;
+      double const highest = Measurement::sucroseConversions[Measurement::sucroseConversions_size - 1].*lookup.fromColumn;
+      for (int ii = 0; ii <= numSteps; ++ii) {
+         double const value = lowest + (highest - lowest) * ii / numSteps;
+         QCOMPARE(lookup.convert(value), referenceConversion(value, lookup.fromColumn, lookup.toColumn));
+      }
+      // Exact matches on every row should give the value in that row
+      for (std::size_t row = 1; row < Measurement::sucroseConversions_size; ++row) {
+         double const value = Measurement::sucroseConversions[row].*lookup.fromColumn;
+         QCOMPARE(lookup.convert(value), Measurement::sucroseConversions[row].*lookup.toColumn);
+      }
+   }
+
+   // Batch conversion should give the same as one-at-a-time, and should be quick
+   std::vector<double> refractiveIndexes(10000);
+   for (std::size_t ii = 0; ii < refractiveIndexes.size(); ++ii) {
+      refractiveIndexes[ii] = 1.3330 + 0.1 * ii / refractiveIndexes.size();
+   }
+   std::vector<double> brix(refractiveIndexes.size());
+   QBENCHMARK {
+      Algorithms::RefractiveIndexAt20CToBrix(refractiveIndexes.size(), refractiveIndexes.data(), brix.data());
+   }
+   for (std::size_t ii = 0; ii < refractiveIndexes.size(); ++ii) {
+      QCOMPARE(brix[ii], Algorithms::RefractiveIndexAt20CToBrix(refractiveIndexes[ii]));
+   }
+   return;
+}
+
+void Testing::testWriteBehindQueue() {
+   // Make sure nothing is left over from other tests
+   QVERIFY(FlushAllObjectStores());
+
+   auto const & hopStore = ObjectStoreTyped<Hop>::getInstance();
+   auto hop = std::make_shared<Hop>(QString{"Write-behind test hop"});
+   int const hopId = ObjectStoreWrapper::insert(hop);
+   QCOMPARE(hopStore.numQueuedPropertyUpdates(), 0);
+
+   auto readHop = [hopId](QSqlDatabase & connection) -> std::optional<QPair<QString, double> > {
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT name, alpha FROM hop WHERE id = :id;");
+      sqlQuery.bindValue(":id", hopId);
+      if (!sqlQuery.exec() || !sqlQuery.next()) {
+         return std::nullopt;
+      }
+      return qMakePair(sqlQuery.value(0).toString(), sqlQuery.value(1).toDouble());
+   };
+
+   //
+   // Several changes to the same property should be coalesced into one queued update, and nothing should be written
+   // until the queue is flushed.  (We don't return to the event loop in this test, so the flush timer can't fire.)
+   //
+   hop->setName("Write-behind test hop 1");
+   hop->setName("Write-behind test hop 2");
+   hop->setAlpha_pct(7.5);
+   hop->setName("Write-behind test hop 3");
+   QCOMPARE(hopStore.numQueuedPropertyUpdates(), 2);
+   QSqlDatabase connection = Database::instance().sqlDatabase();
+   auto const beforeFlush = readHop(connection);
+   QVERIFY(beforeFlush);
+   QCOMPARE(beforeFlush->first, QString{"Write-behind test hop"});
+
+   //
+   // Flushing should write the latest value of each property, ahead of anything queued on the DB writer after the
+   // flush.
+   //
+   std::future<bool> flushed = hopStore.flush();
+   QCOMPARE(hopStore.numQueuedPropertyUpdates(), 0);
+   auto const seenByWriter = Database::instance().writer().enqueueForResult<QPair<QString, double> >(
+      "read back write-behind test hop",
+      readHop
+   ).get();
+   QVERIFY(flushed.get());
+   QVERIFY(seenByWriter);
+   QCOMPARE(seenByWriter->first, QString{"Write-behind test hop 3"});
+   QCOMPARE(seenByWriter->second, 7.5);
+
+   // Flushing an empty queue is fine
+   QVERIFY(hopStore.flush().get());
+   return;
+}
+
+void Testing::testStatementCache() {
+   // Make sure nothing is left over from other tests
+   QVERIFY(FlushAllObjectStores());
+
+   auto const & hopStore = ObjectStoreTyped<Hop>::getInstance();
+   auto hop = std::make_shared<Hop>(QString{"Statement cache test hop"});
+   ObjectStoreWrapper::insert(hop);
+
+   // However many statements the first write needs to prepare, doing the same write again should reuse them all
+   hop->setName("Statement cache test hop 1");
+   QVERIFY(FlushAllObjectStores());
+   ObjectStore::StatementCacheStats const afterFirstWrite = hopStore.statementCacheStats();
+   hop->setName("Statement cache test hop 2");
+   QVERIFY(FlushAllObjectStores());
+   ObjectStore::StatementCacheStats const afterSecondWrite = hopStore.statementCacheStats();
+   QCOMPARE(afterSecondWrite.misses, afterFirstWrite.misses);
+   QVERIFY(afterSecondWrite.hits > afterFirstWrite.hits);
+   QCOMPARE(afterSecondWrite.numStatements, afterFirstWrite.numStatements);
+
+   //
+   // Once the statements for the connection doing the writes have been released, they have to be prepared again.  (We
+   // release them on the DB writer thread, as that's the thread that owns the connection.)
+   //
+   QVERIFY(Database::instance().writer().enqueue(
+      "clear hop statement cache",
+      [&hopStore](QSqlDatabase & connection) {
+         hopStore.clearStatementCache(connection.connectionName());
+         return true;
+      }
+   ).get());
+   QVERIFY(hopStore.statementCacheStats().numStatements < afterSecondWrite.numStatements);
+   hop->setName("Statement cache test hop 3");
+   QVERIFY(FlushAllObjectStores());
+   QVERIFY(hopStore.statementCacheStats().misses > afterSecondWrite.misses);
+
+   // And, of course, the cached statements should have written the right thing
+   QSqlDatabase connection = Database::instance().sqlDatabase();
+   BtSqlQuery sqlQuery{connection};
+   sqlQuery.prepare("SELECT name FROM hop WHERE id = :id;");
+   sqlQuery.bindValue(":id", hop->key());
+   QVERIFY(sqlQuery.exec() && sqlQuery.next());
+   QCOMPARE(sqlQuery.value(0).toString(), QString{"Statement cache test hop 3"});
+   return;
+}
+
+void Testing::testJunctionTableDiff() {
+   QVector<int> hopIds;
+   for (int ii = 0; ii < 4; ++ii) {
+      hopIds.append(ObjectStoreWrapper::insert(std::make_shared<Hop>(QString{"Junction diff test hop %1"}.arg(ii))));
+   }
+   auto recipe = std::make_shared<Recipe>(QString{"Junction diff test recipe"});
+   recipe->setHopIds({hopIds[0], hopIds[1], hopIds[2]});
+   int const recipeId = ObjectStoreWrapper::insert(recipe);
+
+   // Map from hop ID to the ID(s) of its row(s) in the junction table
+   auto readJunctionRows = [recipeId]() {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT hop_id, id FROM hop_in_recipe WHERE recipe_id = :recipe_id;");
+      sqlQuery.bindValue(":recipe_id", recipeId);
+      QMultiMap<int, int> rows;
+      if (!sqlQuery.exec()) {
+         qCritical() << Q_FUNC_INFO << "Error reading junction rows:" << sqlQuery.lastError().text();
+         return rows;
+      }
+      while (sqlQuery.next()) {
+         rows.insert(sqlQuery.value(0).toInt(), sqlQuery.value(1).toInt());
+      }
+      return rows;
+   };
+   QVERIFY(FlushAllObjectStores());
+   auto const rowsBefore = readJunctionRows();
+   QCOMPARE(rowsBefore.uniqueKeys(), (QList<int>{hopIds[0], hopIds[1], hopIds[2]}));
+
+   //
+   // Remove one hop, add another, and change the order.  Only the rows for the hops removed and added should change;
+   // the others should be the same rows as before (rather than new ones with the same contents).
+   //
+   auto & recipeStore = ObjectStoreTyped<Recipe>::getInstance();
+   recipe->setHopIds({hopIds[2], hopIds[0], hopIds[3]});
+   recipeStore.updateProperty(*recipe, PropertyNames::Recipe::hopIds, ObjectStore::WriteMode::Immediate);
+   auto const rowsAfter = readJunctionRows();
+   QCOMPARE(rowsAfter.uniqueKeys(), (QList<int>{hopIds[0], hopIds[2], hopIds[3]}));
+   QCOMPARE(rowsAfter.size(), 3);
+   QCOMPARE(rowsAfter.value(hopIds[0]), rowsBefore.value(hopIds[0]));
+   QCOMPARE(rowsAfter.value(hopIds[2]), rowsBefore.value(hopIds[2]));
+
+   // With a duplicate ID, we fall back to rewriting all the rows, which should still leave the right ones in the DB
+   recipe->setHopIds({hopIds[3], hopIds[3]});
+   recipeStore.updateProperty(*recipe, PropertyNames::Recipe::hopIds, ObjectStore::WriteMode::Immediate);
+   auto const rowsWithDuplicate = readJunctionRows();
+   QCOMPARE(rowsWithDuplicate.size(), 2);
+   QCOMPARE(rowsWithDuplicate.count(hopIds[3]), 2);
+   return;
+}
+
+void Testing::testOwningRecipeIndex() {
+   auto recipe = std::make_shared<Recipe>(QString{"Owning recipe test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   auto otherRecipe = std::make_shared<Recipe>(QString{"Owning recipe test other recipe"});
+   ObjectStoreWrapper::insert(otherRecipe);
+
+   // Something that hasn't been stored can't be in a recipe
+   Hop const unstoredHop{QString{"Owning recipe test unstored hop"}};
+   QVERIFY(Recipe::findOwningRecipe(unstoredHop) == nullptr);
+
+   // Ingredients are held in lists of IDs, each element of which should be indexed
+   auto hop = recipe->add<Hop>(std::make_shared<Hop>(QString{"Owning recipe test hop"}));
+   QCOMPARE(Recipe::findOwningRecipe(*hop), recipe.get());
+   QCOMPARE(hop->getOwningRecipe(), recipe.get());
+
+   // Equipment is held by a single ID, but should be found in the same way
+   auto equipment = std::make_shared<Equipment>(QString{"Owning recipe test equipment"});
+   ObjectStoreWrapper::insert(equipment);
+   otherRecipe->setEquipment(equipment.get());
+   QVERIFY(otherRecipe->equipment() != nullptr);
+   QCOMPARE(Recipe::findOwningRecipe(*otherRecipe->equipment()), otherRecipe.get());
+
+   // Once the hop is removed from the recipe, the index should no longer think it has an owner
+   recipe->remove(hop);
+   QVERIFY(Recipe::findOwningRecipe(*hop) == nullptr);
+   return;
+}
+
+void Testing::testObjectStoreTransactionRollback() {
+   auto existingHop = std::make_shared<Hop>(QString{"Transaction rollback test hop"});
+   int const existingHopId = ObjectStoreWrapper::insert(existingHop);
+   QVERIFY(existingHopId > 0);
+   QVERIFY(FlushAllObjectStores());
+
+   auto countHopsNamed = [](QString const & name) {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("SELECT COUNT(*) FROM hop WHERE name = :name;");
+      sqlQuery.bindValue(":name", name);
+      if (!sqlQuery.exec() || !sqlQuery.next()) {
+         qCritical() << Q_FUNC_INFO << "Error counting hops:" << sqlQuery.lastError().text();
+         return -1;
+      }
+      return sqlQuery.value(0).toInt();
+   };
+
+   //
+   // If any write inside the transaction fails, commit() should roll back everything, and the object stores should
+   // forget the insert and reload the update
+   //
+   auto newHop = std::make_shared<Hop>(QString{"Transaction rollback test new hop"});
+   {
+      ObjectStoreTransaction objectStoreTransaction;
+      int const newHopId = ObjectStoreWrapper::insert(newHop);
+      QVERIFY(newHopId > 0);
+      existingHop->setName("Transaction rollback test hop renamed");
+      Database::instance().writer().enqueue("failing test operation", [](QSqlDatabase &) { return false; });
+      QVERIFY(!objectStoreTransaction.commit());
+      QVERIFY(!ObjectStoreWrapper::contains<Hop>(newHopId));
+   }
+   // Clear the failure we caused
+   Database::instance().writer().waitForIdle();
+   QCOMPARE(newHop->key(), -1);
+   QCOMPARE(existingHop->name(), QString{"Transaction rollback test hop"});
+   QCOMPARE(countHopsNamed("Transaction rollback test new hop"), 0);
+   QCOMPARE(countHopsNamed("Transaction rollback test hop renamed"), 0);
+
+   //
+   // An uncommitted transaction should also be rolled back, and an object deleted in it should come back
+   //
+   {
+      ObjectStoreTransaction objectStoreTransaction;
+      ObjectStoreWrapper::hardDelete<Hop>(existingHopId);
+      QVERIFY(!ObjectStoreWrapper::contains<Hop>(existingHopId));
+   }
+   QVERIFY(ObjectStoreWrapper::contains<Hop>(existingHopId));
+   QCOMPARE(ObjectStoreWrapper::getById<Hop>(existingHopId), existingHop);
+   QCOMPARE(existingHop->key(), existingHopId);
+   QCOMPARE(countHopsNamed("Transaction rollback test hop"), 1);
+
+   // With nothing failing, the transaction should commit
+   {
+      ObjectStoreTransaction objectStoreTransaction;
+      ObjectStoreWrapper::insert(newHop);
+      QVERIFY(objectStoreTransaction.commit());
+   }
+   QVERIFY(newHop->key() > 0);
+   QVERIFY(ObjectStoreWrapper::contains<Hop>(newHop->key()));
+   QCOMPARE(countHopsNamed("Transaction rollback test new hop"), 1);
+   QVERIFY(FlushAllObjectStores());
+   return;
+}
+
+void Testing::testCopyToNewDatabase() {
+   Database & database = Database::instance();
+   if (database.dbType() != Database::DbType::SQLITE) {
+      // We can only stand in for the new DB's Database object if it is the same type as ours
+      QSKIP("Copying to a new SQLite DB needs to start from a SQLite DB");
+   }
+
+   //
+   // We want more hops than ObjectStore::writeAllToNewDb() writes in one chunk, plus a recipe using some of them, so
+   // that both the multi-row inserts and the junction table writes get exercised
+   //
+   {
+      BulkImportSession bulkImportSession;
+      for (int ii = 0; ii < 1100; ++ii) {
+         ObjectStoreWrapper::insert(std::make_shared<Hop>(QString{"Copy to new DB test hop %1"}.arg(ii)));
+      }
+      QVERIFY(bulkImportSession.commit());
+   }
+   auto recipe = std::make_shared<Recipe>(QString{"Copy to new DB test recipe"});
+   ObjectStoreWrapper::insert(recipe);
+   recipe->add<Hop>(std::make_shared<Hop>(QString{"Copy to new DB test recipe hop 1"}));
+   recipe->add<Hop>(std::make_shared<Hop>(QString{"Copy to new DB test recipe hop 2"}));
+   QVERIFY(FlushAllObjectStores());
+
+   int const expectedHops = ObjectStoreWrapper::getAll<Hop>().size();
+   int expectedHopsInRecipes = 0;
+   for (auto const & currentRecipe : ObjectStoreWrapper::getAll<Recipe>()) {
+      expectedHopsInRecipes += currentRecipe->getHopIds().size();
+   }
+
+   QTemporaryDir tempDir;
+   QVERIFY(tempDir.isValid());
+   QString const connectionName{"testCopyToNewDatabase"};
+   bool opened = false;
+   bool copied = false;
+   int hopRows = -1;
+   int hopInRecipeRows = -1;
+   int lastObjectsWritten = -1;
+   int lastObjectsTotal = -1;
+   //
+   // Everything using the connection has to be gone before we can remove it, so we just record results in here, and
+   // check them afterwards
+   //
+   {
+      QSqlDatabase connectionNew = QSqlDatabase::addDatabase("QSQLITE", connectionName);
+      connectionNew.setDatabaseName(tempDir.filePath("copy.sqlite"));
+      opened = connectionNew.open();
+      if (opened) {
+         copied = DatabaseSchemaHelper::copyToNewDatabase(
+            database,
+            connectionNew,
+            [&lastObjectsWritten, &lastObjectsTotal](QString const &, int objectsWritten, int objectsTotal) {
+               lastObjectsWritten = objectsWritten;
+               lastObjectsTotal = objectsTotal;
+               return;
+            }
+         );
+         BtSqlQuery sqlQuery{connectionNew};
+         if (sqlQuery.exec("SELECT COUNT(*) FROM hop") && sqlQuery.next()) {
+            hopRows = sqlQuery.value(0).toInt();
+         }
+         if (sqlQuery.exec("SELECT COUNT(*) FROM hop_in_recipe") && sqlQuery.next()) {
+            hopInRecipeRows = sqlQuery.value(0).toInt();
+         }
+      }
+      connectionNew.close();
+   }
+   QSqlDatabase::removeDatabase(connectionName);
+
+   QVERIFY(opened);
+   QVERIFY(copied);
+   QCOMPARE(hopRows, expectedHops);
+   QCOMPARE(hopInRecipeRows, expectedHopsInRecipes);
+   QVERIFY(lastObjectsTotal > expectedHops);
+   QCOMPARE(lastObjectsWritten, lastObjectsTotal);
+   return;
+}
+
+void Testing::testCalcSettingsRefresh() {
+   PersistentSettings::remove(PersistentSettings::Names::firstWortHopAdjustment);
+   PersistentSettings::remove(PersistentSettings::Names::mashHopAdjustment);
+   double const defaultFirstWortHopAdjustment = Recipe::calcSettings().firstWortHopAdjustment;
+   QVERIFY(fuzzyComp(defaultFirstWortHopAdjustment, 1.1, 1e-9));
+
+   // Changing a setting should be picked up straight away, without anything else having to happen first
+   PersistentSettings::insert(PersistentSettings::Names::firstWortHopAdjustment, 1.5);
+   QVERIFY(fuzzyComp(Recipe::calcSettings().firstWortHopAdjustment, 1.5, 1e-9));
+   PersistentSettings::insert(PersistentSettings::Names::mashHopAdjustment, 0.25);
+   QVERIFY(fuzzyComp(Recipe::calcSettings().mashHopAdjustment, 0.25, 1e-9));
+   QVERIFY(fuzzyComp(Recipe::calcSettings().firstWortHopAdjustment, 1.5, 1e-9));
+
+   // Worker threads should see the same values
+   double workerFirstWortHopAdjustment = 0.0;
+   std::thread worker{
+      [&workerFirstWortHopAdjustment]() {
+         workerFirstWortHopAdjustment = Recipe::calcSettings().firstWortHopAdjustment;
+         return;
+      }
+   };
+   worker.join();
+   QVERIFY(fuzzyComp(workerFirstWortHopAdjustment, 1.5, 1e-9));
+
+   // Removing a setting should take us back to the default
+   PersistentSettings::remove(PersistentSettings::Names::firstWortHopAdjustment);
+   PersistentSettings::remove(PersistentSettings::Names::mashHopAdjustment);
+   QVERIFY(fuzzyComp(Recipe::calcSettings().firstWortHopAdjustment, defaultFirstWortHopAdjustment, 1e-9));
+   QVERIFY(fuzzyComp(Recipe::calcSettings().mashHopAdjustment, 0.0, 1e-9));
+   return;
+}
+
+namespace {
+   //! Sink for \c Testing::testRecipeAnalyser() that just keeps everything it's given
+   class CollectingSink : public RecipeAnalyser::Sink {
+   public:
+      virtual bool begin() override {
+         ++this->numBegins;
+         return true;
+      }
+      virtual bool write(RecipeAnalyser::RecipeStats const & stats) override {
+         this->stats.append(stats);
+         return true;
+      }
+      virtual bool end() override {
+         ++this->numEnds;
+         return true;
+      }
+
+      int numBegins = 0;
+      int numEnds = 0;
+      QVector<RecipeAnalyser::RecipeStats> stats;
+   };
+}
+
+void Testing::testRecipeAnalyser() {
+   auto recipe = std::make_shared<Recipe>(QString{"Recipe analyser test recipe"});
+   int const recipeId = ObjectStoreWrapper::insert(recipe);
+   recipe->add<Hop>(std::make_shared<Hop>(QString{"Recipe analyser test hop"}));
+   double const calculatedOg = recipe->og();
+
+   // Make the OG in the DB disagree with the one in memory, which is what we'd see if the way we calculate it changed
+   double const storedOg = calculatedOg + 0.010;
+   QVERIFY(FlushAllObjectStores());
+   bool updatedStoredOg = false;
+   {
+      QSqlDatabase connection = Database::instance().sqlDatabase();
+      BtSqlQuery sqlQuery{connection};
+      sqlQuery.prepare("UPDATE recipe SET og = :og WHERE id = :id;");
+      sqlQuery.bindValue(":og", storedOg);
+      sqlQuery.bindValue(":id", recipeId);
+      updatedStoredOg = sqlQuery.exec();
+   }
+   QVERIFY(updatedStoredOg);
+
+   QVector<RecipeAnalyser::RecipeSnapshot> const snapshots = RecipeAnalyser::snapshotAllRecipes();
+   QVERIFY(!snapshots.isEmpty());
+   auto const snapshot = std::find_if(
+      snapshots.cbegin(),
+      snapshots.cend(),
+      [recipeId](RecipeAnalyser::RecipeSnapshot const & snapshot) { return snapshot.key == recipeId; }
+   );
+   QVERIFY(snapshot != snapshots.cend());
+   // The stored OG has to come from the DB, not from the Recipe object
+   QVERIFY(fuzzyComp(snapshot->storedOg, storedOg, 1e-9));
+
+   CollectingSink sink;
+   int const numDisagreeing = RecipeAnalyser::analyse(snapshots, sink, 2);
+   QCOMPARE(sink.numBegins, 1);
+   QCOMPARE(sink.numEnds, 1);
+   QCOMPARE(sink.stats.size(), snapshots.size());
+   QVERIFY(numDisagreeing >= 1);
+   int const numFlagged = std::count_if(
+      sink.stats.cbegin(),
+      sink.stats.cend(),
+      [](RecipeAnalyser::RecipeStats const & stats) { return stats.storedOgFgDisagree(); }
+   );
+   QCOMPARE(numDisagreeing, numFlagged);
+
+   auto const stats = std::find_if(
+      sink.stats.cbegin(),
+      sink.stats.cend(),
+      [recipeId](RecipeAnalyser::RecipeStats const & stats) { return stats.key == recipeId; }
+   );
+   QVERIFY(stats != sink.stats.cend());
+   QVERIFY(fuzzyComp(stats->og, calculatedOg, 1e-6));
+   QVERIFY(stats->storedOgFgDisagree());
+
+   // Same again via the file sink, as used by --analyse-all
+   QTemporaryDir tempDir;
+   QVERIFY(tempDir.isValid());
+   QString const csvFileName = tempDir.filePath("analysis.csv");
+   std::unique_ptr<RecipeAnalyser::Sink> fileSink = RecipeAnalyser::makeFileSink(csvFileName);
+   QCOMPARE(RecipeAnalyser::analyse(snapshots, *fileSink, 2), numDisagreeing);
+   QFile csvFile{csvFileName};
+   QVERIFY(csvFile.open(QIODevice::ReadOnly | QIODevice::Text));
+   QVERIFY(QString::fromUtf8(csvFile.readLine()).startsWith("key,name,og,fg,"));
+   int numCsvRows = 0;
+   while (!csvFile.atEnd()) {
+      csvFile.readLine();
+      ++numCsvRows;
+   }
+   QCOMPARE(numCsvRows, snapshots.size());
+   return;
+}
+
 void Testing::cleanupTestCase() {
    Application::cleanup();
    Logging::terminateLogging();
@@ -101,6 +101,102 @@ private slots:
    //! \brief Verify Log rotation is working
    void testLogRotation();
 
+   /**
+    * \brief Verify multi-row inserts into junction tables write the same rows as one-row-at-a-time inserts, and log
+    *        how long each approach takes.
+    */
+   void testJunctionTableBatchInsert();
+
+   /**
+    * \brief Verify that reading a large table from the DB gives us every row, and log how long it takes compared with
+    *        reading the same rows by column name (as \c ObjectStore::readAllFromDb used to).
+    */
+   void testObjectStoreLoadBenchmark();
+
+   /**
+    * \brief Verify that an object store snapshot reads back as the same data we would read from the DB, property for
+    *        property, and with junction table rows in the same order
+    */
+   void testObjectStoreSnapshot();
+
+   /**
+    * \brief Verify that, after the DB is closed and opened again, we read the object stores from the snapshot file, and
+    *        that we don't if the DB has changed since or the snapshot file is corrupt
+    */
+   void testObjectStoreSnapshotFile();
+
+   //! \brief Verify that the DB writer thread runs operations in order and reports failures (including exceptions)
+   void testDbWriter();
+
+   //! \brief Verify that a nested DbTransaction can be committed or rolled back without affecting the enclosing one
+   void testDbTransactionNesting();
+
+   //! \brief Verify that the DB uses an index (rather than a table scan) to find junction table rows by foreign key
+   void testForeignKeyIndexes();
+
+   //! \brief Verify that an online backup of the DB contains the same data as the DB
+   void testOnlineBackup();
+
+   /**
+    * \brief Verify that changing a hop in a recipe only recalculates the things that depend on it (ie IBUs), and that
+    *        several changes in a \c Recipe::RecalcBatch only recalculate each thing once
+    */
+   void testRecipeRecalcGraph();
+
+   //! \brief Verify the recipe calculations work on plain values, without any Recipe object
+   void testRecipeCalculator();
+
+   //! \brief Verify the whole-schedule IBU calculation gives the same results as doing one hop at a time
+   void testIbuBatchKernel();
+
+   /**
+    * \brief Verify that calculated results survive being stored, and that a Recipe only queues its stored results to
+    *        be written to the DB when they, or the inputs they came from, change
+    */
+   void testRecipeResultsStorage();
+
+   /**
+    * \brief Verify the indexed Brix/SG/refractive index lookups give the same results as a binary search of the
+    *        conversion table, and benchmark the batch conversion
+    */
+   void testSucroseConversionLookups();
+
+   /**
+    * \brief Verify that deferred property updates are coalesced, not written until flushed, and written ahead of
+    *        anything queued on the DB writer after the flush
+    */
+   void testWriteBehindQueue();
+
+   //! \brief Verify that object stores reuse prepared statements, and prepare them again once they have been released
+   void testStatementCache();
+
+   /**
+    * \brief Verify that updating a junction table property only replaces the rows that have changed (and that we still
+    *        write the right rows when we have to fall back to rewriting all of them)
+    */
+   void testJunctionTableDiff();
+
+   //! \brief Verify that the reverse index finds the recipe that uses an ingredient, and stops finding it once removed
+   void testOwningRecipeIndex();
+
+   /**
+    * \brief Verify that an \c ObjectStoreTransaction is all or nothing, and that, when it is rolled back, the object
+    *        stores undo the in-memory inserts, updates and deletes done inside it
+    */
+   void testObjectStoreTransactionRollback();
+
+   //! \brief Verify that copying everything to a new DB writes all the rows, in chunks, and reports its progress
+   void testCopyToNewDatabase();
+
+   //! \brief Verify that Recipe's copy of the calculation settings is refreshed when the settings change
+   void testCalcSettingsRefresh();
+
+   /**
+    * \brief Verify that the batch recipe analysis reports every recipe, and flags up those whose OG/FG stored in the DB
+    *        disagree with the calculated ones
+    */
+   void testRecipeAnalyser();
+
 };
 
 #endif
@@ -31,6 +31,7 @@
 #include <QTextStream>
 
 #include "config.h" // For CONFIG_VERSION_STRING
+#include "database/ObjectStoreTyped.h"
 #include "model/BrewNote.h"
 #include "model/Equipment.h"
 #include "model/Fermentable.h"
@@ -790,6 +791,13 @@ bool BeerXML::importFromXML(QString const & filename, QTextStream & userMessage)
    //
    RecipeHelper::SuspendRecipeVersioning suspendRecipeVersioning;
 
+   //
+   // Similarly, we want everything we import to be written to the DB in one transaction, and the UI to hear about all
+   // the new objects at the end rather than one at a time.  If we return without committing the session (ie because
+   // the import failed), none of what we imported is kept.
+   //
+   BulkImportSession bulkImportSession;
+
    //
    // Slightly more manually, we also change the cursor to show "busy" while we're doing the import as, for large
    // imports, processing can take a few seconds or so.
@@ -798,5 +806,12 @@ bool BeerXML::importFromXML(QString const & filename, QTextStream & userMessage)
    QApplication::processEvents();
    bool result = this->pimpl->validateAndLoad(filename, userMessage);
    QApplication::restoreOverrideCursor();
-   return result;
+   if (!result) {
+      return false;
+   }
+   if (!bulkImportSession.commit()) {
+      userMessage << "Unable to store imported data in the database.";
+      return false;
+   }
+   return true;
 }
@@ -147,9 +147,9 @@ protected:
          // we wanted to allow clashes with such soft-deleted things then we could add a check against ne->deleted()
          // as in the isDuplicate() function.
          //
-         auto matchResult = ObjectStoreTyped<NE>::getInstance().findFirstMatching(
-            [currentName](std::shared_ptr<NE> ne) {return ne->name() == currentName;}
-         )
+         // The object store keeps an index on name, so this is a quick lookup
+         !ObjectStoreTyped<NE>::getInstance().findAllWithPropertyValue(PropertyNames::NamedEntity::name,
+                                                                       currentName).isEmpty()
       ) {
          qDebug() << Q_FUNC_INFO << "Found existing " << this->namedEntityClassName << "named" << currentName;
 